@@ -796,6 +796,7 @@ static struct mod_paths {
 	{ .name = "ksocklnd",	.path = "lnet/klnds/socklnd" },
 	{ .name = "obdclass",	.path = "lustre/obdclass" },
 	{ .name = "llog_test",	.path = "lustre/obdclass" },
+	{ .name = "handle_test", .path = "lustre/obdclass" },
 	{ .name = "ptlrpc_gss",	.path = "lustre/ptlrpc/gss" },
 	{ .name = "ptlrpc",	.path = "lustre/ptlrpc" },
 	{ .name = "gks",	.path = "lustre/sec/gks" },
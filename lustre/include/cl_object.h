@@ -1650,10 +1650,21 @@ enum cl_enq_flags {
 	 * is known to exist.
 	 */
 	CEF_LOCK_MATCH  = 0x00000080,
+	/**
+	 * tell the DLM layer to not expand the lock extent beyond the
+	 * requested range. Used by lock ahead and the lock no expand advice.
+	 */
+	CEF_LOCK_NO_EXPAND = 0x00000100,
+	/**
+	 * enqueue a lock speculatively (lock ahead): asynchronously, without
+	 * blocking on or revoking conflicting locks, and without an I/O
+	 * holding it afterwards.
+	 */
+	CEF_SPECULATIVE  = 0x00000200,
 	/**
 	 * mask of enq_flags.
 	 */
-	CEF_MASK         = 0x000000ff,
+	CEF_MASK         = 0x000003ff,
 };
 
 /**
@@ -1876,6 +1887,11 @@ struct cl_io {
 	 * Number of pages owned by this IO. For invariant checking.
 	 */
 	unsigned	     ci_owned_nr;
+	/**
+	 * The mirror of a mirrored file this IO is bound to, 1-based, or 0
+	 * to let the lov layer pick one.
+	 */
+	__u32		     ci_designated_mirror;
 };
 
 /** @} cl_io */
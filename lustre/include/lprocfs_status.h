@@ -351,6 +351,7 @@ enum lprocfs_extra_opc {
         MDS_REINT_SETXATTR,
         BRW_READ_BYTES,
         BRW_WRITE_BYTES,
+	PTLRPC_COALESCED,
         EXTRA_LAST_OPC
 };
 
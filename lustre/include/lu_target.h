@@ -404,6 +404,7 @@ int tgt_adapt_sptlrpc_conf(struct lu_target *tgt);
 int tgt_connect(struct tgt_session_info *tsi);
 int tgt_disconnect(struct tgt_session_info *uti);
 int tgt_obd_ping(struct tgt_session_info *tsi);
+int tgt_batch_reint(struct tgt_session_info *tsi);
 int tgt_enqueue(struct tgt_session_info *tsi);
 int tgt_convert(struct tgt_session_info *tsi);
 int tgt_bl_callback(struct tgt_session_info *tsi);
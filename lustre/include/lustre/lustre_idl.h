@@ -117,6 +117,7 @@
 #define SEQ_DATA_PORTAL                31
 #define SEQ_CONTROLLER_PORTAL          32
 #define MGS_BULK_PORTAL                33
+#define MDS_IO_PORTAL			37
 
 /* Portal 63 is reserved for the Cray Inc DVS - nic@cray.com, roe@cray.com, n8851@cray.com */
 
@@ -404,6 +405,7 @@ enum lu_dirent_attrs {
 	LUDA_FID		= 0x0001,
 	LUDA_TYPE		= 0x0002,
 	LUDA_64BITHASH		= 0x0004,
+	LUDA_ATTRS		= 0x0008,
 
 	/* The following attrs are used for MDT internal only,
 	 * not visible to client */
@@ -475,6 +477,28 @@ struct luda_type {
         __u16 lt_type;
 };
 
+/**
+ * Inode attributes of the object referenced by the entry, packed by the MDT
+ * for readdir-plus (OBD_CONNECT2_READDIR_PLUS). Only the fields flagged in
+ * lat_valid (OBD_MD_FL*) are meaningful, no lock protects them.
+ *
+ * Aligned to 8 bytes, always the last attribute of the entry.
+ */
+struct luda_attrs {
+	__u64	lat_valid;
+	__u64	lat_size;
+	__u64	lat_blocks;
+	__s64	lat_mtime;
+	__s64	lat_atime;
+	__s64	lat_ctime;
+	__u32	lat_mode;
+	__u32	lat_nlink;
+	__u32	lat_uid;
+	__u32	lat_gid;
+	__u32	lat_rdev;
+	__u32	lat_flags;
+};
+
 struct lu_dirpage {
         __u64            ldp_hash_start;
         __u64            ldp_hash_end;
@@ -525,9 +549,26 @@ static inline size_t lu_dirent_calc_size(size_t namelen, __u16 attr)
         } else
                 size = sizeof(struct lu_dirent) + namelen;
 
+	if (attr & LUDA_ATTRS) {
+		size = (size + 7) & ~7;
+		size += sizeof(struct luda_attrs);
+	}
+
         return (size + 7) & ~7;
 }
 
+/**
+ * Return the readdir-plus attributes of \a ent, which must have LUDA_ATTRS
+ * set in its (little-endian) lde_attrs.
+ */
+static inline struct luda_attrs *lu_dirent_attrs(struct lu_dirent *ent)
+{
+	__u16 attr = __le32_to_cpu(ent->lde_attrs) & ~LUDA_ATTRS;
+
+	return (void *)ent +
+	       lu_dirent_calc_size(__le16_to_cpu(ent->lde_namelen), attr);
+}
+
 #define MDS_DIR_END_OFF 0xfffffffffffffffeULL
 
 /**
@@ -790,6 +831,11 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT_FLAGS2	 0x8000000000000000ULL /* second flags word */
 /* ocd_connect_flags2 flags */
 #define OBD_CONNECT2_FILE_SECCTX	0x1ULL /* set file security context at create */
+#define OBD_CONNECT2_DOM		0x2ULL /* Data-on-MDT support */
+#define OBD_CONNECT2_BATCH_GETATTR	0x4ULL /* MDS_BATCH_GETATTR RPC */
+#define OBD_CONNECT2_READDIR_PLUS	0x8ULL /* LUDA_ATTRS in readdir pages */
+#define OBD_CONNECT2_BATCH_REINT	0x10ULL /* MDS_BATCH_REINT RPC */
+#define OBD_CONNECT2_LOCK_CONVERT	0x20ULL /* IBITS lock convert support */
 
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
@@ -838,7 +884,11 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT_SUBTREE | OBD_CONNECT_LARGE_ACL | \
 				OBD_CONNECT_FLAGS2)
 
-#define MDT_CONNECT_SUPPORTED2 OBD_CONNECT2_FILE_SECCTX
+#define MDT_CONNECT_SUPPORTED2 (OBD_CONNECT2_FILE_SECCTX | OBD_CONNECT2_DOM | \
+				OBD_CONNECT2_BATCH_GETATTR | \
+				OBD_CONNECT2_READDIR_PLUS | \
+				OBD_CONNECT2_BATCH_REINT | \
+				OBD_CONNECT2_LOCK_CONVERT)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -856,7 +906,8 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_FID | \
 				OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK | \
 				OBD_CONNECT_BULK_MBITS | \
-				OBD_CONNECT_GRANT_PARAM)
+				OBD_CONNECT_GRANT_PARAM | \
+				OBD_CONNECT_SHORTIO | OBD_CONNECT_LOCK_AHEAD)
 #define OST_CONNECT_SUPPORTED2 0
 
 #define ECHO_CONNECT_SUPPORTED 0
@@ -1531,6 +1582,8 @@ typedef enum {
 	MDS_HSM_CT_REGISTER	= 59,
 	MDS_HSM_CT_UNREGISTER	= 60,
 	MDS_SWAP_LAYOUTS	= 61,
+	MDS_BATCH_GETATTR	= 62,
+	MDS_BATCH_REINT		= 63,
 	MDS_LAST_OPC
 } mds_cmd_t;
 
@@ -1610,7 +1663,8 @@ enum {
         LUSTRE_RES_ID_WAS_VER_OFF = 2, /* see note above */
 	LUSTRE_RES_ID_QUOTA_SEQ_OFF = 2,
 	LUSTRE_RES_ID_QUOTA_VER_OID_OFF = 3,
-        LUSTRE_RES_ID_HSH_OFF = 3
+        LUSTRE_RES_ID_HSH_OFF = 3,
+	LUSTRE_RES_ID_DOM_OFF = 2, /* Data-on-MDT data resource tag */
 };
 
 #define MDS_STATUS_CONN 1
@@ -1855,6 +1909,7 @@ enum mds_op_bias {
 	MDS_HSM_RELEASE		= 1 << 12,
 	MDS_RENAME_MIGRATE	= 1 << 13,
 	MDS_CLOSE_LAYOUT_SWAP	= 1 << 14,
+	MDS_CLOSE_RESYNC_DONE	= 1 << 15,
 };
 
 /* instance of mdt_reint_rec */
@@ -2289,7 +2344,8 @@ struct ldlm_extent {
 };
 
 struct ldlm_inodebits {
-        __u64 bits;
+	__u64 bits;
+	__u64 cancel_bits; /* for lock convert */
 };
 
 struct ldlm_flock_wire {
@@ -2383,6 +2439,39 @@ struct ldlm_reply {
         __u64  lock_policy_res2;
 };
 
+/*
+ * MDS_BATCH_GETATTR: lookup, attributes and ibits lock of several names of
+ * one directory in a single RPC. Request and reply buffers both start with
+ * struct mdt_batch_getattr, followed by mbg_count items, each one padded
+ * to 8 bytes.
+ */
+#define MDS_BATCH_GETATTR_MAX	64
+
+struct mdt_batch_getattr {
+	__u32			mbg_count;
+	__u32			mbg_padding;
+};
+
+struct mdt_batch_getattr_req {
+	/* lock created by the client, granted to it on success */
+	struct ldlm_request	mbq_lockreq;
+	/* FID of the entry as found in the directory page */
+	struct lu_fid		mbq_fid;
+	__u32			mbq_namelen;
+	__u32			mbq_padding;
+	char			mbq_name[0];
+};
+
+struct mdt_batch_getattr_rep {
+	__s32			mbp_rc;
+	__u32			mbp_padding;
+	struct ldlm_reply	mbp_lockrep;
+	/* mbo_eadatasize bytes of layout then mbo_aclsize bytes of ACL
+	 * follow in mbp_data, each padded to 8 bytes */
+	struct mdt_body		mbp_body;
+	char			mbp_data[0];
+};
+
 #define ldlm_flags_to_wire(flags)    ((__u32)(flags))
 #define ldlm_flags_from_wire(flags)  ((__u64)(flags))
 
@@ -3175,6 +3264,8 @@ enum {
 	LAYOUT_INTENT_TRUNC	= 4,	/** truncate file, for comp layout */
 	LAYOUT_INTENT_RELEASE	= 5,	/** reserved for HSM release */
 	LAYOUT_INTENT_RESTORE	= 6,	/** reserved for HSM restore */
+	LAYOUT_INTENT_RESYNC	= 7,	/** resync mirrored file */
+	LAYOUT_INTENT_RESYNC_DONE = 8,	/** MDS internal, finish resync */
 };
 
 /* enqueue layout lock with intent */
@@ -3313,6 +3404,17 @@ struct out_update_buffer {
 	__u32	oub_padding;
 };
 
+/*
+ * MDS_BATCH_REINT: several independent MDS_REINT requests in one RPC. The
+ * out_update_header carries ouh_count sub-requests inline, each one an
+ * out_update_buffer with the size of the lustre_msg that follows it, padded
+ * to 8 bytes. The XID of a sub-request is sent in its pb_mbits. The reply is
+ * an object_update_reply holding the reply message of each sub-request as
+ * the data of its object_update_result.
+ */
+#define BATCH_REINT_HEADER_MAGIC	0xBDDF0002
+#define BATCH_REINT_MAX			64
+
 /* the result of object update */
 struct object_update_result {
 	__u32   our_rc;
@@ -399,6 +399,10 @@ struct ll_futimes_3 {
 #define LL_IOC_FID2MDTIDX		_IOWR('f', 248, struct lu_fid)
 #define LL_IOC_GETPARENT		_IOWR('f', 249, struct getparent)
 #define LL_IOC_LADVISE			_IOR('f', 250, struct llapi_lu_ladvise)
+#define LL_IOC_PCC_ATTACH		_IO('f', 251)
+#define LL_IOC_PCC_DETACH		_IO('f', 252)
+#define LL_IOC_PCC_STATE		_IOR('f', 253, struct lu_pcc_state)
+#define LL_IOC_FLR_SET_MIRROR		_IO('f', 254)
 
 #ifndef	FS_IOC_FSGETXATTR
 /*
@@ -424,6 +428,11 @@ enum ll_lease_type {
 	LL_LEASE_RDLCK	= 0x1,
 	LL_LEASE_WRLCK	= 0x2,
 	LL_LEASE_UNLCK	= 0x4,
+	/* only valid for LL_IOC_SET_LEASE, with a write lease held */
+	LL_LEASE_RESYNC		= 0x8,	/* start resync, instantiate stale
+					 * components */
+	LL_LEASE_RESYNC_DONE	= 0x10,	/* release the lease and clear the
+					 * stale flags */
 };
 
 #define LL_STATFS_LMV		1
@@ -469,7 +478,7 @@ enum ll_lease_type {
 #define LOV_PATTERN_NONE	0x000
 #define LOV_PATTERN_RAID0	0x001
 #define LOV_PATTERN_RAID1	0x002
-#define LOV_PATTERN_FIRST	0x100
+#define LOV_PATTERN_MDT		0x100
 #define LOV_PATTERN_CMOBD	0x200
 
 #define LOV_PATTERN_F_MASK	0xffff0000
@@ -480,6 +489,7 @@ enum ll_lease_type {
 static inline bool lov_pattern_supported(__u32 pattern)
 {
 	return pattern == LOV_PATTERN_RAID0 ||
+	       pattern == LOV_PATTERN_MDT ||
 	       pattern == (LOV_PATTERN_RAID0 | LOV_PATTERN_F_RELEASED);
 }
 
@@ -560,15 +570,16 @@ static inline bool lu_extent_is_overlapped(struct lu_extent *e1,
 
 enum lov_comp_md_entry_flags {
 	LCME_FL_PRIMARY	= 0x00000001,	/* Not used */
-	LCME_FL_STALE	= 0x00000002,	/* Not used */
+	LCME_FL_STALE	= 0x00000002,	/* mirror data is out of date */
 	LCME_FL_OFFLINE	= 0x00000004,	/* Not used */
-	LCME_FL_PREFERRED = 0x00000008, /* Not used */
+	LCME_FL_PREFERRED = 0x00000008, /* mirror preferred for read */
 	LCME_FL_INIT	= 0x00000010,	/* instantiated */
 	LCME_FL_NEG	= 0x80000000	/* used to indicate a negative flag,
 					   won't be stored on disk */
 };
 
-#define LCME_KNOWN_FLAGS	(LCME_FL_NEG | LCME_FL_INIT)
+#define LCME_KNOWN_FLAGS	(LCME_FL_NEG | LCME_FL_INIT | LCME_FL_STALE | \
+				 LCME_FL_PREFERRED)
 
 /* lcme_id can be specified as certain flags, and the the first
  * bit of lcme_id is used to indicate that the ID is representing
@@ -593,15 +604,28 @@ struct lov_comp_md_entry_v1 {
 	__u64			lcme_padding[2];
 } __attribute__((packed));
 
-enum lov_comp_md_flags;
+/*
+ * File level replication state of a mirrored file, stored in lcm_flags.
+ * A mirror is a run of components covering [0, EOF), a new mirror starts
+ * with the next component whose extent starts at 0 again.
+ */
+enum lov_comp_md_flags {
+	LCM_FL_NONE		= 0,	/* not a mirrored file */
+	LCM_FL_RDONLY		= 1,	/* all mirrors are in sync */
+	LCM_FL_WRITE_PENDING	= 2,	/* some mirrors are stale */
+	LCM_FL_SYNC_PENDING	= 3,	/* resync is in progress */
+};
+
+#define LCM_FL_FLR_MASK		0x3
 
 struct lov_comp_md_v1 {
 	__u32	lcm_magic;      /* LOV_USER_MAGIC_COMP_V1 */
 	__u32	lcm_size;       /* overall size including this struct */
 	__u32	lcm_layout_gen;
-	__u16	lcm_flags;
+	__u16	lcm_flags;	/* LCM_FL_* */
 	__u16	lcm_entry_count;
-	__u64	lcm_padding1;
+	__u16	lcm_mirror_count; /* 0 or 1 if the file is not mirrored */
+	__u16	lcm_padding1[3];
 	__u64	lcm_padding2;
 	struct lov_comp_md_entry_v1 lcm_entries[0];
 } __attribute__((packed));
@@ -1208,6 +1232,17 @@ static inline void changelog_remap_rec(struct changelog_rec *rec,
 	rec->cr_flags = (rec->cr_flags & CLF_FLAGMASK) | crf_wanted;
 }
 
+/**
+ * Records a changelog reader is interested in, set on the changelog device
+ * with OBD_IOC_CHLG_SET_FILTER. The zeroed fields are not checked.
+ */
+struct changelog_filter {
+	__u32		cf_mask;	/**< (1 << changelog_rec_type) bits */
+	__u32		cf_padding;
+	lustre_fid	cf_fid;		/**< target, parent or source fid */
+	char		cf_jobid[LUSTRE_JOBID_SIZE];
+};
+
 enum changelog_message_type {
         CL_RECORD = 10, /* message is a changelog_rec */
         CL_EOF    = 11, /* at end of current changelog */
@@ -1243,11 +1278,15 @@ enum hsm_states {
 	HS_NORELEASE	= 0x00000010,
 	HS_NOARCHIVE	= 0x00000020,
 	HS_LOST		= 0x00000040,
+	HS_PCCRO	= 0x00000080,	/* read-only copies cached on clients */
 };
 
 /* HSM user-setable flags. */
 #define HSM_USER_MASK   (HS_NORELEASE | HS_NOARCHIVE | HS_DIRTY)
 
+/* HSM flags any reader may set, but only the administrator may clear. */
+#define HSM_PCC_MASK	(HS_PCCRO)
+
 /* Other HSM flags. */
 #define HSM_STATUS_MASK (HS_EXISTS | HS_LOST | HS_RELEASED | HS_ARCHIVED)
 
@@ -1255,7 +1294,7 @@ enum hsm_states {
  * All HSM-related possible flags that could be applied to a file.
  * This should be kept in sync with hsm_states.
  */
-#define HSM_FLAGS_MASK  (HSM_USER_MASK | HSM_STATUS_MASK)
+#define HSM_FLAGS_MASK  (HSM_USER_MASK | HSM_STATUS_MASK | HSM_PCC_MASK)
 
 /**
  * HSM request progress state
@@ -1588,11 +1627,16 @@ enum lu_ladvise_type {
 	LU_LADVISE_INVALID	= 0,
 	LU_LADVISE_WILLREAD	= 1,
 	LU_LADVISE_DONTNEED	= 2,
+	LU_LADVISE_LOCKNOEXPAND = 3,
+	LU_LADVISE_LOCKAHEAD	= 4,
+	LU_LADVISE_MAX
 };
 
 #define LU_LADVISE_NAMES {						\
-	[LU_LADVISE_WILLREAD]	= "willread",				\
-	[LU_LADVISE_DONTNEED]	= "dontneed",				\
+	[LU_LADVISE_WILLREAD]		= "willread",			\
+	[LU_LADVISE_DONTNEED]		= "dontneed",			\
+	[LU_LADVISE_LOCKNOEXPAND]	= "locknoexpand",		\
+	[LU_LADVISE_LOCKAHEAD]		= "lockahead",			\
 }
 
 /* This is the userspace argument for ladvise.  It is currently the same as
@@ -1607,13 +1651,42 @@ struct llapi_lu_ladvise {
 	__u32 lla_value3;
 	__u32 lla_value4;
 };
+#define lla_lockahead_mode	lla_value1
+#define lla_peradvice_flags	lla_value2
+#define lla_lockahead_result	lla_value3
 
 enum ladvise_flag {
 	LF_ASYNC	= 0x00000001,
+	LF_UNSET	= 0x00000002,
 };
 
 #define LADVISE_MAGIC 0x1ADF1CE0
-#define LF_MASK LF_ASYNC
+/* Masks of valid flags for each advice */
+#define LF_LOCKNOEXPAND_MASK LF_UNSET
+/* Flags valid for all advices not explicitly specified */
+#define LF_DEFAULT_MASK LF_ASYNC
+/* All flags */
+#define LF_MASK (LF_ASYNC | LF_UNSET)
+
+/* Lock modes which may be requested with the lock ahead advice */
+enum lock_mode_user {
+	MODE_READ_USER = 1,
+	MODE_WRITE_USER,
+	MODE_MAX_USER,
+};
+
+#define LOCK_MODE_NAMES {			\
+	[MODE_READ_USER]  = "READ",		\
+	[MODE_WRITE_USER] = "WRITE"		\
+}
+
+/* Results reported back in lla_lockahead_result for each lock ahead advice.
+ * Negative values are errors. */
+enum lockahead_results {
+	LLA_RESULT_SENT = 0,	/* lock request was sent to the servers */
+	LLA_RESULT_DIFFERENT,	/* a lock on a different extent exists */
+	LLA_RESULT_SAME,	/* a lock on exactly this extent exists */
+};
 
 /* This is the userspace argument for ladvise, corresponds to ladvise_hdr which
  * is used on the wire.  It is defined separately as we may need info which is
@@ -1630,6 +1703,18 @@ struct llapi_ladvise_hdr {
 
 #define LAH_COUNT_MAX	(1024)
 
+/* Persistent Client Cache state of a file, see LL_IOC_PCC_STATE */
+enum lu_pcc_state_flags {
+	PCC_STATE_NONE		= 0x0,
+	PCC_STATE_READONLY	= 0x1,	/* data is read from the local copy */
+};
+
+struct lu_pcc_state {
+	__u32	pccs_state;		/* from enum lu_pcc_state_flags */
+	__u32	pccs_padding;
+	char	pccs_path[PATH_MAX];	/* path of the local copy */
+};
+
 /* Shared key */
 enum sk_crypt_alg {
 	SK_CRYPT_INVALID	= -1,
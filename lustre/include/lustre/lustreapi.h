@@ -38,6 +38,7 @@
  * @{
  */
 
+#include <dirent.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <lustre/lustre_user.h>
@@ -281,6 +282,27 @@ extern int llapi_ostlist(char *path, struct find_param *param);
 extern int llapi_uuid_match(char *real_uuid, char *search_uuid);
 extern int llapi_getstripe(char *path, struct find_param *param);
 extern int llapi_find(char *path, struct find_param *param);
+extern int llapi_find_parallel(char *path, struct find_param *param,
+			       unsigned int nthreads);
+
+/**
+ * Callbacks of the parallel directory walk, see llapi_walk_tree().
+ *
+ * lwo_entry() is called once for every directory with \a dirp pointing to
+ * the open directory and \a parent set to NULL, and once for every other
+ * entry with \a parent being the open directory it was found in. It returns
+ * a negative errno to report an error, 1 not to descend into a directory.
+ * Each walker thread passes its own \a data, set up by lwo_thread_init().
+ */
+struct llapi_walk_ops {
+	int	(*lwo_thread_init)(void *arg, void **data);
+	void	(*lwo_thread_fini)(void *arg, void *data);
+	int	(*lwo_entry)(char *path, DIR *parent, DIR **dirp,
+			     struct dirent64 *de, int depth, void *data);
+};
+
+extern int llapi_walk_tree(const char *path, unsigned int nthreads,
+			   const struct llapi_walk_ops *ops, void *arg);
 
 extern int llapi_file_fget_mdtidx(int fd, int *mdtidx);
 extern int llapi_dir_set_default_lmv_stripe(const char *name, int stripe_offset,
@@ -388,6 +410,10 @@ extern int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 				 const char *mdtname, long long startrec);
 extern int llapi_changelog_fini(void **priv);
 extern int llapi_changelog_recv(void *priv, struct changelog_rec **rech);
+extern int llapi_changelog_recv_batch(void *priv, struct changelog_rec **rechs,
+				      int count);
+extern int llapi_changelog_set_filter(void *priv,
+				      const struct changelog_filter *filter);
 extern int llapi_changelog_free(struct changelog_rec **rech);
 extern int llapi_changelog_get_fd(void *priv);
 /* Allow records up to endrec to be destroyed; requires registered id. */
@@ -446,6 +472,8 @@ extern int llapi_json_write_list(struct llapi_json_item_list **item_list,
 extern int llapi_lease_get(int fd, int mode);
 extern int llapi_lease_check(int fd);
 extern int llapi_lease_put(int fd);
+extern int llapi_lease_resync(int fd);
+extern int llapi_lease_resync_done(int fd);
 
 /* Group lock */
 int llapi_group_lock(int fd, int gid);
@@ -454,6 +482,14 @@ int llapi_group_unlock(int fd, int gid);
 /* Ladvise */
 int llapi_ladvise(int fd, unsigned long long flags, int num_advise,
 		  struct llapi_lu_ladvise *ladvise);
+
+/* Read-only Persistent Client Cache */
+int llapi_pcc_attach_fd(int fd);
+int llapi_pcc_attach(const char *path);
+int llapi_pcc_detach_fd(int fd);
+int llapi_pcc_detach(const char *path);
+int llapi_pcc_state_get_fd(int fd, struct lu_pcc_state *state);
+int llapi_pcc_state_get(const char *path, struct lu_pcc_state *state);
 /** @} llapi */
 
 /* llapi_layout user interface */
@@ -533,6 +569,13 @@ void llapi_layout_free(struct llapi_layout *layout);
  */
 #define LLAPI_LAYOUT_RAID0	0
 
+/**
+ * When specified as the value for layout pattern of the first component,
+ * the data of this component is stored on the MDT together with the file
+ * metadata (Data-on-MDT).
+ */
+#define LLAPI_LAYOUT_MDT	2
+
 /**
 * The layout includes a specific set of OSTs on which to allocate.
 */
@@ -748,11 +791,11 @@ static const struct comp_flag_name {
 	const char *cfn_name;
 } comp_flags_table[] = {
 	{ LCME_FL_INIT,		"init" },
-	/* For now, only "init" is supported
-	{ LCME_FL_PRIMARY,	"primary" },
 	{ LCME_FL_STALE,	"stale" },
+	{ LCME_FL_PREFERRED,	"prefer" },
+	/* Not supported yet
+	{ LCME_FL_PRIMARY,	"primary" },
 	{ LCME_FL_OFFLINE,	"offline" },
-	{ LCME_FL_PREFERRED,	"preferred" }
 	*/
 };
 
@@ -781,6 +824,11 @@ int llapi_layout_comp_add(struct llapi_layout *layout);
  * Deletes the current layout component from the composite layout.
  */
 int llapi_layout_comp_del(struct llapi_layout *layout);
+/**
+ * Appends the components of a layout to another one as a new mirror.
+ */
+int llapi_layout_merge(struct llapi_layout **dst_layout,
+		       const struct llapi_layout *src_layout);
 
 enum llapi_layout_comp_use {
 	LLAPI_LAYOUT_COMP_USE_FIRST = 1,
@@ -188,6 +188,9 @@ static inline int lockmode_compat(enum ldlm_mode exist_mode,
  * lr_lock
  *     ns_lock
  *
+ * lr_lock
+ *     lls_lock
+ *
  * lr_lvb_mutex
  *     lr_lock
  *
@@ -274,6 +277,7 @@ typedef int (*ldlm_res_policy)(struct ldlm_namespace *, struct ldlm_lock **,
 			       __u64 flags, void *data);
 
 typedef int (*ldlm_cancel_cbt)(struct ldlm_lock *lock);
+typedef unsigned long (*ldlm_weigh_cbt)(struct ldlm_lock *lock);
 
 /**
  * LVB operations.
@@ -310,12 +314,13 @@ enum ldlm_appetite {
 };
 
 /**
- * Default values for the "max_nolock_size", "contention_time" and
- * "contended_locks" namespace tunables.
+ * Default values for the "max_nolock_size", "contention_time",
+ * "contended_locks" and "contention_region_bytes" namespace tunables.
  */
 #define NS_DEFAULT_MAX_NOLOCK_BYTES 0
 #define NS_DEFAULT_CONTENTION_SECONDS 2
 #define NS_DEFAULT_CONTENDED_LOCKS 32
+#define NS_DEFAULT_CONTENTION_REGION_BYTES (1 << 20)
 
 struct ldlm_ns_bucket {
 	/** back pointer to namespace */
@@ -335,9 +340,37 @@ struct ldlm_ns_bucket {
 enum {
 	/** LDLM namespace lock stats */
 	LDLM_NSS_LOCKS          = 0,
+	/** locks examined by the LRU scans */
+	LDLM_NSS_LRU_SCANNED,
+	/** locks picked for cancel by the LRU scans */
+	LDLM_NSS_LRU_CANCELLED,
+	/** costly locks moved back to the LRU tail instead of cancelled */
+	LDLM_NSS_LRU_SPARED,
+	/** unused locks taken out of the LRU to be used again */
+	LDLM_NSS_LRU_HITS,
+	/** duration of the LRU scans */
+	LDLM_NSS_LRU_SCAN_TIME,
 	LDLM_NSS_LAST
 };
 
+/** Number of sub-lists the LRU of a client namespace is split into */
+#define LDLM_LRU_SHARDS		8
+
+/**
+ * One sub-list of the LRU of unused locks of a client namespace. A lock
+ * always goes to the sub-list selected by its handle cookie, so that the
+ * locks used on different CPUs rarely contend for the same lls_lock.
+ */
+struct ldlm_lru_shard {
+	spinlock_t		lls_lock;
+	/** Unused locks, least recently used first, linked by l_lru */
+	struct list_head	lls_list;
+	/** Number of locks in lls_list */
+	int			lls_nr;
+	/** Position of the LDLM_LRU_FLAG_NO_WAIT scan in lls_list */
+	struct list_head	*lls_last_pos;
+} ____cacheline_aligned;
+
 enum ldlm_ns_type {
 	LDLM_NS_TYPE_UNKNOWN = 0,	/**< invalid type */
 	LDLM_NS_TYPE_MDC,		/**< MDC namespace */
@@ -404,19 +437,17 @@ struct ldlm_namespace {
 	struct list_head	ns_list_chain;
 
 	/**
-	 * List of unused locks for this namespace. This list is also called
-	 * LRU lock list.
+	 * Lists of unused locks for this namespace. These lists are also
+	 * called LRU lock list.
 	 * Unused locks are locks with zero reader/writer reference counts.
-	 * This list is only used on clients for lock caching purposes.
+	 * These lists are only used on clients for lock caching purposes.
 	 * When we want to release some locks voluntarily or if server wants
 	 * us to release some locks due to e.g. memory pressure, we take locks
-	 * to release from the head of this list.
+	 * to release from the head of the list whose first lock is the least
+	 * recently used one.
 	 * Locks are linked via l_lru field in \see struct ldlm_lock.
 	 */
-	struct list_head	ns_unused_list;
-	/** Number of locks in the LRU list above */
-	int			ns_nr_unused;
-	struct list_head	*ns_last_pos;
+	struct ldlm_lru_shard	ns_lru[LDLM_LRU_SHARDS];
 
 	/**
 	 * Maximum number of locks permitted in the LRU. If 0, means locks
@@ -474,18 +505,25 @@ struct ldlm_namespace {
 	enum ldlm_appetite	ns_appetite;
 
 	/**
-	 * If more than \a ns_contended_locks are found, the resource is
-	 * considered to be contended. Lock enqueues might specify that no
-	 * contended locks should be granted
+	 * If more than \a ns_contended_locks conflicting locks are found in
+	 * an extent region of a resource within \a ns_contention_time, the
+	 * region is considered to be contended. Lock enqueues might specify
+	 * that no contended locks should be granted
 	 */
 	unsigned		ns_contended_locks;
 
 	/**
-	 * The resources in this namespace remember contended state during
-	 * \a ns_contention_time, in seconds.
+	 * Length of the sliding window over which conflicts are counted,
+	 * in seconds.
 	 */
 	unsigned		ns_contention_time;
 
+	/**
+	 * Size of the extent regions whose contention is tracked, in bytes.
+	 * A power of two.
+	 */
+	unsigned		ns_contention_region;
+
 	/**
 	 * Limit size of contended extent locks, in bytes.
 	 * If extended lock is requested for more then this many bytes and
@@ -503,6 +541,13 @@ struct ldlm_namespace {
 	 */
 	ldlm_cancel_cbt		ns_cancel;
 
+	/**
+	 * Callback returning the cost of cancelling a lock, e.g. the number
+	 * of cached pages it covers. The LRU scans keep costly locks a bit
+	 * longer than cheap ones. Called without locks held.
+	 */
+	ldlm_weigh_cbt		ns_weigh;
+
 	/** LDLM lock stats */
 	struct lprocfs_stats	*ns_stats;
 
@@ -572,6 +617,25 @@ static inline void ns_register_cancel(struct ldlm_namespace *ns,
 	ns->ns_cancel = arg;
 }
 
+static inline void ns_register_weigh(struct ldlm_namespace *ns,
+				     ldlm_weigh_cbt arg)
+{
+	LASSERT(ns != NULL);
+	ns->ns_weigh = arg;
+}
+
+/** Number of locks in the LRU of \a ns, read without locking */
+static inline int ldlm_ns_nr_unused(struct ldlm_namespace *ns)
+{
+	int nr = 0;
+	int i;
+
+	for (i = 0; i < LDLM_LRU_SHARDS; i++)
+		nr += ACCESS_ONCE(ns->ns_lru[i].lls_nr);
+
+	return nr;
+}
+
 struct ldlm_lock;
 
 /** Type for blocking callback function of a lock. */
@@ -634,6 +698,47 @@ struct ldlm_interval_tree {
 	struct interval_node	*lit_root; /* actual ldlm_interval */
 };
 
+#define MDS_INODELOCK_NUMBITS (MDS_INODELOCK_MAXSHIFT + 1)
+
+/**
+ * Per-bit queues of the locks waiting on an IBITS resource.
+ * Only allocated for server resources, where a new lock is checked for
+ * conflicts against the waiting locks sharing a bit with it rather than
+ * against every waiting lock. See ldlm/ldlm_inodebits.c.
+ */
+struct ldlm_ibits_queues {
+	struct list_head	liq_waiting[MDS_INODELOCK_NUMBITS];
+};
+
+/** Linkage of a waiting IBITS lock into the ldlm_ibits_queues */
+struct ldlm_ibits_node {
+	struct list_head	lin_link[MDS_INODELOCK_NUMBITS];
+	struct ldlm_lock	*lin_lock;
+};
+
+/** Number of extent regions whose contention is tracked per resource */
+#define LDLM_CONTENTION_REGIONS	8
+
+/**
+ * Conflicts seen by the enqueues of one extent region of a resource,
+ * counted over a sliding window approximated by two fixed windows.
+ */
+struct ldlm_contention_region {
+	__u64			lcr_index;  /* offset / ns_contention_region */
+	time64_t		lcr_window; /* start of the current window */
+	unsigned int		lcr_cur;    /* conflicts in current window */
+	unsigned int		lcr_prev;   /* conflicts in previous window */
+};
+
+/**
+ * Contention tracker of a server extent resource, allocated on the first
+ * conflict. Regions are direct-mapped by index, a region evicts the one it
+ * collides with. See ldlm/ldlm_extent.c.
+ */
+struct ldlm_extent_contention {
+	struct ldlm_contention_region lec_regions[LDLM_CONTENTION_REGIONS];
+};
+
 /** Whether to track references to exports by LDLM locks. */
 #define LUSTRE_TRACKS_LOCK_EXP_REFS (0)
 
@@ -719,7 +824,7 @@ struct ldlm_lock {
 	struct ldlm_resource	*l_resource;
 	/**
 	 * List item for client side LRU list.
-	 * Protected by ns_lock in struct ldlm_namespace.
+	 * Protected by lls_lock of the LRU shard of the lock.
 	 */
 	struct list_head	l_lru;
 	/**
@@ -732,6 +837,11 @@ struct ldlm_lock {
 	 * Tree node for ldlm_extent.
 	 */
 	struct ldlm_interval	*l_tree_node;
+	/**
+	 * Per-bit waiting queue linkage for server IBITS locks, freed
+	 * once the lock is granted.
+	 */
+	struct ldlm_ibits_node	*l_ibits_node;
 	/**
 	 * Per export hash of locks.
 	 * Protected by per-bucket exp->exp_lock_hash locks.
@@ -977,12 +1087,16 @@ struct ldlm_resource {
 	 * Interval trees (only for extent locks) for all modes of this resource
 	 */
 	struct ldlm_interval_tree *lr_itree;
+	/**
+	 * Per-bit waiting queues (only for server IBITS resources)
+	 */
+	struct ldlm_ibits_queues *lr_ibits_queues;
 
 	union {
 		/**
-		 * When the resource was considered as contended,
+		 * Contention of the extent regions,
 		 * used only on server side. */
-		cfs_time_t	lr_contention_time;
+		struct ldlm_extent_contention *lr_contention;
 		/**
 		 * Associated inode, used only on client side.
 		 */
@@ -1551,6 +1665,16 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 			  enum ldlm_mode mode, __u64 *flags, void *lvb,
 			  __u32 lvb_len,
 			  const struct lustre_handle *lockh, int rc);
+int ldlm_cli_lock_create_pack(struct obd_export *exp,
+			      struct ldlm_request *dlmreq,
+			      struct ldlm_enqueue_info *einfo,
+			      const struct ldlm_res_id *res_id,
+			      union ldlm_policy_data const *policy,
+			      __u64 *flags, struct lustre_handle *lockh);
+int ldlm_cli_enqueue_fini_reply(struct obd_export *exp,
+				struct ldlm_reply *reply, enum ldlm_type type,
+				enum ldlm_mode mode, __u64 *flags,
+				const struct lustre_handle *lockh, int rc);
 int ldlm_cli_enqueue_local(struct ldlm_namespace *ns,
 			   const struct ldlm_res_id *res_id,
 			   enum ldlm_type type, union ldlm_policy_data *policy,
@@ -1563,6 +1687,7 @@ int ldlm_cli_enqueue_local(struct ldlm_namespace *ns,
 			   struct lustre_handle *lockh);
 int ldlm_cli_convert(const struct lustre_handle *lockh, int new_mode,
 		     __u32 *flags);
+int ldlm_cli_dropbits(struct ldlm_lock *lock, __u64 drop_bits);
 int ldlm_cli_update_pool(struct ptlrpc_request *req);
 int ldlm_cli_cancel(const struct lustre_handle *lockh,
 		    enum ldlm_cancel_flags cancel_flags);
@@ -1669,5 +1794,12 @@ static inline int ldlm_extent_contain(const struct ldlm_extent *ex1,
 	return ex1->start <= ex2->start && ex1->end >= ex2->end;
 }
 
+/* check if @ex1 and @ex2 cover exactly the same range */
+static inline int ldlm_extent_equal(const struct ldlm_extent *ex1,
+				    const struct ldlm_extent *ex2)
+{
+	return ex1->start == ex2->start && ex1->end == ex2->end;
+}
+
 #endif
 /** @} LDLM */
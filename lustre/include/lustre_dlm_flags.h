@@ -26,7 +26,7 @@
 #ifndef LDLM_ALL_FLAGS_MASK
 
 /** l_flags bits marked as "all_flags" bits */
-#define LDLM_FL_ALL_FLAGS_MASK          0x00FFFFFFC08F932FULL
+#define LDLM_FL_ALL_FLAGS_MASK          0x00FFFFFFC08F973FULL
 
 /** extent, mode, or resource changed */
 #define LDLM_FL_LOCK_CHANGED            0x0000000000000001ULL // bit   0
@@ -58,6 +58,15 @@
 #define ldlm_set_block_wait(_l)         LDLM_SET_FLAG((  _l), 1ULL <<  3)
 #define ldlm_clear_block_wait(_l)       LDLM_CLEAR_FLAG((_l), 1ULL <<  3)
 
+/**
+ * Lock request is speculative (lock ahead): the server must neither block
+ * it nor revoke conflicting locks on its behalf, but refuse the request
+ * with -EWOULDBLOCK instead. */
+#define LDLM_FL_SPECULATIVE             0x0000000000000010ULL // bit   4
+#define ldlm_is_speculative(_l)         LDLM_TEST_FLAG(( _l), 1ULL <<  4)
+#define ldlm_set_speculative(_l)        LDLM_SET_FLAG((  _l), 1ULL <<  4)
+#define ldlm_clear_speculative(_l)      LDLM_CLEAR_FLAG((_l), 1ULL <<  4)
+
 /** blocking or cancel packet was queued for sending. */
 #define LDLM_FL_AST_SENT                0x0000000000000020ULL // bit   5
 #define ldlm_is_ast_sent(_l)            LDLM_TEST_FLAG(( _l), 1ULL <<  5)
@@ -78,6 +87,12 @@
 #define ldlm_set_intent_only(_l)        LDLM_SET_FLAG((  _l), 1ULL <<  9)
 #define ldlm_clear_intent_only(_l)      LDLM_CLEAR_FLAG((_l), 1ULL <<  9)
 
+/** Do not expand the lock extent beyond what the client requested. */
+#define LDLM_FL_NO_EXPANSION            0x0000000000000400ULL // bit  10
+#define ldlm_is_no_expansion(_l)        LDLM_TEST_FLAG(( _l), 1ULL << 10)
+#define ldlm_set_no_expansion(_l)       LDLM_SET_FLAG((  _l), 1ULL << 10)
+#define ldlm_clear_no_expansion(_l)     LDLM_CLEAR_FLAG((_l), 1ULL << 10)
+
 /** lock request has intent */
 #define LDLM_FL_HAS_INTENT              0x0000000000001000ULL // bit  12
 #define ldlm_is_has_intent(_l)          LDLM_TEST_FLAG(( _l), 1ULL << 12)
@@ -138,6 +153,14 @@
 #define ldlm_set_cos_incompat(_l)	LDLM_SET_FLAG((_l), 1ULL << 24)
 #define ldlm_clear_cos_incompat(_l)	LDLM_CLEAR_FLAG((_l), 1ULL << 24)
 
+/**
+ * Set in the reply to an enqueue refused with -EUSERS: the lock descriptor
+ * extent is the contended range, the only one to do lockless I/O for. */
+#define LDLM_FL_CONTENDED		0x0000000002000000ULL /* bit  25 */
+#define ldlm_is_contended(_l)		LDLM_TEST_FLAG((_l), 1ULL << 25)
+#define ldlm_set_contended(_l)		LDLM_SET_FLAG((_l), 1ULL << 25)
+#define ldlm_clear_contended(_l)	LDLM_CLEAR_FLAG((_l), 1ULL << 25)
+
 /**
  * measure lock contention and return -EUSERS if locking contention is high */
 #define LDLM_FL_DENY_ON_CONTENTION        0x0000000040000000ULL // bit  30
@@ -354,6 +377,20 @@
 #define ldlm_is_cos_enabled(_l)          LDLM_TEST_FLAG((_l), 1ULL << 57)
 #define ldlm_set_cos_enabled(_l)         LDLM_SET_FLAG((_l), 1ULL << 57)
 
+/** Client is dropping the conflicting inodebits of this lock with a
+ *  LDLM_CONVERT RPC instead of cancelling it, see ldlm_cli_dropbits(). */
+#define LDLM_FL_CONVERTING               0x0400000000000000ULL /* bit  58 */
+#define ldlm_is_converting(_l)           LDLM_TEST_FLAG((_l), 1ULL << 58)
+#define ldlm_set_converting(_l)          LDLM_SET_FLAG((_l), 1ULL << 58)
+#define ldlm_clear_converting(_l)        LDLM_CLEAR_FLAG((_l), 1ULL << 58)
+
+/** Unused lock already moved back to the LRU tail once for the cost of
+ *  its cancel, the next LRU scan may cancel it, see ldlm_lru_spare(). */
+#define LDLM_FL_LRU_SPARED               0x0800000000000000ULL /* bit  59 */
+#define ldlm_is_lru_spared(_l)           LDLM_TEST_FLAG((_l), 1ULL << 59)
+#define ldlm_set_lru_spared(_l)          LDLM_SET_FLAG((_l), 1ULL << 59)
+#define ldlm_clear_lru_spared(_l)        LDLM_CLEAR_FLAG((_l), 1ULL << 59)
+
 /** l_flags bits marked as "ast" bits */
 #define LDLM_FL_AST_MASK                (LDLM_FL_FLOCK_DEADLOCK		|\
 					 LDLM_FL_AST_DISCARD_DATA)
@@ -657,6 +657,30 @@ fid_build_pdo_res_name(const struct lu_fid *fid, unsigned int hash,
 	res->name[LUSTRE_RES_ID_HSH_OFF] = hash;
 }
 
+/* "dom" tag stored in name[LUSTRE_RES_ID_DOM_OFF] of DoM data resources */
+#define LUSTRE_RES_ID_DOM	0x646f6dULL
+
+/*
+ * Build DLM resource name for the data of a Data-on-MDT file.
+ *
+ * Data is protected by extent locks, which cannot share the inodebits
+ * resource of the file, so it gets its own resource tagged in name[2].
+ */
+static inline void
+fid_build_dom_res_name(const struct lu_fid *fid, struct ldlm_res_id *res)
+{
+	fid_build_reg_res_name(fid, res);
+	res->name[LUSTRE_RES_ID_DOM_OFF] = LUSTRE_RES_ID_DOM;
+}
+
+/*
+ * Return true if resource is the DoM data resource of some file.
+ */
+static inline bool fid_res_name_is_dom(const struct ldlm_res_id *res)
+{
+	return res->name[LUSTRE_RES_ID_DOM_OFF] == LUSTRE_RES_ID_DOM;
+}
+
 /**
  * Build DLM resource name from object id & seq, which will be removed
  * finally, when we replace ost_id with FID in data stack.
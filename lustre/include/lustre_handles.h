@@ -43,7 +43,11 @@
 #include <libcfs/libcfs.h>
 
 struct portals_handle_ops {
-	void (*hop_addref)(void *object);
+	/**
+	 * Take a reference on \a object found by a lockless lookup, unless
+	 * its last reference is already gone. Return false in that case.
+	 */
+	bool (*hop_addref)(void *object);
 	void (*hop_free)(void *object, int size);
 };
 
@@ -66,7 +70,6 @@ struct portals_handle {
 
 	/* newly added fields to handle the RCU issue. -jxiong */
 	struct rcu_head			h_rcu;
-	spinlock_t			h_lock;
 	unsigned int			h_size:31;
 	unsigned int			h_in:1;
 };
@@ -77,6 +77,12 @@ int target_queue_recovery_request(struct ptlrpc_request *req,
                                   struct obd_device *obd);
 int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
                    struct l_wait_info *lwi);
+typedef void (*target_bulk_md_cb_t)(struct ptlrpc_bulk_desc *desc, int mdidx,
+				    void *data);
+int target_bulk_io_pipelined(struct obd_export *exp,
+			     struct ptlrpc_bulk_desc *desc,
+			     struct l_wait_info *lwi,
+			     target_bulk_md_cb_t md_done, void *data);
 #endif
 
 int target_pack_pool_reply(struct ptlrpc_request *req);
@@ -51,6 +51,7 @@
  * @{
  */
 
+#include <linux/llist.h>
 #include <linux/uio.h>
 #include <libcfs/libcfs.h>
 #include <lnet/nidstr.h>
@@ -108,6 +109,14 @@
 #define DT_MAX_BRW_PAGES	(DT_MAX_BRW_SIZE >> PAGE_SHIFT)
 #define OFD_MAX_BRW_SIZE	(1U << LNET_MTU_BITS)
 
+/**
+ * Short I/O: a BRW whose payload is no larger than the negotiated threshold
+ * carries its data inline in the request (write) or reply (read) message,
+ * avoiding the separate bulk RDMA handshake for small, latency-bound I/O.
+ */
+#define OBD_DEF_SHORT_IO_BYTES	(16 * 1024)
+#define OBD_MAX_SHORT_IO_BYTES	(64 * 1024)
+
 /* When PAGE_SIZE is a constant, we can check our arithmetic here with cpp! */
 #if ((PTLRPC_MAX_BRW_PAGES & (PTLRPC_MAX_BRW_PAGES - 1)) != 0)
 # error "PTLRPC_MAX_BRW_PAGES isn't a power of two"
@@ -479,15 +488,32 @@
 			     sizeof(struct obdo) + \
 			     sizeof(struct obd_ioobj) + \
 			     sizeof(struct niobuf_remote) * DT_MAX_BRW_PAGES)
+/**
+ * A short I/O write carries its data inline, see OBD_MAX_SHORT_IO_BYTES
+ */
+#define _OST_SHORTIO_MAXREQSIZE_SUM (sizeof(struct lustre_msg) + \
+				     sizeof(struct ptlrpc_body) + \
+				     sizeof(struct obdo) + \
+				     sizeof(struct obd_ioobj) + \
+				     sizeof(struct niobuf_remote) + \
+				     sizeof(struct lustre_capa) + \
+				     OBD_MAX_SHORT_IO_BYTES)
 /**
  * FIEMAP request can be 4K+ for now
  */
 #define OST_MAXREQSIZE		(16 * 1024)
 #define OST_IO_MAXREQSIZE	max_t(int, OST_MAXREQSIZE, \
-				(((_OST_MAXREQSIZE_SUM - 1) | (1024 - 1)) + 1))
+				(((max_t(int, _OST_MAXREQSIZE_SUM, \
+					 _OST_SHORTIO_MAXREQSIZE_SUM) - 1) | \
+				  (1024 - 1)) + 1))
 
 #define OST_MAXREPSIZE		(9 * 1024)
-#define OST_IO_MAXREPSIZE	OST_MAXREPSIZE
+/* a short I/O read returns its data inline in the reply */
+#define OST_IO_MAXREPSIZE	max_t(int, OST_MAXREPSIZE, \
+				      sizeof(struct lustre_msg) + \
+				      sizeof(struct ptlrpc_body) + \
+				      sizeof(struct ost_body) + \
+				      OBD_MAX_SHORT_IO_BYTES + 1024)
 
 #define OST_NBUFS		64
 /** OST_BUFSIZE = max_reqsize + max sptlrpc payload size */
@@ -652,6 +678,10 @@ struct ptlrpc_reply_state {
 	struct list_head	rs_exp_list;
 	/** Linkage for list of all reply states for same obd */
 	struct list_head	rs_obd_list;
+	/** Linkage in the queue of the reply handling thread */
+	struct llist_node	rs_hr_node;
+	/** When the difficult reply was sent, for ack/commit latency */
+	ktime_t			rs_sent;
 #if RS_DEBUG
 	struct list_head	rs_debug_list;
 #endif
@@ -666,6 +696,7 @@ struct ptlrpc_reply_state {
         unsigned long          rs_handled:1;  /* been handled yet? */
         unsigned long          rs_on_net:1;   /* reply_out_callback pending? */
         unsigned long          rs_prealloc:1; /* rs from prealloc list */
+	unsigned long		rs_arena:1;	/* rs from scp_rs_arena */
         unsigned long          rs_committed:1;/* the transaction was committed
                                                  and the rs was dispatched
                                                  by ptlrpc_commit_replies */
@@ -879,6 +910,52 @@ struct ptlrpc_cli_req {
 #define rq_commit_cb		rq_cli.cr_commit_cb
 #define rq_replay_cb		rq_cli.cr_replay_cb
 
+/**
+ * Stages of server request handling whose latency is recorded in the
+ * service histograms, see ptlrpc_req_stage_add()
+ */
+enum ptlrpc_req_stage {
+	/** from arrival to the start of handling, mostly NRS queueing */
+	PTLRPC_STAGE_QUEUE	= 0,
+	/** whole handling, including all stages below */
+	PTLRPC_STAGE_HANDLE,
+	/** unpacking and checking the request before its handler runs */
+	PTLRPC_STAGE_UNPACK,
+	/** obd_preprw(): preparing pages, reading data */
+	PTLRPC_STAGE_IO_PREP,
+	/** bulk transfer */
+	PTLRPC_STAGE_BULK,
+	/** obd_commitrw(): writing data, including the osd transaction */
+	PTLRPC_STAGE_IO_COMMIT,
+	/** sending the reply */
+	PTLRPC_STAGE_REPLY,
+	PTLRPC_STAGE_MAX
+};
+
+/**
+ * Reply states of up to PTLRPC_RS_ARENA_MAX bytes are cached by each
+ * service partition in power of two size classes, the smallest class
+ * being 1 << PTLRPC_RS_ARENA_SHIFT bytes.
+ */
+#define PTLRPC_RS_ARENA_SHIFT	10
+#define PTLRPC_RS_ARENA_CLASSES	7
+#define PTLRPC_RS_ARENA_MAX	(1 << (PTLRPC_RS_ARENA_SHIFT + \
+				       PTLRPC_RS_ARENA_CLASSES - 1))
+
+/** number of slow requests kept by each service */
+#define PTLRPC_SLOW_REQ_MAX	64
+
+/** a request which took longer than srv_slow_req_threshold */
+struct ptlrpc_slow_req {
+	__u64		psr_xid;
+	lnet_nid_t	psr_peer;
+	time64_t	psr_arrival;
+	__u32		psr_opc;
+	__u32		psr_total_us;
+	__u32		psr_stage_us[PTLRPC_STAGE_MAX];
+	char		psr_jobid[LUSTRE_JOBID_SIZE];
+};
+
 struct ptlrpc_srv_req {
 	/** initial thread servicing this request */
 	struct ptlrpc_thread		*sr_svc_thread;
@@ -924,6 +1001,10 @@ struct ptlrpc_srv_req {
 	struct ptlrpc_hpreq_ops		*sr_ops;
 	/** incoming request buffer */
 	struct ptlrpc_request_buffer_desc *sr_rqbd;
+	/** time spent in each handling stage (usecs) */
+	__u32				 sr_stage_us[PTLRPC_STAGE_MAX];
+	/** stages this request went through, bit per ptlrpc_req_stage */
+	__u32				 sr_stage_mask;
 };
 
 /** server request member alias */
@@ -1007,7 +1088,10 @@ struct ptlrpc_request {
 	unsigned int
 		rq_hp:1,		/**< high priority RPC */
 		rq_at_linked:1,		/**< link into service's srv_at_array */
-		rq_packed_final:1;	/**< packed final reply */
+		rq_packed_final:1,	/**< packed final reply */
+		rq_stolen:1,		/**< handled by another partition */
+		rq_coalesce:1;		/**< small async RPC, ptlrpcd may
+					 *   delay its wakeup to batch it */
 	/** @} */
 
 	/** one of RQ_PHASE_* */
@@ -1228,6 +1312,18 @@ static inline void lustre_set_rep_swabbed(struct ptlrpc_request *req,
         req->rq_rep_swab_mask |= 1 << index;
 }
 
+/**
+ * Account the time since \a start to handling stage \a stage of server
+ * request \a req, \a start should come from ktime_get()
+ */
+static inline void ptlrpc_req_stage_add(struct ptlrpc_request *req,
+					enum ptlrpc_req_stage stage,
+					ktime_t start)
+{
+	req->rq_srv.sr_stage_us[stage] += ktime_us_delta(ktime_get(), start);
+	req->rq_srv.sr_stage_mask |= BIT(stage);
+}
+
 /**
  * Convert numerical request phase value \a phase into text string description
  */
@@ -1442,6 +1538,8 @@ struct ptlrpc_bulk_desc {
 	unsigned long bd_failure:1;
 	/** client side */
 	unsigned long bd_registered:1;
+	/** server side - record arrival of each MD in bd_md_done */
+	unsigned long bd_md_track:1;
 	/** For serialization with callback */
 	spinlock_t bd_lock;
 	/** Import generation when request for this bulk was sent */
@@ -1469,8 +1567,14 @@ struct ptlrpc_bulk_desc {
 	lnet_nid_t             bd_sender;       /* stash event::sender */
 	int			bd_md_count;	/* # valid entries in bd_mds */
 	int			bd_md_max_brw;	/* max entries in bd_mds */
+	/** bitmap of MDs whose data has arrived, if bd_md_track is set */
+	__u64			bd_md_done;
 	/** array of associated MDs */
 	struct lnet_handle_md	bd_mds[PTLRPC_BULK_OPS_COUNT];
+	/** server side - partition whose bulk pool this desc belongs to */
+	struct ptlrpc_service_part *bd_svcpt;
+	/** linkage on ptlrpc_service_part::scp_bulk_free */
+	struct list_head	bd_pool_list;
 
 	union {
 		struct {
@@ -1541,6 +1645,8 @@ struct ptlrpc_thread {
 	wait_queue_head_t		t_ctl_waitq;
 	struct lu_env			*t_env;
 	char				t_name[PTLRPC_THR_NAME_LEN];
+	/** last time this thread handled a request */
+	time64_t			t_busy_time;
 };
 
 static inline int thread_is_init(struct ptlrpc_thread *thread)
@@ -1693,12 +1799,24 @@ struct ptlrpc_service {
 	int				srv_nthrs_cpt_init;
 	/** limit of threads number for each partition */
 	int				srv_nthrs_cpt_limit;
+	/** retire threads idle this long (seconds), 0 to never retire */
+	int				srv_thrs_idle_time;
+	/** start threads only if requests wait longer (usecs), 0 always */
+	int				srv_thrs_wait_target;
+	/** record requests taking longer than this (msecs), 0 never */
+	int				srv_slow_req_threshold;
+	/** next slot in srv_slow_reqs, protected by srv_lock */
+	unsigned int			srv_slow_req_next;
+	/** ring of the last PTLRPC_SLOW_REQ_MAX slow requests */
+	struct ptlrpc_slow_req		*srv_slow_reqs;
         /** Root of /proc dir tree for this service */
 	struct proc_dir_entry           *srv_procroot;
         /** Pointer to statistic data for this service */
         struct lprocfs_stats           *srv_stats;
         /** # hp per lp reqs to handle */
         int                             srv_hpreq_ratio;
+	/** idle threads handle requests queued on other partitions */
+	int				srv_req_steal;
         /** biggest request to receive */
         int                             srv_max_req_size;
         /** biggest reply to send */
@@ -1768,6 +1886,14 @@ struct ptlrpc_service_part {
 	int				scp_nthrs_stopping;
 	/** # running threads */
 	int				scp_nthrs_running;
+	/** # threads retired because they were idle */
+	__u64				scp_nthrs_retired;
+	/** moving average of request queue wait time (usecs) */
+	__u64				scp_thr_wait_avg;
+	/** latency of each handling stage (usecs), log2 buckets */
+	struct obd_histogram		scp_stage_hist[PTLRPC_STAGE_MAX];
+	/** total latency per opcode (usecs), indexed by opcode_offset() */
+	struct obd_histogram		*scp_opc_hist;
 	/** service threads list */
 	struct list_head		scp_threads;
 
@@ -1822,6 +1948,12 @@ struct ptlrpc_service_part {
 	int				scp_nhreqs_active;
 	/** # hp requests handled */
 	int				scp_hreq_count;
+	/** # reqs of this partition being served by other partitions */
+	int				scp_nreqs_stolen;
+	/** # reqs taken from other partitions by threads of this one */
+	__u64				scp_steal_count;
+	/** # reqs of this partition taken by other partitions */
+	__u64				scp_stolen_count;
 
 	/** NRS head for regular requests */
 	struct ptlrpc_nrs		scp_nrs_reg;
@@ -1848,6 +1980,42 @@ struct ptlrpc_service_part {
 	unsigned			scp_at_check;
 	/** @} */
 
+	/**
+	 * serialize the following fields, used for caching the bulk
+	 * descriptors allocated on the memory of this partition
+	 */
+	spinlock_t			scp_bulk_lock __cfs_cacheline_aligned;
+	/** free descriptors with a PTLRPC_MAX_BRW_PAGES kiov vector */
+	struct list_head		scp_bulk_free;
+	/** # descriptors on scp_bulk_free */
+	int				scp_bulk_nfree;
+	/** # descriptors taken from scp_bulk_free */
+	__u64				scp_bulk_hits;
+	/** # descriptors allocated because scp_bulk_free was empty */
+	__u64				scp_bulk_allocs;
+	/** # descriptors handed to a thread running outside of scp_cpt */
+	__u64				scp_bulk_remote;
+	/** # descriptors released by the memory shrinker */
+	__u64				scp_bulk_shrunk;
+
+	/**
+	 * serialize the following fields, used for caching the reply
+	 * states allocated on the memory of this partition
+	 */
+	spinlock_t			scp_rs_arena_lock;
+	/** free reply states, by size class */
+	struct list_head		scp_rs_arena[PTLRPC_RS_ARENA_CLASSES];
+	/** # reply states on each of scp_rs_arena */
+	int				scp_rs_arena_count[PTLRPC_RS_ARENA_CLASSES];
+	/** # reply states taken from scp_rs_arena */
+	__u64				scp_rs_arena_hits;
+	/** # reply states allocated because the size class was empty */
+	__u64				scp_rs_arena_misses;
+	/** # reply states too large for any size class */
+	__u64				scp_rs_arena_oversize;
+	/** # reply states released by the memory shrinker */
+	__u64				scp_rs_arena_shrunk;
+
 	/**
 	 * serialize the following fields, used for processing
 	 * replies for this portal
@@ -1861,6 +2029,14 @@ struct ptlrpc_service_part {
 	wait_queue_head_t		scp_rep_waitq;
 	/** # 'difficult' replies */
 	atomic_t			scp_nreps_difficult;
+	/** # difficult replies dispatched after their transaction commit */
+	__u64				scp_rep_committed;
+	/** # batches these were dispatched in, see ptlrpc_commit_replies() */
+	__u64				scp_rep_commit_batches;
+	/** usecs from sending a difficult reply until its ACK was handled */
+	struct obd_histogram		scp_rep_ack_hist;
+	/** usecs from sending a difficult reply until its commit was handled */
+	struct obd_histogram		scp_rep_commit_hist;
 };
 
 #define ptlrpc_service_for_each_part(part, i, svc)			\
@@ -1921,6 +2097,11 @@ struct ptlrpcd_ctl {
 	 * Error code if the thread failed to fully start.
 	 */
 	int				pc_error;
+	/**
+	 * Fires at the end of the coalescing window to wake the thread
+	 * for small async RPCs whose wakeup was deferred.
+	 */
+	struct timer_list		pc_coalesce_timer;
 };
 
 /* Bits for pc_flags */
@@ -1943,6 +2124,11 @@ enum ptlrpcd_ctl_flags {
          * This is a recovery ptlrpc thread.
          */
         LIOD_RECOVERY    = 1 << 3,
+	/**
+	 * The wakeup for queued small async RPCs was deferred to the
+	 * coalescing timer.
+	 */
+	LIOD_COALESCE	 = 1 << 4,
 };
 
 /**
@@ -2065,6 +2251,24 @@ static inline int ptlrpc_server_bulk_active(struct ptlrpc_bulk_desc *desc)
 	spin_unlock(&desc->bd_lock);
 	return rc;
 }
+
+/**
+ * Returns true if the data for MD \a mdidx of the server bulk \a desc
+ * has arrived, so its pages may be read while later MDs are in flight.
+ */
+static inline bool ptlrpc_server_bulk_md_done(struct ptlrpc_bulk_desc *desc,
+					      int mdidx)
+{
+	bool rc;
+
+	LASSERT(desc->bd_md_track);
+	LASSERT(mdidx < 64);
+
+	spin_lock(&desc->bd_lock);
+	rc = desc->bd_md_done & (1ULL << mdidx);
+	spin_unlock(&desc->bd_lock);
+	return rc;
+}
 #endif
 
 int ptlrpc_register_bulk(struct ptlrpc_request *req);
@@ -2116,6 +2320,8 @@ struct ptlrpc_connection *ptlrpc_uuid_to_connection(struct obd_uuid *uuid,
 						    lnet_nid_t nid4refnet);
 
 int ptlrpc_queue_wait(struct ptlrpc_request *req);
+int ptlrpc_subreq_reply(struct ptlrpc_request *batch,
+			struct ptlrpc_request *req, void *msg, int len);
 int ptlrpc_replay_req(struct ptlrpc_request *req);
 void ptlrpc_restart_req(struct ptlrpc_request *req);
 void ptlrpc_abort_inflight(struct obd_import *imp);
@@ -2281,6 +2487,13 @@ struct ptlrpc_service_conf {
  */
 void ptlrpc_save_lock(struct ptlrpc_request *req, struct lustre_handle *lock,
 		      int mode, bool no_ack, bool convert_lock);
+struct ptlrpc_request *
+ptlrpc_server_subreq_alloc(struct ptlrpc_request *req, struct lustre_msg *msg,
+			   int len);
+int ptlrpc_server_subreq_reply(struct ptlrpc_request *req,
+			       struct ptlrpc_request *sub, void *buf,
+			       int buflen);
+void ptlrpc_server_subreq_free(struct ptlrpc_request *sub);
 void ptlrpc_commit_replies(struct obd_export *exp);
 void ptlrpc_dispatch_difficult_reply(struct ptlrpc_reply_state *rs);
 void ptlrpc_schedule_difficult_reply(struct ptlrpc_reply_state *rs);
@@ -129,6 +129,8 @@ struct timeout_item {
 #define OSC_MAX_DIRTY_DEFAULT	(OBD_MAX_RIF_DEFAULT * 4)
 #define OSC_MAX_DIRTY_MB_MAX	2048     /* arbitrary, but < MAX_LONG bytes */
 #define OSC_DEFAULT_RESENDS	10
+#define MDC_BATCH_MAX_DEFAULT	8
+#define MDC_BATCH_WINDOW_US_DEFAULT 50
 
 /* possible values for fo_sync_lock_cancel */
 enum {
@@ -242,6 +244,8 @@ struct client_obd {
 	atomic_t		cl_pending_r_pages;
 	__u32			cl_max_pages_per_rpc;
 	__u32			cl_max_rpcs_in_flight;
+	/* BRWs up to this size are sent inline in the RPC, 0 = disabled */
+	__u32			cl_short_io_bytes;
 	struct obd_histogram	cl_read_rpc_hist;
 	struct obd_histogram	cl_write_rpc_hist;
 	struct obd_histogram	cl_read_page_hist;
@@ -299,6 +303,13 @@ struct client_obd {
 	wait_queue_head_t	 cl_mod_rpcs_waitq;
 	unsigned long		*cl_mod_tag_bitmap;
 	struct obd_histogram	 cl_mod_rpcs_hist;
+	/* modify rpcs gathered into one MDS_BATCH_REINT, protected by
+	 * cl_mod_rpcs_lock */
+	struct list_head	 cl_batch_list;
+	struct task_struct	*cl_batch_leader;
+	__u16			 cl_batch_count;
+	__u16			 cl_batch_max;
+	__u32			 cl_batch_window_us;
 
         /* mgc datastruct */
 	struct mutex		  cl_mgc_mutex;
@@ -776,6 +787,7 @@ enum md_cli_flags {
 	CLI_HASH64      = 1 << 2,
 	CLI_API32       = 1 << 3,
 	CLI_MIGRATE     = 1 << 4,
+	CLI_READDIR_PLUS = 1 << 5,
 };
 
 /**
@@ -848,6 +860,15 @@ struct md_callback {
 			       void *data, int flag);
 };
 
+struct lustre_md {
+	struct mdt_body         *body;
+	struct lu_buf		 layout;
+	struct lmv_stripe_md    *lmv;
+#ifdef CONFIG_FS_POSIX_ACL
+	struct posix_acl        *posix_acl;
+#endif
+};
+
 struct md_enqueue_info;
 /* metadata stat-ahead */
 typedef int (* md_enqueue_cb_t)(struct ptlrpc_request *req,
@@ -862,6 +883,9 @@ struct md_enqueue_info {
 	struct ldlm_enqueue_info	mi_einfo;
 	md_enqueue_cb_t			mi_cb;
 	void			       *mi_cbdata;
+	/* attributes unpacked from a MDS_BATCH_GETATTR reply, mi_md.body is
+	 * only set if this entry was sent in a batch */
+	struct lustre_md		mi_md;
 };
 
 struct obd_ops {
@@ -965,15 +989,6 @@ struct obd_ops {
 };
 
 /* lmv structures */
-struct lustre_md {
-	struct mdt_body         *body;
-	struct lu_buf		 layout;
-	struct lmv_stripe_md    *lmv;
-#ifdef CONFIG_FS_POSIX_ACL
-	struct posix_acl        *posix_acl;
-#endif
-};
-
 struct md_open_data {
 	struct obd_client_handle	*mod_och;
 	struct ptlrpc_request		*mod_open_req;
@@ -1059,6 +1074,9 @@ struct md_ops {
 	int (*m_intent_getattr_async)(struct obd_export *,
 				      struct md_enqueue_info *);
 
+	int (*m_batch_getattr_async)(struct obd_export *,
+				     struct md_enqueue_info **, unsigned int);
+
         int (*m_revalidate_lock)(struct obd_export *, struct lookup_intent *,
                                  struct lu_fid *, __u64 *bits);
 
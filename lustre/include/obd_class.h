@@ -1606,6 +1606,18 @@ static inline int md_intent_getattr_async(struct obd_export *exp,
 	RETURN(rc);
 }
 
+static inline int md_batch_getattr_async(struct obd_export *exp,
+					 struct md_enqueue_info **minfos,
+					 unsigned int count)
+{
+	int rc;
+	ENTRY;
+	EXP_CHECK_MD_OP(exp, batch_getattr_async);
+	EXP_MD_COUNTER_INCREMENT(exp, batch_getattr_async);
+	rc = MDP(exp->exp_obd, batch_getattr_async)(exp, minfos, count);
+	RETURN(rc);
+}
+
 static inline int md_revalidate_lock(struct obd_export *exp,
                                      struct lookup_intent *it,
                                      struct lu_fid *fid, __u64 *bits)
@@ -56,6 +56,9 @@
 
 #include "ldlm_internal.h"
 
+/* slab cache for ldlm_extent_contention */
+struct kmem_cache *ldlm_contention_slab;
+
 #ifdef HAVE_SERVER_SUPPORT
 # define LDLM_MAX_GROWN_EXTENT (32 * 1024 * 1024 - 1)
 
@@ -286,6 +289,15 @@ static void ldlm_extent_policy(struct ldlm_resource *res,
                 /* fast-path whole file locks */
                 return;
 
+	/* Lock ahead requests are made for exactly the range the client is
+	 * going to access, typically by many clients writing disjoint parts
+	 * of a shared file; growing them would only cause lock ping-pong.
+	 * Check the lock rather than @flags, which are zeroed on reprocess. */
+	if (ldlm_is_no_expansion(lock)) {
+		LDLM_DEBUG(lock, "not expanding manually requested lock");
+		return;
+	}
+
         ldlm_extent_internal_policy_granted(lock, &new_ex);
         ldlm_extent_internal_policy_waiting(lock, &new_ex);
 
@@ -297,19 +309,154 @@ static void ldlm_extent_policy(struct ldlm_resource *res,
         }
 }
 
-static int ldlm_check_contention(struct ldlm_lock *lock, int contended_locks)
+/**
+ * Return the number of conflicts counted for the region \a lcr over the
+ * last ns_contention_time seconds.
+ *
+ * The sliding window is approximated by the current fixed window and the
+ * previous one, weighted by the part of it still inside the sliding window.
+ */
+static unsigned int ldlm_contention_count(struct ldlm_namespace *ns,
+					  struct ldlm_contention_region *lcr,
+					  time64_t now)
 {
-	struct ldlm_resource *res = lock->l_resource;
-	cfs_time_t now = cfs_time_current();
+	unsigned int window = max(ns->ns_contention_time, 1U);
+	unsigned int elapsed;
+
+	if (now - lcr->lcr_window >= 2 * window) {
+		lcr->lcr_prev = 0;
+		lcr->lcr_cur = 0;
+		lcr->lcr_window = now;
+	} else if (now - lcr->lcr_window >= window) {
+		lcr->lcr_prev = lcr->lcr_cur;
+		lcr->lcr_cur = 0;
+		lcr->lcr_window += window;
+	}
+	elapsed = now - lcr->lcr_window;
+
+	return lcr->lcr_cur + lcr->lcr_prev * (window - elapsed) / window;
+}
 
-	if (OBD_FAIL_CHECK(OBD_FAIL_LDLM_SET_CONTENTION))
+/**
+ * Find the contention region of \a res with index \a index.
+ *
+ * \param[in] create	evict the region colliding with \a index if any
+ *
+ * \retval the region, or NULL if it is not tracked
+ */
+static struct ldlm_contention_region *
+ldlm_contention_region(struct ldlm_resource *res, __u64 index, bool create,
+		       time64_t now)
+{
+	struct ldlm_contention_region *lcr;
+
+	if (res->lr_contention == NULL) {
+		if (!create)
+			return NULL;
+		/* under lr_lock, losing the tracker only loses history */
+		OBD_SLAB_ALLOC_PTR_GFP(res->lr_contention, ldlm_contention_slab,
+				       GFP_ATOMIC);
+		if (res->lr_contention == NULL)
+			return NULL;
+		/* the first region of a new tracker must not match index 0 */
+		res->lr_contention->lec_regions[0].lcr_index = ~0ULL;
+	}
+
+	lcr = &res->lr_contention->lec_regions[index &
+					       (LDLM_CONTENTION_REGIONS - 1)];
+	if (lcr->lcr_index != index) {
+		if (!create)
+			return NULL;
+		lcr->lcr_index = index;
+		lcr->lcr_window = now;
+		lcr->lcr_cur = 0;
+		lcr->lcr_prev = 0;
+	}
+
+	return lcr;
+}
+
+/**
+ * Account \a conflicts conflicting locks found by an enqueue of the extent
+ * [\a start, \a end] of \a res to the regions this extent spans.
+ *
+ * Only the first LDLM_CONTENTION_REGIONS regions of a large extent are
+ * accounted, these are what the enqueue would be denied for.
+ */
+static void ldlm_contention_note(struct ldlm_resource *res, __u64 start,
+				 __u64 end, int conflicts)
+{
+	struct ldlm_namespace *ns = ldlm_res_to_ns(res);
+	struct ldlm_contention_region *lcr;
+	unsigned int shift = ilog2(ns->ns_contention_region);
+	time64_t now = ktime_get_seconds();
+	__u64 index;
+	__u64 last;
+
+	last = min(end >> shift,
+		   (start >> shift) + LDLM_CONTENTION_REGIONS - 1);
+	for (index = start >> shift; index <= last; index++) {
+		lcr = ldlm_contention_region(res, index, true, now);
+		if (lcr == NULL)
+			return;
+		ldlm_contention_count(ns, lcr, now);
+		lcr->lcr_cur += conflicts;
+	}
+}
+
+/**
+ * Check whether the enqueue of \a lock is in a contended extent region.
+ *
+ * \param[in] contended_locks	conflicting locks this enqueue found so far
+ * \param[in] found		conflicting locks found in the queue just
+ *				scanned, not accounted to the regions yet
+ * \param[out] ext		span of the contended regions the enqueue
+ *				extent overlaps, if contended
+ *
+ * \retval 1 if contended, 0 otherwise
+ */
+static int ldlm_check_contention(struct ldlm_lock *lock, int contended_locks,
+				 int found, struct ldlm_extent *ext)
+{
+	struct ldlm_resource *res = lock->l_resource;
+	struct ldlm_namespace *ns = ldlm_res_to_ns(res);
+	struct ldlm_contention_region *lcr;
+	__u64 start = lock->l_req_extent.start;
+	__u64 end = lock->l_req_extent.end;
+	unsigned int shift = ilog2(ns->ns_contention_region);
+	time64_t now = ktime_get_seconds();
+	__u64 index;
+	__u64 last;
+	int rc = 0;
+
+	if (OBD_FAIL_CHECK(OBD_FAIL_LDLM_SET_CONTENTION)) {
+		ext->start = start;
+		ext->end = end;
 		return 1;
+	}
 
 	CDEBUG(D_DLMTRACE, "contended locks = %d\n", contended_locks);
-	if (contended_locks > ldlm_res_to_ns(res)->ns_contended_locks)
-		res->lr_contention_time = now;
-	return cfs_time_before(now, cfs_time_add(res->lr_contention_time,
-		cfs_time_seconds(ldlm_res_to_ns(res)->ns_contention_time)));
+	if (found > 0)
+		ldlm_contention_note(res, start, end, found);
+	if (res->lr_contention == NULL)
+		return 0;
+
+	last = min(end >> shift,
+		   (start >> shift) + LDLM_CONTENTION_REGIONS - 1);
+	for (index = start >> shift; index <= last; index++) {
+		lcr = ldlm_contention_region(res, index, false, now);
+		if (lcr == NULL ||
+		    ldlm_contention_count(ns, lcr, now) <=
+		    ns->ns_contended_locks)
+			continue;
+
+		if (rc == 0)
+			ext->start = index << shift;
+		ext->end = ((index + 1) << shift) - 1;
+		rc = 1;
+	}
+
+	return rc;
 }
 
 struct ldlm_extent_compat_args {
@@ -380,7 +527,9 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
 	__u64 req_start = req->l_req_extent.start;
 	__u64 req_end = req->l_req_extent.end;
 	struct ldlm_lock *lock;
+	struct ldlm_extent contended;
 	int check_contention;
+	int found = *contended_locks;
 	int compat = 1;
 	int scan = 0;
 	ENTRY;
@@ -617,13 +766,19 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                 }
         }
 
-        if (ldlm_check_contention(req, *contended_locks) &&
-            compat == 0 &&
-            (*flags & LDLM_FL_DENY_ON_CONTENTION) &&
-            req->l_req_mode != LCK_GROUP &&
-            req_end - req_start <=
-            ldlm_res_to_ns(req->l_resource)->ns_max_nolock_size)
-                GOTO(destroylock, compat = -EUSERS);
+	if (ldlm_check_contention(req, *contended_locks,
+				  *contended_locks - found, &contended) &&
+	    compat == 0 &&
+	    (*flags & LDLM_FL_DENY_ON_CONTENTION) &&
+	    req->l_req_mode != LCK_GROUP &&
+	    req_end - req_start <=
+	    ldlm_res_to_ns(req->l_resource)->ns_max_nolock_size) {
+		/* tell the client which range to do lockless I/O for */
+		*flags |= LDLM_FL_CONTENDED;
+		req->l_policy_data.l_extent.start = contended.start;
+		req->l_policy_data.l_extent.end = contended.end;
+		GOTO(destroylock, compat = -EUSERS);
+	}
 
         RETURN(compat);
 destroylock:
@@ -809,6 +964,16 @@ int ldlm_process_extent_lock(struct ldlm_lock *lock, __u64 *flags,
 	}
 
 	if (rc + rc2 != 2) {
+		/* Speculative locks must not wait for, or call back, any
+		 * conflicting lock: refuse them instead. */
+		if (*flags & LDLM_FL_SPECULATIVE) {
+			list_del_init(&lock->l_res_link);
+			ldlm_lock_destroy_nolock(lock);
+			rc = -EWOULDBLOCK;
+			*err = rc;
+			GOTO(out_rpc_list, rc);
+		}
+
 		/* Adding LDLM_FL_NO_TIMEOUT flag to granted lock to force
 		 * client to wait for the lock endlessly once the lock is
 		 * enqueued -bzzz */
@@ -1089,6 +1254,23 @@ void ldlm_extent_unlink_lock(struct ldlm_lock *lock)
 	}
 }
 
+/**
+ * Free the contention tracker of a server extent resource \a res, if any.
+ *
+ * lr_contention shares its storage with the client lr_lvb_inode, only server
+ * LDLM_EXTENT resources may have one.
+ */
+void ldlm_extent_free_res(struct ldlm_resource *res)
+{
+	if (res->lr_type != LDLM_EXTENT || !ns_is_server(ldlm_res_to_ns(res)))
+		return;
+
+	if (res->lr_contention != NULL) {
+		OBD_SLAB_FREE_PTR(res->lr_contention, ldlm_contention_slab);
+		res->lr_contention = NULL;
+	}
+}
+
 void ldlm_extent_policy_wire_to_local(const union ldlm_wire_policy_data *wpolicy,
 				      union ldlm_policy_data *lpolicy)
 {
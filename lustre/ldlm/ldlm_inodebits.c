@@ -56,7 +56,72 @@
 
 #include "ldlm_internal.h"
 
+struct kmem_cache *ldlm_ibits_node_slab;
+struct kmem_cache *ldlm_ibits_queues_slab;
+
 #ifdef HAVE_SERVER_SUPPORT
+/**
+ * Determine if the lock is compatible with the waiting locks of its resource.
+ *
+ * Only the per-bit waiting queues of the bits set in \a req are walked, so
+ * waiting locks with no bit in common with \a req are never looked at.
+ * A lock sharing several bits with \a req is seen once per common bit,
+ * ldlm_add_ast_work_item() adds it to \a work_list only the first time.
+ *
+ * Waiting locks are not organized in skip lists, so unlike for the granted
+ * queue there are no groups of locks to add to \a work_list.
+ *
+ * \retval 0 if there are conflicting waiting locks
+ * \retval 1 if the lock is compatible to all waiting locks
+ */
+static int
+ldlm_inodebits_compat_waiting(struct ldlm_ibits_queues *queues,
+			      struct ldlm_lock *req,
+			      struct list_head *work_list)
+{
+	struct ldlm_ibits_node *node;
+	struct ldlm_lock *lock;
+	__u64 req_bits = req->l_policy_data.l_inodebits.bits;
+	int compat = 1;
+	int i;
+	ENTRY;
+
+	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++) {
+		if (!(req_bits & (1 << i)))
+			continue;
+
+		list_for_each_entry(node, &queues->liq_waiting[i],
+				    lin_link[i]) {
+			lock = node->lin_lock;
+
+			/* We stop walking the queue if we hit ourselves so we
+			 * don't take conflicting locks enqueued after us into
+			 * account, or we'd wait forever. */
+			if (req == lock)
+				break;
+
+			/* see ldlm_inodebits_compat_queue() for COS */
+			if (lock->l_req_mode == LCK_COS &&
+			    !ldlm_is_cos_incompat(req) &&
+			    (!ldlm_is_cos_enabled(req) ||
+			     lock->l_client_cookie == req->l_client_cookie))
+				continue;
+
+			if (lockmode_compat(lock->l_req_mode, req->l_req_mode))
+				continue;
+
+			if (!work_list)
+				RETURN(0);
+
+			compat = 0;
+			if (lock->l_blocking_ast)
+				ldlm_add_ast_work_item(lock, req, work_list);
+		}
+	}
+
+	RETURN(compat);
+}
+
 /**
  * Determine if the lock is compatible with all locks on the queue.
  *
@@ -86,6 +151,12 @@ ldlm_inodebits_compat_queue(struct list_head *queue, struct ldlm_lock *req,
 	 * Also, such a lock would be compatible with any other bit lock */
 	LASSERT(req_bits != 0);
 
+	if (queue == &req->l_resource->lr_waiting &&
+	    req->l_resource->lr_ibits_queues != NULL)
+		RETURN(ldlm_inodebits_compat_waiting(
+				req->l_resource->lr_ibits_queues, req,
+				work_list));
+
 	list_for_each(tmp, queue) {
 		struct list_head *mode_tail;
 
@@ -234,12 +305,161 @@ int ldlm_process_inodebits_lock(struct ldlm_lock *lock, __u64 *flags,
 
 	RETURN(rc);
 }
+
+/**
+ * Drop the \a to_drop bits of the granted \a lock on a lock convert.
+ *
+ * The lock is moved to the granted queue policy group of the bits it keeps
+ * and no longer has a blocking AST pending. If the kept bits still conflict
+ * with a waiting lock, a new blocking AST for it is added to \a bl_list.
+ *
+ * Must be called with the resource lock held.
+ */
+void ldlm_inodebits_drop(struct ldlm_lock *lock, __u64 to_drop,
+			 struct list_head *bl_list)
+{
+	struct ldlm_resource *res = lock->l_resource;
+	struct ldlm_lock *waiter;
+	ENTRY;
+
+	check_res_locked(res);
+	LASSERT(lock->l_granted_mode == lock->l_req_mode);
+
+	ldlm_resource_unlink_lock(lock);
+	lock->l_policy_data.l_inodebits.bits &= ~to_drop;
+	lock->l_policy_data.l_inodebits.cancel_bits = 0;
+	ldlm_grant_lock_with_skiplist(lock);
+
+	ldlm_clear_ast_sent(lock);
+	ldlm_clear_cbpending(lock);
+	lock->l_bl_ast_run = 0;
+
+	list_for_each_entry(waiter, &res->lr_waiting, l_res_link) {
+		if (lockmode_compat(waiter->l_req_mode, lock->l_granted_mode) ||
+		    !(waiter->l_policy_data.l_inodebits.bits &
+		      lock->l_policy_data.l_inodebits.bits))
+			continue;
+
+		ldlm_add_ast_work_item(lock, waiter, bl_list);
+		break;
+	}
+	EXIT;
+}
 #endif /* HAVE_SERVER_SUPPORT */
 
+/**
+ * Allocate the per-bit queues of an IBITS resource in a server namespace.
+ */
+int ldlm_inodebits_alloc_res(struct ldlm_namespace *ns,
+			     struct ldlm_resource *res)
+{
+	int i;
+
+	res->lr_ibits_queues = NULL;
+	if (!ns_is_server(ns))
+		return 0;
+
+	OBD_SLAB_ALLOC_PTR_GFP(res->lr_ibits_queues, ldlm_ibits_queues_slab,
+			       GFP_NOFS);
+	if (res->lr_ibits_queues == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++)
+		INIT_LIST_HEAD(&res->lr_ibits_queues->liq_waiting[i]);
+
+	return 0;
+}
+
+void ldlm_inodebits_free_res(struct ldlm_resource *res)
+{
+	if (res->lr_ibits_queues != NULL) {
+		OBD_SLAB_FREE_PTR(res->lr_ibits_queues, ldlm_ibits_queues_slab);
+		res->lr_ibits_queues = NULL;
+	}
+}
+
+/**
+ * Allocate the per-bit waiting queue linkage of a server IBITS lock.
+ */
+int ldlm_inodebits_alloc_lock(struct ldlm_lock *lock)
+{
+	int i;
+
+	lock->l_ibits_node = NULL;
+	if (!ldlm_is_ns_srv(lock))
+		return 0;
+
+	OBD_SLAB_ALLOC_PTR_GFP(lock->l_ibits_node, ldlm_ibits_node_slab,
+			       GFP_NOFS);
+	if (lock->l_ibits_node == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++)
+		INIT_LIST_HEAD(&lock->l_ibits_node->lin_link[i]);
+	lock->l_ibits_node->lin_lock = lock;
+
+	return 0;
+}
+
+void ldlm_inodebits_free_lock(struct ldlm_lock *lock)
+{
+	struct ldlm_ibits_node *node = lock->l_ibits_node;
+	int i;
+
+	if (node == NULL)
+		return;
+
+	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++)
+		LASSERT(list_empty(&node->lin_link[i]));
+
+	OBD_SLAB_FREE_PTR(node, ldlm_ibits_node_slab);
+	lock->l_ibits_node = NULL;
+}
+
+/**
+ * Called when \a lock is added to the \a head queue of \a res.
+ *
+ * A waiting lock is also queued on the per-bit waiting queues of its bits.
+ * A granted server lock never waits again, so its linkage is freed.
+ */
+void ldlm_inodebits_add_lock(struct ldlm_resource *res, struct list_head *head,
+			     struct ldlm_lock *lock)
+{
+	__u64 bits = lock->l_policy_data.l_inodebits.bits;
+	int i;
+
+	if (res->lr_ibits_queues == NULL)
+		return;
+
+	if (head == &res->lr_waiting) {
+		LASSERT(lock->l_ibits_node != NULL);
+		for (i = 0; i < MDS_INODELOCK_NUMBITS; i++) {
+			if (bits & (1 << i))
+				list_add_tail(&lock->l_ibits_node->lin_link[i],
+					&res->lr_ibits_queues->liq_waiting[i]);
+		}
+	} else if (head == &res->lr_granted) {
+		ldlm_inodebits_free_lock(lock);
+	}
+}
+
+void ldlm_inodebits_unlink_lock(struct ldlm_lock *lock)
+{
+	struct ldlm_ibits_node *node = lock->l_ibits_node;
+	int i;
+
+	if (node == NULL)
+		return;
+
+	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++)
+		list_del_init(&node->lin_link[i]);
+}
+
 void ldlm_ibits_policy_wire_to_local(const union ldlm_wire_policy_data *wpolicy,
 				     union ldlm_policy_data *lpolicy)
 {
 	lpolicy->l_inodebits.bits = wpolicy->l_inodebits.bits;
+	lpolicy->l_inodebits.cancel_bits = 0;
 }
 
 void ldlm_ibits_policy_local_to_wire(const union ldlm_policy_data *lpolicy,
@@ -409,6 +409,10 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	 * from OFD after connecting. */
 	cli->cl_max_pages_per_rpc = PTLRPC_MAX_BRW_PAGES;
 
+	/* Short I/O is only used once the server has agreed to
+	 * OBD_CONNECT_SHORTIO at connect time. */
+	cli->cl_short_io_bytes = OBD_DEF_SHORT_IO_BYTES;
+
 	/* set cl_chunkbits default value to PAGE_SHIFT,
 	 * it will be updated at OSC connection time. */
 	cli->cl_chunkbits = PAGE_SHIFT;
@@ -435,11 +439,18 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	cli->cl_close_rpcs_in_flight = 0;
 	init_waitqueue_head(&cli->cl_mod_rpcs_waitq);
 	cli->cl_mod_tag_bitmap = NULL;
+	INIT_LIST_HEAD(&cli->cl_batch_list);
+	cli->cl_batch_leader = NULL;
+	cli->cl_batch_count = 0;
+	cli->cl_batch_max = 0;
+	cli->cl_batch_window_us = 0;
 
 	INIT_LIST_HEAD(&cli->cl_chg_dev_linkage);
 
 	if (connect_op == MDS_CONNECT) {
 		cli->cl_max_mod_rpcs_in_flight = cli->cl_max_rpcs_in_flight - 1;
+		cli->cl_batch_max = MDC_BATCH_MAX_DEFAULT;
+		cli->cl_batch_window_us = MDC_BATCH_WINDOW_US_DEFAULT;
 		OBD_ALLOC(cli->cl_mod_tag_bitmap,
 			  BITS_TO_LONGS(OBD_MAX_RIF_MAX) * sizeof(long));
 		if (cli->cl_mod_tag_bitmap == NULL)
@@ -2999,6 +3010,7 @@ void target_send_reply(struct ptlrpc_request *req, int rc, int fail_id)
 	list_add_tail(&rs->rs_exp_list, &exp->exp_outstanding_replies);
 	spin_unlock(&exp->exp_lock);
 
+	rs->rs_sent = ktime_get();
 	netrc = target_send_reply_msg(req, rc, fail_id);
 
 	spin_lock(&svcpt->scp_rep_lock);
@@ -3156,16 +3168,47 @@ static inline const char *bulk2type(struct ptlrpc_request *req)
 	return "UNKNOWN";
 }
 
-int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
-                   struct l_wait_info *lwi)
+/* The bulk is finished, or will never finish for this request. */
+static inline bool target_bulk_settled(struct obd_export *exp,
+				       struct ptlrpc_bulk_desc *desc)
+{
+	return !ptlrpc_server_bulk_active(desc) || exp->exp_failed ||
+	       exp->exp_conn_cnt >
+	       lustre_msg_get_conn_cnt(desc->bd_req->rq_reqmsg);
+}
+
+/**
+ * Transfer bulk \a desc, calling \a md_done for each MD of a bulk GET in
+ * order as soon as its pages have arrived, while the remaining MDs are
+ * still in flight. \a md_done is called for every MD only if the transfer
+ * succeeds, i.e. 0 is returned, so its result must be ignored otherwise.
+ *
+ * \a md_done is only supported for kiov descriptors without an encryption
+ * vector, and for up to 64 MDs.
+ */
+int target_bulk_io_pipelined(struct obd_export *exp,
+			     struct ptlrpc_bulk_desc *desc,
+			     struct l_wait_info *lwi,
+			     target_bulk_md_cb_t md_done, void *data)
 {
 	struct ptlrpc_request	*req = desc->bd_req;
 	time_t			 start = cfs_time_current_sec();
 	time_t			 deadline;
+	int			 md_total = 0;
+	int			 md_next = 0;
 	int			 rc = 0;
 
 	ENTRY;
 
+	if (md_done != NULL) {
+		LASSERT(ptlrpc_is_bulk_get_sink(desc->bd_type));
+		LASSERT(ptlrpc_is_bulk_desc_kiov(desc->bd_type));
+		LASSERT(!GET_ENC_KIOV(desc));
+		md_total = DIV_ROUND_UP(desc->bd_iov_count, LNET_MAX_IOV);
+		LASSERT(md_total <= 64);
+	}
+	desc->bd_md_track = md_done != NULL;
+
 	/* If there is eviction in progress, wait for it to finish. */
 	if (unlikely(atomic_read(&exp->exp_obd->obd_evict_inprogress))) {
 		*lwi = LWI_INTR(NULL, NULL);
@@ -3200,7 +3243,9 @@ int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
 
 	if (OBD_FAIL_CHECK(OBD_FAIL_MDS_SENDPAGE)) {
 		ptlrpc_abort_bulk(desc);
-		RETURN(0);
+		/* md_done was not called for every MD, the transfer must
+		 * not look successful to a caller relying on it */
+		RETURN(md_done != NULL ? -ETIMEDOUT : 0);
 	}
 
 	/* limit actual bulk transfer to bulk_timeout seconds */
@@ -3217,19 +3262,23 @@ int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
 		*lwi = LWI_TIMEOUT_INTERVAL(timeout, cfs_time_seconds(1),
 					    target_bulk_timeout, desc);
 		rc = l_wait_event(desc->bd_waitq,
-				  !ptlrpc_server_bulk_active(desc) ||
-				  exp->exp_failed ||
-				  exp->exp_conn_cnt >
-				  lustre_msg_get_conn_cnt(req->rq_reqmsg),
+				  target_bulk_settled(exp, desc) ||
+				  (md_next < md_total &&
+				   ptlrpc_server_bulk_md_done(desc, md_next)),
 				  lwi);
 		LASSERT(rc == 0 || rc == -ETIMEDOUT);
+
+		while (md_next < md_total &&
+		       ptlrpc_server_bulk_md_done(desc, md_next))
+			md_done(desc, md_next++, data);
+
 		/* Wait again if we changed rq_deadline. */
 		rq_deadline = ACCESS_ONCE(req->rq_deadline);
 		deadline = start + bulk_timeout;
 		if (deadline > rq_deadline)
 			deadline = rq_deadline;
-	} while ((rc == -ETIMEDOUT) &&
-		 (deadline > cfs_time_current_sec()));
+	} while ((rc == -ETIMEDOUT && deadline > cfs_time_current_sec()) ||
+		 (rc == 0 && !target_bulk_settled(exp, desc)));
 
 	if (rc == -ETIMEDOUT) {
 		DEBUG_REQ(D_ERROR, req, "timeout on bulk %s after %ld%+lds",
@@ -3263,10 +3312,19 @@ int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
 			/* XXX should this be a different errno? */
 			rc = -ETIMEDOUT;
 		}
+		while (rc == 0 && md_next < md_total)
+			md_done(desc, md_next++, data);
 	}
 
 	RETURN(rc);
 }
+EXPORT_SYMBOL(target_bulk_io_pipelined);
+
+int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
+		   struct l_wait_info *lwi)
+{
+	return target_bulk_io_pipelined(exp, desc, lwi, NULL, NULL);
+}
 EXPORT_SYMBOL(target_bulk_io);
 
 #endif /* HAVE_SERVER_SUPPORT */
@@ -215,6 +215,7 @@ void ldlm_lock_put(struct ldlm_lock *lock)
                         OBD_FREE_LARGE(lock->l_lvb_data, lock->l_lvb_len);
 
                 ldlm_interval_free(ldlm_interval_detach(lock));
+		ldlm_inodebits_free_lock(lock);
                 lu_ref_fini(&lock->l_reference);
 		OBD_FREE_RCU(lock, sizeof(*lock), &lock->l_handle);
         }
@@ -223,6 +224,15 @@ void ldlm_lock_put(struct ldlm_lock *lock)
 }
 EXPORT_SYMBOL(ldlm_lock_put);
 
+/**
+ * Returns the LRU shard of the namespace of \a lock the lock is kept in.
+ */
+struct ldlm_lru_shard *ldlm_lock_lru_shard(struct ldlm_lock *lock)
+{
+	return &ldlm_lock_to_ns(lock)->ns_lru[lock->l_handle.h_cookie %
+					      LDLM_LRU_SHARDS];
+}
+
 /**
  * Removes LDLM lock \a lock from LRU. Assumes LRU is already locked.
  */
@@ -230,14 +240,14 @@ int ldlm_lock_remove_from_lru_nolock(struct ldlm_lock *lock)
 {
 	int rc = 0;
 	if (!list_empty(&lock->l_lru)) {
-		struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+		struct ldlm_lru_shard *lls = ldlm_lock_lru_shard(lock);
 
 		LASSERT(lock->l_resource->lr_type != LDLM_FLOCK);
-		if (ns->ns_last_pos == &lock->l_lru)
-			ns->ns_last_pos = lock->l_lru.prev;
+		if (lls->lls_last_pos == &lock->l_lru)
+			lls->lls_last_pos = lock->l_lru.prev;
 		list_del_init(&lock->l_lru);
-		LASSERT(ns->ns_nr_unused > 0);
-		ns->ns_nr_unused--;
+		LASSERT(lls->lls_nr > 0);
+		lls->lls_nr--;
 		rc = 1;
 	}
 	return rc;
@@ -256,7 +266,7 @@ int ldlm_lock_remove_from_lru_nolock(struct ldlm_lock *lock)
  */
 int ldlm_lock_remove_from_lru_check(struct ldlm_lock *lock, ktime_t last_use)
 {
-	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+	struct ldlm_lru_shard *lls;
 	int rc = 0;
 
 	ENTRY;
@@ -265,11 +275,12 @@ int ldlm_lock_remove_from_lru_check(struct ldlm_lock *lock, ktime_t last_use)
 		RETURN(0);
 	}
 
-	spin_lock(&ns->ns_lock);
+	lls = ldlm_lock_lru_shard(lock);
+	spin_lock(&lls->lls_lock);
 	if (!ktime_compare(last_use, ktime_set(0, 0)) ||
 	    !ktime_compare(last_use, lock->l_last_used))
 		rc = ldlm_lock_remove_from_lru_nolock(lock);
-	spin_unlock(&ns->ns_lock);
+	spin_unlock(&lls->lls_lock);
 
 	RETURN(rc);
 }
@@ -279,14 +290,14 @@ int ldlm_lock_remove_from_lru_check(struct ldlm_lock *lock, ktime_t last_use)
  */
 void ldlm_lock_add_to_lru_nolock(struct ldlm_lock *lock)
 {
-	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+	struct ldlm_lru_shard *lls = ldlm_lock_lru_shard(lock);
 
 	lock->l_last_used = ktime_get();
 	LASSERT(list_empty(&lock->l_lru));
 	LASSERT(lock->l_resource->lr_type != LDLM_FLOCK);
-	list_add_tail(&lock->l_lru, &ns->ns_unused_list);
-	LASSERT(ns->ns_nr_unused >= 0);
-	ns->ns_nr_unused++;
+	list_add_tail(&lock->l_lru, &lls->lls_list);
+	LASSERT(lls->lls_nr >= 0);
+	lls->lls_nr++;
 }
 
 /**
@@ -295,12 +306,14 @@ void ldlm_lock_add_to_lru_nolock(struct ldlm_lock *lock)
  */
 void ldlm_lock_add_to_lru(struct ldlm_lock *lock)
 {
-	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+	struct ldlm_lru_shard *lls = ldlm_lock_lru_shard(lock);
 
 	ENTRY;
-	spin_lock(&ns->ns_lock);
+	/* a lock used again may be spared by the LRU scans once more */
+	ldlm_clear_lru_spared(lock);
+	spin_lock(&lls->lls_lock);
 	ldlm_lock_add_to_lru_nolock(lock);
-	spin_unlock(&ns->ns_lock);
+	spin_unlock(&lls->lls_lock);
 	EXIT;
 }
 
@@ -310,7 +323,7 @@ void ldlm_lock_add_to_lru(struct ldlm_lock *lock)
  */
 void ldlm_lock_touch_in_lru(struct ldlm_lock *lock)
 {
-	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+	struct ldlm_lru_shard *lls;
 
 	ENTRY;
 	if (ldlm_is_ns_srv(lock)) {
@@ -319,12 +332,13 @@ void ldlm_lock_touch_in_lru(struct ldlm_lock *lock)
 		return;
 	}
 
-	spin_lock(&ns->ns_lock);
+	lls = ldlm_lock_lru_shard(lock);
+	spin_lock(&lls->lls_lock);
 	if (!list_empty(&lock->l_lru)) {
 		ldlm_lock_remove_from_lru_nolock(lock);
 		ldlm_lock_add_to_lru_nolock(lock);
 	}
-	spin_unlock(&ns->ns_lock);
+	spin_unlock(&lls->lls_lock);
 	EXIT;
 }
 
@@ -420,10 +434,10 @@ void ldlm_lock_destroy_nolock(struct ldlm_lock *lock)
         EXIT;
 }
 
-/* this is called by portals_handle2object with the handle lock taken */
-static void lock_handle_addref(void *lock)
+/* this is called by class_handle2object under rcu_read_lock() */
+static bool lock_handle_addref(void *lock)
 {
-        LDLM_LOCK_GET((struct ldlm_lock *)lock);
+	return atomic_inc_not_zero(&((struct ldlm_lock *)lock)->l_refc);
 }
 
 static void lock_handle_free(void *lock, int size)
@@ -730,7 +744,9 @@ EXPORT_SYMBOL(ldlm_lock_addref);
 void ldlm_lock_addref_internal_nolock(struct ldlm_lock *lock,
 				      enum ldlm_mode mode)
 {
-        ldlm_lock_remove_from_lru(lock);
+	if (ldlm_lock_remove_from_lru(lock))
+		lprocfs_counter_incr(ldlm_lock_to_ns(lock)->ns_stats,
+				     LDLM_NSS_LRU_HITS);
         if (mode & (LCK_NL | LCK_CR | LCK_PR)) {
                 lock->l_readers++;
                 lu_ref_add_atomic(&lock->l_reference, "reader", lock);
@@ -1070,7 +1086,7 @@ static void ldlm_granted_list_add_lock(struct ldlm_lock *lock,
  * Add a lock to granted list on a resource maintaining skiplist
  * correctness.
  */
-static void ldlm_grant_lock_with_skiplist(struct ldlm_lock *lock)
+void ldlm_grant_lock_with_skiplist(struct ldlm_lock *lock)
 {
         struct sl_insert_point prev;
         ENTRY;
@@ -1674,6 +1690,12 @@ struct ldlm_lock *ldlm_lock_create(struct ldlm_namespace *ns,
 		if (ldlm_interval_alloc(lock) == NULL)
 			GOTO(out, rc = -ENOMEM);
 
+	if (type == LDLM_IBITS) {
+		rc = ldlm_inodebits_alloc_lock(lock);
+		if (rc != 0)
+			GOTO(out, rc);
+	}
+
 	if (lvb_len) {
 		lock->l_lvb_len = lvb_len;
 		OBD_ALLOC_LARGE(lock->l_lvb_data, lvb_len);
@@ -1797,6 +1819,8 @@ enum ldlm_error ldlm_lock_enqueue(struct ldlm_namespace *ns,
 		ldlm_set_ast_discard_data(lock);
 	if (*flags & LDLM_FL_TEST_LOCK)
 		ldlm_set_test_lock(lock);
+	if (*flags & LDLM_FL_NO_EXPANSION)
+		ldlm_set_no_expansion(lock);
 	if (*flags & LDLM_FL_COS_INCOMPAT)
 		ldlm_set_cos_incompat(lock);
 	if (*flags & LDLM_FL_COS_ENABLED)
@@ -2027,6 +2051,12 @@ ldlm_work_bl_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 	unlock_res_and_lock(lock);
 
 	ldlm_lock2desc(lock->l_blocking_lock, &d);
+	/* name the conflicting bits so that the client can drop only them
+	 * with a lock convert instead of cancelling the whole lock */
+	if (lock->l_resource->lr_type == LDLM_IBITS)
+		d.l_policy_data.l_inodebits.cancel_bits =
+			lock->l_policy_data.l_inodebits.bits &
+			lock->l_blocking_lock->l_policy_data.l_inodebits.bits;
 
 	rc = lock->l_blocking_ast(lock, &d, (void *)arg, LDLM_CB_BLOCKING);
 	LDLM_LOCK_RELEASE(lock->l_blocking_lock);
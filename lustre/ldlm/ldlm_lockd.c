@@ -1466,7 +1466,19 @@ existing_lock:
                 err = lustre_pack_reply(req, 1, NULL, NULL);
                 if (rc == 0)
                         rc = err;
-        }
+	} else if (rc == -EUSERS && (flags & LDLM_FL_CONTENDED) &&
+		   lock != NULL) {
+		/* report the contended range for the client lockless I/O */
+		dlm_rep = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REP);
+		if (dlm_rep != NULL) {
+			dlm_rep->lock_flags =
+				ldlm_flags_to_wire(LDLM_FL_CONTENDED);
+			dlm_rep->lock_desc.l_policy_data.l_extent.start =
+				lock->l_policy_data.l_extent.start;
+			dlm_rep->lock_desc.l_policy_data.l_extent.end =
+				lock->l_policy_data.l_extent.end;
+		}
+	}
 
         /* The LOCK_CHANGED code in ldlm_lock_enqueue depends on this
          * ldlm_reprocess_all.  If this moves, revisit that code. -phil */
@@ -1564,6 +1576,44 @@ int ldlm_handle_enqueue(struct ptlrpc_request *req,
         return rc;
 }
 
+/**
+ * Drop inodebits of a granted IBITS lock, keeping the \a new_bits only.
+ *
+ * The client does this instead of cancelling the lock when a blocking AST
+ * conflicts with some of the bits only, see ldlm_cli_dropbits().
+ */
+static int ldlm_handle_ibits_convert(struct ldlm_lock *lock, __u64 new_bits)
+{
+	struct ldlm_resource *res = lock->l_resource;
+	struct list_head bl_list = LIST_HEAD_INIT(bl_list);
+	__u64 bits;
+	int rc = 0;
+	ENTRY;
+
+	lock_res_and_lock(lock);
+	bits = lock->l_policy_data.l_inodebits.bits;
+	if (lock->l_granted_mode != lock->l_req_mode ||
+	    ldlm_is_destroyed(lock) || new_bits == 0 ||
+	    (new_bits & ~bits) != 0 || new_bits == bits) {
+		LDLM_DEBUG(lock, "cannot convert to bits %#llx", new_bits);
+		rc = -EINVAL;
+	} else {
+		ldlm_inodebits_drop(lock, bits & ~new_bits, &bl_list);
+	}
+	unlock_res_and_lock(lock);
+
+	if (rc == 0) {
+		LDLM_DEBUG(lock, "dropped bits %#llx", bits & ~new_bits);
+		if (ldlm_del_waiting_lock(lock))
+			LDLM_DEBUG(lock, "converted waiting lock");
+		/* the kept bits still conflict with a waiting lock */
+		ldlm_run_ast_work(ldlm_res_to_ns(res), &bl_list,
+				  LDLM_WORK_BL_AST);
+	}
+
+	RETURN(rc);
+}
+
 /**
  * Main LDLM entry point for server code to process lock conversion requests.
  */
@@ -1595,6 +1645,14 @@ int ldlm_handle_convert0(struct ptlrpc_request *req,
 
                 LDLM_DEBUG(lock, "server-side convert handler START");
 
+		if (lock->l_resource->lr_type == LDLM_IBITS &&
+		    dlm_req->lock_desc.l_req_mode == lock->l_granted_mode) {
+			rc = ldlm_handle_ibits_convert(lock,
+				dlm_req->lock_desc.l_policy_data.l_inodebits.bits);
+			req->rq_status = rc ? LUSTRE_EINVAL : 0;
+			GOTO(out, rc);
+		}
+
                 res = ldlm_lock_convert(lock, dlm_req->lock_desc.l_req_mode,
                                         &dlm_rep->lock_flags);
                 if (res) {
@@ -1606,6 +1664,7 @@ int ldlm_handle_convert0(struct ptlrpc_request *req,
                 }
         }
 
+out:
         if (lock) {
                 if (!req->rq_status)
                         ldlm_reprocess_all(lock->l_resource);
@@ -2293,6 +2352,11 @@ static int ldlm_callback_handler(struct ptlrpc_request *req)
 		 * Let ldlm_cancel_lru() be fast. */
 		ldlm_lock_remove_from_lru(lock);
 		ldlm_set_bl_ast(lock);
+		/* the server names the conflicting bits, keep them for the
+		 * blocking AST which may run after the lock is released */
+		if (lock->l_resource->lr_type == LDLM_IBITS)
+			lock->l_policy_data.l_inodebits.cancel_bits |=
+			dlm_req->lock_desc.l_policy_data.l_inodebits.cancel_bits;
 	}
         unlock_res_and_lock(lock);
 
@@ -2390,6 +2454,24 @@ static int ldlm_cancel_handler(struct ptlrpc_request *req)
                 if (rc)
                         break;
                 RETURN(0);
+	case LDLM_CONVERT: {
+		struct ldlm_request *dlm_req;
+
+		/* IBITS lock convert, on this portal as it replaces a cancel */
+		req_capsule_set(&req->rq_pill, &RQF_LDLM_CONVERT);
+		CDEBUG(D_INODE, "convert\n");
+		dlm_req = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
+		if (dlm_req == NULL) {
+			ldlm_callback_reply(req, -EPROTO);
+			RETURN(0);
+		}
+		rc = ldlm_handle_convert0(req, dlm_req);
+		if (rc == 0)
+			rc = ptlrpc_reply(req);
+		else
+			ldlm_callback_reply(req, rc);
+		RETURN(0);
+	}
         default:
                 CERROR("invalid opcode %d\n",
                        lustre_msg_get_opc(req->rq_reqmsg));
@@ -3228,11 +3310,35 @@ int ldlm_init(void)
 	if (ldlm_interval_tree_slab == NULL)
 		goto out_interval;
 
+	ldlm_ibits_node_slab = kmem_cache_create("ldlm_ibits_node",
+					sizeof(struct ldlm_ibits_node),
+					0, SLAB_HWCACHE_ALIGN, NULL);
+	if (ldlm_ibits_node_slab == NULL)
+		goto out_interval_tree;
+
+	ldlm_ibits_queues_slab = kmem_cache_create("ldlm_ibits_queues",
+					sizeof(struct ldlm_ibits_queues),
+					0, SLAB_HWCACHE_ALIGN, NULL);
+	if (ldlm_ibits_queues_slab == NULL)
+		goto out_ibits_node;
+
+	ldlm_contention_slab = kmem_cache_create("ldlm_contention",
+					sizeof(struct ldlm_extent_contention),
+					0, SLAB_HWCACHE_ALIGN, NULL);
+	if (ldlm_contention_slab == NULL)
+		goto out_ibits_queues;
+
 #if LUSTRE_TRACKS_LOCK_EXP_REFS
 	class_export_dump_hook = ldlm_dump_export_locks;
 #endif
 	return 0;
 
+out_ibits_queues:
+	kmem_cache_destroy(ldlm_ibits_queues_slab);
+out_ibits_node:
+	kmem_cache_destroy(ldlm_ibits_node_slab);
+out_interval_tree:
+	kmem_cache_destroy(ldlm_interval_tree_slab);
 out_interval:
 	kmem_cache_destroy(ldlm_interval_slab);
 out_lock:
@@ -3255,4 +3361,7 @@ void ldlm_exit(void)
 	kmem_cache_destroy(ldlm_lock_slab);
 	kmem_cache_destroy(ldlm_interval_slab);
 	kmem_cache_destroy(ldlm_interval_tree_slab);
+	kmem_cache_destroy(ldlm_ibits_node_slab);
+	kmem_cache_destroy(ldlm_ibits_queues_slab);
+	kmem_cache_destroy(ldlm_contention_slab);
 }
@@ -549,9 +549,7 @@ static int ldlm_cli_pool_shrink(struct ldlm_pool *pl,
          */
         ldlm_cli_pool_pop_slv(pl);
 
-	spin_lock(&ns->ns_lock);
-	unused = ns->ns_nr_unused;
-	spin_unlock(&ns->ns_lock);
+	unused = ldlm_ns_nr_unused(ns);
 
 	if (nr == 0)
 		return (unused / 100) * sysctl_vfs_cache_pressure;
@@ -560,16 +560,18 @@ static void failed_lock_cleanup(struct ldlm_namespace *ns,
  *
  * Called after receiving reply from server.
  */
-int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
-			  enum ldlm_type type, __u8 with_policy,
-			  enum ldlm_mode mode, __u64 *flags, void *lvb,
-			  __u32 lvb_len, const struct lustre_handle *lockh,
-			  int rc)
+static int ldlm_cli_enqueue_reply_fini(struct obd_export *exp,
+				       struct req_capsule *pill,
+				       struct ldlm_reply *reply,
+				       enum ldlm_type type, __u8 with_policy,
+				       enum ldlm_mode mode, __u64 *flags,
+				       void *lvb, __u32 lvb_len,
+				       const struct lustre_handle *lockh,
+				       int rc)
 {
         struct ldlm_namespace *ns = exp->exp_obd->obd_namespace;
         int is_replay = *flags & LDLM_FL_REPLAY;
         struct ldlm_lock *lock;
-        struct ldlm_reply *reply;
         int cleanup_phase = 1;
         ENTRY;
 
@@ -593,15 +595,16 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 	}
 
 	/* Before we return, swab the reply */
-	reply = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REP);
+	if (reply == NULL && pill != NULL)
+		reply = req_capsule_server_get(pill, &RMF_DLM_REP);
 	if (reply == NULL)
 		GOTO(cleanup, rc = -EPROTO);
 
 	if (lvb_len > 0) {
 		int size = 0;
 
-		size = req_capsule_get_size(&req->rq_pill, &RMF_DLM_LVB,
-					    RCL_SERVER);
+		LASSERT(pill != NULL);
+		size = req_capsule_get_size(pill, &RMF_DLM_LVB, RCL_SERVER);
 		if (size < 0) {
 			LDLM_ERROR(lock, "Fail to get lvb_len, rc = %d", size);
 			GOTO(cleanup, rc = size);
@@ -616,7 +619,7 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 
 	if (rc == ELDLM_LOCK_ABORTED) {
 		if (lvb_len > 0 && lvb != NULL)
-			rc = ldlm_fill_lvb(lock, &req->rq_pill, RCL_SERVER,
+			rc = ldlm_fill_lvb(lock, pill, RCL_SERVER,
 					   lvb, lvb_len);
 		GOTO(cleanup, rc = rc ? : ELDLM_LOCK_ABORTED);
 	}
@@ -699,7 +702,7 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 		 * a tiny window for completion to get in */
 		lock_res_and_lock(lock);
 		if (lock->l_req_mode != lock->l_granted_mode)
-			rc = ldlm_fill_lvb(lock, &req->rq_pill, RCL_SERVER,
+			rc = ldlm_fill_lvb(lock, pill, RCL_SERVER,
 					   lock->l_lvb_data, lvb_len);
 		unlock_res_and_lock(lock);
 		if (rc < 0) {
@@ -735,8 +738,35 @@ cleanup:
         LDLM_LOCK_RELEASE(lock);
         return rc;
 }
+
+int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
+			  enum ldlm_type type, __u8 with_policy,
+			  enum ldlm_mode mode, __u64 *flags, void *lvb,
+			  __u32 lvb_len, const struct lustre_handle *lockh,
+			  int rc)
+{
+	return ldlm_cli_enqueue_reply_fini(exp, &req->rq_pill, NULL, type,
+					   with_policy, mode, flags, lvb,
+					   lvb_len, lockh, rc);
+}
 EXPORT_SYMBOL(ldlm_cli_enqueue_fini);
 
+/**
+ * Finish the enqueue of a lock created by ldlm_cli_lock_create_pack(),
+ * \a reply is the part of the batched reply that belongs to this lock.
+ * As for ldlm_cli_enqueue_fini(), the lock is cleaned up if \a rc is an
+ * error, and the reference taken on the lock for \a mode is kept on success.
+ */
+int ldlm_cli_enqueue_fini_reply(struct obd_export *exp,
+				struct ldlm_reply *reply, enum ldlm_type type,
+				enum ldlm_mode mode, __u64 *flags,
+				const struct lustre_handle *lockh, int rc)
+{
+	return ldlm_cli_enqueue_reply_fini(exp, NULL, reply, type, 1, mode,
+					   flags, NULL, 0, lockh, rc);
+}
+EXPORT_SYMBOL(ldlm_cli_enqueue_fini_reply);
+
 /**
  * Estimate number of lock handles that would fit into request of given
  * size.  PAGE_SIZE-512 is to allow TCP/IP and LNET headers to fit into
@@ -878,6 +908,89 @@ struct ptlrpc_request *ldlm_enqueue_pack(struct obd_export *exp, int lvb_len)
 }
 EXPORT_SYMBOL(ldlm_enqueue_pack);
 
+/* create the local lock of a client enqueue, with a reference for its mode */
+static struct ldlm_lock *
+ldlm_cli_lock_create(struct obd_export *exp, struct ldlm_enqueue_info *einfo,
+		     const struct ldlm_res_id *res_id,
+		     union ldlm_policy_data const *policy, __u64 flags,
+		     __u32 lvb_len, enum lvb_type lvb_type,
+		     struct lustre_handle *lockh)
+{
+	const struct ldlm_callback_suite cbs = {
+		.lcs_completion = einfo->ei_cb_cp,
+		.lcs_blocking	= einfo->ei_cb_bl,
+		.lcs_glimpse	= einfo->ei_cb_gl
+	};
+	struct ldlm_lock *lock;
+
+	lock = ldlm_lock_create(exp->exp_obd->obd_namespace, res_id,
+				einfo->ei_type, einfo->ei_mode, &cbs,
+				einfo->ei_cbdata, lvb_len, lvb_type);
+	if (IS_ERR(lock))
+		return lock;
+
+	/* for the local lock, add the reference */
+	ldlm_lock_addref_internal(lock, einfo->ei_mode);
+	ldlm_lock2handle(lock, lockh);
+	if (policy != NULL)
+		lock->l_policy_data = *policy;
+
+	if (einfo->ei_type == LDLM_EXTENT) {
+		/* extent lock without policy is a bug */
+		if (policy == NULL)
+			LBUG();
+
+		lock->l_req_extent = policy->l_extent;
+	}
+	LDLM_DEBUG(lock, "client-side enqueue START, flags %#llx", flags);
+
+	return lock;
+}
+
+static void ldlm_cli_lock_setup(struct obd_export *exp, struct ldlm_lock *lock,
+				struct ldlm_enqueue_info *einfo, __u64 flags)
+{
+	lock->l_conn_export = exp;
+	lock->l_export = NULL;
+	lock->l_blocking_ast = einfo->ei_cb_bl;
+	lock->l_flags |= (flags & (LDLM_FL_NO_LRU | LDLM_FL_EXCL));
+	lock->l_last_activity = cfs_time_current_sec();
+}
+
+/**
+ * Create a client lock to be enqueued as part of a batched request, such as
+ * MDS_BATCH_GETATTR, and describe it in \a dlmreq for the server.
+ *
+ * The lock is referenced as by ldlm_cli_enqueue(), so it must be finished
+ * with ldlm_cli_enqueue_fini_reply() whether the request succeeds or not.
+ */
+int ldlm_cli_lock_create_pack(struct obd_export *exp,
+			      struct ldlm_request *dlmreq,
+			      struct ldlm_enqueue_info *einfo,
+			      const struct ldlm_res_id *res_id,
+			      union ldlm_policy_data const *policy,
+			      __u64 *flags, struct lustre_handle *lockh)
+{
+	struct ldlm_lock *lock;
+	ENTRY;
+
+	lock = ldlm_cli_lock_create(exp, einfo, res_id, policy, *flags, 0,
+				    LVB_T_NONE, lockh);
+	if (IS_ERR(lock))
+		RETURN(PTR_ERR(lock));
+
+	ldlm_cli_lock_setup(exp, lock, einfo, *flags);
+
+	memset(dlmreq, 0, sizeof(*dlmreq));
+	ldlm_lock2desc(lock, &dlmreq->lock_desc);
+	dlmreq->lock_flags = ldlm_flags_to_wire(*flags);
+	dlmreq->lock_count = 1;
+	dlmreq->lock_handle[0] = *lockh;
+
+	RETURN(0);
+}
+EXPORT_SYMBOL(ldlm_cli_lock_create_pack);
+
 /**
  * Client-side lock enqueue.
  *
@@ -916,38 +1029,13 @@ int ldlm_cli_enqueue(struct obd_export *exp, struct ptlrpc_request **reqp,
                 LDLM_DEBUG(lock, "client-side enqueue START");
                 LASSERT(exp == lock->l_conn_export);
         } else {
-		const struct ldlm_callback_suite cbs = {
-			.lcs_completion = einfo->ei_cb_cp,
-			.lcs_blocking	= einfo->ei_cb_bl,
-			.lcs_glimpse	= einfo->ei_cb_gl
-		};
-		lock = ldlm_lock_create(ns, res_id, einfo->ei_type,
-					einfo->ei_mode, &cbs, einfo->ei_cbdata,
-					lvb_len, lvb_type);
+		lock = ldlm_cli_lock_create(exp, einfo, res_id, policy, *flags,
+					    lvb_len, lvb_type, lockh);
 		if (IS_ERR(lock))
 			RETURN(PTR_ERR(lock));
-                /* for the local lock, add the reference */
-                ldlm_lock_addref_internal(lock, einfo->ei_mode);
-                ldlm_lock2handle(lock, lockh);
-		if (policy != NULL)
-			lock->l_policy_data = *policy;
-
-		if (einfo->ei_type == LDLM_EXTENT) {
-			/* extent lock without policy is a bug */
-			if (policy == NULL)
-				LBUG();
-
-			lock->l_req_extent = policy->l_extent;
-		}
-		LDLM_DEBUG(lock, "client-side enqueue START, flags %#llx",
-			   *flags);
 	}
 
-	lock->l_conn_export = exp;
-	lock->l_export = NULL;
-	lock->l_blocking_ast = einfo->ei_cb_bl;
-	lock->l_flags |= (*flags & (LDLM_FL_NO_LRU | LDLM_FL_EXCL));
-        lock->l_last_activity = cfs_time_current_sec();
+	ldlm_cli_lock_setup(exp, lock, einfo, *flags);
 
 	/* lock not sent to server yet */
 	if (reqp == NULL || *reqp == NULL) {
@@ -1106,6 +1194,100 @@ int ldlm_cli_convert(const struct lustre_handle *lockh, int new_mode,
         return rc;
 }
 
+/**
+ * Drop the \a drop_bits of the granted IBITS \a lock instead of cancelling it.
+ *
+ * The blocking AST of the lock is called with LDLM_CB_CANCELING and the
+ * dropped bits in the lock descriptor, so that only the state they protect
+ * is invalidated. The server is then told the remaining bits with a
+ * LDLM_CONVERT RPC. On success the lock is kept cached in the LRU.
+ *
+ * Called from the blocking AST of an unused lock. On error the lock is left
+ * as is and the caller should cancel it.
+ */
+int ldlm_cli_dropbits(struct ldlm_lock *lock, __u64 drop_bits)
+{
+	struct ldlm_lock_desc desc;
+	struct ldlm_request *body;
+	struct ptlrpc_request *req;
+	struct obd_export *exp = lock->l_conn_export;
+	__u64 bits;
+	int rc;
+	ENTRY;
+
+	if (exp == NULL || !exp_connect_lock_convert(exp))
+		RETURN(-EOPNOTSUPP);
+
+	lock_res_and_lock(lock);
+	bits = lock->l_policy_data.l_inodebits.bits;
+	drop_bits &= bits;
+	if (lock->l_resource->lr_type != LDLM_IBITS ||
+	    lock->l_granted_mode != lock->l_req_mode ||
+	    drop_bits == 0 || drop_bits == bits ||
+	    lock->l_readers != 0 || lock->l_writers != 0 ||
+	    ldlm_is_canceling(lock) || ldlm_is_cancel(lock) ||
+	    ldlm_is_converting(lock)) {
+		unlock_res_and_lock(lock);
+		RETURN(-EINVAL);
+	}
+
+	/* stop matching the dropped bits before their state is invalidated */
+	ldlm_set_converting(lock);
+	ldlm_resource_unlink_lock(lock);
+	lock->l_policy_data.l_inodebits.bits &= ~drop_bits;
+	ldlm_grant_lock_with_skiplist(lock);
+	ldlm_lock2desc(lock, &desc);
+	unlock_res_and_lock(lock);
+
+	LDLM_DEBUG(lock, "client-side convert, dropping bits %#llx", drop_bits);
+
+	desc.l_policy_data.l_inodebits.bits = drop_bits;
+	if (lock->l_blocking_ast != NULL)
+		lock->l_blocking_ast(lock, &desc, lock->l_ast_data,
+				     LDLM_CB_CANCELING);
+
+	req = ptlrpc_request_alloc_pack(class_exp2cliimp(exp),
+					&RQF_LDLM_CONVERT, LUSTRE_DLM_VERSION,
+					LDLM_CONVERT);
+	if (req == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
+	body->lock_handle[0] = lock->l_remote_handle;
+	body->lock_desc.l_req_mode = lock->l_granted_mode;
+	body->lock_desc.l_policy_data.l_inodebits.bits = bits & ~drop_bits;
+
+	/* served with cancels, it must not wait behind blocked enqueues */
+	req->rq_request_portal = LDLM_CANCEL_REQUEST_PORTAL;
+	req->rq_reply_portal = LDLM_CANCEL_REPLY_PORTAL;
+	ptlrpc_at_set_req_timeout(req);
+
+	ptlrpc_request_set_replen(req);
+	rc = ptlrpc_queue_wait(req);
+	if (rc == 0 && req->rq_status != 0)
+		rc = req->rq_status;
+	ptlrpc_req_finished(req);
+	EXIT;
+out:
+	lock_res_and_lock(lock);
+	ldlm_clear_converting(lock);
+	lock->l_policy_data.l_inodebits.cancel_bits = 0;
+	if (rc == 0 && !ldlm_is_canceling(lock) && !ldlm_is_cancel(lock)) {
+		/* the server no longer waits for this lock to go away */
+		ldlm_clear_cbpending(lock);
+		ldlm_clear_bl_ast(lock);
+		if (lock->l_readers == 0 && lock->l_writers == 0 &&
+		    !ldlm_is_no_lru(lock))
+			ldlm_lock_add_to_lru(lock);
+	}
+	unlock_res_and_lock(lock);
+
+	if (rc != 0)
+		LDLM_DEBUG(lock, "client-side convert failed: rc = %d", rc);
+	return rc;
+}
+EXPORT_SYMBOL(ldlm_cli_dropbits);
+
 /**
  * Cancel locks locally.
  * Returns:
@@ -1258,6 +1440,7 @@ int ldlm_cli_cancel_req(struct obd_export *exp, struct list_head *cancels,
 
 		ptlrpc_request_set_replen(req);
 		if (flags & LCF_ASYNC) {
+			req->rq_coalesce = 1;
 			ptlrpcd_add_req(req);
 			sent = count;
 			GOTO(out, 0);
@@ -1665,6 +1848,115 @@ ldlm_cancel_lru_policy(struct ldlm_namespace *ns, enum ldlm_lru_flags lru_flags)
 	return ldlm_cancel_default_policy;
 }
 
+/**
+ * Finds the least recently used lock of the LRU of \a ns, looking at the head
+ * of every LRU shard, or at the lock after the position of the previous
+ * LDLM_LRU_FLAG_NO_WAIT scan if \a no_wait is set. Locks already being
+ * cancelled are dropped from the LRU on the way.
+ *
+ * \retval the lock with a reference taken, its l_last_used is in \a last_use
+ * \retval NULL if there is no unused lock left to look at
+ */
+static struct ldlm_lock *ldlm_lru_oldest(struct ldlm_namespace *ns,
+					 bool no_wait, ktime_t *last_use)
+{
+	struct ldlm_lock *oldest = NULL;
+	int i;
+
+	for (i = 0; i < LDLM_LRU_SHARDS; i++) {
+		struct ldlm_lru_shard *lls = &ns->ns_lru[i];
+		struct ldlm_lock *prev = NULL;
+		struct ldlm_lock *lock = NULL;
+		struct list_head *item, *next;
+
+		if (list_empty(&lls->lls_list))
+			continue;
+
+		spin_lock(&lls->lls_lock);
+		item = no_wait ? lls->lls_last_pos : &lls->lls_list;
+		for (item = item->next, next = item->next;
+		     item != &lls->lls_list;
+		     item = next, next = item->next) {
+			lock = list_entry(item, struct ldlm_lock, l_lru);
+
+			/* No locks which got blocking requests. */
+			LASSERT(!ldlm_is_bl_ast(lock));
+
+			if (!ldlm_is_canceling(lock))
+				break;
+
+			/* Somebody is already doing CANCEL. No need for this
+			 * lock in LRU, do not traverse it again. */
+			ldlm_lock_remove_from_lru_nolock(lock);
+		}
+		if (item != &lls->lls_list &&
+		    (oldest == NULL ||
+		     ktime_compare(lock->l_last_used, *last_use) < 0)) {
+			prev = oldest;
+			oldest = LDLM_LOCK_GET(lock);
+			*last_use = lock->l_last_used;
+		}
+		spin_unlock(&lls->lls_lock);
+
+		if (prev != NULL)
+			LDLM_LOCK_RELEASE(prev);
+	}
+
+	return oldest;
+}
+
+/**
+ * Gives an unused lock picked for cancel by the LRU policy a second chance
+ * if cancelling it is costly, e.g. it still covers cached pages which would
+ * have to be read again. The lock is moved to the tail of its LRU shard and
+ * is cancelled when the scans reach it again, unless it is used meanwhile.
+ *
+ * Only done for the scans run to keep the LRU in bounds, an explicit cancel
+ * request (lru_size, replay, umount) gets the locks it asked for.
+ *
+ * \retval true if the lock was spared and must be skipped
+ */
+static bool ldlm_lru_spare(struct ldlm_namespace *ns, struct ldlm_lock *lock,
+			   ktime_t last_use, enum ldlm_lru_flags lru_flags)
+{
+	struct ldlm_lru_shard *lls;
+	bool spared = false;
+
+	if (ns->ns_weigh == NULL || ldlm_is_lru_spared(lock) ||
+	    !(lru_flags & (LDLM_LRU_FLAG_LRUR | LDLM_LRU_FLAG_AGED |
+			   LDLM_LRU_FLAG_SHRINK)) ||
+	    (lru_flags & (LDLM_LRU_FLAG_NO_WAIT | LDLM_LRU_FLAG_CLEANUP)))
+		return false;
+
+	/* Locks unused for longer than ns_max_age are not worth keeping. */
+	if (ktime_compare(ktime_get(), ktime_add(last_use, ns->ns_max_age)) >= 0)
+		return false;
+
+	if (ns->ns_weigh(lock) == 0)
+		return false;
+
+	lls = ldlm_lock_lru_shard(lock);
+	lock_res_and_lock(lock);
+	spin_lock(&lls->lls_lock);
+	if (!ldlm_is_canceling(lock) && !list_empty(&lock->l_lru) &&
+	    !ktime_compare(last_use, lock->l_last_used)) {
+		if (lls->lls_last_pos == &lock->l_lru)
+			lls->lls_last_pos = lock->l_lru.prev;
+		list_move_tail(&lock->l_lru, &lls->lls_list);
+		ldlm_set_lru_spared(lock);
+		spared = true;
+	}
+	spin_unlock(&lls->lls_lock);
+	unlock_res_and_lock(lock);
+
+	if (spared) {
+		LDLM_DEBUG(lock, "costly lock kept in LRU");
+		lprocfs_counter_incr(ns->ns_stats, LDLM_NSS_LRU_SPARED);
+	}
+
+	return spared;
+}
+
 /**
  * - Free space in LRU for \a count new locks,
  *   redundant unused locks are canceled locally;
@@ -1701,56 +1993,38 @@ ldlm_cancel_lru_policy(struct ldlm_namespace *ns, enum ldlm_lru_flags lru_flags)
  * flags & LDLM_CANCEL_CLEANUP - when cancelling read locks, do not check for
  * 				other read locks covering the same pages, just
  * 				discard those pages.
+ *
+ * The locks are taken from the LRU shards oldest first, see ldlm_lru_oldest().
+ * Costly locks picked by the LRUR, AGED and SHRINK policies may be kept a bit
+ * longer, see ldlm_lru_spare().
  */
 static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 				 struct list_head *cancels, int count, int max,
 				 enum ldlm_lru_flags lru_flags)
 {
 	ldlm_cancel_lru_policy_t pf;
+	ktime_t start = ktime_get();
 	int added = 0;
 	int no_wait = lru_flags & LDLM_LRU_FLAG_NO_WAIT;
 
 	ENTRY;
 
 	if (!ns_connect_lru_resize(ns))
-		count += ns->ns_nr_unused - ns->ns_max_unused;
+		count += ldlm_ns_nr_unused(ns) - ns->ns_max_unused;
 
 	pf = ldlm_cancel_lru_policy(ns, lru_flags);
 	LASSERT(pf != NULL);
 
 	/* For any flags, stop scanning if @max is reached. */
-	while (!list_empty(&ns->ns_unused_list) && (max == 0 || added < max)) {
+	while (max == 0 || added < max) {
 		struct ldlm_lock *lock;
-		struct list_head *item, *next;
 		enum ldlm_policy_res result;
 		ktime_t last_use = ktime_set(0, 0);
 
-		spin_lock(&ns->ns_lock);
-		item = no_wait ? ns->ns_last_pos : &ns->ns_unused_list;
-		for (item = item->next, next = item->next;
-		     item != &ns->ns_unused_list;
-		     item = next, next = item->next) {
-			lock = list_entry(item, struct ldlm_lock, l_lru);
-
-			/* No locks which got blocking requests. */
-			LASSERT(!ldlm_is_bl_ast(lock));
-
-			if (!ldlm_is_canceling(lock))
-				break;
-
-			/* Somebody is already doing CANCEL. No need for this
-			 * lock in LRU, do not traverse it again. */
-			ldlm_lock_remove_from_lru_nolock(lock);
-		}
-		if (item == &ns->ns_unused_list) {
-			spin_unlock(&ns->ns_lock);
+		lock = ldlm_lru_oldest(ns, no_wait, &last_use);
+		if (lock == NULL)
 			break;
-		}
-
-		last_use = lock->l_last_used;
 
-		LDLM_LOCK_GET(lock);
-		spin_unlock(&ns->ns_lock);
 		lu_ref_add(&lock->l_reference, __FUNCTION__, current);
 
 		/* Pass the lock through the policy filter and see if it
@@ -1766,7 +2040,8 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 		 * old locks, but additionally choose them by
 		 * their weight. Big extent locks will stay in
 		 * the cache. */
-		result = pf(ns, lock, ns->ns_nr_unused, added, count);
+		lprocfs_counter_incr(ns->ns_stats, LDLM_NSS_LRU_SCANNED);
+		result = pf(ns, lock, ldlm_ns_nr_unused(ns), added, count);
 		if (result == LDLM_POLICY_KEEP_LOCK) {
 			lu_ref_del(&lock->l_reference, __func__, current);
 			LDLM_LOCK_RELEASE(lock);
@@ -1777,15 +2052,24 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 			lu_ref_del(&lock->l_reference, __func__, current);
 			LDLM_LOCK_RELEASE(lock);
 			if (no_wait) {
-				spin_lock(&ns->ns_lock);
+				struct ldlm_lru_shard *lls;
+
+				lls = ldlm_lock_lru_shard(lock);
+				spin_lock(&lls->lls_lock);
 				if (!list_empty(&lock->l_lru) &&
-				    lock->l_lru.prev == ns->ns_last_pos)
-					ns->ns_last_pos = &lock->l_lru;
-				spin_unlock(&ns->ns_lock);
+				    lock->l_lru.prev == lls->lls_last_pos)
+					lls->lls_last_pos = &lock->l_lru;
+				spin_unlock(&lls->lls_lock);
 			}
 			continue;
 		}
 
+		if (ldlm_lru_spare(ns, lock, last_use, lru_flags)) {
+			lu_ref_del(&lock->l_reference, __func__, current);
+			LDLM_LOCK_RELEASE(lock);
+			continue;
+		}
+
 		lock_res_and_lock(lock);
 		/* Check flags again under the lock. */
 		if (ldlm_is_canceling(lock) ||
@@ -1835,6 +2119,11 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 		lu_ref_del(&lock->l_reference, __FUNCTION__, current);
 		added++;
 	}
+
+	if (added > 0)
+		lprocfs_counter_add(ns->ns_stats, LDLM_NSS_LRU_CANCELLED, added);
+	lprocfs_counter_add(ns->ns_stats, LDLM_NSS_LRU_SCAN_TIME,
+			    ktime_us_delta(ktime_get(), start));
 	RETURN(added);
 }
 
@@ -2355,12 +2644,12 @@ static void ldlm_cancel_unused_locks_for_replay(struct ldlm_namespace *ns)
 
 	CDEBUG(D_DLMTRACE, "Dropping as many unused locks as possible before"
 			   "replay for namespace %s (%d)\n",
-			   ldlm_ns_name(ns), ns->ns_nr_unused);
+			   ldlm_ns_name(ns), ldlm_ns_nr_unused(ns));
 
 	/* We don't need to care whether or not LRU resize is enabled
 	 * because the LDLM_LRU_FLAG_NO_WAIT policy doesn't use the
 	 * count parameter */
-	canceled = ldlm_cancel_lru_local(ns, &cancels, ns->ns_nr_unused, 0,
+	canceled = ldlm_cancel_lru_local(ns, &cancels, ldlm_ns_nr_unused(ns), 0,
 					 LCF_LOCAL, LDLM_LRU_FLAG_NO_WAIT);
 
 	CDEBUG(D_DLMTRACE, "Canceled %d unused locks from namespace %s\n",
@@ -297,7 +297,7 @@ static ssize_t lock_unused_count_show(struct kobject *kobj,
 	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
 						 ns_kobj);
 
-	return sprintf(buf, "%d\n", ns->ns_nr_unused);
+	return sprintf(buf, "%d\n", ldlm_ns_nr_unused(ns));
 }
 LUSTRE_RO_ATTR(lock_unused_count);
 
@@ -306,11 +306,11 @@ static ssize_t lru_size_show(struct kobject *kobj, struct attribute *attr,
 {
 	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
 						 ns_kobj);
-	__u32 *nr = &ns->ns_max_unused;
+	__u32 nr = ns->ns_max_unused;
 
 	if (ns_connect_lru_resize(ns))
-		nr = &ns->ns_nr_unused;
-	return sprintf(buf, "%u\n", *nr);
+		nr = ldlm_ns_nr_unused(ns);
+	return sprintf(buf, "%u\n", nr);
 }
 
 static ssize_t lru_size_store(struct kobject *kobj, struct attribute *attr,
@@ -320,6 +320,7 @@ static ssize_t lru_size_store(struct kobject *kobj, struct attribute *attr,
 						 ns_kobj);
 	unsigned long tmp;
 	int lru_resize;
+	int nr_unused;
 	int err;
 
 	if (strncmp(buffer, "clear", 5) == 0) {
@@ -327,8 +328,8 @@ static ssize_t lru_size_store(struct kobject *kobj, struct attribute *attr,
                        "dropping all unused locks from namespace %s\n",
                        ldlm_ns_name(ns));
                 if (ns_connect_lru_resize(ns)) {
-			/* Try to cancel all @ns_nr_unused locks. */
-			ldlm_cancel_lru(ns, ns->ns_nr_unused, 0,
+			/* Try to cancel all unused locks. */
+			ldlm_cancel_lru(ns, ldlm_ns_nr_unused(ns), 0,
 					LDLM_LRU_FLAG_PASSED |
 					LDLM_LRU_FLAG_CLEANUP);
 		} else {
@@ -352,13 +353,14 @@ static ssize_t lru_size_store(struct kobject *kobj, struct attribute *attr,
 		if (!lru_resize)
 			ns->ns_max_unused = (unsigned int)tmp;
 
-		if (tmp > ns->ns_nr_unused)
-			tmp = ns->ns_nr_unused;
-		tmp = ns->ns_nr_unused - tmp;
+		nr_unused = ldlm_ns_nr_unused(ns);
+		if (tmp > nr_unused)
+			tmp = nr_unused;
+		tmp = nr_unused - tmp;
 
 		CDEBUG(D_DLMTRACE,
 		       "changing namespace %s unused locks from %u to %u\n",
-		       ldlm_ns_name(ns), ns->ns_nr_unused,
+		       ldlm_ns_name(ns), nr_unused,
 		       (unsigned int)tmp);
 		ldlm_cancel_lru(ns, tmp, LCF_ASYNC, LDLM_LRU_FLAG_PASSED);
 
@@ -587,6 +589,38 @@ static ssize_t contended_locks_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(contended_locks);
 
+static ssize_t contention_region_bytes_show(struct kobject *kobj,
+					    struct attribute *attr, char *buf)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+
+	return sprintf(buf, "%u\n", ns->ns_contention_region);
+}
+
+static ssize_t contention_region_bytes_store(struct kobject *kobj,
+					     struct attribute *attr,
+					     const char *buffer, size_t count)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+	unsigned long tmp;
+	int err;
+
+	err = kstrtoul(buffer, 10, &tmp);
+	if (err != 0)
+		return -EINVAL;
+
+	/* regions are indexed by offset shift */
+	if (tmp < PAGE_SIZE || tmp > UINT_MAX || !is_power_of_2(tmp))
+		return -ERANGE;
+
+	ns->ns_contention_region = tmp;
+
+	return count;
+}
+LUSTRE_RW_ATTR(contention_region_bytes);
+
 static ssize_t max_parallel_ast_show(struct kobject *kobj,
 				     struct attribute *attr, char *buf)
 {
@@ -631,6 +665,7 @@ static struct attribute *ldlm_ns_attrs[] = {
 	&lustre_attr_max_nolock_bytes.attr,
 	&lustre_attr_contention_seconds.attr,
 	&lustre_attr_contended_locks.attr,
+	&lustre_attr_contention_region_bytes.attr,
 	&lustre_attr_max_parallel_ast.attr,
 #endif
 	NULL,
@@ -684,6 +719,16 @@ int ldlm_namespace_sysfs_register(struct ldlm_namespace *ns)
 
 	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LOCKS,
 			     LPROCFS_CNTR_AVGMINMAX, "locks", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_SCANNED, 0,
+			     "lru_scanned", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_CANCELLED, 0,
+			     "lru_cancelled", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_SPARED, 0,
+			     "lru_spared", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_HITS, 0,
+			     "lru_hits", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_SCAN_TIME,
+			     LPROCFS_CNTR_AVGMINMAX, "lru_scan_time", "usec");
 
 	return err;
 }
@@ -691,6 +736,7 @@ int ldlm_namespace_sysfs_register(struct ldlm_namespace *ns)
 static int ldlm_namespace_proc_register(struct ldlm_namespace *ns)
 {
 	struct proc_dir_entry *ns_pde;
+	int rc;
 
         LASSERT(ns != NULL);
         LASSERT(ns->ns_rs_hash != NULL);
@@ -704,7 +750,11 @@ static int ldlm_namespace_proc_register(struct ldlm_namespace *ns)
 		ns->ns_proc_dir_entry = ns_pde;
 	}
 
-	return 0;
+	rc = lprocfs_register_stats(ns_pde, "stats", ns->ns_stats);
+	if (rc != 0)
+		lprocfs_remove(&ns->ns_proc_dir_entry);
+
+	return rc;
 }
 #undef MAX_STRING_SIZE
 #else /* CONFIG_PROC_FS */
@@ -932,7 +982,14 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
         ns->ns_client   = client;
 
 	INIT_LIST_HEAD(&ns->ns_list_chain);
-	INIT_LIST_HEAD(&ns->ns_unused_list);
+	for (idx = 0; idx < LDLM_LRU_SHARDS; idx++) {
+		struct ldlm_lru_shard *lls = &ns->ns_lru[idx];
+
+		spin_lock_init(&lls->lls_lock);
+		INIT_LIST_HEAD(&lls->lls_list);
+		lls->lls_nr = 0;
+		lls->lls_last_pos = &lls->lls_list;
+	}
 	spin_lock_init(&ns->ns_lock);
 	atomic_set(&ns->ns_bref, 0);
 	init_waitqueue_head(&ns->ns_waitq);
@@ -940,9 +997,9 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 	ns->ns_max_nolock_size    = NS_DEFAULT_MAX_NOLOCK_BYTES;
 	ns->ns_contention_time    = NS_DEFAULT_CONTENTION_SECONDS;
 	ns->ns_contended_locks    = NS_DEFAULT_CONTENDED_LOCKS;
+	ns->ns_contention_region  = NS_DEFAULT_CONTENTION_REGION_BYTES;
 
         ns->ns_max_parallel_ast   = LDLM_DEFAULT_PARALLEL_AST_LIMIT;
-        ns->ns_nr_unused          = 0;
         ns->ns_max_unused         = LDLM_DEFAULT_LRU_SIZE;
 	ns->ns_max_age            = ktime_set(LDLM_DEFAULT_MAX_ALIVE, 0);
         ns->ns_ctime_age_limit    = LDLM_CTIME_AGE_LIMIT;
@@ -951,7 +1008,6 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
         ns->ns_connect_flags      = 0;
         ns->ns_stopping           = 0;
 	ns->ns_reclaim_start	  = 0;
-	ns->ns_last_pos		  = &ns->ns_unused_list;
 
 	rc = ldlm_namespace_sysfs_register(ns);
 	if (rc) {
@@ -1353,7 +1409,8 @@ struct ldlm_namespace *ldlm_namespace_first_locked(enum ldlm_side client)
 }
 
 /** Create and initialize new resource. */
-static struct ldlm_resource *ldlm_resource_new(enum ldlm_type ldlm_type)
+static struct ldlm_resource *ldlm_resource_new(struct ldlm_namespace *ns,
+					       enum ldlm_type ldlm_type)
 {
 	struct ldlm_resource *res;
 	int idx;
@@ -1362,6 +1419,12 @@ static struct ldlm_resource *ldlm_resource_new(enum ldlm_type ldlm_type)
 	if (res == NULL)
 		return NULL;
 
+	if (ldlm_type == LDLM_IBITS &&
+	    ldlm_inodebits_alloc_res(ns, res) != 0) {
+		OBD_SLAB_FREE_PTR(res, ldlm_resource_slab);
+		return NULL;
+	}
+
 	if (ldlm_type == LDLM_EXTENT) {
 		OBD_SLAB_ALLOC(res->lr_itree, ldlm_interval_tree_slab,
 			       sizeof(*res->lr_itree) * LCK_MODE_NUM);
@@ -1430,7 +1493,7 @@ ldlm_resource_get(struct ldlm_namespace *ns, struct ldlm_resource *parent,
 
 	LASSERTF(type >= LDLM_MIN_TYPE && type < LDLM_MAX_TYPE,
 		 "type: %d\n", type);
-	res = ldlm_resource_new(type);
+	res = ldlm_resource_new(ns, type);
 	if (res == NULL)
 		return ERR_PTR(-ENOMEM);
 
@@ -1450,6 +1513,8 @@ ldlm_resource_get(struct ldlm_namespace *ns, struct ldlm_resource *parent,
 		if (res->lr_itree != NULL)
 			OBD_SLAB_FREE(res->lr_itree, ldlm_interval_tree_slab,
 				      sizeof(*res->lr_itree) * LCK_MODE_NUM);
+		ldlm_inodebits_free_res(res);
+		ldlm_extent_free_res(res);
 		OBD_SLAB_FREE(res, ldlm_resource_slab, sizeof *res);
 found:
 		res = hlist_entry(hnode, struct ldlm_resource, lr_hash);
@@ -1534,6 +1599,8 @@ int ldlm_resource_putref(struct ldlm_resource *res)
 		if (res->lr_itree != NULL)
 			OBD_SLAB_FREE(res->lr_itree, ldlm_interval_tree_slab,
 				      sizeof(*res->lr_itree) * LCK_MODE_NUM);
+		ldlm_inodebits_free_res(res);
+		ldlm_extent_free_res(res);
 		OBD_SLAB_FREE(res, ldlm_resource_slab, sizeof *res);
 		return 1;
 	}
@@ -1559,6 +1626,9 @@ void ldlm_resource_add_lock(struct ldlm_resource *res, struct list_head *head,
 	LASSERT(list_empty(&lock->l_res_link));
 
 	list_add_tail(&lock->l_res_link, head);
+
+	if (res->lr_type == LDLM_IBITS)
+		ldlm_inodebits_add_lock(res, head, lock);
 }
 
 /**
@@ -1584,6 +1654,9 @@ void ldlm_resource_insert_lock_after(struct ldlm_lock *original,
 	LASSERT(list_empty(&new->l_res_link));
 
 	list_add(&new->l_res_link, &original->l_res_link);
+
+	if (res->lr_type == LDLM_IBITS)
+		ldlm_inodebits_add_lock(res, &res->lr_granted, new);
  out:;
 }
 
@@ -1592,7 +1665,10 @@ void ldlm_resource_unlink_lock(struct ldlm_lock *lock)
         int type = lock->l_resource->lr_type;
 
         check_res_locked(lock->l_resource);
-        if (type == LDLM_IBITS || type == LDLM_PLAIN)
+	if (type == LDLM_IBITS) {
+		ldlm_unlink_lock_skiplist(lock);
+		ldlm_inodebits_unlink_lock(lock);
+	} else if (type == LDLM_PLAIN)
                 ldlm_unlink_lock_skiplist(lock);
         else if (type == LDLM_EXTENT)
                 ldlm_extent_unlink_lock(lock);
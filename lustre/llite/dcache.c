@@ -305,6 +305,13 @@ static int ll_revalidate_dentry(struct dentry *dentry,
 {
 	struct inode *dir = dentry->d_parent->d_inode;
 
+	/* Dentry instantiated from readdir-plus attributes without a LOOKUP
+	 * lock, nothing invalidates it once they are too old. */
+	if (dentry->d_inode != NULL &&
+	    ll_i2info(dentry->d_inode)->lli_rdplus_expire != 0 &&
+	    !ll_rdplus_valid(dentry->d_inode))
+		return 0;
+
 	/* If this is intermediate component path lookup and we were able to get
 	 * to this dentry, then its lock has not been revoked and the
 	 * path component is valid. */
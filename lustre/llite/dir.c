@@ -150,6 +150,8 @@ struct page *ll_get_dir_page(struct inode *dir, struct md_op_data *op_data,
 	int			rc;
 
 	cb_op.md_blocking_ast = ll_md_blocking_ast;
+	if (ll_i2sbi(dir)->ll_rdplus_max_age != 0)
+		op_data->op_cli_flags |= CLI_READDIR_PLUS;
 	rc = md_read_page(ll_i2mdexp(dir), op_data, &cb_op, offset, &page);
 	if (rc != 0)
 		return ERR_PTR(rc);
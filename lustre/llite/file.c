@@ -69,6 +69,8 @@ static struct ll_file_data *ll_file_data_get(void)
 		return NULL;
 
 	fd->fd_write_failed = false;
+	fd->fd_lock_no_expand = false;
+	fd->fd_designated_mirror = 0;
 
 	return fd;
 }
@@ -118,6 +120,7 @@ static void ll_prepare_close(struct inode *inode, struct md_op_data *op_data,
  * If \a bias is MDS_HSM_RELEASE then \a data is a pointer to the data version.
  * If \a bias is MDS_CLOSE_LAYOUT_SWAP then \a data is a pointer to the inode to
  * swap layouts with.
+ * If \a bias is MDS_CLOSE_RESYNC_DONE then \a data is unused.
  */
 static int ll_close_inode_openhandle(struct inode *inode,
 				     struct obd_client_handle *och,
@@ -161,6 +164,11 @@ static int ll_close_inode_openhandle(struct inode *inode,
 		op_data->op_attr.ia_valid |= ATTR_SIZE | ATTR_BLOCKS;
 		break;
 
+	case MDS_CLOSE_RESYNC_DONE:
+		op_data->op_bias |= MDS_CLOSE_RESYNC_DONE;
+		op_data->op_lease_handle = och->och_lease_handle;
+		break;
+
 	default:
 		LASSERT(data == NULL);
 		break;
@@ -172,7 +180,8 @@ static int ll_close_inode_openhandle(struct inode *inode,
 		       md_exp->exp_obd->obd_name, PFID(&lli->lli_fid), rc);
 
 	if (rc == 0 &&
-	    op_data->op_bias & (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP)) {
+	    op_data->op_bias & (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP |
+				MDS_CLOSE_RESYNC_DONE)) {
 		struct mdt_body *body;
 
 		body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
@@ -952,11 +961,13 @@ out_free_och:
 }
 
 /**
- * Release lease and close the file.
+ * Release lease and close the file, executing the close intent \a bias
+ * on the MDT if the lease is still valid.
  * It will check if the lease has ever broken.
  */
-static int ll_lease_close(struct obd_client_handle *och, struct inode *inode,
-			  bool *lease_broken)
+static int ll_lease_close_intent(struct obd_client_handle *och,
+				 struct inode *inode, bool *lease_broken,
+				 enum mds_op_bias bias, void *data)
 {
 	struct ldlm_lock *lock;
 	bool cancelled = true;
@@ -971,19 +982,37 @@ static int ll_lease_close(struct obd_client_handle *och, struct inode *inode,
 		LDLM_LOCK_PUT(lock);
 	}
 
-	CDEBUG(D_INODE, "lease for "DFID" broken? %d\n",
-	       PFID(&ll_i2info(inode)->lli_fid), cancelled);
+	CDEBUG(D_INODE, "lease for "DFID" broken? %d, bias %#x\n",
+	       PFID(&ll_i2info(inode)->lli_fid), cancelled, bias);
 
-	if (!cancelled)
+	/* the lease is cancelled by the MDT when the intent is executed,
+	 * see mdc_intent_close_pack() */
+	if (!cancelled && bias == 0)
 		ldlm_cli_cancel(&och->och_lease_handle, 0);
 
 	if (lease_broken != NULL)
 		*lease_broken = cancelled;
 
-	rc = ll_close_inode_openhandle(inode, och, 0, NULL);
+	/* no need to execute the intent if the lease is gone */
+	if (cancelled) {
+		bias = 0;
+		data = NULL;
+	}
+
+	rc = ll_close_inode_openhandle(inode, och, bias, data);
 	RETURN(rc);
 }
 
+/**
+ * Release lease and close the file.
+ * It will check if the lease has ever broken.
+ */
+static int ll_lease_close(struct obd_client_handle *och, struct inode *inode,
+			  bool *lease_broken)
+{
+	return ll_lease_close_intent(och, inode, lease_broken, 0, NULL);
+}
+
 int ll_merge_attr(const struct lu_env *env, struct inode *inode)
 {
 	struct ll_inode_info *lli = ll_i2info(inode);
@@ -1081,7 +1110,7 @@ static bool file_is_noatime(const struct file *file)
 
 static int ll_file_io_ptask(struct cfs_ptask *ptask);
 
-static void ll_io_init(struct cl_io *io, struct file *file, enum cl_io_type iot)
+void ll_io_init(struct cl_io *io, struct file *file, enum cl_io_type iot)
 {
 	struct inode *inode = file_inode(file);
 
@@ -1105,6 +1134,7 @@ static void ll_io_init(struct cl_io *io, struct file *file, enum cl_io_type iot)
 		io->ci_lockreq = CILR_MANDATORY;
 	}
 	io->ci_noatime = file_is_noatime(file);
+	io->ci_designated_mirror = LUSTRE_FPRIVATE(file)->fd_designated_mirror;
 	if (ll_i2sbi(inode)->ll_flags & LL_SBI_PIO)
 		io->ci_pio = !io->u.ci_rw.rw_append;
 	else
@@ -1426,8 +1456,14 @@ static ssize_t ll_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
 	struct vvp_io_args *args;
 	ssize_t result;
 	ssize_t rc2;
+	bool cached;
 	__u16 refcheck;
 
+	/* served by the Persistent Client Cache, no lock nor RPC needed */
+	result = pcc_file_read_iter(iocb, to, &cached);
+	if (cached)
+		return result;
+
 	env = cl_env_get(&refcheck);
 	if (IS_ERR(env))
 		return PTR_ERR(env);
@@ -1891,7 +1927,8 @@ ll_get_grouplock(struct inode *inode, struct file *file, unsigned long arg)
 
 		rc = cl_object_layout_get(env, obj, &cl);
 		if (!rc && cl.cl_is_composite)
-			rc = ll_layout_write_intent(inode, 0, OBD_OBJECT_EOF);
+			rc = ll_layout_write_intent(inode, LAYOUT_INTENT_WRITE,
+						    0, OBD_OBJECT_EOF);
 
 		cl_env_put(env, &refcheck);
 		if (rc)
@@ -2328,8 +2365,9 @@ int ll_hsm_state_set(struct inode *inode, struct hsm_state_set *hss)
 		RETURN(-EINVAL);
 
 	/* Non-root users are forbidden to set or clear flags which are
-	 * NOT defined in HSM_USER_MASK. */
-	if (((hss->hss_setmask | hss->hss_clearmask) & ~HSM_USER_MASK) &&
+	 * NOT defined in HSM_USER_MASK, but they may set HSM_PCC_MASK. */
+	if (((hss->hss_setmask & ~(HSM_USER_MASK | HSM_PCC_MASK)) ||
+	     (hss->hss_clearmask & ~HSM_USER_MASK)) &&
 	    !cfs_capable(CFS_CAP_SYS_ADMIN))
 		RETURN(-EPERM);
 
@@ -2502,6 +2540,139 @@ static int ll_ladvise(struct inode *inode, struct file *file, __u64 flags,
 	RETURN(rc);
 }
 
+/*
+ * Request DLM extent locks for a range of a file ahead of the I/O, so that
+ * e.g. each rank of a shared-file N-to-1 writer owns its stripes before the
+ * first byte lands, instead of having the first writer's lock expanded to
+ * EOF and ping-ponged between all the others.
+ *
+ * The locks are requested asynchronously, are never expanded by the server
+ * and never block on or revoke conflicting locks: a conflicting request is
+ * simply refused.  The locks are left unused in the client lock cache for
+ * the I/O that follows to match.
+ *
+ * \retval LLA_RESULT_SENT	lock request(s) sent to the servers
+ * \retval LLA_RESULT_DIFFERENT	a lock on a different extent already exists
+ * \retval LLA_RESULT_SAME	a lock on exactly this extent already exists
+ * \retval negative errno on failure
+ */
+static int ll_file_lock_ahead(struct file *file,
+			      struct llapi_lu_ladvise *ladvise)
+{
+	struct inode *inode = file_inode(file);
+	struct cl_object *obj = ll_i2info(inode)->lli_clob;
+	struct lu_env *env;
+	struct cl_io *io;
+	struct cl_lock *lock;
+	struct cl_lock_descr *descr;
+	enum cl_lock_mode cl_mode;
+	int rc;
+	__u16 refcheck;
+	ENTRY;
+
+	CDEBUG(D_VFSTRACE, "Lock request: file=%s, inode="DFID", mode=%u, "
+	       "start=%llu, end=%llu\n", file_dentry(file)->d_name.name,
+	       PFID(ll_inode2fid(inode)), ladvise->lla_lockahead_mode,
+	       ladvise->lla_start, ladvise->lla_end);
+
+	if (ladvise->lla_lockahead_mode == MODE_READ_USER)
+		cl_mode = CLM_READ;
+	else
+		cl_mode = CLM_WRITE;
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		RETURN(PTR_ERR(env));
+
+	io = vvp_env_thread_io(env);
+	io->ci_obj = obj;
+
+	rc = cl_io_init(env, io, CIT_MISC, io->ci_obj);
+	if (rc == 0) {
+		lock = vvp_env_lock(env);
+		descr = &lock->cll_descr;
+
+		descr->cld_obj = obj;
+		descr->cld_start = cl_index(obj, ladvise->lla_start);
+		descr->cld_end = cl_index(obj, ladvise->lla_end - 1);
+		descr->cld_mode = cl_mode;
+		/* CEF_MUST keeps the lock from being converted to a lockless
+		 * one, CEF_SPECULATIVE makes the enqueue asynchronous and
+		 * refused by the server on any conflict. */
+		descr->cld_enq_flags = CEF_MUST | CEF_LOCK_NO_EXPAND |
+				       CEF_SPECULATIVE;
+
+		rc = cl_lock_request(env, io, lock);
+		/* on success the lock has to be released, the DLM locks
+		 * stay cached for the I/O that follows */
+		if (rc >= 0)
+			cl_lock_release(env, lock);
+	} else if (rc > 0) {
+		/* Does not make sense to lock a released layout */
+		rc = -ENOTSUPP;
+	}
+
+	cl_io_fini(env, io);
+	cl_env_put(env, &refcheck);
+
+	/* -ECANCELED indicates a lock on a different extent was already
+	 * present and -EEXIST a lock on exactly the same extent. Convert
+	 * them to positive values so userspace can tell them from real
+	 * errors. */
+	if (rc == -ECANCELED)
+		rc = LLA_RESULT_DIFFERENT;
+	else if (rc == -EEXIST)
+		rc = LLA_RESULT_SAME;
+
+	RETURN(rc);
+}
+
+/* Check an advice before any of the advices of a request is acted upon */
+static int ll_ladvise_sanity(struct inode *inode,
+			     struct llapi_lu_ladvise *ladvise)
+{
+	enum lu_ladvise_type advice = ladvise->lla_advice;
+	__u32 flags_mask = LF_DEFAULT_MASK;
+	int rc = 0;
+
+	switch (advice) {
+	case LU_LADVISE_WILLREAD:
+	case LU_LADVISE_DONTNEED:
+		break;
+	case LU_LADVISE_LOCKNOEXPAND:
+		/* the advice applies to the file descriptor, not a range */
+		if (ladvise->lla_peradvice_flags & ~LF_LOCKNOEXPAND_MASK)
+			GOTO(out, rc = -EINVAL);
+		return 0;
+	case LU_LADVISE_LOCKAHEAD:
+		if (!(ll_i2sbi(inode)->ll_lco.lco_flags &
+		      OBD_CONNECT_LOCK_AHEAD))
+			GOTO(out, rc = -EOPNOTSUPP);
+		if (ladvise->lla_lockahead_mode < MODE_READ_USER ||
+		    ladvise->lla_lockahead_mode >= MODE_MAX_USER)
+			GOTO(out, rc = -EINVAL);
+		/* lock ahead requests are always asynchronous */
+		flags_mask = 0;
+		break;
+	default:
+		GOTO(out, rc = -EINVAL);
+	}
+
+	if (ladvise->lla_peradvice_flags & ~flags_mask)
+		GOTO(out, rc = -EINVAL);
+
+	if (ladvise->lla_start >= ladvise->lla_end)
+		GOTO(out, rc = -EINVAL);
+out:
+	if (rc)
+		CDEBUG(D_VFSTRACE, "%s: invalid advice %u (flags %#x, range "
+		       "[%llu, %llu)) for "DFID": rc = %d\n",
+		       ll_get_fsname(inode->i_sb, NULL, 0), advice,
+		       ladvise->lla_peradvice_flags, ladvise->lla_start,
+		       ladvise->lla_end, PFID(ll_inode2fid(inode)), rc);
+	return rc;
+}
+
 int ll_ioctl_fsgetxattr(struct inode *inode, unsigned int cmd,
 			unsigned long arg)
 {
@@ -2807,6 +2978,7 @@ out:
 		struct obd_client_handle *och = NULL;
 		bool lease_broken;
 		fmode_t fmode;
+		int rc2;
 
 		switch (arg) {
 		case LL_LEASE_WRLCK:
@@ -2843,6 +3015,46 @@ out:
 				fmode = 0;
 
 			RETURN(ll_lease_type_from_fmode(fmode));
+		case LL_LEASE_RESYNC:
+			/* instantiate the stale components of a mirrored
+			 * file, the write lease makes sure nobody else
+			 * has it open while it is resynced */
+			mutex_lock(&lli->lli_och_mutex);
+			if (fd->fd_lease_och != NULL)
+				fmode = fd->fd_lease_och->och_flags;
+			else
+				fmode = 0;
+			mutex_unlock(&lli->lli_och_mutex);
+
+			if (!(fmode & FMODE_WRITE))
+				RETURN(-ENOLCK);
+
+			RETURN(ll_layout_write_intent(inode,
+						      LAYOUT_INTENT_RESYNC,
+						      0, OBD_OBJECT_EOF));
+		case LL_LEASE_RESYNC_DONE:
+			mutex_lock(&lli->lli_och_mutex);
+			if (fd->fd_lease_och != NULL &&
+			    fd->fd_lease_och->och_flags & FMODE_WRITE) {
+				och = fd->fd_lease_och;
+				fd->fd_lease_och = NULL;
+			}
+			mutex_unlock(&lli->lli_och_mutex);
+
+			if (och == NULL)
+				RETURN(-ENOLCK);
+
+			/* clear the stale flags on close of the lease */
+			rc = ll_lease_close_intent(och, inode, &lease_broken,
+						   MDS_CLOSE_RESYNC_DONE,
+						   NULL);
+			rc2 = ll_lease_och_release(inode, file);
+			if (rc == 0 && lease_broken)
+				rc = -EBUSY;
+			if (rc == 0)
+				rc = rc2;
+
+			RETURN(rc);
 		default:
 			RETURN(-EINVAL);
 		}
@@ -2891,6 +3103,15 @@ out:
 
 		RETURN(ll_lease_type_from_fmode(fmode));
 	}
+	case LL_IOC_FLR_SET_MIRROR: {
+		/* mirror I/O must be direct to not pollute the page cache
+		 * with the data of a stale mirror */
+		if (!(file->f_flags & O_DIRECT))
+			RETURN(-EINVAL);
+
+		fd->fd_designated_mirror = (__u32)arg;
+		RETURN(0);
+	}
 	case LL_IOC_HSM_IMPORT: {
 		struct hsm_user_import *hui;
 
@@ -2920,6 +3141,7 @@ out:
 	}
 	case LL_IOC_LADVISE: {
 		struct llapi_ladvise_hdr *ladvise_hdr;
+		bool lockahead = false;
 		int i;
 		int num_advise;
 		int alloc_size = sizeof(*ladvise_hdr);
@@ -2958,16 +3180,73 @@ out:
 			GOTO(out_ladvise, rc = -EFAULT);
 
 		for (i = 0; i < num_advise; i++) {
-			rc = ll_ladvise(inode, file, ladvise_hdr->lah_flags,
-					&ladvise_hdr->lah_advise[i]);
+			rc = ll_ladvise_sanity(inode,
+					       &ladvise_hdr->lah_advise[i]);
+			if (rc)
+				GOTO(out_ladvise, rc);
+		}
+
+		for (i = 0; i < num_advise; i++) {
+			struct llapi_lu_ladvise *llia;
+
+			llia = &ladvise_hdr->lah_advise[i];
+			switch (llia->lla_advice) {
+			case LU_LADVISE_LOCKNOEXPAND:
+				fd->fd_lock_no_expand =
+					!(llia->lla_peradvice_flags & LF_UNSET);
+				rc = 0;
+				break;
+			case LU_LADVISE_LOCKAHEAD:
+				/* each lock ahead request reports its own
+				 * result, see enum lockahead_results */
+				llia->lla_lockahead_result =
+					ll_file_lock_ahead(file, llia);
+				lockahead = true;
+				rc = 0;
+				break;
+			default:
+				rc = ll_ladvise(inode, file,
+						ladvise_hdr->lah_flags, llia);
+				break;
+			}
 			if (rc)
 				break;
 		}
 
+		if (lockahead &&
+		    copy_to_user((struct llapi_ladvise_hdr __user *)arg,
+				 ladvise_hdr, alloc_size))
+			rc = -EFAULT;
+
 out_ladvise:
 		OBD_FREE(ladvise_hdr, alloc_size);
 		RETURN(rc);
 	}
+	case LL_IOC_PCC_ATTACH:
+		RETURN(pcc_inode_attach(file));
+	case LL_IOC_PCC_DETACH:
+		if (!S_ISREG(inode->i_mode))
+			RETURN(-EINVAL);
+
+		pcc_inode_detach(inode);
+		RETURN(0);
+	case LL_IOC_PCC_STATE: {
+		struct lu_pcc_state	*state;
+		int			 rc;
+
+		OBD_ALLOC_PTR(state);
+		if (state == NULL)
+			RETURN(-ENOMEM);
+
+		rc = pcc_inode_state(inode, state);
+		if (rc == 0 &&
+		    copy_to_user((struct lu_pcc_state __user *)arg, state,
+				 sizeof(*state)))
+			rc = -EFAULT;
+
+		OBD_FREE_PTR(state);
+		RETURN(rc);
+	}
 	case LL_IOC_FSGETXATTR:
 		RETURN(ll_ioctl_fsgetxattr(inode, cmd, arg));
 	case LL_IOC_FSSETXATTR:
@@ -3660,6 +3939,10 @@ static int __ll_inode_revalidate(struct dentry *dentry, __u64 ibits)
 	CDEBUG(D_VFSTRACE, "VFS Op:inode="DFID"(%p),name=%s\n",
 	       PFID(ll_inode2fid(inode)), inode, dentry->d_name.name);
 
+	/* attributes primed from readdir-plus are recent enough */
+	if (ll_rdplus_valid(inode))
+		RETURN(0);
+
         exp = ll_i2mdexp(inode);
 
         /* XXX: Enable OBD_CONNECT_ATTRFID to reduce unnecessary getattr RPC.
@@ -4505,10 +4788,11 @@ int ll_layout_refresh(struct inode *inode, __u32 *gen)
  * \retval 0	on success
  * \retval < 0	error code
  */
-int ll_layout_write_intent(struct inode *inode, __u64 start, __u64 end)
+int ll_layout_write_intent(struct inode *inode, __u32 opc, __u64 start,
+			   __u64 end)
 {
 	struct layout_intent intent = {
-		.li_opc = LAYOUT_INTENT_WRITE,
+		.li_opc = opc,
 		.li_start = start,
 		.li_end = end,
 	};
@@ -93,6 +93,10 @@ int cl_setattr_ost(struct cl_object *obj, const struct iattr *attr,
 	io->u.ci_setattr.sa_attr_flags = attr_flags;
 	io->u.ci_setattr.sa_valid = attr->ia_valid;
 	io->u.ci_setattr.sa_parent_fid = lu_object_fid(&obj->co_lu);
+	/* ftruncate of a mirror bound file descriptor */
+	if (attr->ia_valid & ATTR_FILE)
+		io->ci_designated_mirror =
+			LUSTRE_FPRIVATE(attr->ia_file)->fd_designated_mirror;
 
 again:
         if (cl_io_init(env, io, CIT_SETATTR, io->ci_obj) == 0) {
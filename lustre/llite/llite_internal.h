@@ -132,6 +132,9 @@ struct ll_inode_info {
 	s64				lli_atime;
 	s64				lli_mtime;
 	s64				lli_ctime;
+	/* jiffies until which the attributes primed from readdir-plus are
+	 * trusted without a lock, 0 once the MDT refreshed them */
+	unsigned long			lli_rdplus_expire;
 	spinlock_t			lli_agl_lock;
 
 	/* update atime from MDS no matter if it's older than
@@ -208,6 +211,12 @@ struct ll_inode_info {
 			 * accurate if the file is shared by different jobs.
 			 */
 			char                    lli_jobid[LUSTRE_JOBID_SIZE];
+
+			/* read-only copy in the Persistent Client Cache and
+			 * its generation, increased whenever the layout lock
+			 * is cancelled. Both protected by lli_lock */
+			struct file			*lli_pcc_file;
+			__u32				lli_pcc_gen;
 		};
 	};
 
@@ -338,14 +347,25 @@ enum ra_stat {
         RA_STAT_MAX_IN_FLIGHT,
         RA_STAT_WRONG_GRAB_PAGE,
 	RA_STAT_FAILED_REACH_END,
+	RA_STAT_ASYNC,
 	_NR_RA_STAT,
 };
 
+/* default number of read-ahead windows kept in flight asynchronously */
+#define LL_RA_ASYNC_WINDOWS_DEF		2
+#define LL_RA_ASYNC_WINDOWS_MAX		16
+/* maximum number of async read-ahead threads per filesystem */
+#define LL_RA_ASYNC_THREADS_MAX		8
+
 struct ll_ra_info {
 	atomic_t	ra_cur_pages;
 	unsigned long	ra_max_pages;
 	unsigned long	ra_max_pages_per_file;
 	unsigned long	ra_max_read_ahead_whole_pages;
+	/* windows a sequential reader may have queued to ra_async_sched,
+	 * 0 disables async read-ahead */
+	unsigned int	ra_async_max_windows;
+	struct cfs_wi_sched *ra_async_sched;
 };
 
 /* ra_io_arg will be filled in the beginning of ll_readahead with
@@ -525,6 +545,11 @@ struct ll_sb_info {
 	unsigned int		  ll_sa_running_max;/* max concurrent
 						     * statahead instances */
 	unsigned int		  ll_sa_max;     /* max statahead RPCs */
+	unsigned int		  ll_sa_batch_max;/* max entries stated by
+						   * one batched RPC */
+	unsigned int		  ll_rdplus_max_age;/* seconds readdir-plus
+						     * attributes are trusted,
+						     * 0 to disable */
 	atomic_t		  ll_sa_total;   /* statahead thread started
 						  * count */
 	atomic_t		  ll_sa_wrong;   /* statahead thread stopped for
@@ -541,6 +566,11 @@ struct ll_sb_info {
 
 	/* st_blksize returned by stat(2), when non-zero */
 	unsigned int		  ll_stat_blksize;
+
+	/* directory of the Persistent Client Cache, protected by
+	 * ll_pcc_lock, NULL if disabled */
+	spinlock_t		  ll_pcc_lock;
+	char			 *ll_pcc_root;
 };
 
 /*
@@ -626,6 +656,13 @@ struct ll_readahead_state {
          * stride read-ahead will be enable
          */
         unsigned long   ras_consecutive_stride_requests;
+	/*
+	 * First page not yet handed to the async read-ahead threads, and
+	 * the number of async windows queued or being read for this file.
+	 * Both are reset together with the read-ahead window.
+	 */
+	pgoff_t		ras_async_next;
+	unsigned int	ras_async_inflight;
 };
 
 extern struct kmem_cache *ll_file_data_slab;
@@ -645,6 +682,12 @@ struct ll_file_data {
 	 * true: failure is known, not report again.
 	 * false: unknown failure, should report. */
 	bool fd_write_failed;
+	/* Set by the lock no expand advice: ask servers to not expand the
+	 * extent locks of I/O done through this file descriptor */
+	bool fd_lock_no_expand;
+	/* The mirror of a mirrored file the I/O through this file descriptor
+	 * is bound to, set by LL_IOC_FLR_SET_MIRROR, 0 if not bound. */
+	__u32 fd_designated_mirror;
 	rwlock_t fd_lock; /* protect lcc list */
 	struct list_head fd_lccs; /* list of ll_cl_context */
 };
@@ -796,6 +839,8 @@ int ll_writepage(struct page *page, struct writeback_control *wbc);
 int ll_writepages(struct address_space *, struct writeback_control *wbc);
 int ll_readpage(struct file *file, struct page *page);
 void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras);
+int ll_ra_async_init(struct ll_sb_info *sbi);
+void ll_ra_async_fini(struct ll_sb_info *sbi);
 int vvp_io_write_commit(const struct lu_env *env, struct cl_io *io);
 
 enum lcc_type;
@@ -818,6 +863,7 @@ extern enum ldlm_mode ll_take_md_lock(struct inode *inode, __u64 bits,
 				      enum ldlm_mode mode);
 
 int ll_file_open(struct inode *inode, struct file *file);
+void ll_io_init(struct cl_io *io, struct file *file, enum cl_io_type iot);
 int ll_file_release(struct inode *inode, struct file *file);
 int ll_release_openhandle(struct dentry *, struct lookup_intent *);
 int ll_md_real_close(struct inode *inode, fmode_t fmode);
@@ -881,6 +927,16 @@ int ll_data_version(struct inode *inode, __u64 *data_version, int flags);
 int ll_hsm_release(struct inode *inode);
 int ll_hsm_state_set(struct inode *inode, struct hsm_state_set *hss);
 
+/* llite/pcc.c */
+int pcc_root_set(struct ll_sb_info *sbi, const char *name);
+void pcc_root_show(struct seq_file *m, struct ll_sb_info *sbi);
+void pcc_super_fini(struct ll_sb_info *sbi);
+int pcc_inode_attach(struct file *file);
+void pcc_inode_detach(struct inode *inode);
+int pcc_inode_state(struct inode *inode, struct lu_pcc_state *state);
+ssize_t pcc_file_read_iter(struct kiocb *iocb, struct iov_iter *iter,
+			   bool *cached);
+
 /* llite/dcache.c */
 
 int ll_d_init(struct dentry *de);
@@ -921,6 +977,8 @@ int ll_show_options(struct seq_file *seq, struct dentry *dentry);
 int ll_show_options(struct seq_file *seq, struct vfsmount *vfs);
 #endif
 void ll_dirty_page_discard_warn(struct page *page, int ioret);
+int ll_prep_inode_md(struct inode **inode, struct lustre_md *md,
+		     struct super_block *sb, struct lookup_intent *it);
 int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 		  struct super_block *, struct lookup_intent *);
 int ll_obd_statfs(struct inode *inode, void __user *arg);
@@ -1162,6 +1220,37 @@ void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
 #define LL_SA_RPC_DEF           32
 #define LL_SA_RPC_MAX           512
 
+/* entries of one MDS_BATCH_GETATTR RPC, 0 to send one RPC per entry */
+#define LL_SA_BATCH_DEF		32
+#define LL_SA_BATCH_MAX		MDS_BATCH_GETATTR_MAX
+
+/* readdir-plus attributes are trusted without a lock for at most this long */
+#define LL_RDPLUS_MAX_AGE	60
+
+/**
+ * Return the jiffies until which the readdir-plus attributes carried by dir
+ * \a page may be trusted, 0 if they are too old or the page has none.
+ */
+static inline unsigned long ll_rdplus_expire(struct ll_sb_info *sbi,
+					     struct page *page)
+{
+	unsigned long expire;
+
+	if (sbi->ll_rdplus_max_age == 0 || page_private(page) == 0)
+		return 0;
+
+	expire = page_private(page) + cfs_time_seconds(sbi->ll_rdplus_max_age);
+	return time_before(jiffies, expire) ? expire : 0;
+}
+
+/* attributes of @inode were primed from readdir-plus and are still fresh */
+static inline bool ll_rdplus_valid(struct inode *inode)
+{
+	unsigned long expire = ll_i2info(inode)->lli_rdplus_expire;
+
+	return expire != 0 && time_before(jiffies, expire);
+}
+
 /* XXX: If want to support more concurrent statahead instances,
  *	please consider to decentralize the RPC lists attached
  *	on related import, such as imp_{sending,delayed}_list.
@@ -1211,6 +1300,10 @@ struct ll_statahead_info {
 						      * instantiated */
 	struct list_head	sai_entries;    /* completed entries */
 	struct list_head	sai_agls;	/* AGLs to be sent */
+	unsigned int		sai_batch_max;	/* max entries in sai_batch */
+	unsigned int		sai_batch_count;/* entries in sai_batch */
+	struct md_enqueue_info *sai_batch[LL_SA_BATCH_MAX]; /* entries to be
+						  * stated by one RPC */
 	struct list_head	sai_cache[LL_SA_CACHE_SIZE];
 	spinlock_t		sai_cache_lock[LL_SA_CACHE_SIZE];
 	atomic_t		sai_cache_count; /* entry count in cache */
@@ -1414,7 +1507,8 @@ static inline void d_lustre_revalidate(struct dentry *dentry)
 int ll_layout_conf(struct inode *inode, const struct cl_object_conf *conf);
 int ll_layout_refresh(struct inode *inode, __u32 *gen);
 int ll_layout_restore(struct inode *inode, loff_t start, __u64 length);
-int ll_layout_write_intent(struct inode *inode, __u64 start, __u64 end);
+int ll_layout_write_intent(struct inode *inode, __u32 opc, __u64 start,
+			   __u64 end);
 
 int ll_xattr_init(void);
 void ll_xattr_fini(void);
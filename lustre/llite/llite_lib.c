@@ -83,6 +83,7 @@ static struct ll_sb_info *ll_init_sbi(void)
 	mutex_init(&sbi->ll_lco.lco_lock);
 	spin_lock_init(&sbi->ll_pp_extent_lock);
 	spin_lock_init(&sbi->ll_process_lock);
+	spin_lock_init(&sbi->ll_pcc_lock);
         sbi->ll_rw_stats_on = 0;
 
         si_meminfo(&si);
@@ -100,6 +101,10 @@ static struct ll_sb_info *ll_init_sbi(void)
 					   SBI_DEFAULT_READAHEAD_MAX);
 	sbi->ll_ra_info.ra_max_pages = sbi->ll_ra_info.ra_max_pages_per_file;
 	sbi->ll_ra_info.ra_max_read_ahead_whole_pages = -1;
+	sbi->ll_ra_info.ra_async_max_windows = LL_RA_ASYNC_WINDOWS_DEF;
+	/* fall back to synchronous read-ahead if no thread can be started */
+	if (ll_ra_async_init(sbi) != 0)
+		sbi->ll_ra_info.ra_async_max_windows = 0;
 
         ll_generate_random_uuid(uuid);
         class_uuid_unparse(uuid, &sbi->ll_sb_uuid);
@@ -125,6 +130,7 @@ static struct ll_sb_info *ll_init_sbi(void)
 	/* metadata statahead is enabled by default */
 	sbi->ll_sa_running_max = LL_SA_RUNNING_DEF;
 	sbi->ll_sa_max = LL_SA_RPC_DEF;
+	sbi->ll_sa_batch_max = LL_SA_BATCH_DEF;
 	atomic_set(&sbi->ll_sa_total, 0);
 	atomic_set(&sbi->ll_sa_wrong, 0);
 	atomic_set(&sbi->ll_sa_running, 0);
@@ -153,6 +159,8 @@ static void ll_free_sbi(struct super_block *sb)
 			cl_cache_decref(sbi->ll_cache);
 			sbi->ll_cache = NULL;
 		}
+		pcc_super_fini(sbi);
+		ll_ra_async_fini(sbi);
 		OBD_FREE(sbi, sizeof(*sbi));
 	}
 	EXIT;
@@ -262,6 +270,11 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 #if defined(HAVE_SECURITY_DENTRY_INIT_SECURITY) && defined(CONFIG_SECURITY)
 	data->ocd_connect_flags2 |= OBD_CONNECT2_FILE_SECCTX;
 #endif /* HAVE_SECURITY_DENTRY_INIT_SECURITY */
+	data->ocd_connect_flags2 |= OBD_CONNECT2_DOM;
+	data->ocd_connect_flags2 |= OBD_CONNECT2_BATCH_GETATTR;
+	data->ocd_connect_flags2 |= OBD_CONNECT2_READDIR_PLUS;
+	data->ocd_connect_flags2 |= OBD_CONNECT2_BATCH_REINT;
+	data->ocd_connect_flags2 |= OBD_CONNECT2_LOCK_CONVERT;
 
 	data->ocd_brw_size = MD_MAX_BRW_SIZE;
 
@@ -399,7 +412,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
 				  OBD_CONNECT_LAYOUTLOCK |
 				  OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK |
-				  OBD_CONNECT_BULK_MBITS;
+				  OBD_CONNECT_BULK_MBITS | OBD_CONNECT_SHORTIO |
+				  OBD_CONNECT_LOCK_AHEAD;
 
 	data->ocd_connect_flags2 = 0;
 
@@ -926,6 +940,8 @@ void ll_lli_init(struct ll_inode_info *lli)
 		INIT_LIST_HEAD(&lli->lli_agl_list);
 		lli->lli_agl_index = 0;
 		lli->lli_async_rc = 0;
+		lli->lli_pcc_file = NULL;
+		lli->lli_pcc_gen = 0;
 	}
 	mutex_init(&lli->lli_layout_mutex);
 	memset(lli->lli_jobid, 0, LUSTRE_JOBID_SIZE);
@@ -1437,6 +1453,9 @@ void ll_clear_inode(struct inode *inode)
 
 	md_null_inode(sbi->ll_md_exp, ll_inode2fid(inode));
 
+	if (S_ISREG(inode->i_mode))
+		pcc_inode_detach(inode);
+
         LASSERT(!lli->lli_open_fd_write_count);
         LASSERT(!lli->lli_open_fd_read_count);
         LASSERT(!lli->lli_open_fd_exec_count);
@@ -1861,6 +1880,10 @@ int ll_update_inode(struct inode *inode, struct lustre_md *md)
 	struct ll_sb_info *sbi = ll_i2sbi(inode);
 	int rc = 0;
 
+	/* attributes from the MDT supersede those primed from readdir-plus,
+	 * see sa_prime() */
+	lli->lli_rdplus_expire = 0;
+
 	if (body->mbo_valid & OBD_MD_FLEASIZE) {
 		rc = cl_file_inode_init(inode, md);
 		if (rc)
@@ -2280,25 +2303,24 @@ void ll_open_cleanup(struct super_block *sb, struct ptlrpc_request *open_req)
 	EXIT;
 }
 
-int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
-		  struct super_block *sb, struct lookup_intent *it)
+/**
+ * Update or create the inode from the attributes unpacked in \a md, which is
+ * left to be freed by the caller.
+ */
+int ll_prep_inode_md(struct inode **inode, struct lustre_md *md,
+		     struct super_block *sb, struct lookup_intent *it)
 {
-	struct ll_sb_info *sbi = NULL;
-	struct lustre_md md = { NULL };
+	struct ll_sb_info *sbi;
 	int rc;
 	ENTRY;
 
 	LASSERT(*inode || sb);
 	sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
-	rc = md_get_lustre_md(sbi->ll_md_exp, req, sbi->ll_dt_exp,
-			      sbi->ll_md_exp, &md);
-	if (rc != 0)
-		GOTO(cleanup, rc);
 
 	if (*inode) {
-		rc = ll_update_inode(*inode, &md);
+		rc = ll_update_inode(*inode, md);
 		if (rc != 0)
-			GOTO(out, rc);
+			RETURN(rc);
 	} else {
 		LASSERT(sb != NULL);
 
@@ -2306,27 +2328,27 @@ int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 		 * At this point server returns to client's same fid as client
 		 * generated for creating. So using ->fid1 is okay here.
 		 */
-		if (!fid_is_sane(&md.body->mbo_fid1)) {
+		if (!fid_is_sane(&md->body->mbo_fid1)) {
 			CERROR("%s: Fid is insane "DFID"\n",
 				ll_get_fsname(sb, NULL, 0),
-				PFID(&md.body->mbo_fid1));
-			GOTO(out, rc = -EINVAL);
+				PFID(&md->body->mbo_fid1));
+			RETURN(-EINVAL);
 		}
 
-		*inode = ll_iget(sb, cl_fid_build_ino(&md.body->mbo_fid1,
+		*inode = ll_iget(sb, cl_fid_build_ino(&md->body->mbo_fid1,
 					     sbi->ll_flags & LL_SBI_32BIT_API),
-				 &md);
+				 md);
 		if (IS_ERR(*inode)) {
 #ifdef CONFIG_FS_POSIX_ACL
-                        if (md.posix_acl) {
-                                posix_acl_release(md.posix_acl);
-                                md.posix_acl = NULL;
+                        if (md->posix_acl) {
+                                posix_acl_release(md->posix_acl);
+                                md->posix_acl = NULL;
                         }
 #endif
                         rc = IS_ERR(*inode) ? PTR_ERR(*inode) : -ENOMEM;
                         *inode = NULL;
                         CERROR("new_inode -fatal: rc %d\n", rc);
-                        GOTO(out, rc);
+                        RETURN(rc);
                 }
         }
 
@@ -2352,15 +2374,31 @@ int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 			conf.coc_opc = OBJECT_CONF_SET;
 			conf.coc_inode = *inode;
 			conf.coc_lock = lock;
-			conf.u.coc_layout = md.layout;
+			conf.u.coc_layout = md->layout;
 			(void)ll_layout_conf(*inode, &conf);
 		}
 		LDLM_LOCK_PUT(lock);
 	}
 
-	GOTO(out, rc = 0);
+	RETURN(0);
+}
+
+int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
+		  struct super_block *sb, struct lookup_intent *it)
+{
+	struct ll_sb_info *sbi = NULL;
+	struct lustre_md md = { NULL };
+	int rc;
+	ENTRY;
 
-out:
+	LASSERT(*inode || sb);
+	sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
+	rc = md_get_lustre_md(sbi->ll_md_exp, req, sbi->ll_dt_exp,
+			      sbi->ll_md_exp, &md);
+	if (rc != 0)
+		GOTO(cleanup, rc);
+
+	rc = ll_prep_inode_md(inode, &md, sb, it);
 	md_free_lustre_md(sbi->ll_md_exp, &md);
 
 cleanup:
@@ -423,6 +423,45 @@ ll_max_read_ahead_whole_mb_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ll_max_read_ahead_whole_mb);
 
+static int ll_read_ahead_async_windows_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "%u\n", sbi->ll_ra_info.ra_async_max_windows);
+	return 0;
+}
+
+static ssize_t
+ll_read_ahead_async_windows_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LL_RA_ASYNC_WINDOWS_MAX)
+		return -ERANGE;
+
+	/* no async read-ahead thread could be started at mount */
+	if (val > 0 && sbi->ll_ra_info.ra_async_sched == NULL)
+		return -ENODEV;
+
+	spin_lock(&sbi->ll_lock);
+	sbi->ll_ra_info.ra_async_max_windows = val;
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ll_read_ahead_async_windows);
+
 static int ll_max_cached_mb_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block     *sb    = m->private;
@@ -741,6 +780,76 @@ static ssize_t ll_statahead_max_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ll_statahead_max);
 
+static int ll_statahead_batch_max_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "%u\n", sbi->ll_sa_batch_max);
+	return 0;
+}
+
+static ssize_t ll_statahead_batch_max_seq_write(struct file *file,
+						const char __user *buffer,
+						size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LL_SA_BATCH_MAX) {
+		CERROR("%s: bad statahead_batch_max value %lld. Valid values "
+		       "are in the range [0, %u]\n", ll_get_fsname(sb, NULL, 0),
+		       val, LL_SA_BATCH_MAX);
+		return -ERANGE;
+	}
+
+	sbi->ll_sa_batch_max = val;
+	return count;
+}
+LPROC_SEQ_FOPS(ll_statahead_batch_max);
+
+static int ll_readdir_plus_max_age_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "%u\n", sbi->ll_rdplus_max_age);
+	return 0;
+}
+
+static ssize_t ll_readdir_plus_max_age_seq_write(struct file *file,
+						 const char __user *buffer,
+						 size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LL_RDPLUS_MAX_AGE) {
+		CERROR("%s: bad readdir_plus_max_age value %lld. Valid values "
+		       "are in the range [0, %u]\n", ll_get_fsname(sb, NULL, 0),
+		       val, LL_RDPLUS_MAX_AGE);
+		return -ERANGE;
+	}
+
+	sbi->ll_rdplus_max_age = val;
+	return count;
+}
+LPROC_SEQ_FOPS(ll_readdir_plus_max_age);
+
 static int ll_statahead_agl_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block *sb = m->private;
@@ -1114,6 +1223,40 @@ static ssize_t ll_nosquash_nids_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ll_nosquash_nids);
 
+static int ll_pcc_root_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+
+	pcc_root_show(m, ll_s2sbi(sb));
+	return 0;
+}
+
+static ssize_t ll_pcc_root_seq_write(struct file *file,
+				     const char __user *buffer,
+				     size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	char *kernbuf;
+	int rc;
+
+	if (count >= PATH_MAX)
+		return -EINVAL;
+
+	OBD_ALLOC(kernbuf, count + 1);
+	if (kernbuf == NULL)
+		return -ENOMEM;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		GOTO(out, rc = -EFAULT);
+
+	rc = pcc_root_set(ll_s2sbi(sb), kernbuf);
+out:
+	OBD_FREE(kernbuf, count + 1);
+	return rc < 0 ? rc : count;
+}
+LPROC_SEQ_FOPS(ll_pcc_root);
+
 struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	{ .name	=	"uuid",
 	  .fops	=	&ll_sb_uuid_fops			},
@@ -1143,6 +1286,8 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops	=	&ll_max_readahead_per_file_mb_fops	},
 	{ .name	=	"max_read_ahead_whole_mb",
 	  .fops	=	&ll_max_read_ahead_whole_mb_fops	},
+	{ .name	=	"read_ahead_async_windows",
+	  .fops	=	&ll_read_ahead_async_windows_fops	},
 	{ .name	=	"max_cached_mb",
 	  .fops	=	&ll_max_cached_mb_fops			},
 	{ .name	=	"checksum_pages",
@@ -1155,6 +1300,10 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops	=	&ll_track_gid_fops			},
 	{ .name	=	"statahead_max",
 	  .fops	=	&ll_statahead_max_fops			},
+	{ .name	=	"statahead_batch_max",
+	  .fops	=	&ll_statahead_batch_max_fops		},
+	{ .name	=	"readdir_plus_max_age",
+	  .fops	=	&ll_readdir_plus_max_age_fops		},
 	{ .name	=	"statahead_running_max",
 	  .fops	=	&ll_statahead_running_max_fops		},
 	{ .name	=	"statahead_agl",
@@ -1181,6 +1330,8 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops =	&ll_fast_read_fops,			},
 	{ .name =	"pio",
 	  .fops =	&ll_pio_fops,				},
+	{ .name =	"pcc_root",
+	  .fops =	&ll_pcc_root_fops,			},
 	{ NULL }
 };
 
@@ -1268,7 +1419,8 @@ static const char *ra_stat_string[] = {
 	[RA_STAT_EOF] = "read-ahead to EOF",
 	[RA_STAT_MAX_IN_FLIGHT] = "hit max r-a issue",
 	[RA_STAT_WRONG_GRAB_PAGE] = "wrong page from grab_cache_page",
-	[RA_STAT_FAILED_REACH_END] = "failed to reach end"
+	[RA_STAT_FAILED_REACH_END] = "failed to reach end",
+	[RA_STAT_ASYNC] = "async readahead",
 };
 
 LPROC_SEQ_FOPS_RO_TYPE(llite, name);
@@ -191,6 +191,12 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 
 	switch (flag) {
 	case LDLM_CB_BLOCKING:
+		/* keep the lock if the server conflicts with some bits only */
+		if (lock->l_policy_data.l_inodebits.cancel_bits != 0 &&
+		    ldlm_cli_dropbits(lock,
+			lock->l_policy_data.l_inodebits.cancel_bits) == 0)
+			break;
+
 		ldlm_lock2handle(lock, &lockh);
 		rc = ldlm_cli_cancel(&lockh, LCF_ASYNC);
 		if (rc < 0) {
@@ -202,6 +208,10 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 		struct inode *inode = ll_inode_from_resource_lock(lock);
 		__u64 bits = lock->l_policy_data.l_inodebits.bits;
 
+		/* only the dropped bits are given on a lock convert */
+		if (desc != NULL && ldlm_is_converting(lock))
+			bits = desc->l_policy_data.l_inodebits.bits;
+
 		/* Inode is set to lock->l_resource->lr_lvb_inode
 		 * for mdc - bug 24555 */
 		LASSERT(lock->l_ast_data == NULL);
@@ -210,7 +220,7 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 			break;
 
 		/* Invalidate all dentries associated with this inode */
-		LASSERT(ldlm_is_canceling(lock));
+		LASSERT(ldlm_is_canceling(lock) || ldlm_is_converting(lock));
 
 		if (!fid_res_name_eq(ll_inode2fid(inode),
 				     &lock->l_resource->lr_name)) {
@@ -269,6 +279,10 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 				CDEBUG(D_INODE, "cannot invalidate layout of "
 				       DFID": rc = %d\n",
 				       PFID(ll_inode2fid(inode)), rc);
+
+			/* the file may be written, drop the local copy */
+			if (S_ISREG(inode->i_mode))
+				pcc_inode_detach(inode);
 		}
 
 		if (bits & MDS_INODELOCK_UPDATE) {
@@ -0,0 +1,454 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2017, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Read-only Persistent Client Cache (PCC).
+ *
+ * A file can be attached to a local file system of the client (typically
+ * a NVMe device mounted under llite.*.pcc_root), its data is then copied
+ * into "<pcc_root>/<FID>" and the subsequent reads on this client are
+ * served from the local copy, without any RPC or LDLM lock.
+ *
+ * Coherency relies on the layout lock: the attach sets HS_PCCRO on the
+ * file, and the MDT revokes all layout locks of a file having this flag
+ * when it is opened for write or truncated, see mdt_pcc_revoke(). The
+ * local copy is dropped together with the layout lock in
+ * ll_md_blocking_ast(), so the next reads go to the OSTs again.
+ *
+ * The local copy is created and filled by the kernel with root
+ * credentials so that users cannot tamper with the cached data.
+ */
+
+#define DEBUG_SUBSYSTEM S_LLITE
+
+#include <linux/cred.h>
+#include <linux/file.h>
+#include <linux/fs.h>
+#include <linux/namei.h>
+#include <linux/uaccess.h>
+
+#include "llite_internal.h"
+
+/* size of the buffer used to copy the data into the local file system */
+#define PCC_COPY_BUFSIZE	(1 << 20)
+
+/**
+ * Set the directory holding the local copies.
+ *
+ * \param[in] sbi	super block info
+ * \param[in] name	absolute path of a directory, "none" or an empty
+ *			string to disable PCC
+ *
+ * \retval 0 on success
+ * \retval negative errno on failure
+ */
+int pcc_root_set(struct ll_sb_info *sbi, const char *name)
+{
+	struct path path;
+	char *root = NULL;
+	char *old;
+	int len = strlen(name);
+	int rc;
+	ENTRY;
+
+	if (len > 0 && name[len - 1] == '\n')
+		len--;
+
+	if (len > 0 && !(len == 4 && strncmp(name, "none", 4) == 0)) {
+		/* keep room for "/<FID>" */
+		if (name[0] != '/' || len >= PATH_MAX - FID_LEN)
+			RETURN(-EINVAL);
+
+		OBD_ALLOC(root, len + 1);
+		if (root == NULL)
+			RETURN(-ENOMEM);
+		memcpy(root, name, len);
+
+		rc = kern_path(root, LOOKUP_FOLLOW | LOOKUP_DIRECTORY, &path);
+		if (rc < 0) {
+			OBD_FREE(root, len + 1);
+			RETURN(rc);
+		}
+		path_put(&path);
+	}
+
+	spin_lock(&sbi->ll_pcc_lock);
+	old = sbi->ll_pcc_root;
+	sbi->ll_pcc_root = root;
+	spin_unlock(&sbi->ll_pcc_lock);
+
+	if (old != NULL)
+		OBD_FREE(old, strlen(old) + 1);
+
+	RETURN(0);
+}
+
+/**
+ * Print the directory holding the local copies, or "none".
+ */
+void pcc_root_show(struct seq_file *m, struct ll_sb_info *sbi)
+{
+	spin_lock(&sbi->ll_pcc_lock);
+	seq_printf(m, "%s\n", sbi->ll_pcc_root != NULL ?
+		   sbi->ll_pcc_root : "none");
+	spin_unlock(&sbi->ll_pcc_lock);
+}
+
+void pcc_super_fini(struct ll_sb_info *sbi)
+{
+	pcc_root_set(sbi, "none");
+}
+
+/* Build the path of the local copy of \a fid in \a buf of PATH_MAX bytes */
+static int pcc_file_name(struct ll_sb_info *sbi, const struct lu_fid *fid,
+			 char *buf)
+{
+	int rc = -EOPNOTSUPP;
+
+	spin_lock(&sbi->ll_pcc_lock);
+	if (sbi->ll_pcc_root != NULL) {
+		snprintf(buf, PATH_MAX, "%s/"DFID_NOBRACE, sbi->ll_pcc_root,
+			 PFID(fid));
+		rc = 0;
+	}
+	spin_unlock(&sbi->ll_pcc_lock);
+
+	return rc;
+}
+
+static int pcc_hsm_flags_get(struct inode *inode, __u32 *flags)
+{
+	struct hsm_user_state	*hus;
+	struct md_op_data	*op_data;
+	int			 rc;
+
+	OBD_ALLOC_PTR(hus);
+	if (hus == NULL)
+		return -ENOMEM;
+
+	op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, hus);
+	if (IS_ERR(op_data)) {
+		OBD_FREE_PTR(hus);
+		return PTR_ERR(op_data);
+	}
+
+	rc = obd_iocontrol(LL_IOC_HSM_STATE_GET, ll_i2mdexp(inode),
+			   sizeof(*op_data), op_data, NULL);
+	if (rc == 0)
+		*flags = hus->hus_states;
+
+	ll_finish_md_op_data(op_data);
+	OBD_FREE_PTR(hus);
+
+	return rc;
+}
+
+static int pcc_copy_data(struct file *src, struct file *dst)
+{
+	mm_segment_t	 oldfs;
+	loff_t		 rpos = 0;
+	loff_t		 wpos = 0;
+	ssize_t		 count;
+	ssize_t		 written;
+	char		*buf;
+	int		 rc = 0;
+	ENTRY;
+
+	OBD_ALLOC_LARGE(buf, PCC_COPY_BUFSIZE);
+	if (buf == NULL)
+		RETURN(-ENOMEM);
+
+	oldfs = get_fs();
+	set_fs(KERNEL_DS);
+	while (1) {
+		count = vfs_read(src, (char __user *)buf, PCC_COPY_BUFSIZE,
+				 &rpos);
+		if (count <= 0) {
+			rc = count;
+			break;
+		}
+
+		written = 0;
+		while (written < count) {
+			ssize_t rc2;
+
+			rc2 = vfs_write(dst, (char __user *)buf + written,
+					count - written, &wpos);
+			if (rc2 <= 0) {
+				rc = rc2 < 0 ? rc2 : -EIO;
+				break;
+			}
+			written += rc2;
+		}
+		if (rc < 0)
+			break;
+	}
+	set_fs(oldfs);
+
+	OBD_FREE_LARGE(buf, PCC_COPY_BUFSIZE);
+
+	RETURN(rc);
+}
+
+/**
+ * Copy the data of an opened file into the local cache and serve the
+ * subsequent reads of this client from the copy.
+ *
+ * \param[in] file	Lustre file opened for read
+ *
+ * \retval 0 on success
+ * \retval -EBUSY if the file is opened for write
+ * \retval -EAGAIN if the file was modified during the copy
+ * \retval negative errno on other failures
+ */
+int pcc_inode_attach(struct file *file)
+{
+	struct inode		*inode = file_inode(file);
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct hsm_state_set	*hss;
+	struct file		*pcc_file = NULL;
+	const struct cred	*old_cred;
+	struct cred		*cred;
+	char			*name;
+	__u64			 dv1;
+	__u64			 dv2;
+	__u32			 pcc_gen;
+	__u32			 gen;
+	__u32			 flags;
+	int			 rc;
+	ENTRY;
+
+	if (!S_ISREG(inode->i_mode))
+		RETURN(-EINVAL);
+
+	if (!(file->f_mode & FMODE_READ))
+		RETURN(-EBADF);
+
+	/* the local copy is invalidated with the layout lock */
+	if (!(sbi->ll_flags & LL_SBI_LAYOUT_LOCK))
+		RETURN(-EOPNOTSUPP);
+
+	OBD_ALLOC(name, PATH_MAX);
+	if (name == NULL)
+		RETURN(-ENOMEM);
+
+	rc = pcc_file_name(sbi, ll_inode2fid(inode), name);
+	if (rc < 0)
+		GOTO(out_name, rc);
+
+	spin_lock(&lli->lli_lock);
+	if (lli->lli_pcc_file != NULL)
+		rc = -EALREADY;
+	pcc_gen = lli->lli_pcc_gen;
+	spin_unlock(&lli->lli_lock);
+	if (rc < 0)
+		GOTO(out_name, rc);
+
+	/* from now on, any writer revokes the layout lock */
+	OBD_ALLOC_PTR(hss);
+	if (hss == NULL)
+		GOTO(out_name, rc = -ENOMEM);
+
+	hss->hss_valid = HSS_SETMASK;
+	hss->hss_setmask = HS_PCCRO;
+	rc = ll_hsm_state_set(inode, hss);
+	OBD_FREE_PTR(hss);
+	if (rc < 0)
+		GOTO(out_name, rc);
+
+	rc = ll_layout_refresh(inode, &gen);
+	if (rc < 0)
+		GOTO(out_name, rc);
+
+	rc = ll_data_version(inode, &dv1, LL_DV_RD_FLUSH);
+	if (rc < 0)
+		GOTO(out_name, rc);
+
+	cred = prepare_kernel_cred(NULL);
+	if (cred == NULL)
+		GOTO(out_name, rc = -ENOMEM);
+
+	old_cred = override_creds(cred);
+	pcc_file = filp_open(name, O_RDWR | O_CREAT | O_TRUNC | O_LARGEFILE,
+			     0600);
+	if (IS_ERR(pcc_file)) {
+		rc = PTR_ERR(pcc_file);
+		pcc_file = NULL;
+	} else {
+		rc = pcc_copy_data(file, pcc_file);
+	}
+	revert_creds(old_cred);
+	put_cred(cred);
+	if (rc < 0)
+		GOTO(out_file, rc);
+
+	/* the copy is only valid if nobody has written the file meanwhile */
+	rc = pcc_hsm_flags_get(inode, &flags);
+	if (rc < 0)
+		GOTO(out_file, rc);
+
+	if (!(flags & HS_PCCRO))
+		GOTO(out_file, rc = -EAGAIN);
+
+	rc = ll_data_version(inode, &dv2, LL_DV_RD_FLUSH);
+	if (rc < 0)
+		GOTO(out_file, rc);
+
+	if (dv1 != dv2)
+		GOTO(out_file, rc = -EAGAIN);
+
+	/* lli_pcc_gen changes if the layout lock was cancelled */
+	spin_lock(&lli->lli_lock);
+	if (lli->lli_pcc_file != NULL) {
+		rc = -EALREADY;
+	} else if (lli->lli_pcc_gen != pcc_gen) {
+		rc = -EAGAIN;
+	} else {
+		lli->lli_pcc_file = pcc_file;
+		pcc_file = NULL;
+	}
+	spin_unlock(&lli->lli_lock);
+
+	CDEBUG(D_INODE, "%s: attach "DFID" to %s, layout gen %u: rc = %d\n",
+	       ll_get_fsname(inode->i_sb, NULL, 0), PFID(ll_inode2fid(inode)),
+	       name, gen, rc);
+
+	EXIT;
+out_file:
+	if (pcc_file != NULL)
+		filp_close(pcc_file, NULL);
+out_name:
+	OBD_FREE(name, PATH_MAX);
+
+	return rc;
+}
+
+/**
+ * Stop serving the reads of \a inode from the local copy.
+ *
+ * The local file is kept, it is overwritten by the next attach.
+ */
+void pcc_inode_detach(struct inode *inode)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct file		*pcc_file;
+
+	spin_lock(&lli->lli_lock);
+	pcc_file = lli->lli_pcc_file;
+	lli->lli_pcc_file = NULL;
+	lli->lli_pcc_gen++;
+	spin_unlock(&lli->lli_lock);
+
+	if (pcc_file != NULL) {
+		CDEBUG(D_INODE, "detach "DFID" from PCC\n",
+		       PFID(ll_inode2fid(inode)));
+		filp_close(pcc_file, NULL);
+	}
+}
+
+static struct file *pcc_file_get(struct ll_inode_info *lli)
+{
+	struct file *pcc_file;
+
+	spin_lock(&lli->lli_lock);
+	pcc_file = lli->lli_pcc_file;
+	if (pcc_file != NULL)
+		get_file(pcc_file);
+	spin_unlock(&lli->lli_lock);
+
+	return pcc_file;
+}
+
+int pcc_inode_state(struct inode *inode, struct lu_pcc_state *state)
+{
+	struct file	*pcc_file;
+	char		*path;
+	int		 rc = 0;
+
+	memset(state, 0, sizeof(*state));
+	if (!S_ISREG(inode->i_mode))
+		return 0;
+
+	pcc_file = pcc_file_get(ll_i2info(inode));
+	if (pcc_file == NULL)
+		return 0;
+
+	state->pccs_state = PCC_STATE_READONLY;
+	path = d_path(&pcc_file->f_path, state->pccs_path,
+		      sizeof(state->pccs_path));
+	if (IS_ERR(path))
+		rc = PTR_ERR(path);
+	else
+		memmove(state->pccs_path, path, strlen(path) + 1);
+	fput(pcc_file);
+
+	return rc;
+}
+
+/**
+ * Read the data from the local copy, if any.
+ *
+ * \param[in] iocb	kernel I/O control block of the Lustre file
+ * \param[in] iter	destination buffers
+ * \param[out] cached	set if the read was served by the local copy
+ *
+ * \retval number of bytes read, or negative errno if \a cached is set
+ */
+ssize_t pcc_file_read_iter(struct kiocb *iocb, struct iov_iter *iter,
+			   bool *cached)
+{
+#ifdef HAVE_FILE_OPERATIONS_READ_WRITE_ITER
+	struct inode		*inode = file_inode(iocb->ki_filp);
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct file		*pcc_file;
+	struct kiocb		 kiocb;
+	ssize_t			 result;
+
+	*cached = false;
+	if (!S_ISREG(inode->i_mode) || lli->lli_pcc_file == NULL ||
+	    !is_sync_kiocb(iocb))
+		return 0;
+
+	pcc_file = pcc_file_get(lli);
+	if (pcc_file == NULL)
+		return 0;
+
+	init_sync_kiocb(&kiocb, pcc_file);
+	kiocb.ki_pos = iocb->ki_pos;
+	result = pcc_file->f_op->read_iter(&kiocb, iter);
+	if (result > 0)
+		iocb->ki_pos = kiocb.ki_pos;
+	fput(pcc_file);
+
+	*cached = true;
+	return result;
+#else
+	*cached = false;
+	return 0;
+#endif
+}
@@ -367,13 +367,16 @@ ll_read_ahead_pages(const struct lu_env *env, struct cl_io *io,
 				LASSERTF(ra.cra_end >= page_idx,
 					 "object: %p, indcies %lu / %lu\n",
 					 io->ci_obj, ra.cra_end, page_idx);
-				/* update read ahead RPC size.
-				 * NB: it's racy but doesn't matter */
+				/* update read ahead RPC size, under ras_lock
+				 * as the async read-ahead threads and the
+				 * reader may do this concurrently */
+				spin_lock(&ras->ras_lock);
 				if (ras->ras_rpc_size > ra.cra_rpc_size &&
 				    ra.cra_rpc_size > 0)
 					ras->ras_rpc_size = ra.cra_rpc_size;
 				/* trim it to align with optimal RPC size */
 				end = ras_align(ras, ria->ria_end + 1, NULL);
+				spin_unlock(&ras->ras_lock);
 				if (end > 0 && !ria->ria_eof)
 					ria->ria_end = end - 1;
 				if (ria->ria_end < ria->ria_end_min)
@@ -526,8 +529,10 @@ static int ll_readahead(const struct lu_env *env, struct cl_io *io,
 		/* to the end of current read window. */
 		mlen = vio->vui_ra_start + vio->vui_ra_count - ria->ria_start;
 		/* trim to RPC boundary */
+		spin_lock(&ras->ras_lock);
 		ras_align(ras, ria->ria_start, &remainder);
 		mlen = min(mlen, ras->ras_rpc_size - remainder);
+		spin_unlock(&ras->ras_lock);
 		ria->ria_end_min = ria->ria_start + mlen;
 	}
 
@@ -565,6 +570,215 @@ static int ll_readahead(const struct lu_env *env, struct cl_io *io,
 	RETURN(ret);
 }
 
+/**
+ * Read-ahead of one window handed to the async read-ahead threads of the
+ * filesystem by ll_readahead_async(). The file reference pins both the
+ * read-ahead state and the superblock until the window has been issued.
+ */
+struct ll_readahead_work {
+	struct cfs_workitem	 lrw_wi;
+	struct file		*lrw_file;
+	pgoff_t			 lrw_start;
+	pgoff_t			 lrw_end;
+	bool			 lrw_eof;
+};
+
+static int ll_readahead_work_handler(struct cfs_workitem *wi)
+{
+	struct ll_readahead_work *lrw = wi->wi_data;
+	struct file *file = lrw->lrw_file;
+	struct inode *inode = file_inode(file);
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ll_file_data *fd = LUSTRE_FPRIVATE(file);
+	struct ll_readahead_state *ras = &fd->fd_ras;
+	unsigned long len = lrw->lrw_end - lrw->lrw_start + 1;
+	struct ra_io_arg *ria;
+	struct cl_2queue *queue;
+	struct vvp_io *vio;
+	struct lu_env *env;
+	struct cl_io *io;
+	pgoff_t ra_end = 0;
+	int count = 0;
+	int rc;
+	__u16 refcheck;
+	ENTRY;
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		GOTO(out, rc = PTR_ERR(env));
+
+	io = vvp_env_thread_io(env);
+	ll_io_init(io, file, CIT_READ);
+	io->ci_pio = 0;
+	rc = cl_io_rw_init(env, io, CIT_READ,
+			   (loff_t)lrw->lrw_start << PAGE_SHIFT,
+			   (size_t)len << PAGE_SHIFT);
+	if (rc != 0)
+		GOTO(out_fini, rc);
+
+	vio = vvp_env_io(env);
+	vio->vui_fd = fd;
+	vio->vui_io_subtype = IO_NORMAL;
+
+	/* take the DLM locks covering the window like a read of it would,
+	 * so that cl_io_read_ahead() does not stop at the first page not
+	 * yet covered by a lock of the reader */
+	rc = cl_io_iter_init(env, io);
+	if (rc == 0)
+		rc = cl_io_lock(env, io);
+	if (rc != 0)
+		GOTO(out_iter, rc);
+
+	ria = &ll_env_info(env)->lti_ria;
+	memset(ria, 0, sizeof(*ria));
+	ria->ria_start = lrw->lrw_start;
+	ria->ria_end = lrw->lrw_end;
+	ria->ria_eof = lrw->lrw_eof;
+	ria->ria_reserved = ll_ra_count_get(sbi, ria, len, 0);
+	if (ria->ria_reserved < len)
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_MAX_IN_FLIGHT);
+
+	queue = &io->ci_queue;
+	cl_2queue_init(queue);
+	count = ll_read_ahead_pages(env, io, &queue->c2_qin, ras, ria, &ra_end);
+	if (ria->ria_reserved != 0)
+		ll_ra_count_put(sbi, ria->ria_reserved);
+
+	if (queue->c2_qin.pl_nr > 0) {
+		int nr = queue->c2_qin.pl_nr;
+
+		rc = cl_io_submit_rw(env, io, CRT_READ, queue);
+		if (rc == 0)
+			task_io_account_read(PAGE_SIZE * nr);
+	}
+	cl_page_list_disown(env, io, &queue->c2_qin);
+	cl_2queue_fini(env, queue);
+	cl_io_unlock(env, io);
+
+	if (count > 0)
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_ASYNC);
+	if (ra_end != lrw->lrw_end)
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_FAILED_REACH_END);
+out_iter:
+	cl_io_iter_fini(env, io);
+out_fini:
+	cl_io_fini(env, io);
+	cl_env_put(env, &refcheck);
+out:
+	CDEBUG(D_READA, DFID": async read-ahead [%lu, %lu]: %d pages, "
+	       "rc = %d\n", PFID(ll_inode2fid(inode)), lrw->lrw_start,
+	       lrw->lrw_end, count, rc);
+
+	spin_lock(&ras->ras_lock);
+	LASSERT(ras->ras_async_inflight > 0);
+	ras->ras_async_inflight--;
+	spin_unlock(&ras->ras_lock);
+
+	cfs_wi_exit(sbi->ll_ra_info.ra_async_sched, wi);
+	fput(file);
+	OBD_FREE_PTR(lrw);
+
+	/* the workitem is freed, the scheduler must not touch it again */
+	RETURN(1);
+}
+
+/**
+ * Keep up to ll_ra_info::ra_async_max_windows read-ahead windows in flight
+ * ahead of a sequential reader.
+ *
+ * Once ras_update() has confirmed a sequential stream and grown its window,
+ * the windows following the current one are handed to the async read-ahead
+ * threads instead of being read by the next read(2) that reaches them.
+ * Stride and mmap access keep using the synchronous ll_readahead() only.
+ */
+static void ll_readahead_async(const struct lu_env *env, struct cl_io *io,
+			       struct file *file,
+			       struct ll_readahead_state *ras)
+{
+	struct inode *inode = file_inode(file);
+	struct ll_ra_info *ra = &ll_i2sbi(inode)->ll_ra_info;
+	struct cl_attr *attr = vvp_env_thread_attr(env);
+	struct cl_object *clob = io->ci_obj;
+	struct ll_readahead_work *lrw;
+	pgoff_t start, end, end_index, limit;
+	int rc;
+	ENTRY;
+
+	if (ra->ra_async_sched == NULL || ra->ra_async_max_windows == 0)
+		RETURN_EXIT;
+
+	cl_object_attr_lock(clob);
+	rc = cl_object_attr_get(env, clob, attr);
+	cl_object_attr_unlock(clob);
+	if (rc != 0 || attr->cat_kms == 0)
+		RETURN_EXIT;
+	end_index = (attr->cat_kms - 1) >> PAGE_SHIFT;
+
+	while (1) {
+		spin_lock(&ras->ras_lock);
+		if (stride_io_mode(ras) || ras->ras_consecutive_requests < 2 ||
+		    ras->ras_window_len < ras->ras_rpc_size ||
+		    ras->ras_async_inflight >= ra->ra_async_max_windows) {
+			spin_unlock(&ras->ras_lock);
+			break;
+		}
+
+		/* never run more than ra_async_max_windows windows past the
+		 * end of the current one */
+		start = ras->ras_window_start + ras->ras_window_len;
+		limit = start + ras->ras_window_len * ra->ra_async_max_windows;
+		start = max3(start, ras->ras_next_readahead,
+			     ras->ras_async_next);
+		if (start > end_index || start >= limit) {
+			spin_unlock(&ras->ras_lock);
+			break;
+		}
+		end = min(start + ras->ras_window_len - 1, end_index);
+		ras->ras_async_next = end + 1;
+		ras->ras_async_inflight++;
+		spin_unlock(&ras->ras_lock);
+
+		OBD_ALLOC_PTR(lrw);
+		if (lrw == NULL) {
+			spin_lock(&ras->ras_lock);
+			if (ras->ras_async_next == end + 1)
+				ras->ras_async_next = start;
+			ras->ras_async_inflight--;
+			spin_unlock(&ras->ras_lock);
+			break;
+		}
+
+		lrw->lrw_file = get_file(file);
+		lrw->lrw_start = start;
+		lrw->lrw_end = end;
+		lrw->lrw_eof = end == end_index;
+		cfs_wi_init(&lrw->lrw_wi, lrw, ll_readahead_work_handler);
+		cfs_wi_schedule(ra->ra_async_sched, &lrw->lrw_wi);
+
+		CDEBUG(D_READA, DFID": queued async read-ahead [%lu, %lu]\n",
+		       PFID(ll_inode2fid(inode)), start, end);
+	}
+	EXIT;
+}
+
+int ll_ra_async_init(struct ll_sb_info *sbi)
+{
+	int nthrs = min_t(int, num_online_cpus(), LL_RA_ASYNC_THREADS_MAX);
+
+	return cfs_wi_sched_create("ll_ra", NULL, CFS_CPT_ANY, nthrs,
+				   &sbi->ll_ra_info.ra_async_sched);
+}
+
+void ll_ra_async_fini(struct ll_sb_info *sbi)
+{
+	/* every queued window holds a file reference, so nothing can be
+	 * left on the scheduler once the superblock goes away */
+	if (sbi->ll_ra_info.ra_async_sched != NULL) {
+		cfs_wi_sched_destroy(sbi->ll_ra_info.ra_async_sched);
+		sbi->ll_ra_info.ra_async_sched = NULL;
+	}
+}
+
 static void ras_set_start(struct inode *inode, struct ll_readahead_state *ras,
 			  unsigned long index)
 {
@@ -581,6 +795,7 @@ static void ras_reset(struct inode *inode, struct ll_readahead_state *ras,
 	ras->ras_window_len = 0;
 	ras_set_start(inode, ras, index);
 	ras->ras_next_readahead = max(ras->ras_window_start, index + 1);
+	ras->ras_async_next = 0;
 
 	RAS_CDEBUG(ras);
 }
@@ -600,6 +815,7 @@ void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras)
 	ras->ras_rpc_size = PTLRPC_MAX_BRW_PAGES;
 	ras_reset(inode, ras, 0);
 	ras->ras_requests = 0;
+	ras->ras_async_inflight = 0;
 }
 
 /*
@@ -1120,6 +1336,9 @@ static int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
 				   uptodate);
 		CDEBUG(D_READA, DFID "%d pages read ahead at %lu\n",
 		       PFID(ll_inode2fid(inode)), rc2, vvp_index(vpg));
+
+		if (vvp_env_io(env)->vui_ra_valid)
+			ll_readahead_async(env, io, file, ras);
 	}
 
 	if (queue->c2_qin.pl_nr > 0) {
@@ -346,6 +346,10 @@ sa_make_ready(struct ll_statahead_info *sai, struct sa_entry *entry, int ret)
 	if (minfo) {
 		entry->se_minfo = NULL;
 		ll_intent_release(&minfo->mi_it);
+#ifdef CONFIG_FS_POSIX_ACL
+		if (minfo->mi_md.posix_acl != NULL)
+			posix_acl_release(minfo->mi_md.posix_acl);
+#endif
 		iput(minfo->mi_dir);
 		OBD_FREE_PTR(minfo);
 	}
@@ -407,6 +411,7 @@ static struct ll_statahead_info *ll_sai_alloc(struct dentry *dentry)
 	sai->sai_dentry = dget(dentry);
 	atomic_set(&sai->sai_refcount, 1);
 	sai->sai_max = LL_SA_RPC_MIN;
+	sai->sai_batch_max = ll_i2sbi(dentry->d_inode)->ll_sa_batch_max;
 	sai->sai_index = 1;
 	init_waitqueue_head(&sai->sai_waitq);
 	init_waitqueue_head(&sai->sai_thread.t_ctl_waitq);
@@ -585,7 +590,11 @@ static void sa_instantiate(struct ll_statahead_info *sai,
         minfo = entry->se_minfo;
         it = &minfo->mi_it;
         req = entry->se_req;
-        body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+	/* attributes of a batched entry are already unpacked */
+	if (minfo->mi_md.body != NULL)
+		body = minfo->mi_md.body;
+	else
+		body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
         if (body == NULL)
                 GOTO(out, rc = -EFAULT);
 
@@ -605,7 +614,16 @@ static void sa_instantiate(struct ll_statahead_info *sai,
         if (rc != 1)
                 GOTO(out, rc = -EAGAIN);
 
-        rc = ll_prep_inode(&child, req, dir->i_sb, it);
+	if (minfo->mi_md.body != NULL) {
+		rc = ll_prep_inode_md(&child, &minfo->mi_md, dir->i_sb, it);
+#ifdef CONFIG_FS_POSIX_ACL
+		/* the ACL is now owned by the inode */
+		if (rc == 0)
+			minfo->mi_md.posix_acl = NULL;
+#endif
+	} else {
+		rc = ll_prep_inode(&child, req, dir->i_sb, it);
+	}
         if (rc)
                 GOTO(out, rc);
 
@@ -769,6 +787,64 @@ sa_prep_data(struct inode *dir, struct inode *child, struct sa_entry *entry)
 	return minfo;
 }
 
+/*
+ * send the entries queued in sai_batch by one MDS_BATCH_GETATTR RPC, or one
+ * by one if they can't be batched.
+ */
+static void sa_batch_flush(struct ll_statahead_info *sai)
+{
+	struct inode *dir = sai->sai_dentry->d_inode;
+	unsigned int count = sai->sai_batch_count;
+	unsigned int i;
+	int rc;
+
+	if (count == 0)
+		return;
+
+	sai->sai_batch_count = 0;
+	rc = md_batch_getattr_async(ll_i2mdexp(dir), sai->sai_batch, count);
+	if (rc == 0)
+		return;
+
+	CDEBUG(D_READA, "batch stat of %u entries in "DFID" failed: rc = %d\n",
+	       count, PFID(ll_inode2fid(dir)), rc);
+	/* not supported by the MDT, don't try again */
+	if (rc == -EOPNOTSUPP)
+		sai->sai_batch_max = 0;
+
+	for (i = 0; i < count; i++) {
+		struct md_enqueue_info *minfo = sai->sai_batch[i];
+
+		minfo->mi_data.op_name = NULL;
+		minfo->mi_data.op_namelen = 0;
+		rc = md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+		if (rc < 0)
+			ll_statahead_interpret(NULL, minfo, rc);
+	}
+}
+
+/*
+ * send async stat RPC for \a minfo, or queue it to be sent with the next
+ * entries by sa_batch_flush().
+ */
+static int sa_getattr(struct inode *dir, struct md_enqueue_info *minfo)
+{
+	struct ll_statahead_info *sai = ll_i2info(dir)->lli_sai;
+	struct sa_entry *entry = minfo->mi_cbdata;
+
+	if (sai->sai_batch_max == 0)
+		return md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+
+	/* the batched entries are looked up by name */
+	minfo->mi_data.op_name = entry->se_qstr.name;
+	minfo->mi_data.op_namelen = entry->se_qstr.len;
+	sai->sai_batch[sai->sai_batch_count++] = minfo;
+	if (sai->sai_batch_count >= sai->sai_batch_max)
+		sa_batch_flush(sai);
+
+	return 0;
+}
+
 /* async stat for file not found in dcache */
 static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 {
@@ -780,7 +856,7 @@ static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 	if (IS_ERR(minfo))
 		RETURN(PTR_ERR(minfo));
 
-	rc = md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+	rc = sa_getattr(dir, minfo);
 	if (rc < 0)
 		sa_fini_data(minfo);
 
@@ -826,7 +902,7 @@ static int sa_revalidate(struct inode *dir, struct sa_entry *entry,
 		RETURN(PTR_ERR(minfo));
 	}
 
-	rc = md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+	rc = sa_getattr(dir, minfo);
 	if (rc < 0) {
 		entry->se_inode = NULL;
 		iput(inode);
@@ -836,9 +912,70 @@ static int sa_revalidate(struct inode *dir, struct sa_entry *entry,
 	RETURN(rc);
 }
 
-/* async stat for file with @name */
+/*
+ * instantiate the inode of @entry from the readdir-plus attributes @lat, no
+ * RPC is sent and no lock protects the inode, so its attributes are trusted
+ * until @expire only, see ll_rdplus_valid(). Regular files are not primed:
+ * their size lives on the OSTs and their layout needs the layout lock, so a
+ * getattr is sent for them as usual.
+ */
+static int sa_prime(struct inode *dir, struct sa_entry *entry,
+		    const struct luda_attrs *lat, unsigned long expire)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct lustre_md md = { NULL };
+	struct mdt_body body = { { 0 } };
+	struct inode *child = NULL;
+	struct inode *cached;
+	int rc;
+	ENTRY;
+
+	if (S_ISREG(le32_to_cpu(lat->lat_mode)))
+		RETURN(sa_lookup(dir, entry));
+
+	/* don't overwrite attributes the MDT might have refreshed since */
+	cached = ilookup5_nowait(dir->i_sb,
+				 cl_fid_build_ino(&entry->se_fid,
+					sbi->ll_flags & LL_SBI_32BIT_API),
+				 ll_test_inode_by_fid, &entry->se_fid);
+	if (cached != NULL) {
+		iput(cached);
+		RETURN(sa_lookup(dir, entry));
+	}
+
+	body.mbo_fid1 = entry->se_fid;
+	body.mbo_valid = le64_to_cpu(lat->lat_valid) | OBD_MD_FLID;
+	body.mbo_size = le64_to_cpu(lat->lat_size);
+	body.mbo_blocks = le64_to_cpu(lat->lat_blocks);
+	body.mbo_mtime = le64_to_cpu(lat->lat_mtime);
+	body.mbo_atime = le64_to_cpu(lat->lat_atime);
+	body.mbo_ctime = le64_to_cpu(lat->lat_ctime);
+	body.mbo_mode = le32_to_cpu(lat->lat_mode);
+	body.mbo_nlink = le32_to_cpu(lat->lat_nlink);
+	body.mbo_uid = le32_to_cpu(lat->lat_uid);
+	body.mbo_gid = le32_to_cpu(lat->lat_gid);
+	body.mbo_rdev = le32_to_cpu(lat->lat_rdev);
+	body.mbo_flags = le32_to_cpu(lat->lat_flags);
+	md.body = &body;
+
+	rc = ll_prep_inode_md(&child, &md, dir->i_sb, NULL);
+	if (rc != 0)
+		RETURN(rc);
+
+	ll_i2info(child)->lli_rdplus_expire = expire;
+	entry->se_inode = child;
+
+	CDEBUG(D_READA, "%s: primed %.*s "DFID" from readdir-plus\n",
+	       ll_get_fsname(dir->i_sb, NULL, 0), entry->se_qstr.len,
+	       entry->se_qstr.name, PFID(&entry->se_fid));
+
+	RETURN(1);
+}
+
+/* async stat for file with @name, or prime it from readdir-plus @lat */
 static void sa_statahead(struct dentry *parent, const char *name, int len,
-			 const struct lu_fid *fid)
+			 const struct lu_fid *fid,
+			 const struct luda_attrs *lat, unsigned long expire)
 {
 	struct inode *dir = parent->d_inode;
 	struct ll_inode_info *lli = ll_i2info(dir);
@@ -854,7 +991,10 @@ static void sa_statahead(struct dentry *parent, const char *name, int len,
 
 	dentry = d_lookup(parent, &entry->se_qstr);
 	if (!dentry) {
-		rc = sa_lookup(dir, entry);
+		if (lat != NULL)
+			rc = sa_prime(dir, entry, lat, expire);
+		else
+			rc = sa_lookup(dir, entry);
 	} else {
 		rc = sa_revalidate(dir, entry, dentry);
 		if (rc == 1 && agl_should_run(sai, dentry->d_inode))
@@ -988,6 +1128,7 @@ static int ll_statahead_thread(void *arg)
 	struct ll_dir_chain chain;
 	struct l_wait_info lwi = { 0 };
 	struct page *page = NULL;
+	unsigned long expire;
 	__u64 pos = 0;
 	int rc = 0;
 	ENTRY;
@@ -1035,6 +1176,7 @@ static int ll_statahead_thread(void *arg)
 		}
 
 		dp = page_address(page);
+		expire = ll_rdplus_expire(sbi, page);
 		for (ent = lu_dirent_start(dp);
 		     ent != NULL && thread_is_running(sa_thread) &&
 		     !sa_low_hit(sai);
@@ -1043,6 +1185,7 @@ static int ll_statahead_thread(void *arg)
 			int namelen;
 			char *name;
 			struct lu_fid fid;
+			struct luda_attrs *lat = NULL;
 
 			hash = le64_to_cpu(ent->lde_hash);
 			if (unlikely(hash < pos))
@@ -1086,9 +1229,16 @@ static int ll_statahead_thread(void *arg)
 				continue;
 
 			fid_le_to_cpu(&fid, &ent->lde_fid);
+			if (expire != 0 &&
+			    le32_to_cpu(ent->lde_attrs) & LUDA_ATTRS)
+				lat = lu_dirent_attrs(ent);
 
 			/* wait for spare statahead window */
 			do {
+				/* the window may be full of batched entries */
+				if (sa_sent_full(sai))
+					sa_batch_flush(sai);
+
 				l_wait_event(sa_thread->t_ctl_waitq,
 					     !sa_sent_full(sai) ||
 					     sa_has_callback(sai) ||
@@ -1116,9 +1266,12 @@ static int ll_statahead_thread(void *arg)
 			} while (sa_sent_full(sai) &&
 				 thread_is_running(sa_thread));
 
-			sa_statahead(parent, name, namelen, &fid);
+			sa_statahead(parent, name, namelen, &fid, lat, expire);
 		}
 
+		/* don't keep entries of this page waiting for the next one */
+		sa_batch_flush(sai);
+
 		pos = le64_to_cpu(dp->ldp_hash_end);
 		ll_release_page(dir, page,
 				le32_to_cpu(dp->ldp_flags) & LDF_COLLIDE);
@@ -1478,6 +1631,12 @@ static int revalidate_statahead_dentry(struct inode *dir,
 
 		rc = md_revalidate_lock(ll_i2mdexp(dir), &it,
 					ll_inode2fid(inode), &bits);
+		if (rc != 1 && entry->se_handle == 0 &&
+		    ll_rdplus_valid(inode)) {
+			/* primed from readdir-plus, no lock to match */
+			bits = MDS_INODELOCK_LOOKUP;
+			rc = 1;
+		}
 		if (rc == 1) {
 			if ((*dentryp)->d_inode == NULL) {
 				struct dentry *alias;
@@ -339,6 +339,7 @@ static void vvp_io_fini(const struct lu_env *env, const struct cl_io_slice *ios)
 	 * RPC.
 	 */
 	if (io->ci_need_write_intent) {
+		__u32 opc = LAYOUT_INTENT_WRITE;
 		loff_t start = 0;
 		loff_t end = OBD_OBJECT_EOF;
 
@@ -353,7 +354,11 @@ static void vvp_io_fini(const struct lu_env *env, const struct cl_io_slice *ios)
 				end = start + io->u.ci_rw.rw_range.cir_count;
 			}
 		} else if (cl_io_is_trunc(io)) {
-			end = io->u.ci_setattr.sa_attr.lvb_size;
+			/* the MDT instantiates the components below the new
+			 * size, and marks the data beyond it stale in the
+			 * other mirrors of a mirrored file */
+			opc = LAYOUT_INTENT_TRUNC;
+			start = io->u.ci_setattr.sa_attr.lvb_size;
 		} else { /* mkwrite */
 			pgoff_t index = io->u.ci_fault.ft_index;
 
@@ -364,7 +369,7 @@ static void vvp_io_fini(const struct lu_env *env, const struct cl_io_slice *ios)
 		CDEBUG(D_VFSTRACE, DFID" write layout, type %u [%llu, %llu)\n",
 		       PFID(lu_object_fid(&obj->co_lu)), io->ci_type,
 		       start, end);
-		rc = ll_layout_write_intent(inode, start, end);
+		rc = ll_layout_write_intent(inode, opc, start, end);
 		io->ci_result = rc;
 		if (!rc)
 			io->ci_need_restart = 1;
@@ -529,6 +534,7 @@ static void vvp_io_advance(const struct lu_env *env,
 static int vvp_io_rw_lock(const struct lu_env *env, struct cl_io *io,
                           enum cl_lock_mode mode, loff_t start, loff_t end)
 {
+	struct vvp_io *vio = vvp_env_io(env);
 	int result;
 	int ast_flags = 0;
 
@@ -541,6 +547,8 @@ static int vvp_io_rw_lock(const struct lu_env *env, struct cl_io *io,
 
 	if (io->u.ci_rw.rw_nonblock)
 		ast_flags |= CEF_NONBLOCK;
+	if (vio->vui_fd != NULL && vio->vui_fd->fd_lock_no_expand)
+		ast_flags |= CEF_LOCK_NO_EXPAND;
 
 	result = vvp_mmap_locks(env, io);
 	if (result == 0)
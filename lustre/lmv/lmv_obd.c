@@ -2995,6 +2995,55 @@ int lmv_intent_getattr_async(struct obd_export *exp,
 	RETURN(rc);
 }
 
+/*
+ * All the entries of a batch must be on the MDT of the directory, or of its
+ * stripe, they are looked up in. Like for lmv_intent_getattr_async(), the
+ * remote entries are not supported.
+ */
+static int lmv_batch_getattr_async(struct obd_export *exp,
+				   struct md_enqueue_info **minfos,
+				   unsigned int count)
+{
+	struct obd_device	*obd = exp->exp_obd;
+	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_tgt_desc	*tgt = NULL;
+	struct lu_fid		*pfid = NULL;
+	unsigned int		 i;
+	int			 rc;
+	ENTRY;
+
+	for (i = 0; i < count; i++) {
+		struct md_op_data *op_data = &minfos[i]->mi_data;
+		struct lmv_tgt_desc *ptgt;
+		struct lmv_tgt_desc *ctgt;
+
+		if (!fid_is_sane(&op_data->op_fid2))
+			RETURN(-EINVAL);
+
+		ptgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
+		if (IS_ERR(ptgt))
+			RETURN(PTR_ERR(ptgt));
+
+		ctgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid2);
+		if (IS_ERR(ctgt))
+			RETURN(PTR_ERR(ctgt));
+
+		if (ptgt != ctgt)
+			RETURN(-ENOTSUPP);
+
+		/* the batch is sent for a single directory (stripe) */
+		if (tgt == NULL) {
+			tgt = ptgt;
+			pfid = &op_data->op_fid1;
+		} else if (tgt != ptgt || !lu_fid_eq(pfid, &op_data->op_fid1)) {
+			RETURN(-ENOTSUPP);
+		}
+	}
+
+	rc = md_batch_getattr_async(tgt->ltd_exp, minfos, count);
+	RETURN(rc);
+}
+
 int lmv_revalidate_lock(struct obd_export *exp, struct lookup_intent *it,
                         struct lu_fid *fid, __u64 *bits)
 {
@@ -3168,6 +3217,7 @@ struct md_ops lmv_md_ops = {
         .m_set_open_replay_data = lmv_set_open_replay_data,
         .m_clear_open_replay_data = lmv_clear_open_replay_data,
         .m_intent_getattr_async = lmv_intent_getattr_async,
+	.m_batch_getattr_async	= lmv_batch_getattr_async,
 	.m_revalidate_lock      = lmv_revalidate_lock,
 	.m_get_fid_from_lsm	= lmv_get_fid_from_lsm,
 	.m_unpackmd		= lmv_unpackmd,
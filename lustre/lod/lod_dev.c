@@ -1631,6 +1631,7 @@ static int lod_init0(const struct lu_env *env, struct lod_device *lod,
 
 	dt_conf_get(env, &lod->lod_dt_dev, &ddp);
 	lod->lod_osd_max_easize = ddp.ddp_max_ea_size;
+	lod->lod_dom_max_stripesize = LOD_DOM_STRIPESIZE_DEFAULT;
 
 	/* setup obd to be used with old lov code */
 	rc = lod_pools_init(lod, cfg);
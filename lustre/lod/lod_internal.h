@@ -56,6 +56,10 @@
 
 #define LOV_OFFSET_DEFAULT		((__u16)-1)
 
+/* default and upper limit of the Data-on-MDT component size */
+#define LOD_DOM_STRIPESIZE_DEFAULT	(1U << 20)
+#define LOD_DOM_MAX_STRIPESIZE		(1U << 30)
+
 struct lod_qos_rr {
 	spinlock_t		 lqr_alloc;	/* protect allocation index */
 	__u32			 lqr_start_idx;	/* start index of new inode */
@@ -212,6 +216,9 @@ struct lod_device {
 
 	/* ROOT object, used to fetch FS default striping */
 	struct lod_object      *lod_md_root;
+
+	/* maximum size of the Data-on-MDT component, 0 disables DoM */
+	__u32			lod_dom_max_stripesize;
 };
 
 #define lod_osts	lod_ost_descs.ltd_tgts
@@ -272,6 +279,10 @@ struct lod_object {
 			/* Layout component count for a regular file.
 			 * It equals to 1 for non-composite layout. */
 			__u16		ldo_comp_cnt;
+			/* Mirror count and file level replication state
+			 * (LCM_FL_*) of a mirrored file. */
+			__u16		ldo_mirror_count;
+			__u16		ldo_flr_state;
 			__u32		ldo_is_composite:1,
 					ldo_comp_cached:1;
 		};
@@ -359,6 +370,39 @@ static inline void lod_obj_inc_layout_gen(struct lod_object *lo)
 		lo->ldo_layout_gen++;
 }
 
+/**
+ * Return the index of the first component of the mirror following the one
+ * component \a i belongs to, or ldo_comp_cnt if it is in the last mirror.
+ *
+ * Components of a mirror are adjacent and cover [0, EOF), so a new mirror
+ * starts with the next component whose extent starts at 0.
+ */
+static inline int lod_mirror_next(const struct lod_object *lo, int i)
+{
+	for (i++; i < lo->ldo_comp_cnt; i++)
+		if (lo->ldo_comp_entries[i].llc_extent.e_start == 0)
+			break;
+	return i;
+}
+
+/**
+ * Set the mirror count of the object from its components, and make sure
+ * the replication state is consistent with it.
+ */
+static inline void lod_obj_set_mirrors(struct lod_object *lo)
+{
+	int i;
+
+	lo->ldo_mirror_count = 0;
+	for (i = 0; i < lo->ldo_comp_cnt; i = lod_mirror_next(lo, i))
+		lo->ldo_mirror_count++;
+
+	if (lo->ldo_mirror_count <= 1)
+		lo->ldo_flr_state = LCM_FL_NONE;
+	else if (lo->ldo_flr_state == LCM_FL_NONE)
+		lo->ldo_flr_state = LCM_FL_RDONLY;
+}
+
 struct lod_it {
 	struct dt_object	*lit_obj; /* object from the layer below */
 	/* stripe offset of iteration */
@@ -576,6 +620,12 @@ lod_comp_inited(const struct lod_layout_component *entry)
 	return entry->llc_flags & LCME_FL_INIT;
 }
 
+static inline bool
+lod_comp_is_dom(const struct lod_layout_component *entry)
+{
+	return lov_pattern(entry->llc_pattern) == LOV_PATTERN_MDT;
+}
+
 /**
  * For a PFL file, some of its component could be un-instantiated, so
  * that their lov_ost_data_v1 array is not needed, we'd use this function
@@ -588,6 +638,11 @@ static inline void
 lod_comp_shrink_stripe_count(struct lod_layout_component *lod_comp,
 			     __u16 *stripe_count)
 {
+	/* DoM component never has OST objects */
+	if (lod_comp_is_dom(lod_comp)) {
+		*stripe_count = 0;
+		return;
+	}
 	/**
 	 * Need one lov_ost_data_v1 to store invalid ost_idx, please refer to
 	 * lod_parse_striping()
@@ -699,6 +699,8 @@ void lod_free_comp_entries(struct lod_object *lo)
 			     sizeof(*lo->ldo_comp_entries) * lo->ldo_comp_cnt);
 	lo->ldo_comp_entries = NULL;
 	lo->ldo_comp_cnt = 0;
+	lo->ldo_mirror_count = 0;
+	lo->ldo_flr_state = LCM_FL_NONE;
 	lo->ldo_is_composite = 0;
 }
 
@@ -792,7 +794,8 @@ static int lod_gen_component_ea(const struct lu_env *env,
 	if (!is_dir && lo->ldo_is_composite)
 		lod_comp_shrink_stripe_count(lod_comp, &stripe_count);
 
-	if (is_dir || lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED)
+	if (is_dir || lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED ||
+	    lod_comp_is_dom(lod_comp))
 		GOTO(done, rc = 0);
 
 	/* generate ost_idx of this component stripe */
@@ -983,6 +986,10 @@ int lod_generate_lovea(const struct lu_env *env, struct lod_object *lo,
 	}
 	lcm->lcm_size = cpu_to_le32(offset);
 	lcm->lcm_layout_gen = cpu_to_le32(is_dir ? 0 : lo->ldo_layout_gen);
+	if (!is_dir && lo->ldo_mirror_count > 1) {
+		lcm->lcm_flags = cpu_to_le16(lo->ldo_flr_state);
+		lcm->lcm_mirror_count = cpu_to_le16(lo->ldo_mirror_count);
+	}
 
 	lustre_print_user_md(D_LAYOUT, (struct lov_user_md *)lmm,
 			     "generate lum");
@@ -1223,6 +1230,8 @@ int lod_parse_striping(const struct lu_env *env, struct lod_object *lo,
 			GOTO(out, rc = -EINVAL);
 		lo->ldo_layout_gen = le32_to_cpu(comp_v1->lcm_layout_gen);
 		lo->ldo_is_composite = 1;
+		lo->ldo_flr_state = le16_to_cpu(comp_v1->lcm_flags) &
+				    LCM_FL_FLR_MASK;
 	} else {
 		comp_cnt = 1;
 		lo->ldo_layout_gen = le16_to_cpu(lmm->lmm_layout_gen);
@@ -1259,7 +1268,8 @@ int lod_parse_striping(const struct lu_env *env, struct lod_object *lo,
 		}
 
 		pattern = le32_to_cpu(lmm->lmm_pattern);
-		if (lov_pattern(pattern) != LOV_PATTERN_RAID0)
+		if (lov_pattern(pattern) != LOV_PATTERN_RAID0 &&
+		    lov_pattern(pattern) != LOV_PATTERN_MDT)
 			GOTO(out, rc = -EINVAL);
 
 		lod_comp->llc_pattern = pattern;
@@ -1320,12 +1330,14 @@ int lod_parse_striping(const struct lu_env *env, struct lod_object *lo,
 		if (!lod_comp_inited(lod_comp))
 			continue;
 
-		if (!(lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED)) {
+		if (!(lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED) &&
+		    !lod_comp_is_dom(lod_comp)) {
 			rc = lod_initialize_objects(env, lo, objs, i);
 			if (rc)
 				GOTO(out, rc);
 		}
 	}
+	lod_obj_set_mirrors(lo);
 out:
 	if (rc)
 		lod_object_free_striping(env, lo);
@@ -1610,6 +1622,54 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Verify Data-on-MDT component of a composite layout.
+ *
+ * The DoM component has no OST objects, must be the first component
+ * and its size (which is also its stripe size) is limited by the
+ * dom_stripesize tunable, which disables DoM when set to 0.
+ *
+ * \param[in] d			LOD device
+ * \param[in] lum		DoM component layout
+ * \param[in] first		component is the first one of the file
+ * \param[in] end		component extent end
+ * \param[in] is_from_disk	0 - from user, 1 - from disk
+ *
+ * \retval			0 if the DoM component is valid
+ * \retval			-EINVAL if it is invalid
+ */
+static int lod_verify_dom(struct lod_device *d, struct lov_user_md_v1 *lum,
+			  bool first, __u64 end, bool is_from_disk)
+{
+	__u32 stripe_size = le32_to_cpu(lum->lmm_stripe_size);
+
+	if (!first) {
+		CDEBUG(D_LAYOUT, "DoM component must be the first one\n");
+		return -EINVAL;
+	}
+
+	if (le16_to_cpu(lum->lmm_stripe_count) != 0) {
+		CDEBUG(D_LAYOUT, "DoM component with %u stripes\n",
+		       le16_to_cpu(lum->lmm_stripe_count));
+		return -EINVAL;
+	}
+
+	if (end == LUSTRE_EOF || end & (LOV_MIN_STRIPE_SIZE - 1) ||
+	    (stripe_size != 0 && stripe_size != end)) {
+		CDEBUG(D_LAYOUT, "DoM stripe size %u doesn't match component "
+		       "end %llu\n", stripe_size, end);
+		return -EINVAL;
+	}
+
+	if (!is_from_disk && end > d->lod_dom_max_stripesize) {
+		CDEBUG(D_LAYOUT, "DoM component size %llu exceeds limit %u\n",
+		       end, d->lod_dom_max_stripesize);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 /**
  * Verify LOV striping.
  *
@@ -1656,6 +1716,7 @@ int lod_verify_striping(struct lod_device *d, const struct lu_buf *buf,
 		struct lu_buf	tmp;
 		__u32	stripe_size = 0;
 		__u64	prev_end = start;
+		__u16	mirror_count = 1;
 
 		comp_v1 = buf->lb_buf;
 		if (buf->lb_len < le32_to_cpu(comp_v1->lcm_size)) {
@@ -1690,6 +1751,14 @@ int lod_verify_striping(struct lod_device *d, const struct lu_buf *buf,
 				RETURN(-EINVAL);
 			}
 
+			/* a component starting at 0 after a component ending
+			 * at EOF starts a new mirror of the file */
+			if (i > 0 && prev_end == LUSTRE_EOF &&
+			    le64_to_cpu(ext->e_start) == 0) {
+				prev_end = 0;
+				mirror_count++;
+			}
+
 			/* first component must start with 0, and the next
 			 * must be adjacent with the previous one */
 			if (le64_to_cpu(ext->e_start) != prev_end) {
@@ -1709,6 +1778,16 @@ int lod_verify_striping(struct lod_device *d, const struct lu_buf *buf,
 
 			lum = tmp.lb_buf;
 
+			if (lov_pattern(le32_to_cpu(lum->lmm_pattern)) ==
+			    LOV_PATTERN_MDT) {
+				rc = lod_verify_dom(d, lum,
+						    i == 0 && start == 0,
+						    prev_end, is_from_disk);
+				if (rc)
+					break;
+				continue;
+			}
+
 			/* extent end must be aligned with the stripe_size */
 			stripe_size = le32_to_cpu(lum->lmm_stripe_size);
 			if (stripe_size == 0)
@@ -1722,8 +1801,21 @@ int lod_verify_striping(struct lod_device *d, const struct lu_buf *buf,
 				RETURN(-EINVAL);
 			}
 		}
+
+		/* every mirror has to cover the whole file */
+		if (rc == 0 && mirror_count > 1 && prev_end != LUSTRE_EOF) {
+			CDEBUG(D_LAYOUT, "last mirror ends at %llu, not EOF\n",
+			       prev_end);
+			RETURN(-EINVAL);
+		}
 	} else {
 		rc = lod_verify_v1v3(d, buf, is_from_disk);
+		/* DoM is only possible as a component of composite layout */
+		if (rc == 0 && lov_pattern(le32_to_cpu(lum->lmm_pattern)) ==
+			       LOV_PATTERN_MDT) {
+			CDEBUG(D_LAYOUT, "DoM pattern in plain layout\n");
+			rc = -EINVAL;
+		}
 	}
 
 	RETURN(rc);
@@ -1049,11 +1049,15 @@ static int lod_attr_get(const struct lu_env *env,
 static inline void lod_adjust_stripe_info(struct lod_layout_component *comp,
 					  struct lov_desc *desc)
 {
-	if (comp->llc_pattern != LOV_PATTERN_FIRST) {
-		if (!comp->llc_stripe_count)
-			comp->llc_stripe_count =
-				desc->ld_default_stripe_count;
+	if (lod_comp_is_dom(comp)) {
+		/* DoM component has no stripes, its size is the extent end */
+		if (comp->llc_stripe_size <= 0)
+			comp->llc_stripe_size = comp->llc_extent.e_end;
+		return;
 	}
+
+	if (!comp->llc_stripe_count)
+		comp->llc_stripe_count = desc->ld_default_stripe_count;
 	if (comp->llc_stripe_size <= 0)
 		comp->llc_stripe_size = desc->ld_default_stripe_size;
 }
@@ -2153,7 +2157,7 @@ inline __u16 lod_comp_entry_stripe_count(struct lod_object *lo,
 {
 	struct lod_device *lod = lu2lod_dev(lod2lu_obj(lo)->lo_dev);
 
-	if (is_dir)
+	if (is_dir || lod_comp_is_dom(entry))
 		return  0;
 	else if (lod_comp_inited(entry))
 		return entry->llc_stripe_count;
@@ -3319,6 +3323,7 @@ static int lod_layout_del(const struct lu_env *env, struct dt_object *dt,
 			 sizeof(*comp_array) * lo->ldo_comp_cnt);
 		lo->ldo_comp_entries = comp_array;
 		lo->ldo_comp_cnt = left;
+		lod_obj_set_mirrors(lo);
 		lod_obj_inc_layout_gen(lo);
 	} else {
 		lod_free_comp_entries(lo);
@@ -3682,6 +3687,7 @@ static int lod_get_default_lov_striping(const struct lu_env *env,
 		}
 
 		if (v1->lmm_pattern != LOV_PATTERN_RAID0 &&
+		    v1->lmm_pattern != LOV_PATTERN_MDT &&
 		    v1->lmm_pattern != 0) {
 			lod_free_def_comp_entries(lds);
 			RETURN(-EINVAL);
@@ -3693,6 +3699,7 @@ static int lod_get_default_lov_striping(const struct lu_env *env,
 		       (int)v1->lmm_stripe_count, (int)v1->lmm_stripe_size,
 		       (int)v1->lmm_stripe_offset);
 
+		lod_comp->llc_pattern = v1->lmm_pattern;
 		lod_comp->llc_stripe_count = v1->lmm_stripe_count;
 		lod_comp->llc_stripe_size = v1->lmm_stripe_size;
 		lod_comp->llc_stripe_offset = v1->lmm_stripe_offset;
@@ -3832,6 +3839,7 @@ static void lod_striping_from_default(struct lod_object *lo,
 
 			lod_adjust_stripe_info(obj_comp, desc);
 		}
+		lod_obj_set_mirrors(lo);
 	} else if (lds->lds_dir_def_striping_set && S_ISDIR(mode)) {
 		if (lo->ldo_dir_stripe_count == 0)
 			lo->ldo_dir_stripe_count =
@@ -4369,7 +4377,8 @@ int lod_striped_create(const struct lu_env *env, struct dt_object *dt,
 		if (lod_comp_inited(lod_comp))
 			continue;
 
-		if (lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED)
+		if (lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED ||
+		    lod_comp_is_dom(lod_comp))
 			lod_comp_set_init(lod_comp);
 
 		if (lod_comp->llc_stripe == NULL)
@@ -4874,6 +4883,162 @@ static int lod_invalidate(const struct lu_env *env, struct dt_object *dt)
 	return dt_invalidate(env, dt_object_child(dt));
 }
 
+/**
+ * Pick the mirror to be written by a write or truncate intent.
+ *
+ * A mirror without any stale component has the latest data, so only the
+ * other mirrors have to be marked stale when it is written. If there is no
+ * such mirror, the one with a preferred component, or the first one is used.
+ *
+ * \param[in] lo	mirrored LOD object
+ *
+ * \retval		index of the first component of the picked mirror
+ */
+static int lod_primary_mirror(const struct lod_object *lo)
+{
+	int preferred = -1;
+	int i, j, k;
+
+	for (i = 0; i < lo->ldo_comp_cnt; i = j) {
+		bool stale = false;
+
+		j = lod_mirror_next(lo, i);
+		for (k = i; k < j; k++) {
+			__u32 flags = lo->ldo_comp_entries[k].llc_flags;
+
+			if (flags & LCME_FL_STALE)
+				stale = true;
+			if (flags & LCME_FL_PREFERRED && preferred < 0)
+				preferred = i;
+		}
+		if (!stale)
+			return i;
+	}
+
+	return preferred >= 0 ? preferred : 0;
+}
+
+/**
+ * Update the layout of a mirrored file for a layout intent.
+ *
+ * A write or truncate intent instantiates the components of the primary
+ * mirror which cover the range and marks the overlapping components of
+ * the other mirrors stale. A resync intent instantiates the stale
+ * components so they can be written, and a resync done intent, which is
+ * only sent by the MDT on close of the resync lease, clears the stale
+ * flags again.
+ *
+ * \param[in] env	execution environment
+ * \param[in] lo	mirrored LOD object
+ * \param[in] layout	layout intent
+ * \param[in] inuse	OSTs used by the file so far
+ * \param[in] th	transaction handle
+ *
+ * \retval 0		if the layout has been changed
+ * \retval -EALREADY	if no change was needed
+ * \retval negative	negated errno on error
+ */
+static int lod_declare_update_mirrors(const struct lu_env *env,
+				      struct lod_object *lo,
+				      struct layout_intent *layout,
+				      struct ost_pool *inuse,
+				      struct thandle *th)
+{
+	struct lod_layout_component *lod_comp;
+	struct lu_extent create = { .e_start = layout->li_start,
+				    .e_end = layout->li_end };
+	struct lu_extent stale = create;
+	bool changed = false;
+	int primary, next, i, rc;
+	ENTRY;
+
+	switch (layout->li_opc) {
+	case LAYOUT_INTENT_TRUNC:
+		/* the data beyond the new size is only truncated in the
+		 * primary mirror, the components below it must exist */
+		create.e_start = 0;
+		create.e_end = layout->li_start;
+		stale.e_end = LUSTRE_EOF;
+		/* fall through */
+	case LAYOUT_INTENT_WRITE:
+		primary = lod_primary_mirror(lo);
+		next = lod_mirror_next(lo, primary);
+
+		for (i = 0; i < lo->ldo_comp_cnt; i++) {
+			lod_comp = &lo->ldo_comp_entries[i];
+
+			if (i < primary || i >= next) {
+				if (lod_comp->llc_flags & LCME_FL_STALE ||
+				    !lu_extent_is_overlapped(&stale,
+						&lod_comp->llc_extent))
+					continue;
+
+				lod_comp->llc_flags |= LCME_FL_STALE;
+				changed = true;
+				continue;
+			}
+
+			if (lod_comp_inited(lod_comp) ||
+			    !lu_extent_is_overlapped(&create,
+						     &lod_comp->llc_extent))
+				continue;
+
+			/* A released component is being extended */
+			if (lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED)
+				RETURN(-EINVAL);
+
+			rc = lod_qos_prep_create(env, lo, NULL, th, i, inuse);
+			if (rc)
+				RETURN(rc);
+			changed = true;
+		}
+
+		if (lo->ldo_flr_state != LCM_FL_WRITE_PENDING) {
+			lo->ldo_flr_state = LCM_FL_WRITE_PENDING;
+			changed = true;
+		}
+		break;
+	case LAYOUT_INTENT_RESYNC:
+		for (i = 0; i < lo->ldo_comp_cnt; i++) {
+			lod_comp = &lo->ldo_comp_entries[i];
+
+			if (!(lod_comp->llc_flags & LCME_FL_STALE) ||
+			    lod_comp_inited(lod_comp) ||
+			    !lu_extent_is_overlapped(&create,
+						     &lod_comp->llc_extent))
+				continue;
+
+			if (lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED)
+				RETURN(-EINVAL);
+
+			rc = lod_qos_prep_create(env, lo, NULL, th, i, inuse);
+			if (rc)
+				RETURN(rc);
+			changed = true;
+		}
+
+		if (lo->ldo_flr_state == LCM_FL_WRITE_PENDING) {
+			lo->ldo_flr_state = LCM_FL_SYNC_PENDING;
+			changed = true;
+		}
+		break;
+	case LAYOUT_INTENT_RESYNC_DONE:
+		/* the file was written during resync */
+		if (lo->ldo_flr_state != LCM_FL_SYNC_PENDING)
+			RETURN(-EBUSY);
+
+		for (i = 0; i < lo->ldo_comp_cnt; i++)
+			lo->ldo_comp_entries[i].llc_flags &= ~LCME_FL_STALE;
+		lo->ldo_flr_state = LCM_FL_RDONLY;
+		changed = true;
+		break;
+	default:
+		RETURN(-ENOTSUPP);
+	}
+
+	RETURN(changed ? 0 : -EALREADY);
+}
+
 static int lod_declare_layout_change(const struct lu_env *env,
 				     struct dt_object *dt,
 				     struct layout_intent *layout,
@@ -4887,6 +5052,8 @@ static int lod_declare_layout_change(const struct lu_env *env,
 	struct ost_pool *inuse = &info->lti_inuse_osts;
 	struct lod_layout_component *lod_comp;
 	struct lov_comp_md_v1 *comp_v1 = NULL;
+	struct lu_extent extent = { .e_start = layout->li_start,
+				    .e_end = layout->li_end };
 	bool replay = false;
 	bool need_create = false;
 	int i, rc;
@@ -4896,6 +5063,12 @@ static int lod_declare_layout_change(const struct lu_env *env,
 	    dt_object_remote(next))
 		RETURN(-EINVAL);
 
+	/* truncate needs the components below the new size only */
+	if (layout->li_opc == LAYOUT_INTENT_TRUNC) {
+		extent.e_start = 0;
+		extent.e_end = layout->li_start;
+	}
+
 	dt_write_lock(env, next, 0);
 	/*
 	 * In case the client is passing lovea, which only happens during
@@ -4936,18 +5109,34 @@ static int lod_declare_layout_change(const struct lu_env *env,
 		rc = lod_prepare_inuse(env, lo);
 		if (rc)
 			GOTO(out, rc);
+
+		if (lo->ldo_mirror_count > 1) {
+			rc = lod_declare_update_mirrors(env, lo, layout, inuse,
+							th);
+			if (rc == -EALREADY)
+				GOTO(unlock, rc);
+			if (rc)
+				GOTO(out, rc);
+			lod_obj_inc_layout_gen(lo);
+			GOTO(declare, rc);
+		}
 	}
 
+	if (layout->li_opc != LAYOUT_INTENT_WRITE &&
+	    layout->li_opc != LAYOUT_INTENT_TRUNC &&
+	    !(replay && lo->ldo_mirror_count > 1))
+		GOTO(out, rc = -ENOTSUPP);
+
 	/* Make sure defined layout covers the requested write range. */
 	lod_comp = &lo->ldo_comp_entries[lo->ldo_comp_cnt - 1];
 	if (lo->ldo_comp_cnt > 1 &&
 	    lod_comp->llc_extent.e_end != OBD_OBJECT_EOF &&
-	    lod_comp->llc_extent.e_end < layout->li_end) {
+	    lod_comp->llc_extent.e_end < extent.e_end) {
 		CDEBUG(replay ? D_ERROR : D_LAYOUT,
 		       "%s: the defined layout [0, %#llx) does not covers "
 		       "the write range [%#llx, %#llx).\n",
 		       lod2obd(d)->obd_name, lod_comp->llc_extent.e_end,
-		       layout->li_start, layout->li_end);
+		       extent.e_start, extent.e_end);
 		GOTO(out, rc = -EINVAL);
 	}
 
@@ -4958,13 +5147,25 @@ static int lod_declare_layout_change(const struct lu_env *env,
 	for (i = 0; i < lo->ldo_comp_cnt; i++) {
 		lod_comp = &lo->ldo_comp_entries[i];
 
-		if (lod_comp->llc_extent.e_start >= layout->li_end)
-			break;
-
 		if (!replay) {
+			if (lod_comp->llc_extent.e_start >= extent.e_end)
+				break;
 			if (lod_comp_inited(lod_comp))
 				continue;
+		} else if (lo->ldo_mirror_count > 1) {
+			/**
+			 * The replayed layout of a mirrored file carries the
+			 * stale flags and replication state as they were set
+			 * by the intent, so just instantiate the components
+			 * it has but the on-disk EA does not.
+			 */
+			if (!lod_comp_inited(lod_comp) ||
+			    le32_to_cpu(comp_v1->lcm_entries[i].lcme_flags) &
+			    LCME_FL_INIT)
+				continue;
 		} else {
+			if (lod_comp->llc_extent.e_start >= extent.e_end)
+				break;
 			/**
 			 * In replay path, lod_comp is the EA passed by
 			 * client replay buffer,  comp_v1 is the pre-recovery
@@ -4991,11 +5192,15 @@ static int lod_declare_layout_change(const struct lu_env *env,
 			break;
 	}
 
+	if (replay && lo->ldo_mirror_count > 1)
+		need_create = true;
+
 	if (need_create)
 		lod_obj_inc_layout_gen(lo);
 	else
 		GOTO(unlock, rc = -EALREADY);
 
+declare:
 	if (!rc) {
 		info->lti_buf.lb_len = lod_comp_md_size(lo, false);
 		rc = lod_sub_declare_xattr_set(env, next, &info->lti_buf,
@@ -1745,6 +1745,8 @@ int lod_use_defined_striping(const struct lu_env *env,
 		if (comp_cnt == 0)
 			RETURN(-EINVAL);
 		mo->ldo_is_composite = 1;
+		mo->ldo_flr_state = le16_to_cpu(comp_v1->lcm_flags) &
+				    LCM_FL_FLR_MASK;
 	} else {
 		mo->ldo_is_composite = 0;
 		comp_cnt = 1;
@@ -1803,12 +1805,14 @@ int lod_use_defined_striping(const struct lu_env *env,
 		lod_obj_set_pool(mo, i, pool_name);
 
 		if ((!mo->ldo_is_composite || lod_comp_inited(lod_comp)) &&
-		    !(lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED)) {
+		    !(lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED) &&
+		    !lod_comp_is_dom(lod_comp)) {
 			rc = lod_initialize_objects(env, mo, objs, i);
 			if (rc)
 				GOTO(out, rc);
 		}
 	}
+	lod_obj_set_mirrors(mo);
 out:
 	if (rc)
 		lod_object_free_striping(env, mo);
@@ -1936,6 +1940,10 @@ int lod_qos_parse_config(const struct lu_env *env, struct lod_object *lo,
 					comp_v1->lcm_entries[i].lcme_offset);
 			ext = &comp_v1->lcm_entries[i].lcme_extent;
 			lod_comp->llc_extent = *ext;
+			/* only the read preference can be set by user */
+			lod_comp->llc_flags =
+				comp_v1->lcm_entries[i].lcme_flags &
+				LCME_FL_PREFERRED;
 		}
 
 		pool_name = NULL;
@@ -1973,7 +1981,9 @@ int lod_qos_parse_config(const struct lu_env *env, struct lod_object *lo,
 
 		if (v1->lmm_pattern == 0)
 			v1->lmm_pattern = LOV_PATTERN_RAID0;
-		if (lov_pattern(v1->lmm_pattern) != LOV_PATTERN_RAID0) {
+		if (lov_pattern(v1->lmm_pattern) != LOV_PATTERN_RAID0 &&
+		    (lov_pattern(v1->lmm_pattern) != LOV_PATTERN_MDT ||
+		     !lo->ldo_is_composite || i != 0)) {
 			CDEBUG(D_LAYOUT, "%s: invalid pattern: %x\n",
 			       lod2obd(d)->obd_name, v1->lmm_pattern);
 			GOTO(free_comp, rc = -EINVAL);
@@ -1981,6 +1991,14 @@ int lod_qos_parse_config(const struct lu_env *env, struct lod_object *lo,
 
 		lod_comp->llc_pattern = v1->lmm_pattern;
 
+		/* DoM component keeps its data in the MDT object */
+		if (lod_comp_is_dom(lod_comp)) {
+			lod_comp->llc_stripe_size = lod_comp->llc_extent.e_end;
+			lod_comp->llc_stripe_count = 0;
+			lod_comp->llc_stripe_offset = LOV_OFFSET_DEFAULT;
+			continue;
+		}
+
 		lod_comp->llc_stripe_size = desc->ld_default_stripe_size;
 		if (v1->lmm_stripe_size)
 			lod_comp->llc_stripe_size = v1->lmm_stripe_size;
@@ -2019,6 +2037,7 @@ int lod_qos_parse_config(const struct lu_env *env, struct lod_object *lo,
 
 		lod_pool_putref(pool);
 	}
+	lod_obj_set_mirrors(lo);
 
 	RETURN(0);
 
@@ -2066,6 +2085,10 @@ int lod_qos_prep_create(const struct lu_env *env, struct lod_object *lo,
 	if (lod_comp->llc_pattern & LOV_PATTERN_F_RELEASED)
 		RETURN(0);
 
+	/* DoM component data is stored in the MDT object itself */
+	if (lod_comp_is_dom(lod_comp))
+		RETURN(0);
+
 	if (likely(lod_comp->llc_stripe == NULL)) {
 		/*
 		 * no striping has been created so far
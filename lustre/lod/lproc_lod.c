@@ -104,6 +104,67 @@ lod_stripesize_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(lod_stripesize);
 
+/**
+ * Show maximum size of the Data-on-MDT component.
+ *
+ * \param[in] m		seq file
+ * \param[in] v		unused for single entry
+ *
+ * \retval 0		on success
+ * \retval negative	error code if failed
+ */
+static int lod_dom_stripesize_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *dev = m->private;
+	struct lod_device *lod;
+
+	LASSERT(dev != NULL);
+	lod = lu2lod_dev(dev->obd_lu_dev);
+	seq_printf(m, "%u\n", lod->lod_dom_max_stripesize);
+	return 0;
+}
+
+/**
+ * Set maximum size of the Data-on-MDT component.
+ *
+ * A value of zero disables creation of new DoM components.
+ *
+ * \param[in] file	proc file
+ * \param[in] buffer	string containing the maximum size in bytes of data
+ *			that may be stored on the MDT
+ * \param[in] count	@buffer length
+ * \param[in] off	unused for single entry
+ *
+ * \retval @count	on success
+ * \retval negative	error code if failed
+ */
+static ssize_t
+lod_dom_stripesize_seq_write(struct file *file, const char __user *buffer,
+			     size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct obd_device *dev = m->private;
+	struct lod_device *lod;
+	__s64 val;
+	int rc;
+
+	LASSERT(dev != NULL);
+	lod = lu2lod_dev(dev->obd_lu_dev);
+	rc = lprocfs_str_with_units_to_s64(buffer, count, &val, '1');
+	if (rc)
+		return rc;
+	if (val < 0 || val > LOD_DOM_MAX_STRIPESIZE)
+		return -ERANGE;
+	/* the DoM component must end on a stripe boundary */
+	if (val & (LOV_MIN_STRIPE_SIZE - 1))
+		return -EINVAL;
+
+	lod->lod_dom_max_stripesize = val;
+
+	return count;
+}
+LPROC_SEQ_FOPS(lod_dom_stripesize);
+
 /**
  * Show default stripe offset.
  *
@@ -743,6 +804,8 @@ static struct lprocfs_vars lprocfs_lod_obd_vars[] = {
 	  .fops	=	&lod_stripesize_fops	},
 	{ .name	=	"stripeoffset",
 	  .fops	=	&lod_stripeoffset_fops	},
+	{ .name	=	"dom_stripesize",
+	  .fops	=	&lod_dom_stripesize_fops	},
 	{ .name	=	"stripecount",
 	  .fops	=	&lod_stripecount_fops	},
 	{ .name	=	"stripetype",
@@ -101,8 +101,21 @@ struct lov_device {
         __u32                     ld_target_nr;
         struct lovsub_device    **ld_target;
         __u32                     ld_flags;
+
+	/** Data-on-MDT devices, set up on first use and indexed by MDT */
+	struct mutex		  ld_md_mutex;
+	__u32			  ld_md_tgts_nr;
+	struct lovsub_device	**ld_md_tgts;
+	/** LMV device of the same mount, used to find the MDC of a file */
+	struct obd_device	 *ld_lmv;
 };
 
+/**
+ * Version of the FID used to find the Data-on-MDT sub-object of a file in
+ * the client site. The top object uses the file FID itself.
+ */
+#define LOV_DOM_FID_VER		0x646f6d
+
 /**
  * Layout type.
  */
@@ -227,6 +240,33 @@ struct lov_object {
 				struct lu_extent lle_extent;
 				struct lov_layout_raid0 lle_raid0;
 			} *lo_entries;
+			/**
+			 * File level replication state, LCM_FL_*.
+			 */
+			unsigned int lo_flr_state;
+			/**
+			 * Number of mirrors, 1 if the file is not mirrored.
+			 */
+			unsigned int lo_mirror_count;
+			/**
+			 * Index of the mirror with a preferred component,
+			 * -1 if there is none.
+			 */
+			int lo_preferred_mirror;
+			/**
+			 * Mirror to start from when reads are spread over
+			 * the mirrors, so that different clients do not all
+			 * pick the first one.
+			 */
+			unsigned int lo_mirror_hint;
+			/**
+			 * Entries [lre_start, lre_end) of lo_entries form
+			 * a mirror, which covers [0, EOF) of the file.
+			 */
+			struct lov_mirror_entry {
+				int lre_start;
+				int lre_end;
+			} *lo_mirrors;
 		} composite;
 	} u;
 	/**
@@ -242,6 +282,12 @@ struct lov_object {
 			[lov->u.composite.lo_entry_count];	\
 	     entry++)
 
+#define lov_foreach_mirror_entry(lov, lre)			\
+	for (lre = &lov->u.composite.lo_mirrors[0];		\
+	     lre < &lov->u.composite.lo_mirrors			\
+			[lov->u.composite.lo_mirror_count];	\
+	     lre++)
+
 /**
  * State lov_lock keeps for each sub-lock.
  */
@@ -382,6 +428,11 @@ struct lov_io {
 	 */
 	loff_t			lis_endpos;
 	int			lis_nr_subios;
+	/**
+	 * Index of the mirror of a mirrored file this IO is done with,
+	 * see lov_io_mirror_init(). Always 0 for a non-mirrored file.
+	 */
+	int			lis_mirror_index;
 
 	/**
 	 * the index of ls_single_subio in ls_subios array
@@ -459,9 +510,13 @@ struct lu_object *lovsub_object_alloc(const struct lu_env *env,
                                       const struct lu_object_header *hdr,
                                       struct lu_device *dev);
 
+struct lovsub_device *lov_md_target(const struct lu_env *env,
+				    struct lov_device *ld,
+				    const struct lu_fid *fid, __u32 *mdt_idx);
 struct lov_stripe_md *lov_lsm_addref(struct lov_object *lov);
 int lov_page_stripe(const struct cl_page *page);
 int lov_lsm_entry(const struct lov_stripe_md *lsm, __u64 offset);
+int lov_io_layout_at(struct lov_io *lio, __u64 offset);
 
 #define lov_foreach_target(lov, var)                    \
         for (var = 0; var < lov_targets_nr(lov); ++var)
@@ -488,6 +543,26 @@ static inline struct lov_io *lov_env_io(const struct lu_env *env)
         return &lov_env_session(env)->ls_io;
 }
 
+/**
+ * IO of these types is served by a single mirror of a mirrored file, the
+ * others go to all the mirrors.
+ */
+static inline bool lov_io_is_mirror_io(const struct cl_io *io)
+{
+	switch (io->ci_type) {
+	case CIT_READ:
+	case CIT_WRITE:
+	case CIT_FAULT:
+	case CIT_DATA_VERSION:
+	case CIT_MISC:
+		return true;
+	case CIT_SETATTR:
+		return cl_io_is_trunc(io);
+	default:
+		return false;
+	}
+}
+
 static inline int lov_is_object(const struct lu_object *obj)
 {
         return obj->lo_dev->ld_type == &lov_device_type;
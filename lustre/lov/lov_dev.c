@@ -38,6 +38,7 @@
 
 /* class_name2obd() */
 #include <obd_class.h>
+#include <lustre_fld.h>
 
 #include "lov_cl_internal.h"
 
@@ -149,6 +150,14 @@ static struct lu_device *lov_device_fini(const struct lu_env *env,
         struct lov_device *ld = lu2lov_dev(d);
 
         LASSERT(ld->ld_lov != NULL);
+
+	for (i = 0; i < ld->ld_md_tgts_nr; i++) {
+		if (ld->ld_md_tgts[i] != NULL) {
+			cl_stack_fini(env, lovsub2cl_dev(ld->ld_md_tgts[i]));
+			ld->ld_md_tgts[i] = NULL;
+		}
+	}
+
         if (ld->ld_target == NULL)
                 RETURN(NULL);
 
@@ -212,6 +221,9 @@ static struct lu_device *lov_device_free(const struct lu_env *env,
 	cl_device_fini(lu2cl_dev(d));
 	if (ld->ld_target != NULL)
 		OBD_FREE(ld->ld_target, nr * sizeof ld->ld_target[0]);
+	if (ld->ld_md_tgts != NULL)
+		OBD_FREE(ld->ld_md_tgts,
+			 ld->ld_md_tgts_nr * sizeof(ld->ld_md_tgts[0]));
 
 	OBD_FREE_PTR(ld);
 	return NULL;
@@ -303,6 +315,114 @@ static int lov_cl_add_target(const struct lu_env *env, struct lu_device *dev,
         RETURN(rc);
 }
 
+static struct obd_device *lov_find_lmv(struct lov_device *ld)
+{
+	struct obd_device *obd = lov2obd(ld->ld_lov);
+	struct obd_device *lmv;
+	int next = 0;
+
+	/* all client devices of a mount share the same instance uuid */
+	while ((lmv = class_devices_in_group(&obd->obd_uuid, &next)) != NULL) {
+		if (strcmp(lmv->obd_type->typ_name, LUSTRE_LMV_NAME) == 0)
+			break;
+	}
+	return lmv;
+}
+
+/**
+ * Get the lovsub device on top of the MDC serving the MDT of \a fid.
+ *
+ * MDCs are not LOV targets, so their cl_devices are set up on the first
+ * access to a Data-on-MDT file and are kept until the LOV device is gone.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ld	LOV device
+ * \param[in] fid	FID of the file
+ * \param[out] mdt_idx	index of the MDT holding the file
+ *
+ * \retval		lovsub device on success
+ * \retval		ERR_PTR(negative errno) on failure
+ */
+struct lovsub_device *lov_md_target(const struct lu_env *env,
+				    struct lov_device *ld,
+				    const struct lu_fid *fid, __u32 *mdt_idx)
+{
+	struct lov_obd *lov = ld->ld_lov;
+	struct lmv_obd *lmv;
+	struct obd_export *exp;
+	struct lovsub_device *lsd;
+	struct cl_device *cl;
+	__u32 idx;
+	int rc;
+	ENTRY;
+
+	mutex_lock(&ld->ld_md_mutex);
+	if (ld->ld_lmv == NULL) {
+		ld->ld_lmv = lov_find_lmv(ld);
+		if (ld->ld_lmv == NULL)
+			GOTO(out, lsd = ERR_PTR(-ENODEV));
+	}
+	lmv = &ld->ld_lmv->u.lmv;
+
+	rc = fld_client_lookup(&lmv->lmv_fld, fid_seq(fid), &idx,
+			       LU_SEQ_RANGE_MDT, env);
+	if (rc < 0)
+		GOTO(out, lsd = ERR_PTR(rc));
+
+	if (idx >= lmv->tgts_size || lmv->tgts[idx] == NULL ||
+	    lmv->tgts[idx]->ltd_exp == NULL)
+		GOTO(out, lsd = ERR_PTR(-ENODEV));
+	exp = lmv->tgts[idx]->ltd_exp;
+
+	if (idx >= ld->ld_md_tgts_nr) {
+		struct lovsub_device **newd;
+		__u32 sz = lmv->tgts_size;
+
+		OBD_ALLOC(newd, sz * sizeof(newd[0]));
+		if (newd == NULL)
+			GOTO(out, lsd = ERR_PTR(-ENOMEM));
+
+		if (ld->ld_md_tgts_nr > 0) {
+			memcpy(newd, ld->ld_md_tgts,
+			       ld->ld_md_tgts_nr * sizeof(newd[0]));
+			OBD_FREE(ld->ld_md_tgts,
+				 ld->ld_md_tgts_nr * sizeof(newd[0]));
+		}
+		ld->ld_md_tgts = newd;
+		ld->ld_md_tgts_nr = sz;
+	}
+
+	lsd = ld->ld_md_tgts[idx];
+	if (lsd != NULL)
+		GOTO(out, lsd);
+
+	/* DoM pages are accounted in the same cache as the OSC ones */
+	if (exp->exp_obd->u.cli.cl_cache == NULL) {
+		if (lov->lov_cache == NULL)
+			GOTO(out, lsd = ERR_PTR(-ENODEV));
+
+		rc = obd_set_info_async(env, exp, sizeof(KEY_CACHE_SET),
+					KEY_CACHE_SET, sizeof(*lov->lov_cache),
+					lov->lov_cache, NULL);
+		if (rc < 0)
+			GOTO(out, lsd = ERR_PTR(rc));
+	}
+
+	cl = cl_type_setup(env, lov2lu_dev(ld)->ld_site, &lovsub_device_type,
+			   exp->exp_obd->obd_lu_dev);
+	if (IS_ERR(cl))
+		GOTO(out, lsd = ERR_CAST(cl));
+
+	lsd = cl2lovsub_dev(cl);
+	ld->ld_md_tgts[idx] = lsd;
+	EXIT;
+out:
+	mutex_unlock(&ld->ld_md_mutex);
+	if (!IS_ERR(lsd))
+		*mdt_idx = idx;
+	return lsd;
+}
+
 static int lov_process_config(const struct lu_env *env,
                               struct lu_device *d, struct lustre_cfg *cfg)
 {
@@ -354,6 +474,7 @@ static struct lu_device *lov_device_alloc(const struct lu_env *env,
 	cl_device_init(&ld->ld_cl, t);
 	d = lov2lu_dev(ld);
 	d->ld_ops = &lov_lu_ops;
+	mutex_init(&ld->ld_md_mutex);
 
         /* setup the LOV OBD */
         obd = class_name2obd(lustre_cfg_string(cfg, 0));
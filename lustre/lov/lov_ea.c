@@ -93,7 +93,8 @@ static int lsm_lmm_verify_v1v3(struct lov_mds_md *lmm, size_t lmm_size,
 		return -EINVAL;
 	}
 
-	if (lov_pattern(le32_to_cpu(lmm->lmm_pattern)) != LOV_PATTERN_RAID0) {
+	if (lov_pattern(le32_to_cpu(lmm->lmm_pattern)) != LOV_PATTERN_RAID0 &&
+	    lov_pattern(le32_to_cpu(lmm->lmm_pattern)) != LOV_PATTERN_MDT) {
 		CERROR("bad striping pattern\n");
 		lov_dump_lmm_common(D_WARNING, lmm);
 		return -EINVAL;
@@ -165,6 +166,10 @@ lsme_unpack(struct lov_obd *lov, struct lov_mds_md *lmm, size_t buf_size,
 	pattern = le32_to_cpu(lmm->lmm_pattern);
 	if (pattern & LOV_PATTERN_F_RELEASED || !inited)
 		stripe_count = 0;
+	else if (lov_pattern(pattern) == LOV_PATTERN_MDT)
+		/* DoM component has a single stripe on the MDT, it has no
+		 * objects on disk and is set up by lov_init_raid0() */
+		stripe_count = 1;
 	else
 		stripe_count = le16_to_cpu(lmm->lmm_stripe_count);
 
@@ -192,7 +197,10 @@ lsme_unpack(struct lov_obd *lov, struct lov_mds_md *lmm, size_t buf_size,
 	lsme->lsme_flags = 0;
 	lsme->lsme_stripe_size = le32_to_cpu(lmm->lmm_stripe_size);
 	/* preserve the possible -1 stripe count for uninstantiated component */
-	lsme->lsme_stripe_count = le16_to_cpu(lmm->lmm_stripe_count);
+	if (lov_pattern(pattern) == LOV_PATTERN_MDT)
+		lsme->lsme_stripe_count = stripe_count;
+	else
+		lsme->lsme_stripe_count = le16_to_cpu(lmm->lmm_stripe_count);
 	lsme->lsme_layout_gen = le16_to_cpu(lmm->lmm_layout_gen);
 
 	if (pool_name != NULL) {
@@ -214,6 +222,9 @@ lsme_unpack(struct lov_obd *lov, struct lov_mds_md *lmm, size_t buf_size,
 
 		lsme->lsme_oinfo[i] = loi;
 
+		if (lov_pattern(pattern) == LOV_PATTERN_MDT)
+			continue;
+
 		ostid_le_to_cpu(&objects[i].l_ost_oi, &loi->loi_oi);
 		loi->loi_ost_idx = le32_to_cpu(objects[i].l_ost_idx);
 		loi->loi_ost_gen = le32_to_cpu(objects[i].l_ost_gen);
@@ -384,7 +395,8 @@ lsme_unpack_comp(struct lov_obd *lov, struct lov_mds_md *lmm,
 	unsigned int stripe_count;
 
 	stripe_count = le16_to_cpu(lmm->lmm_stripe_count);
-	if (stripe_count == 0)
+	if (stripe_count == 0 &&
+	    lov_pattern(le32_to_cpu(lmm->lmm_pattern)) != LOV_PATTERN_MDT)
 		RETURN(ERR_PTR(-EINVAL));
 	/* un-instantiated lmm contains no ost id info, i.e. lov_ost_data_v1 */
 	if (!inited)
@@ -435,6 +447,8 @@ lsm_unpackmd_comp_md_v1(struct lov_obd *lov, void *buf, size_t buf_size)
 	lsm->lsm_magic = le32_to_cpu(lcm->lcm_magic);
 	lsm->lsm_layout_gen = le32_to_cpu(lcm->lcm_layout_gen);
 	lsm->lsm_entry_count = entry_count;
+	lsm->lsm_flags = le16_to_cpu(lcm->lcm_flags) & LCM_FL_FLR_MASK;
+	lsm->lsm_mirror_count = le16_to_cpu(lcm->lcm_mirror_count);
 	lsm->lsm_is_released = true;
 	lsm->lsm_maxbytes = LLONG_MIN;
 
@@ -498,10 +512,10 @@ void dump_lsm(unsigned int level, const struct lov_stripe_md *lsm)
 	int i, j;
 
 	CDEBUG(level, "lsm %p, objid "DOSTID", maxbytes %#llx, magic 0x%08X, "
-	       "refc: %d, entry: %u, layout_gen %u\n",
+	       "refc: %d, entry: %u, layout_gen %u, flags %#x, mirrors %u\n",
 	       lsm, POSTID(&lsm->lsm_oi), lsm->lsm_maxbytes, lsm->lsm_magic,
 	       atomic_read(&lsm->lsm_refc), lsm->lsm_entry_count,
-	       lsm->lsm_layout_gen);
+	       lsm->lsm_layout_gen, lsm->lsm_flags, lsm->lsm_mirror_count);
 
 	for (i = 0; i < lsm->lsm_entry_count; i++) {
 		struct lov_stripe_md_entry *lse = lsm->lsm_entries[i];
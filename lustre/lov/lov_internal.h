@@ -76,6 +76,8 @@ struct lov_stripe_md {
 	u32		lsm_magic;
 	u32		lsm_layout_gen;
 	u32		lsm_entry_count;
+	u16		lsm_flags;	/* LCM_FL_* replication state */
+	u16		lsm_mirror_count;
 	bool		lsm_is_released;
 	struct lov_stripe_md_entry *lsm_entries[];
 };
@@ -90,6 +92,16 @@ static inline bool lsm_entry_inited(const struct lov_stripe_md *lsm, int index)
 	return lsme_inited(lsm->lsm_entries[index]);
 }
 
+static inline bool lsme_is_stale(const struct lov_stripe_md_entry *lsme)
+{
+	return lsme->lsme_flags & LCME_FL_STALE;
+}
+
+static inline bool lsme_is_dom(const struct lov_stripe_md_entry *lsme)
+{
+	return lov_pattern(lsme->lsme_pattern) == LOV_PATTERN_MDT;
+}
+
 static inline bool lsm_is_composite(__u32 magic)
 {
 	return magic == LOV_MAGIC_COMP_V1;
@@ -113,14 +125,13 @@ static inline size_t lov_comp_md_size(const struct lov_stripe_md *lsm)
 
 		lsme = lsm->lsm_entries[entry];
 
-		if (lsme_inited(lsme))
+		if (lsme_inited(lsme) && !lsme_is_dom(lsme))
 			stripe_count = lsme->lsme_stripe_count;
 		else
 			stripe_count = 0;
 
 		size += sizeof(*lsme);
-		size += lov_mds_md_size(lsme->lsme_stripe_count,
-					lsme->lsme_magic);
+		size += lov_mds_md_size(stripe_count, lsme->lsme_magic);
 	}
 
 	return size;
@@ -273,6 +273,218 @@ static int lov_io_slice_init(struct lov_io *lio,
 	RETURN(0);
 }
 
+/**
+ * Check that no component of mirror \a index overlapping \a ext is stale.
+ */
+static bool lov_io_mirror_valid(struct lov_object *obj, int index,
+				struct lu_extent *ext)
+{
+	struct lov_mirror_entry *lre = &obj->u.composite.lo_mirrors[index];
+	int i;
+
+	for (i = lre->lre_start; i < lre->lre_end; i++) {
+		struct lov_stripe_md_entry *lsme = lov_lse(obj, i);
+
+		if (lu_extent_is_overlapped(ext, &lsme->lsme_extent) &&
+		    lsme_is_stale(lsme))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Check whether mirror \a index can be written over \a ext without asking
+ * the MDT, i.e. the overlapping components of all the other mirrors have
+ * already been marked stale.
+ */
+static bool lov_io_mirror_writable(struct lov_object *obj, int index,
+				   struct lu_extent *ext)
+{
+	struct lov_layout_composite *comp = &obj->u.composite;
+	struct lov_mirror_entry *lre = &comp->lo_mirrors[index];
+	int i;
+
+	/* writes during resync must let the MDT mark the mirrors again */
+	if (comp->lo_flr_state != LCM_FL_WRITE_PENDING)
+		return false;
+
+	if (!lov_io_mirror_valid(obj, index, ext))
+		return false;
+
+	for (i = 0; i < comp->lo_entry_count; i++) {
+		struct lov_stripe_md_entry *lsme = lov_lse(obj, i);
+
+		if (i >= lre->lre_start && i < lre->lre_end)
+			continue;
+
+		if (lu_extent_is_overlapped(ext, &lsme->lsme_extent) &&
+		    !lsme_is_stale(lsme))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Estimate the load of the targets holding the data of mirror \a index
+ * over \a ext, as the number of RPCs this client has in flight to them.
+ *
+ * \retval	-1 if one of the targets is inactive
+ */
+static int lov_io_mirror_load(struct lov_object *obj, int index,
+			      struct lu_extent *ext)
+{
+	struct lov_obd *lov = lu2lov_dev(lov2lu(obj)->lo_dev)->ld_lov;
+	struct lov_mirror_entry *lre = &obj->u.composite.lo_mirrors[index];
+	int load = 0;
+	int i;
+	int j;
+
+	for (i = lre->lre_start; i < lre->lre_end; i++) {
+		struct lov_stripe_md_entry *lsme = lov_lse(obj, i);
+
+		if (!lu_extent_is_overlapped(ext, &lsme->lsme_extent) ||
+		    !lsme_inited(lsme) || lsme_is_dom(lsme) ||
+		    lsme->lsme_pattern & LOV_PATTERN_F_RELEASED)
+			continue;
+
+		for (j = 0; j < lsme->lsme_stripe_count; j++) {
+			int idx = lsme->lsme_oinfo[j]->loi_ost_idx;
+			struct lov_tgt_desc *tgt;
+			struct client_obd *cli;
+
+			if (idx >= lov->desc.ld_tgt_count)
+				return -1;
+
+			tgt = lov->lov_tgts[idx];
+			if (tgt == NULL || !tgt->ltd_active ||
+			    tgt->ltd_exp == NULL)
+				return -1;
+
+			cli = &tgt->ltd_exp->exp_obd->u.cli;
+			load += cli->cl_r_in_flight + cli->cl_w_in_flight;
+		}
+	}
+	return load;
+}
+
+/**
+ * Pick the mirror of a mirrored file that will serve \a io.
+ *
+ * A mirror designated by the application is always used. Writes need a
+ * mirror that is already the only valid one in the range, otherwise a
+ * write intent is sent to the MDT to stale the others first. Reads use the
+ * preferred mirror if it is valid, else the least loaded valid mirror,
+ * starting from a random one so that the clients spread their reads.
+ */
+static int lov_io_mirror_init(struct lov_io *lio, struct lov_object *obj,
+			      struct cl_io *io)
+{
+	struct lov_layout_composite *comp = &obj->u.composite;
+	struct lu_extent ext = {
+		.e_start = lio->lis_pos,
+		.e_end = lio->lis_endpos,
+	};
+	int best = -1;
+	int best_load = 0;
+	int fallback = -1;
+	int i;
+	ENTRY;
+
+	lio->lis_mirror_index = 0;
+
+	if (io->ci_designated_mirror > 0) {
+		if (io->ci_designated_mirror > comp->lo_mirror_count)
+			RETURN(-EINVAL);
+
+		lio->lis_mirror_index = io->ci_designated_mirror - 1;
+		RETURN(0);
+	}
+
+	if (comp->lo_mirror_count <= 1 || !lov_io_is_mirror_io(io))
+		RETURN(0);
+
+	if (io->ci_type == CIT_WRITE || io->ci_type == CIT_FAULT ||
+	    cl_io_is_trunc(io)) {
+		for (i = 0; i < comp->lo_mirror_count; i++) {
+			if (lov_io_mirror_writable(obj, i, &ext)) {
+				lio->lis_mirror_index = i;
+				RETURN(0);
+			}
+		}
+
+		/* a fault may turn out to be a read, checked again by
+		 * lov_io_iter_init() for mkwrite */
+		if (io->ci_type != CIT_FAULT) {
+			io->ci_need_write_intent = 1;
+			RETURN(-ENODATA);
+		}
+	}
+
+	if (comp->lo_preferred_mirror >= 0 &&
+	    lov_io_mirror_valid(obj, comp->lo_preferred_mirror, &ext) &&
+	    lov_io_mirror_load(obj, comp->lo_preferred_mirror, &ext) >= 0) {
+		lio->lis_mirror_index = comp->lo_preferred_mirror;
+		RETURN(0);
+	}
+
+	for (i = 0; i < comp->lo_mirror_count; i++) {
+		int index = (comp->lo_mirror_hint + i) % comp->lo_mirror_count;
+		int load;
+
+		if (!lov_io_mirror_valid(obj, index, &ext))
+			continue;
+
+		load = lov_io_mirror_load(obj, index, &ext);
+		if (load < 0) {
+			/* use a mirror on inactive targets only as last
+			 * resort */
+			if (fallback < 0)
+				fallback = index;
+			continue;
+		}
+
+		if (best < 0 || load < best_load) {
+			best = index;
+			best_load = load;
+		}
+	}
+
+	if (best < 0)
+		best = fallback;
+	if (best < 0) {
+		CDEBUG(D_VFSTRACE, DFID": no valid mirror for [%llu, %llu)\n",
+		       PFID(lu_object_fid(lov2lu(obj))), ext.e_start,
+		       ext.e_end);
+		RETURN(-EIO);
+	}
+
+	CDEBUG(D_VFSTRACE, DFID": use mirror %d, load %d\n",
+	       PFID(lu_object_fid(lov2lu(obj))), best, best_load);
+	lio->lis_mirror_index = best;
+	RETURN(0);
+}
+
+/**
+ * Find the component of the mirror used by \a lio which covers \a offset.
+ */
+int lov_io_layout_at(struct lov_io *lio, __u64 offset)
+{
+	struct lov_object *lov = lio->lis_object;
+	struct lov_mirror_entry *lre;
+	int i;
+
+	lre = &lov->u.composite.lo_mirrors[lio->lis_mirror_index];
+	for (i = lre->lre_start; i < lre->lre_end; i++) {
+		struct lu_extent *ext = &lov_lse(lov, i)->lsme_extent;
+
+		if ((offset >= ext->e_start && offset < ext->e_end) ||
+		    (offset == OBD_OBJECT_EOF && ext->e_end == OBD_OBJECT_EOF))
+			return i;
+	}
+
+	return -1;
+}
+
 static void lov_io_fini(const struct lu_env *env, const struct cl_io_slice *ios)
 {
 	struct lov_io *lio = cl2lov_io(env, ios);
@@ -396,6 +608,7 @@ static int lov_io_iter_init(const struct lu_env *env,
 	struct lov_stripe_md *lsm = lio->lis_object->lo_lsm;
 	struct lov_io_sub    *sub;
 	struct lov_layout_entry *le;
+	struct lov_mirror_entry *mirror;
 	struct lu_extent ext;
 	int index;
 	int rc = 0;
@@ -405,6 +618,15 @@ static int lov_io_iter_init(const struct lu_env *env,
 	ext.e_start = lio->lis_pos;
 	ext.e_end = lio->lis_endpos;
 
+	mirror = &lio->lis_object->u.composite.lo_mirrors[lio->lis_mirror_index];
+	if (cl_io_is_mkwrite(io) && io->ci_designated_mirror == 0 &&
+	    lio->lis_object->u.composite.lo_mirror_count > 1 &&
+	    !lov_io_mirror_writable(lio->lis_object, lio->lis_mirror_index,
+				    &ext)) {
+		io->ci_need_write_intent = 1;
+		RETURN(-ENODATA);
+	}
+
 	index = 0;
 	lov_foreach_layout_entry(lio->lis_object, le) {
 		struct lov_layout_raid0 *r0 = &le->lle_raid0;
@@ -413,6 +635,11 @@ static int lov_io_iter_init(const struct lu_env *env,
 		int stripe;
 
 		index++;
+		if (lov_io_is_mirror_io(io) &&
+		    (index - 1 < mirror->lre_start ||
+		     index - 1 >= mirror->lre_end))
+			continue;
+
 		if (!lu_extent_is_overlapped(&ext, &le->lle_extent))
 			continue;
 
@@ -493,7 +720,7 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
 	if (cl_io_is_append(io))
 		RETURN(lov_io_iter_init(env, ios));
 
-	index = lov_lsm_entry(lsm, range->cir_pos);
+	index = lov_io_layout_at(lio, range->cir_pos);
 	if (index < 0) { /* non-existing layout component */
 		if (io->ci_type == CIT_READ) {
 			/* TODO: it needs to detect the next component and
@@ -569,8 +796,8 @@ static int lov_io_setattr_iter_init(const struct lu_env *env,
 	ENTRY;
 
 	if (cl_io_is_trunc(io) && lio->lis_pos > 0) {
-		index = lov_lsm_entry(lsm, lio->lis_pos - 1);
-		if (index > 0 && !lsm_entry_inited(lsm, index)) {
+		index = lov_io_layout_at(lio, lio->lis_pos - 1);
+		if (index >= 0 && !lsm_entry_inited(lsm, index)) {
 			io->ci_need_write_intent = 1;
 			RETURN(io->ci_result = -ENODATA);
 		}
@@ -710,8 +937,9 @@ static int lov_io_read_ahead(const struct lu_env *env,
 	ENTRY;
 
 	offset = cl_offset(obj, start);
-	index = lov_lsm_entry(loo->lo_lsm, offset);
-	if (index < 0 || !lsm_entry_inited(loo->lo_lsm, index))
+	index = lov_io_layout_at(lio, offset);
+	if (index < 0 || !lsm_entry_inited(loo->lo_lsm, index) ||
+	    lsme_is_stale(lov_lse(loo, index)))
 		RETURN(-ENODATA);
 
 	stripe = lov_stripe_number(loo->lo_lsm, index, offset);
@@ -1121,6 +1349,10 @@ int lov_io_init_composite(const struct lu_env *env, struct cl_object *obj,
 	if (io->ci_result != 0)
 		RETURN(io->ci_result);
 
+	io->ci_result = lov_io_mirror_init(lio, lov, io);
+	if (io->ci_result != 0)
+		RETURN(io->ci_result);
+
 	if (io->ci_result == 0) {
 		io->ci_result = lov_io_subio_init(env, lio, io);
 		if (io->ci_result == 0) {
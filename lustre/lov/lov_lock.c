@@ -112,9 +112,11 @@ static int lov_sublock_init(const struct lu_env *env,
  */
 static struct lov_lock *lov_lock_sub_init(const struct lu_env *env,
 					  const struct cl_object *obj,
-					  struct cl_lock *lock)
+					  struct cl_lock *lock,
+					  const struct cl_io *io)
 {
 	struct lov_object *lov = cl2lov(obj);
+	struct lov_io *lio = lov_env_io(env);
 	struct lov_lock *lovlck;
 	struct lu_extent ext;
 	loff_t start;
@@ -122,6 +124,8 @@ static struct lov_lock *lov_lock_sub_init(const struct lu_env *env,
 	int result = 0;
 	int i;
 	int index;
+	int first;
+	int last;
 	int nr;
 
 	ENTRY;
@@ -132,15 +136,28 @@ static struct lov_lock *lov_lock_sub_init(const struct lu_env *env,
 	else
 		ext.e_end  = cl_offset(obj, lock->cll_descr.cld_end + 1);
 
+	/* only lock the mirror the IO is going to use */
+	first = 0;
+	last = lov->lo_lsm->lsm_entry_count;
+	if (io != NULL && lio->lis_cl.cis_io == io &&
+	    lio->lis_object == lov && lov_io_is_mirror_io(io)) {
+		struct lov_mirror_entry *lre;
+
+		lre = &lov->u.composite.lo_mirrors[lio->lis_mirror_index];
+		first = lre->lre_start;
+		last = lre->lre_end;
+	} else if (lov->u.composite.lo_mirror_count > 1 &&
+		   lov->u.composite.lo_mirrors != NULL) {
+		last = lov->u.composite.lo_mirrors[0].lre_end;
+	}
+
 	nr = 0;
-	for (index = lov_lsm_entry(lov->lo_lsm, ext.e_start);
-	     index >= 0 && index < lov->lo_lsm->lsm_entry_count; index++) {
+	for (index = first; index < last; index++) {
 		struct lov_layout_raid0 *r0 = lov_r0(lov, index);
 
-		/* assume lsm entries are sorted. */
 		if (!lu_extent_is_overlapped(&ext,
 					     &lov_lse(lov, index)->lsme_extent))
-			break;
+			continue;
 
 		for (i = 0; i < r0->lo_nr; i++) {
 			if (likely(r0->lo_sub[i] != NULL) && /* spare layout */
@@ -161,14 +178,12 @@ static struct lov_lock *lov_lock_sub_init(const struct lu_env *env,
 
 	lovlck->lls_nr = nr;
 	nr = 0;
-	for (index = lov_lsm_entry(lov->lo_lsm, ext.e_start);
-	     index >= 0 && index < lov->lo_lsm->lsm_entry_count; index++) {
+	for (index = first; index < last; index++) {
 		struct lov_layout_raid0 *r0 = lov_r0(lov, index);
 
-		/* assume lsm entries are sorted. */
 		if (!lu_extent_is_overlapped(&ext,
 					     &lov_lse(lov, index)->lsme_extent))
-			break;
+			continue;
 		for (i = 0; i < r0->lo_nr; ++i) {
 			struct lov_lock_sub *lls = &lovlck->lls_sub[nr];
 			struct cl_lock_descr *descr = &lls->sub_lock.cll_descr;
@@ -331,7 +346,7 @@ int lov_lock_init_composite(const struct lu_env *env, struct cl_object *obj,
 	int result = 0;
 
 	ENTRY;
-	lck = lov_lock_sub_init(env, obj, lock);
+	lck = lov_lock_sub_init(env, obj, lock, io);
 	if (!IS_ERR(lck))
 		cl_lock_slice_add(lock, &lck->lls_cl, obj, &lov_lock_ops);
 	else
@@ -232,20 +232,40 @@ static int lov_init_raid0(const struct lu_env *env, struct lov_device *dev,
 		struct lov_oinfo *oinfo = lse->lsme_oinfo[i];
 		int ost_idx = oinfo->loi_ost_idx;
 
-		if (lov_oinfo_is_dummy(oinfo))
-			continue;
-
-		result = ostid_to_fid(ofid, &oinfo->loi_oi, oinfo->loi_ost_idx);
-		if (result != 0)
-			GOTO(out, result);
+		if (lsme_is_dom(lse)) {
+			struct lovsub_device *lsd;
+			__u32 mdt_idx;
+
+			/* the data is in the file itself on its MDT, the
+			 * sub-object is found by a FID distinct from the
+			 * one of the top object */
+			lsd = lov_md_target(env, dev, lu_object_fid(lov2lu(lov)),
+					    &mdt_idx);
+			if (IS_ERR(lsd))
+				GOTO(out, result = PTR_ERR(lsd));
+
+			oinfo->loi_oi.oi_fid = *lu_object_fid(lov2lu(lov));
+			oinfo->loi_ost_idx = mdt_idx;
+			*ofid = oinfo->loi_oi.oi_fid;
+			ofid->f_ver = LOV_DOM_FID_VER;
+			subdev = lovsub2cl_dev(lsd);
+		} else {
+			if (lov_oinfo_is_dummy(oinfo))
+				continue;
+
+			result = ostid_to_fid(ofid, &oinfo->loi_oi,
+					      oinfo->loi_ost_idx);
+			if (result != 0)
+				GOTO(out, result);
+
+			if (dev->ld_target[ost_idx] == NULL) {
+				CERROR("%s: OST %04x is not initialized\n",
+				       lov2obd(dev->ld_lov)->obd_name, ost_idx);
+				GOTO(out, result = -EIO);
+			}
 
-		if (dev->ld_target[ost_idx] == NULL) {
-			CERROR("%s: OST %04x is not initialized\n",
-			       lov2obd(dev->ld_lov)->obd_name, ost_idx);
-			GOTO(out, result = -EIO);
+			subdev = lovsub2cl_dev(dev->ld_target[ost_idx]);
 		}
-
-		subdev = lovsub2cl_dev(dev->ld_target[ost_idx]);
 		subconf->u.coc_oinfo = oinfo;
 		LASSERTF(subdev != NULL, "not init ost %d\n", ost_idx);
 		/* In the function below, .hs_keycmp resolves to
@@ -281,7 +301,9 @@ static int lov_init_composite(const struct lu_env *env, struct lov_device *dev,
 			      union lov_layout_state *state)
 {
 	struct lov_layout_composite *comp = &state->composite;
+	struct lov_mirror_entry *lre = NULL;
 	unsigned int entry_count;
+	unsigned int mirror_count = 0;
 	unsigned int psz = 0;
 	int result = 0;
 	int i;
@@ -295,6 +317,21 @@ static int lov_init_composite(const struct lu_env *env, struct lov_device *dev,
 
 	entry_count = lsm->lsm_entry_count;
 	comp->lo_entry_count = entry_count;
+	comp->lo_flr_state = lsm->lsm_flags;
+	comp->lo_preferred_mirror = -1;
+
+	/* a mirror starts with the first component, or with any other
+	 * component starting at offset 0 */
+	for (i = 0; i < entry_count; i++)
+		if (i == 0 || lsm->lsm_entries[i]->lsme_extent.e_start == 0)
+			mirror_count++;
+	comp->lo_mirror_count = mirror_count;
+	comp->lo_mirror_hint = mirror_count > 1 ?
+			       cfs_rand() % mirror_count : 0;
+
+	OBD_ALLOC(comp->lo_mirrors, mirror_count * sizeof(*comp->lo_mirrors));
+	if (comp->lo_mirrors == NULL)
+		RETURN(-ENOMEM);
 
 	OBD_ALLOC(comp->lo_entries, entry_count * sizeof(*comp->lo_entries));
 	if (comp->lo_entries == NULL)
@@ -304,6 +341,17 @@ static int lov_init_composite(const struct lu_env *env, struct lov_device *dev,
 		struct lov_layout_entry *le = &comp->lo_entries[i];
 
 		le->lle_extent = lsm->lsm_entries[i]->lsme_extent;
+
+		if (lre == NULL || le->lle_extent.e_start == 0) {
+			lre = lre == NULL ? comp->lo_mirrors : lre + 1;
+			lre->lre_start = i;
+		}
+		lre->lre_end = i + 1;
+
+		if (lsm->lsm_entries[i]->lsme_flags & LCME_FL_PREFERRED &&
+		    comp->lo_preferred_mirror < 0)
+			comp->lo_preferred_mirror = lre - comp->lo_mirrors;
+
 		/**
 		 * If the component has not been init-ed on MDS side, for
 		 * PFL layout, we'd know that the components beyond this one
@@ -508,6 +556,12 @@ static void lov_fini_composite(const struct lu_env *env,
 		comp->lo_entries = NULL;
 	}
 
+	if (comp->lo_mirrors != NULL) {
+		OBD_FREE(comp->lo_mirrors,
+			 comp->lo_mirror_count * sizeof(*comp->lo_mirrors));
+		comp->lo_mirrors = NULL;
+	}
+
 	dump_lsm(D_INODE, lov->lo_lsm);
 	lov_free_memmd(&lov->lo_lsm);
 
@@ -555,8 +609,10 @@ static int lov_print_composite(const struct lu_env *env, void *cookie,
 	struct lov_stripe_md *lsm = lov->lo_lsm;
 	int i;
 
-	(*p)(env, cookie, "entries: %d, %s, lsm{%p 0x%08X %d %u}:\n",
-	     lsm->lsm_entry_count,
+	(*p)(env, cookie, "entries: %d, mirrors: %u, flr_state: %#x, %s, "
+	     "lsm{%p 0x%08X %d %u}:\n",
+	     lsm->lsm_entry_count, lov->u.composite.lo_mirror_count,
+	     lov->u.composite.lo_flr_state,
 	     lov->lo_layout_invalid ? "invalid" : "valid", lsm,
 	     lsm->lsm_magic, atomic_read(&lsm->lsm_refc),
 	     lsm->lsm_layout_gen);
@@ -661,19 +717,25 @@ static int lov_attr_get_composite(const struct lu_env *env,
 	attr->cat_size = 0;
 	attr->cat_blocks = 0;
 	lov_foreach_layout_entry(lov, entry) {
+		struct lov_stripe_md_entry *lsme;
 		struct lov_layout_raid0 *r0 = &entry->lle_raid0;
 		struct cl_attr *lov_attr = &r0->lo_attr;
 
-		/* PFL: This component has not been init-ed. */
-		if (!lsm_entry_inited(lov->lo_lsm, index))
-			break;
+		lsme = lov->lo_lsm->lsm_entries[index++];
 
-		result = lov_attr_get_raid0(env, lov, index, r0);
+		/* PFL: This component has not been init-ed, the following
+		 * ones may be init-ed in the other mirrors of the file. */
+		if (!lsme_inited(lsme))
+			continue;
+
+		/* FLR: the data of a stale component is out of date */
+		if (lsme_is_stale(lsme))
+			continue;
+
+		result = lov_attr_get_raid0(env, lov, index - 1, r0);
 		if (result != 0)
 			break;
 
-		index++;
-
 		/* merge results */
 		attr->cat_blocks += lov_attr->cat_blocks;
 		if (attr->cat_size < lov_attr->cat_size)
@@ -1454,6 +1516,11 @@ static int lov_object_fiemap(const struct lu_env *env, struct cl_object *obj,
 	if (lsm == NULL)
 		RETURN(-ENODATA);
 
+	/* DoM data is not mapped to OST objects */
+	if (lsm_is_composite(lsm->lsm_magic) &&
+	    lsme_is_dom(lsm->lsm_entries[0]))
+		GOTO(out_lsm, rc = -EOPNOTSUPP);
+
 	if (!(fiemap->fm_flags & FIEMAP_FLAG_DEVICE_ORDER)) {
 		/**
 		 * If the entry count > 1 or stripe_count > 1 and the
@@ -210,6 +210,8 @@ ssize_t lov_lsm_pack(const struct lov_stripe_md *lsm, void *buf,
 	lcmv1->lcm_size = cpu_to_le32(lmm_size);
 	lcmv1->lcm_layout_gen = cpu_to_le32(lsm->lsm_layout_gen);
 	lcmv1->lcm_entry_count = cpu_to_le16(lsm->lsm_entry_count);
+	lcmv1->lcm_flags = cpu_to_le16(lsm->lsm_flags);
+	lcmv1->lcm_mirror_count = cpu_to_le16(lsm->lsm_mirror_count);
 
 	offset = sizeof(*lcmv1) + sizeof(*lcme) * lsm->lsm_entry_count;
 
@@ -234,7 +236,12 @@ ssize_t lov_lsm_pack(const struct lov_stripe_md *lsm, void *buf,
 		/* lmm->lmm_oi not set */
 		lmm->lmm_pattern = cpu_to_le32(lsme->lsme_pattern);
 		lmm->lmm_stripe_size = cpu_to_le32(lsme->lsme_stripe_size);
-		lmm->lmm_stripe_count = cpu_to_le16(lsme->lsme_stripe_count);
+		/* DoM component has no objects, its stripe is the MDT one */
+		if (lsme_is_dom(lsme))
+			lmm->lmm_stripe_count = 0;
+		else
+			lmm->lmm_stripe_count =
+				cpu_to_le16(lsme->lsme_stripe_count);
 		lmm->lmm_layout_gen = cpu_to_le16(lsme->lsme_layout_gen);
 
 		if (lsme->lsme_magic == LOV_MAGIC_V3) {
@@ -249,7 +256,7 @@ ssize_t lov_lsm_pack(const struct lov_stripe_md *lsm, void *buf,
 				((struct lov_mds_md_v1 *)lmm)->lmm_objects;
 		}
 
-		if (lsme_inited(lsme) &&
+		if (lsme_inited(lsme) && !lsme_is_dom(lsme) &&
 		    !(lsme->lsme_pattern & LOV_PATTERN_F_RELEASED))
 			stripe_count = lsme->lsme_stripe_count;
 		else
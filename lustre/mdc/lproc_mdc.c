@@ -145,6 +145,73 @@ static ssize_t mdc_max_mod_rpcs_in_flight_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(mdc_max_mod_rpcs_in_flight);
 
+static int mdc_batch_reint_max_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *dev = m->private;
+
+	seq_printf(m, "%hu\n", dev->u.cli.cl_batch_max);
+
+	return 0;
+}
+
+/* 0 or 1 disables MDS_BATCH_REINT */
+static ssize_t mdc_batch_reint_max_seq_write(struct file *file,
+					     const char __user *buffer,
+					     size_t count, loff_t *off)
+{
+	struct obd_device *dev =
+			((struct seq_file *)file->private_data)->private;
+	struct client_obd *cli = &dev->u.cli;
+	__s64 val;
+	int rc;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > BATCH_REINT_MAX)
+		return -ERANGE;
+
+	spin_lock(&cli->cl_mod_rpcs_lock);
+	cli->cl_batch_max = val;
+	spin_unlock(&cli->cl_mod_rpcs_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(mdc_batch_reint_max);
+
+static int mdc_batch_reint_window_us_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *dev = m->private;
+
+	seq_printf(m, "%u\n", dev->u.cli.cl_batch_window_us);
+
+	return 0;
+}
+
+static ssize_t mdc_batch_reint_window_us_seq_write(struct file *file,
+						   const char __user *buffer,
+						   size_t count, loff_t *off)
+{
+	struct obd_device *dev =
+			((struct seq_file *)file->private_data)->private;
+	__s64 val;
+	int rc;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* the window has to stay well below a network round trip */
+	if (val < 0 || val > USEC_PER_SEC / 10)
+		return -ERANGE;
+
+	dev->u.cli.cl_batch_window_us = val;
+
+	return count;
+}
+LPROC_SEQ_FOPS(mdc_batch_reint_window_us);
+
 static int mdc_rpc_stats_seq_show(struct seq_file *seq, void *v)
 {
 	struct obd_device *dev = seq->private;
@@ -214,6 +281,10 @@ struct lprocfs_vars lprocfs_mdc_obd_vars[] = {
 	  .fops	=	&mdc_max_rpcs_in_flight_fops	},
 	{ .name	=	"max_mod_rpcs_in_flight",
 	  .fops	=	&mdc_max_mod_rpcs_in_flight_fops	},
+	{ .name	=	"batch_reint_max",
+	  .fops	=	&mdc_batch_reint_max_fops	},
+	{ .name	=	"batch_reint_window_us",
+	  .fops	=	&mdc_batch_reint_window_us_fops	},
 	{ .name	=	"timeouts",
 	  .fops	=	&mdc_timeouts_fops		},
 	{ .name	=	"import",
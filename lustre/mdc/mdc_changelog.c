@@ -34,6 +34,7 @@
 #include <linux/miscdevice.h>
 
 #include <lustre_log.h>
+#include <uapi/linux/lustre_ioctl.h>
 
 #include "mdc_internal.h"
 
@@ -87,6 +88,8 @@ struct chlg_reader_state {
 	__u64			 crs_rec_count;
 	/* List of prefetched enqueued_record::enq_linkage_items */
 	struct list_head	 crs_rec_queue;
+	/* Records to deliver, protected by crs_lock */
+	struct changelog_filter	 crs_filter;
 };
 
 struct chlg_rec_entry {
@@ -103,6 +106,44 @@ enum {
 	CDEV_CHLG_MAX_PREFETCH = 1024,
 };
 
+/**
+ * Check whether a changelog record is of interest to the reader.
+ *
+ * @param[in] cf   Filter of the reader, zeroed fields match all records.
+ * @param[in] rec  Changelog record.
+ *
+ * @return true if the record is to be delivered.
+ */
+static bool chlg_rec_match(const struct changelog_filter *cf,
+			   const struct changelog_rec *rec)
+{
+	if (cf->cf_mask != 0 &&
+	    (rec->cr_type >= 32 || !(cf->cf_mask & (1U << rec->cr_type))))
+		return false;
+
+	if (!fid_is_zero(&cf->cf_fid) && rec->cr_type != CL_MARK &&
+	    !lu_fid_eq(&rec->cr_tfid, &cf->cf_fid) &&
+	    !lu_fid_eq(&rec->cr_pfid, &cf->cf_fid)) {
+		struct changelog_ext_rename *rnm;
+
+		if (!(rec->cr_flags & CLF_RENAME))
+			return false;
+
+		rnm = changelog_rec_rename(rec);
+		if (!lu_fid_eq(&rnm->cr_sfid, &cf->cf_fid) &&
+		    !lu_fid_eq(&rnm->cr_spfid, &cf->cf_fid))
+			return false;
+	}
+
+	if (cf->cf_jobid[0] != '\0' &&
+	    (!(rec->cr_flags & CLF_JOBID) ||
+	     strncmp(changelog_rec_jobid(rec)->cr_jobid, cf->cf_jobid,
+		     sizeof(cf->cf_jobid)) != 0))
+		return false;
+
+	return true;
+}
+
 /**
  * ChangeLog catalog processing callback invoked on each record.
  * If the current record is eligible to userland delivery, push
@@ -124,6 +165,7 @@ static int chlg_read_cat_process_cb(const struct lu_env *env,
 	struct chlg_rec_entry *enq;
 	struct l_wait_info lwi = { 0 };
 	size_t len;
+	bool match;
 	int rc;
 	ENTRY;
 
@@ -152,6 +194,13 @@ static int chlg_read_cat_process_cb(const struct lu_env *env,
 	       PFID(&rec->cr.cr_tfid), PFID(&rec->cr.cr_pfid),
 	       rec->cr.cr_namelen, changelog_rec_name(&rec->cr));
 
+	/* Skip the records filtered out before they use a prefetch slot */
+	mutex_lock(&crs->crs_lock);
+	match = chlg_rec_match(&crs->crs_filter, &rec->cr);
+	mutex_unlock(&crs->crs_lock);
+	if (!match)
+		RETURN(0);
+
 	l_wait_event(crs->crs_waitq_prod,
 		     (crs->crs_rec_count < CDEV_CHLG_MAX_PREFETCH ||
 		      kthread_should_stop()), &lwi);
@@ -168,11 +217,20 @@ static int chlg_read_cat_process_cb(const struct lu_env *env,
 	enq->enq_length = len;
 	memcpy(enq->enq_record, &rec->cr, len);
 
+	/* the filter may have changed while waiting for a slot */
 	mutex_lock(&crs->crs_lock);
-	list_add_tail(&enq->enq_linkage, &crs->crs_rec_queue);
-	crs->crs_rec_count++;
+	match = chlg_rec_match(&crs->crs_filter, enq->enq_record);
+	if (match) {
+		list_add_tail(&enq->enq_linkage, &crs->crs_rec_queue);
+		crs->crs_rec_count++;
+	}
 	mutex_unlock(&crs->crs_lock);
 
+	if (!match) {
+		OBD_FREE(enq, sizeof(*enq) + len);
+		RETURN(0);
+	}
+
 	wake_up_all(&crs->crs_waitq_cons);
 
 	RETURN(0);
@@ -449,6 +507,67 @@ out_kbuf:
 	return rc < 0 ? rc : count;
 }
 
+/**
+ * Set the filter of the records delivered to this reader. The records
+ * already prefetched which do not match the new filter are dropped.
+ *
+ * @param[in]  crs  Current internal state.
+ * @param[in]  arg  User pointer to struct changelog_filter.
+ * @return 0 on success, negated error code on failure.
+ */
+static int chlg_set_filter(struct chlg_reader_state *crs,
+			   void __user *arg)
+{
+	struct changelog_filter cf;
+	struct chlg_rec_entry *rec;
+	struct chlg_rec_entry *tmp;
+
+	if (copy_from_user(&cf, arg, sizeof(cf)))
+		return -EFAULT;
+
+	cf.cf_jobid[sizeof(cf.cf_jobid) - 1] = '\0';
+
+	mutex_lock(&crs->crs_lock);
+	crs->crs_filter = cf;
+	list_for_each_entry_safe(rec, tmp, &crs->crs_rec_queue, enq_linkage) {
+		if (chlg_rec_match(&cf, rec->enq_record))
+			continue;
+
+		crs->crs_rec_count--;
+		enq_record_delete(rec);
+	}
+	mutex_unlock(&crs->crs_lock);
+
+	wake_up_all(&crs->crs_waitq_prod);
+	return 0;
+}
+
+/**
+ * Handle ioctl() on the changelog character device.
+ *
+ * @param[in]  file  File pointer to the changelog character device
+ * @param[in]  cmd   Ioctl command
+ * @param[in]  arg   Ioctl argument
+ * @return 0 on success, negated error code on failure.
+ */
+static long chlg_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+	struct chlg_reader_state *crs = file->private_data;
+	int rc;
+	ENTRY;
+
+	switch (cmd) {
+	case OBD_IOC_CHLG_SET_FILTER:
+		rc = chlg_set_filter(crs, (void __user *)arg);
+		break;
+	default:
+		rc = -ENOTTY;
+		break;
+	}
+
+	RETURN(rc);
+}
+
 /**
  * Find the OBD device associated to a changelog character device.
  * @param[in]  cdev  character device instance descriptor
@@ -580,6 +699,7 @@ static const struct file_operations chlg_fops = {
 	.open		= chlg_open,
 	.release	= chlg_release,
 	.poll		= chlg_poll,
+	.unlocked_ioctl	= chlg_ioctl,
 };
 
 /**
@@ -0,0 +1,120 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2017, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Implementation of cl_device for the MDC, used for Data-on-MDT.
+ *
+ * The data of a DoM component is accessed through the same cl_object,
+ * cl_page and cl_lock slices as OST objects, the MDC just provides an
+ * osc_device on top of its own import. The I/O requests are sent to the
+ * MDS_IO_PORTAL and the extent locks are taken on the DoM resource of the
+ * file, see osc_io_portal() and osc_build_res_name().
+ */
+
+#define DEBUG_SUBSYSTEM S_MDC
+
+#include <obd_class.h>
+
+#include "mdc_internal.h"
+#include "../osc/osc_cl_internal.h"
+
+static int mdc_cl_process_config(const struct lu_env *env,
+				 struct lu_device *d, struct lustre_cfg *cfg)
+{
+	return mdc_process_config(d->ld_obd, 0, cfg);
+}
+
+static const struct lu_device_operations mdc_lu_ops = {
+	.ldo_object_alloc	= osc_object_alloc,
+	.ldo_process_config	= mdc_cl_process_config,
+	.ldo_recovery_complete	= NULL,
+};
+
+static int mdc_device_init(const struct lu_env *env, struct lu_device *d,
+			   const char *name, struct lu_device *next)
+{
+	return 0;
+}
+
+static struct lu_device *mdc_device_fini(const struct lu_env *env,
+					 struct lu_device *d)
+{
+	return NULL;
+}
+
+static struct lu_device *mdc_device_free(const struct lu_env *env,
+					 struct lu_device *d)
+{
+	struct osc_device *od = lu2osc_dev(d);
+
+	cl_device_fini(lu2cl_dev(d));
+	OBD_FREE_PTR(od);
+	return NULL;
+}
+
+static struct lu_device *mdc_device_alloc(const struct lu_env *env,
+					  struct lu_device_type *t,
+					  struct lustre_cfg *cfg)
+{
+	struct lu_device *d;
+	struct osc_device *od;
+	struct obd_device *obd;
+	int rc;
+
+	OBD_ALLOC_PTR(od);
+	if (od == NULL)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	cl_device_init(&od->od_cl, t);
+	d = &od->od_cl.cd_lu_dev;
+	d->ld_ops = &mdc_lu_ops;
+	od->od_dom = true;
+
+	/* Setup MDC OBD */
+	obd = class_name2obd(lustre_cfg_string(cfg, 0));
+	LASSERT(obd != NULL);
+	rc = mdc_setup(obd, cfg);
+	if (rc < 0) {
+		mdc_device_free(env, d);
+		RETURN(ERR_PTR(rc));
+	}
+	od->od_exp = obd->obd_self_export;
+	RETURN(d);
+}
+
+static const struct lu_device_type_operations mdc_device_type_ops = {
+	.ldto_device_alloc	= mdc_device_alloc,
+	.ldto_device_free	= mdc_device_free,
+	.ldto_device_init	= mdc_device_init,
+	.ldto_device_fini	= mdc_device_fini,
+};
+
+struct lu_device_type mdc_device_type = {
+	.ldt_tags	= LU_DEVICE_CL,
+	.ldt_name	= LUSTRE_MDC_NAME,
+	.ldt_ops	= &mdc_device_type_ops,
+	.ldt_ctx_tags	= LCT_CL_THREAD,
+};
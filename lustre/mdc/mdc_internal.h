@@ -44,7 +44,7 @@ void mdc_pack_body(struct ptlrpc_request *req, const struct lu_fid *fid,
 void mdc_swap_layouts_pack(struct ptlrpc_request *req,
 			   struct md_op_data *op_data);
 void mdc_readdir_pack(struct ptlrpc_request *req, __u64 pgoff, size_t size,
-		      const struct lu_fid *fid);
+		      const struct lu_fid *fid, __u32 attrs);
 void mdc_getattr_pack(struct ptlrpc_request *req, __u64 valid, __u32 flags,
 		      struct md_op_data *data, size_t ea_size);
 void mdc_setattr_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
@@ -136,6 +136,8 @@ int mdc_revalidate_lock(struct obd_export *exp, struct lookup_intent *it,
 
 int mdc_intent_getattr_async(struct obd_export *exp,
 			     struct md_enqueue_info *minfo);
+int mdc_batch_getattr_async(struct obd_export *exp,
+			    struct md_enqueue_info **minfos, unsigned int count);
 
 enum ldlm_mode mdc_lock_match(struct obd_export *exp, __u64 flags,
 			      const struct lu_fid *fid, enum ldlm_type type,
@@ -145,6 +147,12 @@ enum ldlm_mode mdc_lock_match(struct obd_export *exp, __u64 flags,
 
 int mdc_changelog_cdev_init(struct obd_device *obd);
 
+int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg);
+int mdc_process_config(struct obd_device *obd, size_t len, void *buf);
+
+/* mdc_dev.c */
+extern struct lu_device_type mdc_device_type;
+
 void mdc_changelog_cdev_finish(struct obd_device *obd);
 
 static inline int mdc_prep_elc_req(struct obd_export *exp,
@@ -149,7 +149,7 @@ void mdc_file_secctx_pack(struct ptlrpc_request *req, const char *secctx_name,
 }
 
 void mdc_readdir_pack(struct ptlrpc_request *req, __u64 pgoff, size_t size,
-		      const struct lu_fid *fid)
+		      const struct lu_fid *fid, __u32 attrs)
 {
         struct mdt_body *b = req_capsule_client_get(&req->rq_pill,
                                                     &RMF_MDT_BODY);
@@ -158,7 +158,7 @@ void mdc_readdir_pack(struct ptlrpc_request *req, __u64 pgoff, size_t size,
 	b->mbo_size = pgoff;		       /* !! */
 	b->mbo_nlink = size;			/* !! */
 	__mdc_pack_body(b, -1);
-	b->mbo_mode = LUDA_FID | LUDA_TYPE;
+	b->mbo_mode = attrs;
 }
 
 /* packing of MDS records */
@@ -446,7 +446,7 @@ static void mdc_intent_close_pack(struct ptlrpc_request *req,
 	enum mds_op_bias	 bias = op_data->op_bias;
 
 	if (!(bias & (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP |
-		      MDS_RENAME_MIGRATE)))
+		      MDS_CLOSE_RESYNC_DONE | MDS_RENAME_MIGRATE)))
 		return;
 
 	data = req_capsule_client_get(&req->rq_pill, &RMF_CLOSE_DATA);
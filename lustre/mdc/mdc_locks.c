@@ -33,9 +33,11 @@
 #define DEBUG_SUBSYSTEM S_MDC
 
 #include <linux/module.h>
+#include <linux/user_namespace.h>
 
 #include <obd.h>
 #include <obd_class.h>
+#include <lustre_acl.h>
 #include <lustre_dlm.h>
 #include <lustre_fid.h>
 #include <lustre_intent.h>
@@ -51,6 +53,12 @@ struct mdc_getattr_args {
 	struct md_enqueue_info		*ga_minfo;
 };
 
+struct mdc_batch_getattr_args {
+	struct obd_export		*bga_exp;
+	struct md_enqueue_info	       **bga_minfos;
+	unsigned int			 bga_count;
+};
+
 int it_open_error(int phase, struct lookup_intent *it)
 {
 	if (it_disposition(it, DISP_OPEN_LEASE)) {
@@ -1280,3 +1288,269 @@ int mdc_intent_getattr_async(struct obd_export *exp,
 
 	RETURN(0);
 }
+
+/* room for the ACL of one entry in a MDS_BATCH_GETATTR reply */
+static inline __u32 mdc_batch_getattr_aclsize(struct obd_export *exp)
+{
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_ACL))
+		return 0;
+
+	return LUSTRE_POSIX_ACL_MAX_SIZE_OLD;
+}
+
+/* unpack the attributes of one entry of a MDS_BATCH_GETATTR reply */
+static int mdc_batch_getattr_unpack(struct mdt_batch_getattr_rep *rep,
+				    struct lustre_md *md)
+{
+	struct mdt_body *body = &rep->mbp_body;
+	int rc = 0;
+	ENTRY;
+
+	memset(md, 0, sizeof(*md));
+	md->body = body;
+
+	if (body->mbo_valid & OBD_MD_FLEASIZE) {
+		if (!S_ISREG(body->mbo_mode) || body->mbo_eadatasize == 0)
+			RETURN(-EPROTO);
+
+		md->layout.lb_buf = rep->mbp_data;
+		md->layout.lb_len = body->mbo_eadatasize;
+	}
+
+#ifdef CONFIG_FS_POSIX_ACL
+	if ((body->mbo_valid & OBD_MD_FLACL) && body->mbo_aclsize != 0) {
+		struct posix_acl *acl;
+
+		acl = posix_acl_from_xattr(&init_user_ns, rep->mbp_data +
+					   cfs_size_round(body->mbo_eadatasize),
+					   body->mbo_aclsize);
+		if (IS_ERR(acl))
+			RETURN(PTR_ERR(acl));
+
+		if (acl != NULL) {
+			rc = posix_acl_valid(&init_user_ns, acl);
+			if (rc != 0) {
+				posix_acl_release(acl);
+				RETURN(rc);
+			}
+		}
+		md->posix_acl = acl;
+	}
+#endif
+	RETURN(rc);
+}
+
+static int mdc_batch_getattr_interpret(const struct lu_env *env,
+				       struct ptlrpc_request *req,
+				       void *args, int rc)
+{
+	struct mdc_batch_getattr_args *bga = args;
+	struct obd_export *exp = bga->bga_exp;
+	struct mdt_batch_getattr *hdr = NULL;
+	char *buf = NULL;
+	char *end = NULL;
+	unsigned int i;
+	ENTRY;
+
+	obd_put_request_slot(&class_exp2obd(exp)->u.cli);
+
+	if (rc == 0) {
+		int size = req_capsule_get_size(&req->rq_pill,
+						&RMF_BATCH_GETATTR, RCL_SERVER);
+
+		hdr = req_capsule_server_get(&req->rq_pill,
+					     &RMF_BATCH_GETATTR);
+		if (hdr == NULL || size < (int)sizeof(*hdr))
+			GOTO(items, rc = -EPROTO);
+
+		if (ptlrpc_rep_need_swab(req))
+			lustre_swab_mdt_batch_getattr(hdr);
+		if (hdr->mbg_count != bga->bga_count)
+			GOTO(items, rc = -EPROTO);
+
+		buf = (char *)(hdr + 1);
+		end = (char *)hdr + size;
+	}
+
+items:
+	for (i = 0; i < bga->bga_count; i++) {
+		struct md_enqueue_info *minfo = bga->bga_minfos[i];
+		struct lookup_intent *it = &minfo->mi_it;
+		struct mdt_batch_getattr_rep *rep = NULL;
+		__u64 flags = 0;
+		int rc2 = rc;
+
+		if (rc2 == 0 && buf + sizeof(*rep) > end)
+			rc2 = -EPROTO;
+		if (rc2 == 0) {
+			rep = (struct mdt_batch_getattr_rep *)buf;
+			if (ptlrpc_rep_need_swab(req))
+				lustre_swab_mdt_batch_getattr_rep(rep);
+			buf += sizeof(*rep) +
+			       cfs_size_round(rep->mbp_body.mbo_eadatasize) +
+			       cfs_size_round(rep->mbp_body.mbo_aclsize);
+			if (buf > end)
+				rc2 = -EPROTO;
+			else
+				rc2 = rep->mbp_rc;
+		}
+
+		rc2 = ldlm_cli_enqueue_fini_reply(exp, rep != NULL ?
+						  &rep->mbp_lockrep : NULL,
+						  minfo->mi_einfo.ei_type,
+						  minfo->mi_einfo.ei_mode,
+						  &flags, &minfo->mi_lockh,
+						  rc2);
+		if (rc2 == 0) {
+			it->it_status = 0;
+			it->it_lock_mode = minfo->mi_einfo.ei_mode;
+			it->it_lock_handle = minfo->mi_lockh.cookie;
+			rc2 = mdc_batch_getattr_unpack(rep, &minfo->mi_md);
+			if (rc2 != 0)
+				memset(&minfo->mi_md, 0, sizeof(minfo->mi_md));
+		}
+
+		minfo->mi_cb(req, minfo, rc2);
+	}
+
+	OBD_FREE(bga->bga_minfos, bga->bga_count * sizeof(*bga->bga_minfos));
+	RETURN(0);
+}
+
+/**
+ * Send an async MDS_BATCH_GETATTR for \a count entries of the same directory.
+ *
+ * Each \a minfos entry is prepared as for mdc_intent_getattr_async(), with the
+ * FID of the child in op_fid2, and its callback is called once the reply is
+ * received, with the entry attributes unpacked in mi_md. The callbacks are not
+ * called if this function returns an error.
+ */
+int mdc_batch_getattr_async(struct obd_export *exp,
+			    struct md_enqueue_info **minfos, unsigned int count)
+{
+	struct obd_device *obddev = class_exp2obd(exp);
+	struct md_op_data *op_data = &minfos[0]->mi_data;
+	struct mdc_batch_getattr_args *bga;
+	struct md_enqueue_info **items;
+	struct mdt_batch_getattr *hdr;
+	struct mdt_body *body;
+	struct ptlrpc_request *req;
+	union ldlm_policy_data policy = {
+			.l_inodebits = { MDS_INODELOCK_LOOKUP |
+					 MDS_INODELOCK_UPDATE |
+					 MDS_INODELOCK_PERM } };
+	__u64 valid = OBD_MD_FLGETATTR | OBD_MD_FLEASIZE | OBD_MD_FLDIREA;
+	__u32 easize;
+	__u32 aclsize;
+	int reqsize = sizeof(*hdr);
+	int repsize;
+	char *buf;
+	unsigned int i;
+	int rc;
+	ENTRY;
+
+	if (!exp_connect_batch_getattr(exp))
+		RETURN(-EOPNOTSUPP);
+	if (count == 0 || count > MDS_BATCH_GETATTR_MAX)
+		RETURN(-EINVAL);
+
+	if (obddev->u.cli.cl_default_mds_easize > 0)
+		easize = obddev->u.cli.cl_default_mds_easize;
+	else
+		easize = obddev->u.cli.cl_max_mds_easize;
+	aclsize = mdc_batch_getattr_aclsize(exp);
+	if (aclsize > 0)
+		valid |= OBD_MD_FLACL;
+
+	for (i = 0; i < count; i++)
+		reqsize += cfs_size_round(sizeof(struct mdt_batch_getattr_req) +
+					  minfos[i]->mi_data.op_namelen + 1);
+	repsize = sizeof(*hdr) + count *
+		  (sizeof(struct mdt_batch_getattr_rep) +
+		   cfs_size_round(easize) + cfs_size_round(aclsize));
+
+	OBD_ALLOC(items, count * sizeof(*items));
+	if (items == NULL)
+		RETURN(-ENOMEM);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_MDS_BATCH_GETATTR);
+	if (req == NULL)
+		GOTO(out_items, rc = -ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_BATCH_GETATTR, RCL_CLIENT,
+			     reqsize);
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, MDS_BATCH_GETATTR);
+	if (rc != 0) {
+		ptlrpc_request_free(req);
+		GOTO(out_items, rc);
+	}
+
+	mdc_pack_body(req, &op_data->op_fid1, valid, easize,
+		      op_data->op_suppgids[0], 0);
+	body = req_capsule_client_get(&req->rq_pill, &RMF_MDT_BODY);
+	body->mbo_aclsize = aclsize;
+
+	hdr = req_capsule_client_get(&req->rq_pill, &RMF_BATCH_GETATTR);
+	hdr->mbg_count = count;
+	buf = (char *)(hdr + 1);
+	for (i = 0; i < count; i++) {
+		struct md_enqueue_info *minfo = minfos[i];
+		struct mdt_batch_getattr_req *item = (void *)buf;
+		struct ldlm_res_id res_id;
+		__u64 flags = 0;
+
+		fid_build_reg_res_name(&minfo->mi_data.op_fid2, &res_id);
+		rc = ldlm_cli_lock_create_pack(exp, &item->mbq_lockreq,
+					       &minfo->mi_einfo, &res_id,
+					       &policy, &flags,
+					       &minfo->mi_lockh);
+		if (rc != 0)
+			break;
+
+		item->mbq_fid = minfo->mi_data.op_fid2;
+		item->mbq_namelen = minfo->mi_data.op_namelen;
+		memcpy(item->mbq_name, minfo->mi_data.op_name,
+		       item->mbq_namelen);
+		item->mbq_name[item->mbq_namelen] = '\0';
+		buf += cfs_size_round(sizeof(*item) + item->mbq_namelen + 1);
+	}
+
+	if (rc == 0)
+		rc = obd_get_request_slot(&obddev->u.cli);
+	if (rc != 0) {
+		/* the callbacks are not called on error, only drop the locks
+		 * created so far */
+		while (i-- > 0) {
+			__u64 flags = 0;
+
+			ldlm_cli_enqueue_fini_reply(exp, NULL,
+						    minfos[i]->mi_einfo.ei_type,
+						    minfos[i]->mi_einfo.ei_mode,
+						    &flags,
+						    &minfos[i]->mi_lockh, rc);
+		}
+		ptlrpc_req_finished(req);
+		GOTO(out_items, rc);
+	}
+
+	req_capsule_set_size(&req->rq_pill, &RMF_BATCH_GETATTR, RCL_SERVER,
+			     repsize);
+	ptlrpc_request_set_replen(req);
+
+	memcpy(items, minfos, count * sizeof(*items));
+	CLASSERT(sizeof(*bga) <= sizeof(req->rq_async_args));
+	bga = ptlrpc_req_async_args(req);
+	bga->bga_exp = exp;
+	bga->bga_minfos = items;
+	bga->bga_count = count;
+
+	req->rq_interpret_reply = mdc_batch_getattr_interpret;
+	ptlrpcd_add_req(req);
+
+	RETURN(0);
+
+out_items:
+	OBD_FREE(items, count * sizeof(*items));
+	return rc;
+}
@@ -36,9 +36,298 @@
 #include <linux/kernel.h>
 
 #include <obd_class.h>
+#include <obj_update.h>
 #include "mdc_internal.h"
 #include <lustre_fid.h>
 
+/*
+ * Concurrent MDS_REINT requests are gathered into one MDS_BATCH_REINT RPC.
+ * The first caller becomes the leader of the batch, waits a short window
+ * for other callers to join if more modify RPCs are in flight, sends the
+ * batch and completes the requests of the followers with their part of
+ * the batch reply. Each request keeps its own modify RPC slot, XID and
+ * transno, so it is resent and replayed as a standalone MDS_REINT.
+ */
+struct mdc_batch_item {
+	struct list_head	 mbi_list;
+	struct ptlrpc_request	*mbi_req;
+	struct completion	 mbi_done;
+	int			 mbi_rc;
+	/* send the request on its own, with MSG_RESENT if mbi_resent */
+	unsigned int		 mbi_alone:1,
+				 mbi_resent:1;
+};
+
+/* leave room for the lustre_msg and ptlrpc_body of the batch itself */
+#define MDC_BATCH_MAXREQSIZE	(MDS_REG_MAXREQSIZE - 1024)
+#define MDC_BATCH_MAXREPSIZE	(MDS_REG_MAXREPSIZE - 1024)
+
+static bool mdc_reint_can_batch(struct ptlrpc_request *req)
+{
+	struct obd_import *imp = req->rq_import;
+	struct obd_connect_data *ocd = &imp->imp_connect_data;
+	struct mdt_rec_reint *rec;
+
+	if (imp->imp_obd->u.cli.cl_batch_max <= 1 ||
+	    !(ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2) ||
+	    !(ocd->ocd_connect_flags2 & OBD_CONNECT2_BATCH_REINT))
+		return false;
+
+	/* resends of mdc_create() are delayed and keep their generation */
+	if (req->rq_send_state != LUSTRE_IMP_FULL || req->rq_bulk != NULL ||
+	    req->rq_generation_set ||
+	    SPTLRPC_FLVR_POLICY(req->rq_flvr.sf_rpc) != SPTLRPC_POLICY_NULL)
+		return false;
+
+	rec = req_capsule_client_get(&req->rq_pill, &RMF_REC_REINT);
+	if (rec == NULL)
+		return false;
+
+	switch (rec->rr_opcode) {
+	case REINT_SETATTR:
+	case REINT_CREATE:
+	case REINT_UNLINK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* fill in the message header as ptl_send_rpc() does */
+static void mdc_batch_prep_msg(struct ptlrpc_request *req)
+{
+	struct obd_import *imp = req->rq_import;
+	struct lustre_msg *msg = req->rq_reqmsg;
+
+	lustre_msg_set_handle(msg, &imp->imp_remote_handle);
+	lustre_msg_set_type(msg, PTL_RPC_MSG_REQUEST);
+	lustre_msg_set_conn_cnt(msg, imp->imp_conn_cnt);
+	lustre_msghdr_set_flags(msg, imp->imp_msghdr_flags);
+	lustre_msg_set_jobid(msg, NULL);
+	lustre_msg_set_status(msg, current_pid());
+	lustre_msg_set_last_xid(msg, 0);
+	lustre_msg_set_mbits(msg, req->rq_xid);
+}
+
+static void mdc_batch_all_alone(struct list_head *items, bool resent)
+{
+	struct mdc_batch_item *item;
+
+	list_for_each_entry(item, items, mbi_list) {
+		if (item->mbi_alone)
+			continue;
+		item->mbi_alone = 1;
+		item->mbi_resent = resent;
+	}
+}
+
+static void mdc_batch_send(struct obd_import *imp, struct list_head *items)
+{
+	struct ptlrpc_request *batch;
+	struct mdc_batch_item *item;
+	struct out_update_header *ouh;
+	struct object_update_reply *reply;
+	struct object_update_result *result;
+	char *buf;
+	int reqsize = 0;
+	int repsize = 0;
+	int count = 0;
+	int size;
+	int i;
+	int rc;
+	ENTRY;
+
+	list_for_each_entry(item, items, mbi_list) {
+		struct ptlrpc_request *req = item->mbi_req;
+		int len = sizeof(struct out_update_buffer) +
+			  cfs_size_round(req->rq_reqlen);
+		int rlen = cfs_size_round(sizeof(*result) + req->rq_replen);
+
+		if (count == BATCH_REINT_MAX || rlen > (USHRT_MAX & ~7) ||
+		    reqsize + len > MDC_BATCH_MAXREQSIZE ||
+		    repsize + rlen > MDC_BATCH_MAXREPSIZE) {
+			item->mbi_alone = 1;
+			continue;
+		}
+		reqsize += len;
+		repsize += rlen;
+		count++;
+	}
+
+	if (count < 2) {
+		mdc_batch_all_alone(items, false);
+		RETURN_EXIT;
+	}
+
+	batch = ptlrpc_request_alloc(imp, &RQF_MDS_BATCH_REINT);
+	if (batch == NULL) {
+		mdc_batch_all_alone(items, false);
+		RETURN_EXIT;
+	}
+
+	req_capsule_set_size(&batch->rq_pill, &RMF_OUT_UPDATE_HEADER,
+			     RCL_CLIENT, sizeof(*ouh) + reqsize);
+	rc = ptlrpc_request_pack(batch, LUSTRE_MDS_VERSION, MDS_BATCH_REINT);
+	if (rc) {
+		ptlrpc_request_free(batch);
+		mdc_batch_all_alone(items, false);
+		RETURN_EXIT;
+	}
+
+	repsize += cfs_size_round(offsetof(struct object_update_reply,
+					   ourp_lens[count]));
+	req_capsule_set_size(&batch->rq_pill, &RMF_OUT_UPDATE_REPLY,
+			     RCL_SERVER, repsize);
+	ptlrpc_request_set_replen(batch);
+
+	ouh = req_capsule_client_get(&batch->rq_pill, &RMF_OUT_UPDATE_HEADER);
+	ouh->ouh_magic = BATCH_REINT_HEADER_MAGIC;
+	ouh->ouh_count = count;
+	ouh->ouh_inline_length = reqsize;
+	ouh->ouh_reply_size = repsize;
+
+	buf = (char *)ouh->ouh_inline_data;
+	list_for_each_entry(item, items, mbi_list) {
+		struct ptlrpc_request *req = item->mbi_req;
+		struct out_update_buffer *oub = (struct out_update_buffer *)buf;
+
+		if (item->mbi_alone)
+			continue;
+
+		mdc_batch_prep_msg(req);
+		oub->oub_size = req->rq_reqlen;
+		oub->oub_padding = 0;
+		memcpy(oub + 1, req->rq_reqmsg, req->rq_reqlen);
+		buf += sizeof(*oub) + cfs_size_round(req->rq_reqlen);
+	}
+
+	rc = ptlrpc_queue_wait(batch);
+	if (rc != 0) {
+		/* an error reply means no sub-request was executed, otherwise
+		 * the reply was lost and the sub-requests are resent */
+		mdc_batch_all_alone(items, batch->rq_repmsg == NULL ||
+				    lustre_msg_get_type(batch->rq_repmsg) !=
+				    PTL_RPC_MSG_ERR);
+		GOTO(out, rc);
+	}
+
+	reply = req_capsule_server_get(&batch->rq_pill, &RMF_OUT_UPDATE_REPLY);
+	size = req_capsule_get_size(&batch->rq_pill, &RMF_OUT_UPDATE_REPLY,
+				    RCL_SERVER);
+	if (reply == NULL || reply->ourp_magic != UPDATE_REPLY_MAGIC ||
+	    reply->ourp_count != count) {
+		DEBUG_REQ(D_ERROR, batch, "bad batch reply");
+		mdc_batch_all_alone(items, true);
+		GOTO(out, rc = -EPROTO);
+	}
+
+	i = 0;
+	list_for_each_entry(item, items, mbi_list) {
+		struct ptlrpc_request *req = item->mbi_req;
+
+		if (item->mbi_alone)
+			continue;
+
+		result = object_update_result_get(reply, i++, NULL);
+		if (result == NULL ||
+		    (char *)result->our_data + result->our_datalen >
+		    (char *)reply + size) {
+			item->mbi_alone = 1;
+			item->mbi_resent = 1;
+			continue;
+		}
+
+		rc = ptlrpc_status_ntoh(result->our_rc);
+		if (rc != 0 || result->our_datalen == 0) {
+			/* -EAGAIN: not executed, anything else: no reply */
+			item->mbi_alone = 1;
+			item->mbi_resent = rc != -EAGAIN;
+			continue;
+		}
+
+		item->mbi_rc = ptlrpc_subreq_reply(batch, req,
+						   result->our_data,
+						   result->our_datalen);
+		if (req->rq_resend) {
+			item->mbi_alone = 1;
+		} else if (!req->rq_replied) {
+			item->mbi_alone = 1;
+			item->mbi_resent = 1;
+		}
+	}
+	EXIT;
+out:
+	ptlrpc_req_finished(batch);
+}
+
+static int mdc_reint_batch(struct ptlrpc_request *req)
+{
+	struct client_obd *cli = &req->rq_import->imp_obd->u.cli;
+	struct mdc_batch_item item = { .mbi_req = req };
+	struct mdc_batch_item *tmp;
+	struct mdc_batch_item *pos;
+	struct list_head items;
+	bool leader;
+	bool wait;
+	ENTRY;
+
+	init_completion(&item.mbi_done);
+	spin_lock(&cli->cl_mod_rpcs_lock);
+	list_add_tail(&item.mbi_list, &cli->cl_batch_list);
+	cli->cl_batch_count++;
+	leader = cli->cl_batch_leader == NULL;
+	if (leader)
+		cli->cl_batch_leader = current;
+	else if (cli->cl_batch_count >= cli->cl_batch_max)
+		wake_up_process(cli->cl_batch_leader);
+	wait = cli->cl_mod_rpcs_in_flight > 1;
+	spin_unlock(&cli->cl_mod_rpcs_lock);
+
+	if (!leader) {
+		wait_for_completion(&item.mbi_done);
+		GOTO(out, 0);
+	}
+
+	/* nobody else can join if no other modify RPC is in flight */
+	if (wait && cli->cl_batch_window_us > 0) {
+		ktime_t expires = ktime_set(0, cli->cl_batch_window_us *
+					       NSEC_PER_USEC);
+
+		set_current_state(TASK_UNINTERRUPTIBLE);
+		spin_lock(&cli->cl_mod_rpcs_lock);
+		wait = cli->cl_batch_count < cli->cl_batch_max;
+		spin_unlock(&cli->cl_mod_rpcs_lock);
+		if (wait)
+			schedule_hrtimeout(&expires, HRTIMER_MODE_REL);
+		__set_current_state(TASK_RUNNING);
+	}
+
+	INIT_LIST_HEAD(&items);
+	spin_lock(&cli->cl_mod_rpcs_lock);
+	list_splice_init(&cli->cl_batch_list, &items);
+	cli->cl_batch_count = 0;
+	cli->cl_batch_leader = NULL;
+	spin_unlock(&cli->cl_mod_rpcs_lock);
+
+	if (list_is_singular(&items))
+		item.mbi_alone = 1;
+	else
+		mdc_batch_send(req->rq_import, &items);
+
+	list_for_each_entry_safe(pos, tmp, &items, mbi_list) {
+		list_del_init(&pos->mbi_list);
+		if (pos != &item)
+			complete(&pos->mbi_done);
+	}
+out:
+	if (!item.mbi_alone)
+		RETURN(item.mbi_rc);
+
+	if (item.mbi_resent)
+		lustre_msg_add_flags(req->rq_reqmsg, MSG_RESENT);
+	RETURN(ptlrpc_queue_wait(req));
+}
+
 /* mdc_setattr does its own semaphore handling */
 static int mdc_reint(struct ptlrpc_request *request, int level)
 {
@@ -47,7 +336,10 @@ static int mdc_reint(struct ptlrpc_request *request, int level)
         request->rq_send_state = level;
 
 	mdc_get_mod_rpc_slot(request, NULL);
-	rc = ptlrpc_queue_wait(request);
+	if (mdc_reint_can_batch(request))
+		rc = mdc_reint_batch(request);
+	else
+		rc = ptlrpc_queue_wait(request);
 	mdc_put_mod_rpc_slot(request, NULL);
         if (rc)
                 CDEBUG(D_INFO, "error in handling %d\n", rc);
@@ -58,6 +58,7 @@
 #include <obd_class.h>
 
 #include "mdc_internal.h"
+#include "../osc/osc_cl_internal.h"
 
 #define REQUEST_MINOR 244
 
@@ -775,7 +776,8 @@ static int mdc_close(struct obd_export *exp, struct md_op_data *op_data,
 			/* save the errcode and proceed to close */
 			saved_rc = rc;
 		}
-	} else if (op_data->op_bias & MDS_CLOSE_LAYOUT_SWAP) {
+	} else if (op_data->op_bias & (MDS_CLOSE_LAYOUT_SWAP |
+				       MDS_CLOSE_RESYNC_DONE)) {
 		req_fmt = &RQF_MDS_INTENT_CLOSE;
 	} else {
 		req_fmt = &RQF_MDS_CLOSE;
@@ -886,7 +888,7 @@ out:
 
 static int mdc_getpage(struct obd_export *exp, const struct lu_fid *fid,
 		       u64 offset, struct page **pages, int npages,
-		       struct ptlrpc_request **request)
+		       __u32 attrs, struct ptlrpc_request **request)
 {
 	struct ptlrpc_request   *req;
 	struct ptlrpc_bulk_desc *desc;
@@ -928,7 +930,7 @@ restart_bulk:
 		desc->bd_frag_ops->add_kiov_frag(desc, pages[i], 0,
 						 PAGE_SIZE);
 
-	mdc_readdir_pack(req, offset, PAGE_SIZE * npages, fid);
+	mdc_readdir_pack(req, offset, PAGE_SIZE * npages, fid, attrs);
 
 	ptlrpc_request_set_replen(req);
 	rc = ptlrpc_queue_wait(req);
@@ -1162,6 +1164,7 @@ struct readpage_param {
 	struct md_op_data	*rp_mod;
 	__u64			rp_off;
 	int			rp_hash64;
+	__u32			rp_attrs;
 	struct obd_export	*rp_exp;
 	struct md_callback	*rp_cb;
 };
@@ -1222,7 +1225,8 @@ static int mdc_read_page_remote(void *data, struct page *page0)
 		page_pool[npages] = page;
 	}
 
-	rc = mdc_getpage(rp->rp_exp, fid, rp->rp_off, page_pool, npages, &req);
+	rc = mdc_getpage(rp->rp_exp, fid, rp->rp_off, page_pool, npages,
+			 rp->rp_attrs, &req);
 	if (rc < 0) {
 		/* page0 is special, which was added into page cache early */
 		delete_from_page_cache(page0);
@@ -1238,6 +1242,13 @@ static int mdc_read_page_remote(void *data, struct page *page0)
 
 		mdc_adjust_dirpages(page_pool, rd_pgs, lu_pgs);
 
+		/* readdir-plus attributes are not protected by any lock, stamp
+		 * the pages with the time they were fetched so that consumers
+		 * can age them, see ll_rdplus_expire() */
+		if (rp->rp_attrs & LUDA_ATTRS)
+			for (i = 0; i < rd_pgs; i++)
+				set_page_private(page_pool[i], jiffies ?: 1);
+
 		SetPageUptodate(page0);
 	}
 	unlock_page(page0);
@@ -1336,6 +1347,10 @@ static int mdc_read_page(struct obd_export *exp, struct md_op_data *op_data,
 
 	rp_param.rp_off = hash_offset;
 	rp_param.rp_hash64 = op_data->op_cli_flags & CLI_HASH64;
+	rp_param.rp_attrs = LUDA_FID | LUDA_TYPE;
+	if (op_data->op_cli_flags & CLI_READDIR_PLUS &&
+	    exp_connect_readdir_plus(exp))
+		rp_param.rp_attrs |= LUDA_ATTRS;
 	page = mdc_page_locate(mapping, &rp_param.rp_off, &start, &end,
 			       rp_param.rp_hash64);
 	if (IS_ERR(page)) {
@@ -2256,6 +2271,13 @@ static int mdc_set_info_async(const struct lu_env *env,
                 RETURN(rc);
         }
 
+	if (KEY_IS(KEY_CACHE_SET) || KEY_IS(KEY_CACHE_LRU_SHRINK)) {
+		/* DoM data is cached through the osc layer */
+		rc = osc_set_info_async(env, exp, keylen, key, vallen, val,
+					set);
+		RETURN(rc);
+	}
+
 	if (KEY_IS(KEY_DEFAULT_EASIZE)) {
 		__u32 *default_easize = val;
 
@@ -2365,9 +2387,25 @@ static int mdc_import_event(struct obd_device *obd, struct obd_import *imp,
 	}
 	case IMP_EVENT_INVALIDATE: {
 		struct ldlm_namespace *ns = obd->obd_namespace;
+		struct lu_env *env;
+		__u16 refcheck;
 
 		ldlm_namespace_cleanup(ns, LDLM_FL_LOCAL_ONLY);
 
+		/* drop the cached DoM data too, see osc_import_event() */
+		env = cl_env_get(&refcheck);
+		if (!IS_ERR(env)) {
+			osc_io_unplug(env, &obd->u.cli, NULL);
+
+			cfs_hash_for_each_nolock(ns->ns_rs_hash,
+						 osc_ldlm_resource_invalidate,
+						 env, 0);
+			cl_env_put(env, &refcheck);
+
+			ldlm_namespace_cleanup(ns, LDLM_FL_LOCAL_ONLY);
+		} else {
+			rc = PTR_ERR(env);
+		}
 		break;
 	}
 	case IMP_EVENT_ACTIVE:
@@ -2419,6 +2457,10 @@ static struct obd_uuid *mdc_get_uuid(struct obd_export *exp)
  */
 static int mdc_cancel_weight(struct ldlm_lock *lock)
 {
+	/* DoM data locks are weighted the same way as on the OSC */
+	if (lock->l_resource->lr_type == LDLM_EXTENT)
+		return osc_cancel_weight(lock);
+
 	if (lock->l_resource->lr_type != LDLM_IBITS)
 		RETURN(0);
 
@@ -2431,6 +2473,35 @@ static int mdc_cancel_weight(struct ldlm_lock *lock)
 	RETURN(1);
 }
 
+/**
+ * Get the cost of cancelling an unused lock from the LRU. Cancelling the
+ * UPDATE lock of a directory drops its cached pages, which are then read
+ * again by the next readdir or lookup.
+ */
+static unsigned long mdc_lock_lru_weight(struct ldlm_lock *lock)
+{
+	struct inode *inode;
+	unsigned long weight = 0;
+
+	/* DoM data locks are weighted the same way as on the OSC */
+	if (lock->l_resource->lr_type == LDLM_EXTENT)
+		return osc_lock_lru_weight(lock);
+
+	if (lock->l_resource->lr_type != LDLM_IBITS ||
+	    !(lock->l_policy_data.l_inodebits.bits & MDS_INODELOCK_UPDATE))
+		return 0;
+
+	/* lr_lvb_inode is reset under the resource lock by mdc_null_inode()
+	 * before the inode is freed */
+	lock_res_and_lock(lock);
+	inode = lock->l_resource->lr_lvb_inode;
+	if (inode != NULL && S_ISDIR(inode->i_mode))
+		weight = inode->i_mapping->nrpages;
+	unlock_res_and_lock(lock);
+
+	return weight;
+}
+
 static int mdc_resource_inode_free(struct ldlm_resource *res)
 {
 	if (res->lr_lvb_inode)
@@ -2476,18 +2547,15 @@ static void mdc_llog_finish(struct obd_device *obd)
 	EXIT;
 }
 
-static int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
+int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
 {
 	int				rc;
 	ENTRY;
 
-	rc = ptlrpcd_addref();
+	/* the osc part of the setup is needed to cache DoM data */
+	rc = osc_setup_common(obd, cfg);
 	if (rc < 0)
 		RETURN(rc);
-
-        rc = client_obd_setup(obd, cfg);
-        if (rc)
-		GOTO(err_ptlrpcd_decref, rc);
 #ifdef CONFIG_PROC_FS
 	obd->obd_vars = lprocfs_mdc_obd_vars;
 	lprocfs_obd_setup(obd);
@@ -2497,6 +2565,7 @@ static int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
 	ptlrpc_lprocfs_register_obd(obd);
 
 	ns_register_cancel(obd->obd_namespace, mdc_cancel_weight);
+	ns_register_weigh(obd->obd_namespace, mdc_lock_lru_weight);
 
 	obd->obd_namespace->ns_lvbo = &inode_lvbo;
 
@@ -2517,12 +2586,8 @@ static int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
 	EXIT;
 err_mdc_cleanup:
 	if (rc)
-		client_obd_cleanup(obd);
-
-err_ptlrpcd_decref:
-	if (rc)
-	        ptlrpcd_decref();
-        return rc;
+		osc_cleanup_common(obd);
+	return rc;
 }
 
 /* Initialize the default and maximum LOV EA sizes.  This allows
@@ -2555,7 +2620,7 @@ static int mdc_precleanup(struct obd_device *obd)
 
 	mdc_changelog_cdev_finish(obd);
 
-	obd_cleanup_client_import(obd);
+	osc_precleanup_common(obd);
 	ptlrpc_lprocfs_unregister_obd(obd);
 	lprocfs_free_md_stats(obd);
 	mdc_llog_finish(obd);
@@ -2564,12 +2629,10 @@ static int mdc_precleanup(struct obd_device *obd)
 
 static int mdc_cleanup(struct obd_device *obd)
 {
-        ptlrpcd_decref();
-
-        return client_obd_cleanup(obd);
+	return osc_cleanup_common(obd);
 }
 
-static int mdc_process_config(struct obd_device *obd, size_t len, void *buf)
+int mdc_process_config(struct obd_device *obd, size_t len, void *buf)
 {
         struct lustre_cfg *lcfg = buf;
 	int rc = class_process_proc_param(PARAM_MDC, obd->obd_vars, lcfg, obd);
@@ -2624,13 +2687,14 @@ static struct md_ops mdc_md_ops = {
         .m_set_open_replay_data = mdc_set_open_replay_data,
         .m_clear_open_replay_data = mdc_clear_open_replay_data,
         .m_intent_getattr_async = mdc_intent_getattr_async,
+	.m_batch_getattr_async	= mdc_batch_getattr_async,
         .m_revalidate_lock      = mdc_revalidate_lock
 };
 
 static int __init mdc_init(void)
 {
 	return class_register_type(&mdc_obd_ops, &mdc_md_ops, true, NULL,
-				   LUSTRE_MDC_NAME, NULL);
+				   LUSTRE_MDC_NAME, &mdc_device_type);
 }
 
 static void __exit mdc_exit(void)
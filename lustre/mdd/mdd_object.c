@@ -2082,6 +2082,74 @@ static int mdd_readpage_sanity_check(const struct lu_env *env,
         RETURN(rc);
 }
 
+/**
+ * Append the readdir-plus attributes of the object referenced by \a ent.
+ *
+ * The client trusts these attributes for a while without holding any lock,
+ * so objects whose access cannot be decided from the mode bits (ACL) or whose
+ * attributes are not local (remote objects, striped directories) are left
+ * without them, the client falls back to a getattr for such entries.
+ */
+static void mdd_dir_page_pack_attrs(const struct lu_env *env,
+				    struct mdd_device *mdd,
+				    struct lu_dirent *ent,
+				    const struct lu_fid *fid)
+{
+	struct lu_attr		*la = &mdd_env_info(env)->mti_cattr;
+	struct mdd_object	*child;
+	struct luda_attrs	*lat;
+	__u32			 attrs = le32_to_cpu(ent->lde_attrs);
+	__u64			 valid;
+	int			 rc;
+
+	child = mdd_object_find(env, mdd, fid);
+	if (IS_ERR_OR_NULL(child))
+		return;
+
+	if (!mdd_object_exists(child) || mdd_object_remote(child))
+		goto out;
+
+	rc = mdd_la_get(env, child, la);
+	if (rc != 0 || mdd_is_dead_obj(child))
+		goto out;
+
+	if (mdo_xattr_get(env, child, &LU_BUF_NULL,
+			  XATTR_NAME_ACL_ACCESS) != -ENODATA)
+		goto out;
+
+	if (S_ISDIR(la->la_mode) &&
+	    mdo_xattr_get(env, child, &LU_BUF_NULL, XATTR_NAME_LMV) != -ENODATA)
+		goto out;
+
+	valid = OBD_MD_FLTYPE | OBD_MD_FLMODE | OBD_MD_FLNLINK |
+		OBD_MD_FLUID | OBD_MD_FLGID | OBD_MD_FLATIME |
+		OBD_MD_FLMTIME | OBD_MD_FLCTIME | OBD_MD_FLRDEV |
+		OBD_MD_FLFLAGS;
+	/* size of a regular file lives on the OSTs */
+	if (!S_ISREG(la->la_mode))
+		valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+
+	ent->lde_attrs = cpu_to_le32(attrs | LUDA_ATTRS);
+	ent->lde_reclen = cpu_to_le16(lu_dirent_calc_size(
+				le16_to_cpu(ent->lde_namelen),
+				attrs | LUDA_ATTRS));
+	lat = lu_dirent_attrs(ent);
+	lat->lat_valid = cpu_to_le64(valid);
+	lat->lat_size = cpu_to_le64(la->la_size);
+	lat->lat_blocks = cpu_to_le64(la->la_blocks);
+	lat->lat_mtime = cpu_to_le64(la->la_mtime);
+	lat->lat_atime = cpu_to_le64(la->la_atime);
+	lat->lat_ctime = cpu_to_le64(la->la_ctime);
+	lat->lat_mode = cpu_to_le32(la->la_mode);
+	lat->lat_nlink = cpu_to_le32(la->la_nlink);
+	lat->lat_uid = cpu_to_le32(la->la_uid);
+	lat->lat_gid = cpu_to_le32(la->la_gid);
+	lat->lat_rdev = cpu_to_le32(la->la_rdev);
+	lat->lat_flags = cpu_to_le32(la->la_flags);
+out:
+	mdd_object_put(env, child);
+}
+
 static int mdd_dir_page_build(const struct lu_env *env, union lu_page *lp,
 			      size_t nob, const struct dt_it_ops *iops,
 			      struct dt_it *it, __u32 attr, void *arg)
@@ -2123,21 +2191,26 @@ static int mdd_dir_page_build(const struct lu_env *env, union lu_page *lp,
                 recsize = lu_dirent_calc_size(len, attr);
 
                 if (nob >= recsize) {
-                        result = iops->rec(env, it, (struct dt_rec *)ent, attr);
+			/* LUDA_ATTRS is packed here, not by the osd */
+			result = iops->rec(env, it, (struct dt_rec *)ent,
+					   attr & ~LUDA_ATTRS);
                         if (result == -ESTALE)
                                 goto next;
                         if (result != 0)
                                 goto out;
 
-                        /* osd might not able to pack all attributes,
-                         * so recheck rec length */
-                        recsize = le16_to_cpu(ent->lde_reclen);
-
 			if (le32_to_cpu(ent->lde_attrs) & LUDA_FID) {
 				fid_le_to_cpu(&fid, &ent->lde_fid);
 				if (fid_is_dot_lustre(&fid))
 					goto next;
+				if (attr & LUDA_ATTRS && arg != NULL)
+					mdd_dir_page_pack_attrs(env, arg, ent,
+								&fid);
 			}
+
+                        /* osd might not able to pack all attributes,
+                         * so recheck rec length */
+                        recsize = le16_to_cpu(ent->lde_reclen);
                 } else {
                         result = (last != NULL) ? 0 :-EINVAL;
                         goto out;
@@ -2211,7 +2284,7 @@ int mdd_readpage(const struct lu_env *env, struct md_object *obj,
         }
 
 	rc = dt_index_walk(env, mdd_object_child(mdd_obj), rdpg,
-			   mdd_dir_page_build, NULL);
+			   mdd_dir_page_build, mdo2mdd(obj));
 	if (rc >= 0) {
 		struct lu_dirpage	*dp;
 
@@ -1285,10 +1285,8 @@ out:
  * \retval 0	on success
  * \retval < 0	error code
  */
-static int mdt_layout_change(struct mdt_thread_info *info,
-			     struct mdt_object *obj,
-			     struct layout_intent *layout,
-			     const struct lu_buf *buf)
+int mdt_layout_change(struct mdt_thread_info *info, struct mdt_object *obj,
+		      struct layout_intent *layout, const struct lu_buf *buf)
 {
 	struct mdt_lock_handle *lh = &info->mti_lh[MDT_LH_LOCAL];
 	int rc;
@@ -1782,6 +1780,316 @@ out_shrink:
 	return rc;
 }
 
+/*
+ * Hand the local lock taken in \a lhc to the client as the lock it created for
+ * a MDS_BATCH_GETATTR entry, as mdt_intent_lock_replace() does for intents.
+ */
+static int mdt_batch_getattr_lock_give(struct mdt_thread_info *info,
+				       struct mdt_lock_handle *lhc,
+				       const struct lustre_handle *remote,
+				       struct ldlm_reply *lockrep)
+{
+	struct ptlrpc_request *req = mdt_info_req(info);
+	struct ldlm_lock *lock;
+
+	lock = ldlm_handle2lock(&lhc->mlh_reg_lh);
+	LASSERT(lock != NULL);
+
+	lock_res_and_lock(lock);
+	/* a conflicting enqueue came in meanwhile, don't grant it */
+	if (ldlm_is_cbpending(lock)) {
+		unlock_res_and_lock(lock);
+		LDLM_LOCK_PUT(lock);
+		return -EAGAIN;
+	}
+
+	while (lock->l_readers > 0) {
+		lu_ref_del(&lock->l_reference, "reader", lock);
+		lu_ref_del(&lock->l_reference, "user", lock);
+		lock->l_readers--;
+	}
+	lock->l_export = class_export_lock_get(req->rq_export, lock);
+	lock->l_blocking_ast = ldlm_server_blocking_ast;
+	lock->l_completion_ast = ldlm_server_completion_ast;
+	lock->l_remote_handle = *remote;
+	lock->l_flags &= ~LDLM_FL_LOCAL;
+	unlock_res_and_lock(lock);
+
+	cfs_hash_add(lock->l_export->exp_lock_hash, &lock->l_remote_handle,
+		     &lock->l_exp_hash);
+
+	ldlm_lock2desc(lock, &lockrep->lock_desc);
+	ldlm_lock2handle(lock, &lockrep->lock_handle);
+	lockrep->lock_flags = 0;
+
+	LDLM_DEBUG(lock, "Returning batched lock to client");
+	LDLM_LOCK_PUT(lock);
+	lhc->mlh_reg_lh.cookie = 0;
+
+	return 0;
+}
+
+/*
+ * Lookup, lock and getattr of one entry of a MDS_BATCH_GETATTR. The child lock
+ * is only taken if it can be granted at once, any entry which can't be done
+ * here gets an error and the client stats it with a regular RPC.
+ *
+ * \retval size of the entry reply, or negative errno for this entry
+ */
+static int mdt_batch_getattr_one(struct mdt_thread_info *info,
+				 struct lu_nodemap *nodemap,
+				 struct mdt_batch_getattr_req *item,
+				 struct mdt_batch_getattr_rep *rep,
+				 __u32 eadatasize, __u32 aclsize)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct mdt_object	*parent = info->mti_object;
+	struct mdt_lock_handle	*lhc = &info->mti_lh[MDT_LH_CHILD];
+	struct lu_fid		*child_fid = &info->mti_tmp_fid1;
+	struct lu_name		*lname = &info->mti_name;
+	struct md_attr		*ma = &info->mti_attr;
+	struct mdt_body		*body = &rep->mbp_body;
+	struct mdt_object	*child;
+	struct ldlm_lock	*lock = NULL;
+	__u64			 ibits = MDS_INODELOCK_LOOKUP |
+					 MDS_INODELOCK_UPDATE |
+					 MDS_INODELOCK_PERM;
+	int			 rc;
+	ENTRY;
+
+	lname->ln_name = item->mbq_name;
+	lname->ln_namelen = item->mbq_namelen;
+	if (!lu_name_is_valid(lname))
+		RETURN(-EPROTO);
+
+	fid_zero(child_fid);
+	rc = mdo_lookup(env, mdt_object_child(parent), lname, child_fid,
+			&info->mti_spec);
+	if (rc != 0)
+		RETURN(rc);
+
+	/* renamed or re-created since the client read the directory */
+	if (!lu_fid_eq(child_fid, &item->mbq_fid))
+		RETURN(-ESTALE);
+
+	child = mdt_object_find(env, info->mti_mdt, child_fid);
+	if (IS_ERR(child))
+		RETURN(PTR_ERR(child));
+
+	if (!mdt_object_exists(child))
+		GOTO(out_child, rc = -ENOENT);
+
+	if (mdt_object_remote(child))
+		GOTO(out_child, rc = -EREMOTE);
+
+	/* the lock was already given in the reply which got lost */
+	if (lustre_msg_get_flags(req->rq_reqmsg) & MSG_RESENT)
+		lock = cfs_hash_lookup(req->rq_export->exp_lock_hash,
+				(void *)&item->mbq_lockreq.lock_handle[0]);
+
+	if (lock == NULL) {
+		mdt_lock_handle_init(lhc);
+		mdt_lock_reg_init(lhc, LCK_PR);
+		if (!mdt_object_lock_try(info, child, lhc, ibits))
+			GOTO(out_child, rc = -EAGAIN);
+	}
+
+	info->mti_big_lmm_used = 0;
+	ma->ma_valid = 0;
+	if (S_ISDIR(lu_object_attr(&child->mot_obj))) {
+		ma->ma_lmv = (void *)rep->mbp_data;
+		ma->ma_lmv_size = eadatasize;
+		ma->ma_need = MA_INODE | MA_LMV;
+	} else {
+		ma->ma_lmm = (void *)rep->mbp_data;
+		ma->ma_lmm_size = eadatasize;
+		ma->ma_need = MA_INODE | MA_HSM;
+		if (eadatasize > 0)
+			ma->ma_need |= MA_LOV;
+	}
+
+	rc = mdt_attr_get_complex(info, child, ma);
+	if (rc != 0)
+		GOTO(out_unlock, rc);
+
+	/* striped directories need their LMV unpacked by the LMV layer, and
+	 * a layout larger than the room left by the client needs a resend */
+	if (ma->ma_valid & MA_LMV || info->mti_big_lmm_used ||
+	    !(ma->ma_valid & MA_INODE))
+		GOTO(out_unlock, rc = -EAGAIN);
+
+	mdt_pack_attr2body(info, body, &ma->ma_attr, mdt_object_fid(child));
+	if (ma->ma_valid & MA_LOV) {
+		body->mbo_eadatasize = ma->ma_lmm_size;
+		body->mbo_valid |= OBD_MD_FLEASIZE;
+	}
+
+#ifdef CONFIG_FS_POSIX_ACL
+	if (aclsize > 0) {
+		struct lu_buf *buf = &info->mti_buf;
+
+		buf->lb_buf = rep->mbp_data +
+			      cfs_size_round(body->mbo_eadatasize);
+		buf->lb_len = aclsize;
+		rc = mo_xattr_get(env, mdt_object_child(child), buf,
+				  XATTR_NAME_ACL_ACCESS);
+		if (rc == -ENODATA) {
+			body->mbo_valid |= OBD_MD_FLACL;
+			rc = 0;
+		} else if (rc == -EOPNOTSUPP) {
+			rc = 0;
+		} else if (rc >= 0) {
+			rc = nodemap_map_acl(nodemap, buf->lb_buf, rc,
+					     NODEMAP_FS_TO_CLIENT);
+			if (rc >= 0) {
+				body->mbo_aclsize = rc;
+				body->mbo_valid |= OBD_MD_FLACL;
+				rc = 0;
+			}
+		}
+		if (rc != 0)
+			GOTO(out_unlock, rc);
+	}
+#endif
+
+	if (lock != NULL) {
+		ldlm_lock2desc(lock, &rep->mbp_lockrep.lock_desc);
+		ldlm_lock2handle(lock, &rep->mbp_lockrep.lock_handle);
+		rep->mbp_lockrep.lock_flags = 0;
+	} else {
+		rc = mdt_batch_getattr_lock_give(info, lhc,
+					&item->mbq_lockreq.lock_handle[0],
+					&rep->mbp_lockrep);
+	}
+
+	EXIT;
+out_unlock:
+	if (lock != NULL)
+		LDLM_LOCK_PUT(lock);
+	else if (rc != 0)
+		mdt_object_unlock(info, child, lhc, 1);
+out_child:
+	mdt_object_put(env, child);
+	if (rc != 0)
+		return rc;
+
+	return sizeof(*rep) + cfs_size_round(body->mbo_eadatasize) +
+	       cfs_size_round(body->mbo_aclsize);
+}
+
+/*
+ * MDS_BATCH_GETATTR handler: lookup and getattr of several entries of the
+ * directory in the MDT body, as the IT_GETATTR intents sent by the statahead
+ * thread would do one by one.
+ */
+static int mdt_batch_getattr(struct tgt_session_info *tsi)
+{
+	struct mdt_thread_info		*info = tsi2mdt_info(tsi);
+	struct req_capsule		*pill = info->mti_pill;
+	struct mdt_body			*reqbody = info->mti_body;
+	struct mdt_object		*parent = info->mti_object;
+	struct mdt_batch_getattr	*reqhdr;
+	struct mdt_batch_getattr	*rephdr;
+	struct lu_nodemap		*nodemap = NULL;
+	char				*reqbuf;
+	char				*reqend;
+	char				*repbuf;
+	__u32				 eadatasize;
+	__u32				 aclsize = 0;
+	bool				 swab;
+	int				 reqlen;
+	int				 replen;
+	unsigned int			 i;
+	int				 rc;
+	ENTRY;
+
+	reqhdr = req_capsule_client_get(pill, &RMF_BATCH_GETATTR);
+	reqlen = req_capsule_get_size(pill, &RMF_BATCH_GETATTR, RCL_CLIENT);
+	if (reqhdr == NULL || reqlen < (int)sizeof(*reqhdr))
+		GOTO(out, rc = err_serious(-EPROTO));
+
+	swab = ptlrpc_req_need_swab(pill->rc_req);
+	if (swab)
+		lustre_swab_mdt_batch_getattr(reqhdr);
+	if (reqhdr->mbg_count == 0 ||
+	    reqhdr->mbg_count > MDS_BATCH_GETATTR_MAX)
+		GOTO(out, rc = err_serious(-EPROTO));
+
+	if (mdt_object_remote(parent))
+		GOTO(out, rc = -EIO);
+	if (!S_ISDIR(lu_object_attr(&parent->mot_obj)))
+		GOTO(out, rc = -ENOTDIR);
+
+	eadatasize = min_t(__u32, reqbody->mbo_eadatasize,
+			   info->mti_mdt->mdt_max_mdsize);
+#ifdef CONFIG_FS_POSIX_ACL
+	if (exp_connect_flags(info->mti_exp) & OBD_CONNECT_ACL &&
+	    reqbody->mbo_valid & OBD_MD_FLACL)
+		aclsize = min_t(__u32, reqbody->mbo_aclsize,
+				LUSTRE_POSIX_ACL_MAX_SIZE_OLD);
+#endif
+
+	replen = sizeof(*rephdr) + reqhdr->mbg_count *
+		 (sizeof(struct mdt_batch_getattr_rep) +
+		  cfs_size_round(eadatasize) + cfs_size_round(aclsize));
+	req_capsule_set_size(pill, &RMF_BATCH_GETATTR, RCL_SERVER, replen);
+	rc = req_capsule_server_pack(pill);
+	if (rc != 0)
+		GOTO(out, rc = err_serious(rc));
+
+	rc = mdt_init_ucred(info, reqbody);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	nodemap = nodemap_get_from_exp(info->mti_exp);
+	if (IS_ERR(nodemap))
+		GOTO(out_ucred, rc = PTR_ERR(nodemap));
+
+	rephdr = req_capsule_server_get(pill, &RMF_BATCH_GETATTR);
+	rephdr->mbg_count = reqhdr->mbg_count;
+	reqbuf = (char *)(reqhdr + 1);
+	reqend = (char *)reqhdr + reqlen;
+	repbuf = (char *)(rephdr + 1);
+	for (i = 0; i < reqhdr->mbg_count; i++) {
+		struct mdt_batch_getattr_req *item = (void *)reqbuf;
+		struct mdt_batch_getattr_rep *rep = (void *)repbuf;
+		int size;
+
+		if (reqbuf + sizeof(*item) > reqend)
+			GOTO(out_nodemap, rc = err_serious(-EPROTO));
+		if (swab)
+			lustre_swab_mdt_batch_getattr_req(item);
+		reqbuf += cfs_size_round(sizeof(*item) + item->mbq_namelen + 1);
+		if (reqbuf > reqend)
+			GOTO(out_nodemap, rc = err_serious(-EPROTO));
+
+		memset(rep, 0, sizeof(*rep));
+		size = mdt_batch_getattr_one(info, nodemap, item, rep,
+					     eadatasize, aclsize);
+		if (size < 0) {
+			memset(rep, 0, sizeof(*rep));
+			rep->mbp_rc = size;
+			size = sizeof(*rep);
+		} else {
+			mdt_counter_incr(mdt_info_req(info), LPROC_MDT_GETATTR);
+		}
+		repbuf += size;
+	}
+
+	req_capsule_shrink(pill, &RMF_BATCH_GETATTR, repbuf - (char *)rephdr,
+			   RCL_SERVER);
+	rc = 0;
+	EXIT;
+out_nodemap:
+	nodemap_putref(nodemap);
+out_ucred:
+	mdt_exit_ucred(info);
+out:
+	mdt_thread_info_fini(info);
+	return rc;
+}
+
 static int mdt_iocontrol(unsigned int cmd, struct obd_export *exp, int len,
 			 void *karg, void __user *uarg);
 
@@ -1846,6 +2154,51 @@ static int mdt_set_info(struct tgt_session_info *tsi)
 	RETURN(rc);
 }
 
+/**
+ * Map the owners of the readdir-plus attributes packed by the MDD to the ids
+ * seen by the client, like mdt_pack_attr2body() does for getattr replies.
+ */
+static void mdt_readpage_map_ids(struct obd_export *exp, struct lu_rdpg *rdpg,
+				 int nob)
+{
+	struct lu_nodemap	*nodemap;
+	int			 i;
+
+	nodemap = nodemap_get_from_exp(exp);
+	if (IS_ERR(nodemap))
+		return;
+
+	for (i = 0; i < rdpg->rp_npages && nob > 0; i++) {
+		union lu_page	*lp = kmap(rdpg->rp_pages[i]);
+		int		 j;
+
+		for (j = 0; j < LU_PAGE_COUNT && nob > 0;
+		     j++, lp++, nob -= LU_PAGE_SIZE) {
+			struct lu_dirent	*ent;
+			struct luda_attrs	*lat;
+
+			for (ent = lu_dirent_start(&lp->lp_dir); ent != NULL;
+			     ent = lu_dirent_next(ent)) {
+				if (!(le32_to_cpu(ent->lde_attrs) & LUDA_ATTRS))
+					continue;
+
+				lat = lu_dirent_attrs(ent);
+				lat->lat_uid = cpu_to_le32(nodemap_map_id(
+						nodemap, NODEMAP_UID,
+						NODEMAP_FS_TO_CLIENT,
+						le32_to_cpu(lat->lat_uid)));
+				lat->lat_gid = cpu_to_le32(nodemap_map_id(
+						nodemap, NODEMAP_GID,
+						NODEMAP_FS_TO_CLIENT,
+						le32_to_cpu(lat->lat_gid)));
+			}
+		}
+		kunmap(rdpg->rp_pages[i]);
+	}
+
+	nodemap_putref(nodemap);
+}
+
 static int mdt_readpage(struct tgt_session_info *tsi)
 {
 	struct mdt_thread_info	*info = mdt_th_info(tsi->tsi_env);
@@ -1880,6 +2233,9 @@ static int mdt_readpage(struct tgt_session_info *tsi)
 	rdpg->rp_attrs = reqbody->mbo_mode;
 	if (exp_connect_flags(tsi->tsi_exp) & OBD_CONNECT_64BITHASH)
 		rdpg->rp_attrs |= LUDA_64BITHASH;
+	if (!exp_connect_readdir_plus(tsi->tsi_exp) ||
+	    !(rdpg->rp_attrs & LUDA_FID))
+		rdpg->rp_attrs &= ~LUDA_ATTRS;
 	rdpg->rp_count  = min_t(unsigned int, reqbody->mbo_nlink,
 				exp_max_brw_size(tsi->tsi_exp));
 	rdpg->rp_npages = (rdpg->rp_count + PAGE_SIZE - 1) >>
@@ -1899,6 +2255,9 @@ static int mdt_readpage(struct tgt_session_info *tsi)
 	if (rc < 0)
 		GOTO(free_rdpg, rc);
 
+	if (rdpg->rp_attrs & LUDA_ATTRS)
+		mdt_readpage_map_ids(tsi->tsi_exp, rdpg, rc);
+
 	/* send pages to client */
 	rc = tgt_sendpage(tsi, rdpg, rc);
 
@@ -3600,6 +3959,7 @@ static int mdt_intent_layout(enum mdt_it_code opcode,
 	switch (layout->li_opc) {
 	case LAYOUT_INTENT_TRUNC:
 	case LAYOUT_INTENT_WRITE:
+	case LAYOUT_INTENT_RESYNC:
 		layout_change = true;
 		break;
 	case LAYOUT_INTENT_ACCESS:
@@ -3608,6 +3968,8 @@ static int mdt_intent_layout(enum mdt_it_code opcode,
 	case LAYOUT_INTENT_GLIMPSE:
 	case LAYOUT_INTENT_RELEASE:
 	case LAYOUT_INTENT_RESTORE:
+	/* only done by the MDT on close of the resync lease */
+	case LAYOUT_INTENT_RESYNC_DONE:
 		CERROR("%s: Unsupported layout intent opc %d\n",
 		       mdt_obd_name(info->mti_mdt), layout->li_opc);
 		rc = -ENOTSUPP;
@@ -3907,6 +4269,32 @@ static int mdt_intent_opc(enum ldlm_intent_flags itopc,
 	RETURN(rc);
 }
 
+static int mdt_dom_glimpse(struct mdt_thread_info *info,
+			   struct ldlm_lock *lock)
+{
+	struct req_capsule *pill = info->mti_pill;
+	struct ost_lvb *lvb;
+	int rc;
+
+	ENTRY;
+
+	req_capsule_set_size(pill, &RMF_DLM_LVB, RCL_SERVER, sizeof(*lvb));
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	lvb = req_capsule_server_get(pill, &RMF_DLM_LVB);
+	lock->l_lvb_type = LVB_T_OST;
+	fid_extract_from_res_name(&info->mti_tmp_fid1,
+				  &lock->l_resource->lr_name);
+	rc = mdt_dom_lvb_fill(info->mti_env, info->mti_mdt,
+			      &info->mti_tmp_fid1, lvb);
+	if (rc < 0)
+		RETURN(rc);
+
+	RETURN(ELDLM_LOCK_ABORTED);
+}
+
 static int mdt_intent_policy(struct ldlm_namespace *ns,
 			     struct ldlm_lock **lockp, void *req_cookie,
 			     enum ldlm_mode mode, __u64 flags, void *data)
@@ -3948,6 +4336,13 @@ static int mdt_intent_policy(struct ldlm_namespace *ns,
                                         l_policy_data.l_inodebits.bits != 0));
                 } else
                         rc = err_serious(-EFAULT);
+	} else if ((*lockp)->l_resource->lr_type == LDLM_EXTENT &&
+		   fid_res_name_is_dom(&(*lockp)->l_resource->lr_name)) {
+		/* Glimpse of Data-on-MDT data. DoM writes are synchronous,
+		 * so the size on disk is current and no glimpse ASTs are
+		 * needed, just reply with the LVB and abort the lock. */
+		LASSERT(pill->rc_fmt == &RQF_LDLM_ENQUEUE);
+		rc = mdt_dom_glimpse(info, *lockp);
         } else {
                 /* No intent was provided */
                 LASSERT(pill->rc_fmt == &RQF_LDLM_ENQUEUE);
@@ -4676,6 +5071,10 @@ TGT_MDT_HDL(HABEO_CORPUS| HABEO_REFERO, MDS_HSM_REQUEST,
 TGT_MDT_HDL(HABEO_CLAVIS | HABEO_CORPUS | HABEO_REFERO | MUTABOR,
 	    MDS_SWAP_LAYOUTS,
 	    mdt_swap_layouts),
+TGT_MDT_HDL(HABEO_CORPUS,		MDS_BATCH_GETATTR,
+							mdt_batch_getattr),
+TGT_MDT_HDL(0		| MUTABOR,	MDS_BATCH_REINT,
+							tgt_batch_reint),
 };
 
 static struct tgt_handler mdt_sec_ctx_ops[] = {
@@ -4688,12 +5087,33 @@ static struct tgt_handler mdt_quota_ops[] = {
 TGT_QUOTA_HDL(HABEO_REFERO,		QUOTA_DQACQ,	  mdt_quota_dqacq),
 };
 
+#define OBD_FAIL_OST_READ_NET	OBD_FAIL_OST_BRW_NET
+#define OBD_FAIL_OST_WRITE_NET	OBD_FAIL_OST_BRW_NET
+#define OST_BRW_READ	OST_READ
+#define OST_BRW_WRITE	OST_WRITE
+
+/* Data-on-MDT I/O handlers, served on the MDS_IO_PORTAL */
+static struct tgt_handler mdt_io_ops[] = {
+TGT_OST_HDL(HABEO_CORPUS | HABEO_REFERO | MUTABOR,
+					OST_SETATTR,	mdt_data_setattr),
+TGT_OST_HDL(HABEO_CORPUS | HABEO_REFERO, OST_BRW_READ,	tgt_brw_read),
+TGT_OST_HDL(HABEO_CORPUS | MUTABOR,	OST_BRW_WRITE,	tgt_brw_write),
+TGT_OST_HDL(HABEO_CORPUS | HABEO_REFERO | MUTABOR,
+					OST_PUNCH,	mdt_punch_hdl),
+TGT_OST_HDL(HABEO_CORPUS | HABEO_REFERO, OST_SYNC,	mdt_data_sync),
+};
+
 static struct tgt_opc_slice mdt_common_slice[] = {
 	{
 		.tos_opc_start	= MDS_FIRST_OPC,
 		.tos_opc_end	= MDS_LAST_OPC,
 		.tos_hs		= mdt_tgt_handlers
 	},
+	{
+		.tos_opc_start	= OST_FIRST_OPC,
+		.tos_opc_end	= OST_LAST_OPC,
+		.tos_hs		= mdt_io_ops
+	},
 	{
 		.tos_opc_start	= OBD_FIRST_OPC,
 		.tos_opc_end	= OBD_LAST_OPC,
@@ -6299,6 +6719,8 @@ static struct obd_ops mdt_obd_device_ops = {
         .o_destroy_export = mdt_destroy_export,
         .o_iocontrol      = mdt_iocontrol,
         .o_postrecov      = mdt_obd_postrecov,
+	.o_preprw	  = mdt_obd_preprw,
+	.o_commitrw	  = mdt_obd_commitrw,
 };
 
 static struct lu_device* mdt_device_fini(const struct lu_env *env,
@@ -79,6 +79,61 @@ int mdt_hsm_attr_set(struct mdt_thread_info *info, struct mdt_object *obj,
 	RETURN(rc);
 }
 
+/**
+ * Invalidate the read-only copies of a file cached by clients (PCC).
+ *
+ * The clients drop their cached copy together with the layout lock, so
+ * revoke the layout locks by enqueuing an EX lock and clear HS_PCCRO so
+ * that the file is not revoked again until some client attaches it.
+ * The caller must hold mot_open_sem so no new copy can be attached.
+ *
+ * \param[in] info	thread info
+ * \param[in] obj	object being modified
+ * \param[in] mh	current HSM attributes of \a obj or NULL to read them
+ *
+ * \retval 0 on success
+ * \retval negative errno on failure
+ */
+int mdt_pcc_revoke(struct mdt_thread_info *info, struct mdt_object *obj,
+		   struct md_hsm *mh)
+{
+	struct mdt_lock_handle	*lh = &info->mti_lh[MDT_LH_LAYOUT];
+	int			 rc;
+	ENTRY;
+
+	if (mh == NULL) {
+		struct md_attr *ma = &info->mti_u.hsm.attr;
+
+		ma->ma_valid = 0;
+		ma->ma_need = MA_HSM;
+		rc = mdt_attr_get_complex(info, obj, ma);
+		if (rc < 0)
+			RETURN(rc);
+		if (!(ma->ma_valid & MA_HSM))
+			RETURN(0);
+		mh = &ma->ma_hsm;
+	}
+
+	if (!(mh->mh_flags & HS_PCCRO))
+		RETURN(0);
+
+	CDEBUG(D_HSM, "revoke PCC copies of "DFID"\n",
+	       PFID(mdt_object_fid(obj)));
+
+	mdt_lock_handle_init(lh);
+	mdt_lock_reg_init(lh, LCK_EX);
+	rc = mdt_object_lock(info, obj, lh, MDS_INODELOCK_LAYOUT);
+	if (rc < 0)
+		RETURN(rc);
+
+	mh->mh_flags &= ~HS_PCCRO;
+	rc = mdt_hsm_attr_set(info, obj, mh);
+
+	mdt_object_unlock(info, obj, lh, 1);
+
+	RETURN(rc);
+}
+
 static inline bool mdt_hsm_is_admin(struct mdt_thread_info *info)
 {
 	bool is_admin;
@@ -259,6 +314,7 @@ int mdt_hsm_state_set(struct tgt_session_info *tsi)
 	struct md_attr          *ma = &info->mti_attr;
 	struct hsm_state_set	*hss;
 	struct mdt_lock_handle	*lh;
+	bool			 pcc_attach = false;
 	int			 rc;
 	__u64			 flags;
 	ENTRY;
@@ -273,6 +329,17 @@ int mdt_hsm_state_set(struct tgt_session_info *tsi)
 	if (rc < 0)
 		GOTO(out, rc = err_serious(rc));
 
+	/* A client attaches a read-only copy of the file, hold open_sem
+	 * so that no writer can open the file until HS_PCCRO is set, the
+	 * next writer will then revoke the copy in mdt_object_open_lock() */
+	if (hss->hss_valid & HSS_SETMASK && hss->hss_setmask & HS_PCCRO) {
+		down_write(&obj->mot_open_sem);
+		pcc_attach = true;
+
+		if (mdt_write_read(obj) > 0)
+			GOTO(out_ucred, rc = -EBUSY);
+	}
+
 	lh = &info->mti_lh[MDT_LH_CHILD];
 	mdt_lock_reg_init(lh, LCK_PW);
 	rc = mdt_object_lock(info, obj, lh, MDS_INODELOCK_LOOKUP |
@@ -289,8 +356,9 @@ int mdt_hsm_state_set(struct tgt_session_info *tsi)
 	}
 
 	/* Non-root users are forbidden to set or clear flags which are
-	 * NOT defined in HSM_USER_MASK. */
-	if (((hss->hss_setmask | hss->hss_clearmask) & ~HSM_USER_MASK) &&
+	 * NOT defined in HSM_USER_MASK, but they may set HSM_PCC_MASK. */
+	if (((hss->hss_setmask & ~(HSM_USER_MASK | HSM_PCC_MASK)) ||
+	     (hss->hss_clearmask & ~HSM_USER_MASK)) &&
 	    !md_capable(mdt_ucred(info), CFS_CAP_SYS_ADMIN)) {
 		CDEBUG(D_HSM, "Incompatible masks provided (set %#llx"
 		       ", clear %#llx) vs unprivileged set (%#x).\n",
@@ -357,6 +425,8 @@ int mdt_hsm_state_set(struct tgt_session_info *tsi)
 out_unlock:
 	mdt_object_unlock(info, obj, lh, 1);
 out_ucred:
+	if (pcc_attach)
+		up_write(&obj->mot_open_sem);
 	mdt_exit_ucred(info);
 out:
 	mdt_thread_info_fini(info);
@@ -773,6 +773,8 @@ struct mdt_thread_info *tsi2mdt_info(struct tgt_session_info *tsi);
 
 int mdt_hsm_attr_set(struct mdt_thread_info *info, struct mdt_object *obj,
 		     const struct md_hsm *mh);
+int mdt_pcc_revoke(struct mdt_thread_info *info, struct mdt_object *obj,
+		   struct md_hsm *mh);
 
 int mdt_remote_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 			    void *data, int flag);
@@ -939,6 +941,8 @@ int mdt_hsm_update_request_state(struct mdt_thread_info *mti,
 
 int mdt_close_swap_layouts(struct mdt_thread_info *info,
 			   struct mdt_object *o, struct md_attr *ma);
+int mdt_layout_change(struct mdt_thread_info *info, struct mdt_object *obj,
+		      struct layout_intent *layout, const struct lu_buf *buf);
 
 extern struct lu_context_key       mdt_thread_key;
 
@@ -1062,6 +1066,21 @@ static inline enum ldlm_mode mdt_mdl_mode2dlm_mode(mdl_mode_t mode)
 /* mdt_lvb.c */
 extern struct ldlm_valblock_ops mdt_lvbo;
 
+/* mdt_io.c */
+int mdt_obd_preprw(const struct lu_env *env, int cmd, struct obd_export *exp,
+		   struct obdo *oa, int objcount, struct obd_ioobj *obj,
+		   struct niobuf_remote *rnb, int *nr_local,
+		   struct niobuf_local *lnb);
+int mdt_obd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
+		     struct obdo *oa, int objcount, struct obd_ioobj *obj,
+		     struct niobuf_remote *rnb, int npages,
+		     struct niobuf_local *lnb, int old_rc);
+int mdt_punch_hdl(struct tgt_session_info *tsi);
+int mdt_data_sync(struct tgt_session_info *tsi);
+int mdt_data_setattr(struct tgt_session_info *tsi);
+int mdt_dom_lvb_fill(const struct lu_env *env, struct mdt_device *mdt,
+		     const struct lu_fid *fid, struct ost_lvb *lvb);
+
 void mdt_enable_cos(struct mdt_device *, int);
 int mdt_cos_is_enabled(struct mdt_device *);
 
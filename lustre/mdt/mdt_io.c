@@ -0,0 +1,716 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2017, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/mdt/mdt_io.c
+ *
+ * Data-on-MDT I/O handling. The data of the first component of a DoM
+ * file is stored in the MDT object itself, so the bulk I/O, punch and sync
+ * requests sent by the MDC to the MDS_IO_PORTAL are served here in the same
+ * way the OFD serves them for OST objects.
+ *
+ * Grant and quota are not used for DoM data, so all DoM writes are sent by
+ * the client synchronously.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include <dt_object.h>
+#include "mdt_internal.h"
+
+/**
+ * Get the end of the DoM component from the layout of \a mo.
+ *
+ * \param[in] env	execution environment
+ * \param[in] mo	MDT object
+ * \param[out] end	end offset of the DoM component
+ *
+ * \retval		0 if successful
+ * \retval		-EPROTO if the layout has no DoM component
+ * \retval		negative value on other errors
+ */
+static int mdt_dom_component_end(const struct lu_env *env,
+				 struct mdt_object *mo, __u64 *end)
+{
+	struct lu_buf buf = LU_BUF_NULL;
+	struct lov_comp_md_v1 *comp;
+	struct lov_comp_md_entry_v1 *ent;
+	struct lov_mds_md *v1;
+	__u32 offset;
+	int size;
+	int rc;
+	int i;
+
+	rc = mo_xattr_get(env, mdt_object_child(mo), &LU_BUF_NULL,
+			  XATTR_NAME_LOV);
+	if (rc == -ENODATA)
+		return -EPROTO;
+	if (rc < 0)
+		return rc;
+
+	lu_buf_alloc(&buf, rc);
+	if (buf.lb_buf == NULL)
+		return -ENOMEM;
+
+	rc = mo_xattr_get(env, mdt_object_child(mo), &buf, XATTR_NAME_LOV);
+	if (rc == -ENODATA)
+		GOTO(out, rc = -EPROTO);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	/* the layout is stored little-endian */
+	size = rc;
+	comp = buf.lb_buf;
+	rc = -EPROTO;
+	if (size < sizeof(*comp) ||
+	    le32_to_cpu(comp->lcm_magic) != LOV_MAGIC_COMP_V1)
+		GOTO(out, rc);
+
+	for (i = 0; i < le16_to_cpu(comp->lcm_entry_count); i++) {
+		ent = &comp->lcm_entries[i];
+		if ((char *)(ent + 1) > (char *)comp + size)
+			break;
+
+		offset = le32_to_cpu(ent->lcme_offset);
+		if (offset + sizeof(*v1) > size)
+			break;
+
+		v1 = (struct lov_mds_md *)((char *)comp + offset);
+		if (lov_pattern(le32_to_cpu(v1->lmm_pattern)) ==
+		    LOV_PATTERN_MDT) {
+			*end = le64_to_cpu(ent->lcme_extent.e_end);
+			GOTO(out, rc = 0);
+		}
+	}
+out:
+	lu_buf_free(&buf);
+	return rc;
+}
+
+/**
+ * Find the MDT object for DoM I/O and check that it exists and is a regular
+ * file with a DoM component. Other objects, e.g. directories or files with
+ * all their data on OSTs, must never be read or written through this path.
+ *
+ * \param[in] env	execution environment
+ * \param[in] mdt	MDT device
+ * \param[in] fid	FID of the file
+ * \param[out] dom_end	end offset of the DoM component, may be NULL
+ *
+ * \retval		MDT object with a reference held
+ * \retval		ERR_PTR on error
+ */
+static struct mdt_object *mdt_dom_object_find(const struct lu_env *env,
+					      struct mdt_device *mdt,
+					      const struct lu_fid *fid,
+					      __u64 *dom_end)
+{
+	struct mdt_object *mo;
+	__u64 end;
+	int rc;
+
+	mo = mdt_object_find(env, mdt, fid);
+	if (IS_ERR(mo))
+		return mo;
+
+	if (!mdt_object_exists(mo) || mdt_object_remote(mo))
+		GOTO(out_put, rc = -ENOENT);
+
+	if (!S_ISREG(lu_object_attr(&mo->mot_obj)))
+		GOTO(out_put, rc = -EPROTO);
+
+	rc = mdt_dom_component_end(env, mo, &end);
+	if (rc != 0)
+		GOTO(out_put, rc);
+
+	if (dom_end != NULL)
+		*dom_end = end;
+
+	return mo;
+
+out_put:
+	CDEBUG(D_INODE, "%s: no DoM I/O for "DFID": rc = %d\n",
+	       mdt_obd_name(mdt), PFID(fid), rc);
+	mdt_object_put(env, mo);
+	return ERR_PTR(rc);
+}
+
+static int mdt_preprw_read(const struct lu_env *env, struct obd_export *exp,
+			   struct mdt_object *mo, struct lu_attr *la,
+			   int niocount, struct niobuf_remote *rnb,
+			   int *nr_local, struct niobuf_local *lnb)
+{
+	struct dt_object *dob = mdt_obj2dt(mo);
+	enum dt_bufs_type dbt = DT_BUFS_TYPE_READ;
+	int i, j, rc;
+
+	ENTRY;
+
+	if (ptlrpc_connection_is_local(exp->exp_connection))
+		dbt |= DT_BUFS_TYPE_LOCAL;
+
+	dt_read_lock(env, dob, 0);
+	for (*nr_local = 0, i = 0, j = 0; i < niocount; i++) {
+		rc = dt_bufs_get(env, dob, rnb + i, lnb + j, dbt);
+		if (unlikely(rc < 0))
+			GOTO(buf_put, rc);
+		LASSERT(rc <= PTLRPC_MAX_BRW_PAGES);
+		/* correct index for local buffers to continue with */
+		j += rc;
+		*nr_local += rc;
+		LASSERT(j <= PTLRPC_MAX_BRW_PAGES);
+	}
+
+	LASSERT(*nr_local > 0 && *nr_local <= PTLRPC_MAX_BRW_PAGES);
+	rc = dt_attr_get(env, dob, la);
+	if (unlikely(rc))
+		GOTO(buf_put, rc);
+
+	rc = dt_read_prep(env, dob, lnb, *nr_local);
+	if (unlikely(rc))
+		GOTO(buf_put, rc);
+
+	RETURN(0);
+
+buf_put:
+	dt_bufs_put(env, dob, lnb, *nr_local);
+	dt_read_unlock(env, dob);
+	return rc;
+}
+
+static int mdt_preprw_write(const struct lu_env *env, struct obd_export *exp,
+			    struct mdt_object *mo, struct obd_ioobj *obj,
+			    struct niobuf_remote *rnb, int *nr_local,
+			    struct niobuf_local *lnb)
+{
+	struct dt_object *dob = mdt_obj2dt(mo);
+	enum dt_bufs_type dbt = DT_BUFS_TYPE_WRITE;
+	int i, j, k, rc;
+
+	ENTRY;
+
+	if (ptlrpc_connection_is_local(exp->exp_connection))
+		dbt |= DT_BUFS_TYPE_LOCAL;
+
+	dt_read_lock(env, dob, 0);
+	/* parse remote buffers to local buffers and prepare the latter */
+	for (*nr_local = 0, i = 0, j = 0; i < obj->ioo_bufcnt; i++) {
+		rc = dt_bufs_get(env, dob, rnb + i, lnb + j, dbt);
+		if (unlikely(rc < 0))
+			GOTO(err, rc);
+		LASSERT(rc <= PTLRPC_MAX_BRW_PAGES);
+		/* correct index for local buffers to continue with */
+		for (k = 0; k < rc; k++) {
+			lnb[j + k].lnb_flags = rnb[i].rnb_flags;
+			lnb[j + k].lnb_flags &= ~OBD_BRW_LOCALS;
+		}
+		j += rc;
+		*nr_local += rc;
+		LASSERT(j <= PTLRPC_MAX_BRW_PAGES);
+	}
+	LASSERT(*nr_local > 0 && *nr_local <= PTLRPC_MAX_BRW_PAGES);
+
+	rc = dt_write_prep(env, dob, lnb, *nr_local);
+	if (unlikely(rc != 0))
+		GOTO(err, rc);
+
+	RETURN(0);
+err:
+	dt_bufs_put(env, dob, lnb, *nr_local);
+	dt_read_unlock(env, dob);
+	return rc;
+}
+
+/**
+ * Prepare bulk IO for a Data-on-MDT object.
+ *
+ * Implementation of obd_ops::o_preprw for the MDT, see ofd_preprw() for
+ * the OST counterpart. The object reference taken here is released by
+ * mdt_obd_commitrw().
+ *
+ * \retval		0 on successful prepare
+ * \retval		negative value on error
+ */
+int mdt_obd_preprw(const struct lu_env *env, int cmd, struct obd_export *exp,
+		   struct obdo *oa, int objcount, struct obd_ioobj *obj,
+		   struct niobuf_remote *rnb, int *nr_local,
+		   struct niobuf_local *lnb)
+{
+	struct mdt_thread_info *info = mdt_th_info(env);
+	struct mdt_device *mdt = mdt_exp2dev(exp);
+	struct lu_attr *la = &info->mti_attr.ma_attr;
+	struct mdt_object *mo;
+	__u64 dom_end;
+	int rc;
+	int i;
+
+	ENTRY;
+
+	if (*nr_local > PTLRPC_MAX_BRW_PAGES) {
+		CERROR("%s: bulk has too many pages %d, which exceeds the "
+		       "maximum pages per RPC of %d\n",
+		       exp->exp_obd->obd_name, *nr_local, PTLRPC_MAX_BRW_PAGES);
+		RETURN(-EPROTO);
+	}
+
+	LASSERT(oa != NULL);
+	LASSERT(objcount == 1);
+	LASSERT(obj->ioo_bufcnt > 0);
+
+	/* there is no grant on MDT, don't let the client count on any */
+	oa->o_valid &= ~OBD_MD_FLGRANT;
+	oa->o_grant = 0;
+
+	mo = mdt_dom_object_find(env, mdt, &oa->o_oi.oi_fid, &dom_end);
+	if (IS_ERR(mo))
+		RETURN(PTR_ERR(mo));
+
+	if (cmd == OBD_BRW_WRITE) {
+		/* the MDT only stores the data of the DoM component */
+		for (i = 0; i < obj->ioo_bufcnt; i++) {
+			if (rnb[i].rnb_offset < dom_end &&
+			    rnb[i].rnb_len <= dom_end - rnb[i].rnb_offset)
+				continue;
+			CERROR("%s: write [%llu, %llu) beyond the DoM component"
+			       " end %llu of "DFID"\n", exp->exp_obd->obd_name,
+			       rnb[i].rnb_offset,
+			       rnb[i].rnb_offset + rnb[i].rnb_len, dom_end,
+			       PFID(&oa->o_oi.oi_fid));
+			GOTO(out, rc = -EPROTO);
+		}
+		rc = mdt_preprw_write(env, exp, mo, obj, rnb, nr_local, lnb);
+	} else if (cmd == OBD_BRW_READ) {
+		la->la_valid = 0;
+		rc = mdt_preprw_read(env, exp, mo, la, obj->ioo_bufcnt,
+				     rnb, nr_local, lnb);
+		if (rc == 0)
+			obdo_from_la(oa, la, LA_ATIME);
+	} else {
+		CERROR("%s: wrong cmd %d received!\n",
+		       exp->exp_obd->obd_name, cmd);
+		rc = -EPROTO;
+	}
+out:
+	if (rc != 0)
+		mdt_object_put(env, mo);
+	RETURN(rc);
+}
+
+static int mdt_commitrw_write(const struct lu_env *env, struct obd_export *exp,
+			      struct mdt_device *mdt, struct mdt_object *mo,
+			      struct lu_attr *la, int niocount,
+			      struct niobuf_local *lnb, int old_rc)
+{
+	struct dt_device *dt = mdt->mdt_bottom;
+	struct dt_object *dob = mdt_obj2dt(mo);
+	struct thandle *th;
+	int rc = 0;
+	int rc2;
+	int retries = 0;
+
+	ENTRY;
+
+	if (old_rc)
+		GOTO(out, rc = old_rc);
+
+	la->la_valid &= LA_ATIME | LA_MTIME | LA_CTIME;
+retry:
+	th = dt_trans_create(env, dt);
+	if (IS_ERR(th))
+		GOTO(out, rc = PTR_ERR(th));
+
+	/* there is no grant on MDT, so DoM writes are always synchronous */
+	th->th_sync = 1;
+
+	rc = dt_declare_write_commit(env, dob, lnb, niocount, th);
+	if (rc)
+		GOTO(out_stop, rc);
+
+	if (la->la_valid) {
+		/* update [mac]time if needed */
+		rc = dt_declare_attr_set(env, dob, la, th);
+		if (rc)
+			GOTO(out_stop, rc);
+	}
+
+	rc = dt_trans_start(env, dt, th);
+	if (rc)
+		GOTO(out_stop, rc);
+
+	rc = dt_write_commit(env, dob, lnb, niocount, th);
+	if (rc)
+		GOTO(out_stop, rc);
+
+	if (la->la_valid) {
+		rc = dt_attr_set(env, dob, la, th);
+		if (rc)
+			GOTO(out_stop, rc);
+	}
+
+	/* get attr to return */
+	rc = dt_attr_get(env, dob, la);
+out_stop:
+	th->th_result = rc;
+	rc2 = dt_trans_stop(env, dt, th);
+	if (!rc)
+		rc = rc2;
+	if (rc == -ENOSPC && retries++ < 3) {
+		CDEBUG(D_INODE, "retry after force commit, retries:%d\n",
+		       retries);
+		goto retry;
+	}
+out:
+	dt_bufs_put(env, dob, lnb, niocount);
+	dt_read_unlock(env, dob);
+	RETURN(rc);
+}
+
+/**
+ * Commit bulk IO for a Data-on-MDT object.
+ *
+ * Implementation of obd_ops::o_commitrw for the MDT, the companion of
+ * mdt_obd_preprw().
+ *
+ * \retval		0 on successful commit
+ * \retval		negative value on error
+ */
+int mdt_obd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
+		     struct obdo *oa, int objcount, struct obd_ioobj *obj,
+		     struct niobuf_remote *rnb, int npages,
+		     struct niobuf_local *lnb, int old_rc)
+{
+	struct mdt_thread_info *info = mdt_th_info(env);
+	struct mdt_device *mdt = mdt_exp2dev(exp);
+	struct lu_attr *la = &info->mti_attr.ma_attr;
+	struct mdt_object *mo;
+	int rc;
+
+	ENTRY;
+
+	LASSERT(npages > 0);
+
+	/* the reference taken in mdt_obd_preprw() is still held */
+	mo = mdt_object_find(env, mdt, &oa->o_oi.oi_fid);
+	LASSERT(!IS_ERR(mo));
+	LASSERT(mdt_object_exists(mo));
+
+	if (cmd == OBD_BRW_WRITE) {
+		la_from_obdo(la, oa, OBD_MD_FLATIME | OBD_MD_FLMTIME |
+				     OBD_MD_FLCTIME);
+		rc = mdt_commitrw_write(env, exp, mdt, mo, la, npages, lnb,
+					old_rc);
+		if (rc == 0)
+			obdo_from_la(oa, la, LA_ATIME | LA_MTIME | LA_CTIME |
+					     LA_SIZE | LA_BLOCKS);
+	} else if (cmd == OBD_BRW_READ) {
+		dt_bufs_put(env, mdt_obj2dt(mo), lnb, npages);
+		dt_read_unlock(env, mdt_obj2dt(mo));
+		rc = old_rc;
+	} else {
+		LBUG();
+		rc = -EPROTO;
+	}
+
+	mdt_object_put(env, mo);
+	/* second put is pair to object_find in mdt_obd_preprw() */
+	mdt_object_put(env, mo);
+	RETURN(rc);
+}
+
+/**
+ * Truncate the data of a Data-on-MDT object.
+ *
+ * OST_PUNCH handler for DoM files, see ofd_punch_hdl() for details.
+ *
+ * \param[in] tsi	target session environment for this request
+ *
+ * \retval		0 if successful
+ * \retval		negative value on error
+ */
+int mdt_punch_hdl(struct tgt_session_info *tsi)
+{
+	const struct obdo *oa = &tsi->tsi_ost_body->oa;
+	struct ldlm_namespace *ns = tsi->tsi_tgt->lut_obd->obd_namespace;
+	struct mdt_device *mdt = mdt_exp2dev(tsi->tsi_exp);
+	struct mdt_thread_info *info = tsi2mdt_info(tsi);
+	struct lu_attr *la = &info->mti_attr.ma_attr;
+	struct ost_body *repbody;
+	struct ldlm_resource *res;
+	struct mdt_object *mo;
+	struct dt_object *dob;
+	struct thandle *th;
+	struct lustre_handle lh = { 0, };
+	__u64 flags = 0;
+	__u64 start, end;
+	__u64 dom_end;
+	bool srvlock;
+	int rc, rc2;
+
+	ENTRY;
+
+	if ((oa->o_valid & (OBD_MD_FLSIZE | OBD_MD_FLBLOCKS)) !=
+	    (OBD_MD_FLSIZE | OBD_MD_FLBLOCKS))
+		GOTO(out_info, rc = err_serious(-EPROTO));
+
+	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
+	if (repbody == NULL)
+		GOTO(out_info, rc = err_serious(-ENOMEM));
+
+	/* punch start,end are passed in o_size,o_blocks throught wire */
+	start = oa->o_size;
+	end = oa->o_blocks;
+
+	if (end != OBD_OBJECT_EOF) /* Only truncate is supported */
+		GOTO(out_info, rc = -EPROTO);
+
+	/* standard truncate optimization: if file body is completely
+	 * destroyed, don't send data back to the server. */
+	if (start == 0)
+		flags |= LDLM_FL_AST_DISCARD_DATA;
+
+	repbody->oa.o_oi = oa->o_oi;
+	repbody->oa.o_valid = OBD_MD_FLID;
+
+	srvlock = oa->o_valid & OBD_MD_FLFLAGS &&
+		  oa->o_flags & OBD_FL_SRVLOCK;
+
+	if (srvlock) {
+		rc = tgt_extent_lock(ns, &tsi->tsi_resid, start, end, &lh,
+				     LCK_PW, &flags);
+		if (rc != 0)
+			GOTO(out_info, rc);
+	}
+
+	CDEBUG(D_INODE, "calling punch for DoM object "DFID", valid = %#llx"
+	       ", start = %lld, end = %lld\n", PFID(&tsi->tsi_fid),
+	       oa->o_valid, start, end);
+
+	mo = mdt_dom_object_find(tsi->tsi_env, mdt, &tsi->tsi_fid, &dom_end);
+	if (IS_ERR(mo))
+		GOTO(out_unlock, rc = PTR_ERR(mo));
+
+	/* the client never punches the DoM component beyond its end */
+	if (start > dom_end) {
+		mdt_object_put(tsi->tsi_env, mo);
+		GOTO(out_unlock, rc = -EPROTO);
+	}
+
+	la_from_obdo(la, oa, OBD_MD_FLMTIME | OBD_MD_FLATIME | OBD_MD_FLCTIME);
+	la->la_size = start;
+	la->la_valid |= LA_SIZE;
+
+	dob = mdt_obj2dt(mo);
+	dt_write_lock(tsi->tsi_env, dob, 0);
+
+	th = dt_trans_create(tsi->tsi_env, mdt->mdt_bottom);
+	if (IS_ERR(th))
+		GOTO(out_put, rc = PTR_ERR(th));
+
+	rc = dt_declare_attr_set(tsi->tsi_env, dob, la, th);
+	if (rc)
+		GOTO(out_stop, rc);
+
+	rc = dt_declare_punch(tsi->tsi_env, dob, start, OBD_OBJECT_EOF, th);
+	if (rc)
+		GOTO(out_stop, rc);
+
+	rc = dt_trans_start(tsi->tsi_env, mdt->mdt_bottom, th);
+	if (rc)
+		GOTO(out_stop, rc);
+
+	rc = dt_punch(tsi->tsi_env, dob, start, OBD_OBJECT_EOF, th);
+	if (rc)
+		GOTO(out_stop, rc);
+
+	rc = dt_attr_set(tsi->tsi_env, dob, la, th);
+	EXIT;
+out_stop:
+	th->th_result = rc;
+	rc2 = dt_trans_stop(tsi->tsi_env, mdt->mdt_bottom, th);
+	if (rc == 0)
+		rc = rc2;
+out_put:
+	dt_write_unlock(tsi->tsi_env, dob);
+	mdt_object_put(tsi->tsi_env, mo);
+out_unlock:
+	if (srvlock)
+		tgt_extent_unlock(&lh, LCK_PW);
+	if (rc == 0) {
+		/* refresh the DoM lock value block after the truncate, this
+		 * is done after the object is released, see ofd_punch_hdl() */
+		res = ldlm_resource_get(ns, NULL, &tsi->tsi_resid,
+					LDLM_EXTENT, 0);
+		if (!IS_ERR(res)) {
+			ldlm_res_lvbo_update(res, NULL, 0);
+			ldlm_resource_putref(res);
+		}
+	}
+out_info:
+	mdt_thread_info_fini(info);
+	return rc;
+}
+
+/**
+ * Sync the data of a Data-on-MDT object to disk.
+ *
+ * OST_SYNC handler for DoM files.
+ *
+ * \param[in] tsi	target session environment for this request
+ *
+ * \retval		0 if successful
+ * \retval		negative value on error
+ */
+int mdt_data_sync(struct tgt_session_info *tsi)
+{
+	struct mdt_device *mdt = mdt_exp2dev(tsi->tsi_exp);
+	struct mdt_thread_info *info = tsi2mdt_info(tsi);
+	struct lu_attr *la = &info->mti_attr.ma_attr;
+	struct ost_body *body = tsi->tsi_ost_body;
+	struct ost_body *repbody;
+	struct mdt_object *mo;
+	struct dt_object *dob;
+	int rc;
+
+	ENTRY;
+
+	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
+
+	/* if no objid is specified, it means "sync whole filesystem" */
+	if (!fid_is_sane(&tsi->tsi_fid)) {
+		rc = tgt_sync(tsi->tsi_env, tsi->tsi_tgt, NULL, 0,
+			      OBD_OBJECT_EOF);
+		GOTO(out, rc);
+	}
+
+	mo = mdt_dom_object_find(tsi->tsi_env, mdt, &tsi->tsi_fid, NULL);
+	if (IS_ERR(mo))
+		GOTO(out, rc = PTR_ERR(mo));
+
+	dob = mdt_obj2dt(mo);
+	rc = tgt_sync(tsi->tsi_env, tsi->tsi_tgt, dob,
+		      body->oa.o_size, body->oa.o_blocks);
+	if (rc == 0) {
+		la->la_valid = 0;
+		rc = dt_attr_get(tsi->tsi_env, dob, la);
+		if (rc == 0) {
+			repbody->oa.o_oi = body->oa.o_oi;
+			repbody->oa.o_valid = OBD_MD_FLID;
+			obdo_from_la(&repbody->oa, la, LA_ATIME | LA_MTIME |
+				     LA_CTIME | LA_SIZE | LA_BLOCKS);
+		}
+	}
+	mdt_object_put(tsi->tsi_env, mo);
+	EXIT;
+out:
+	mdt_thread_info_fini(info);
+	return rc;
+}
+
+/**
+ * Return the attributes of a Data-on-MDT object.
+ *
+ * OST_SETATTR handler for DoM files. File attributes are changed through
+ * the metadata path by the MDS_REINT setattr already, so there is nothing
+ * left to update here and the current attributes are just returned.
+ *
+ * \param[in] tsi	target session environment for this request
+ *
+ * \retval		0 if successful
+ * \retval		negative value on error
+ */
+int mdt_data_setattr(struct tgt_session_info *tsi)
+{
+	struct mdt_device *mdt = mdt_exp2dev(tsi->tsi_exp);
+	struct mdt_thread_info *info = tsi2mdt_info(tsi);
+	struct lu_attr *la = &info->mti_attr.ma_attr;
+	struct ost_body *body = tsi->tsi_ost_body;
+	struct ost_body *repbody;
+	struct mdt_object *mo;
+	int rc;
+
+	ENTRY;
+
+	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
+	if (repbody == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	mo = mdt_dom_object_find(tsi->tsi_env, mdt, &tsi->tsi_fid, NULL);
+	if (IS_ERR(mo))
+		GOTO(out, rc = PTR_ERR(mo));
+
+	la->la_valid = 0;
+	rc = dt_attr_get(tsi->tsi_env, mdt_obj2dt(mo), la);
+	if (rc == 0) {
+		repbody->oa.o_oi = body->oa.o_oi;
+		repbody->oa.o_valid = OBD_MD_FLID;
+		obdo_from_la(&repbody->oa, la, LA_ATIME | LA_MTIME | LA_CTIME |
+			     LA_SIZE | LA_BLOCKS);
+	}
+	mdt_object_put(tsi->tsi_env, mo);
+	EXIT;
+out:
+	mdt_thread_info_fini(info);
+	return rc;
+}
+
+/**
+ * Fill the lock value block of a DoM data lock.
+ *
+ * The size, blocks and times are taken from the MDT object, which is the
+ * only place the data of the DoM component lives in.
+ *
+ * \param[in] env	execution environment
+ * \param[in] mdt	MDT device
+ * \param[in] fid	FID of the file
+ * \param[out] lvb	lock value block to fill
+ *
+ * \retval		0 if successful
+ * \retval		negative value on error
+ */
+int mdt_dom_lvb_fill(const struct lu_env *env, struct mdt_device *mdt,
+		     const struct lu_fid *fid, struct ost_lvb *lvb)
+{
+	struct lu_attr la = { 0 };
+	struct mdt_object *mo;
+	int rc;
+
+	ENTRY;
+
+	mo = mdt_dom_object_find(env, mdt, fid, NULL);
+	if (IS_ERR(mo))
+		RETURN(PTR_ERR(mo));
+
+	rc = dt_attr_get(env, mdt_obj2dt(mo), &la);
+	if (rc == 0) {
+		lvb->lvb_size = la.la_size;
+		lvb->lvb_blocks = la.la_blocks;
+		lvb->lvb_mtime = la.la_mtime;
+		lvb->lvb_atime = la.la_atime;
+		lvb->lvb_ctime = la.la_ctime;
+	}
+	mdt_object_put(env, mo);
+	RETURN(rc);
+}
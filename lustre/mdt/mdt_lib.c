@@ -591,7 +591,8 @@ int mdt_init_ucred_reint(struct mdt_thread_info *info)
 
 	/* LU-5564: for normal close request, skip permission check */
 	if (lustre_msg_get_opc(req->rq_reqmsg) == MDS_CLOSE &&
-	    !(ma->ma_attr_flags & (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP)))
+	    !(ma->ma_attr_flags & (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP |
+				   MDS_CLOSE_RESYNC_DONE)))
 		uc->uc_cap |= CFS_CAP_FS_MASK;
 
 	mdt_exit_ucred(info);
@@ -1087,6 +1088,11 @@ static int mdt_setattr_unpack_rec(struct mdt_thread_info *info)
 	else
 		ma->ma_attr_flags &= ~MDS_CLOSE_LAYOUT_SWAP;
 
+	if (rec->sa_bias & MDS_CLOSE_RESYNC_DONE)
+		ma->ma_attr_flags |= MDS_CLOSE_RESYNC_DONE;
+	else
+		ma->ma_attr_flags &= ~MDS_CLOSE_RESYNC_DONE;
+
 	RETURN(0);
 }
 
@@ -1165,7 +1171,8 @@ static int mdt_intent_close_unpack(struct mdt_thread_info *info)
 	struct req_capsule	*pill = info->mti_pill;
 	ENTRY;
 
-	if (!(ma->ma_attr_flags & (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP)))
+	if (!(ma->ma_attr_flags & (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP |
+				   MDS_CLOSE_RESYNC_DONE)))
 		RETURN(0);
 
 	req_capsule_extend(pill, &RQF_MDS_INTENT_CLOSE);
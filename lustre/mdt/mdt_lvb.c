@@ -33,6 +33,13 @@
 
 #include "mdt_internal.h"
 
+/* Data-on-MDT data lock, see fid_build_dom_res_name() */
+static inline bool mdt_res_is_dom(struct ldlm_resource *res)
+{
+	return res->lr_type == LDLM_EXTENT &&
+	       fid_res_name_is_dom(&res->lr_name);
+}
+
 /* Called with res->lr_lvb_sem held */
 static int mdt_lvbo_init(struct ldlm_resource *res)
 {
@@ -86,6 +93,9 @@ static int mdt_lvbo_size(struct ldlm_lock *lock)
 		return qmt_hdls.qmth_lvbo_size(mdt->mdt_qmt_dev, lock);
 	}
 
+	if (mdt_res_is_dom(lock->l_resource))
+		return sizeof(struct ost_lvb);
+
 	if (ldlm_has_layout(lock))
 		return mdt->mdt_max_mdsize;
 
@@ -98,6 +108,7 @@ static int mdt_lvbo_fill(struct ldlm_lock *lock, void *lvb, int lvblen)
 	struct mdt_thread_info *info;
 	struct mdt_device *mdt;
 	struct lu_fid *fid;
+	struct lu_fid dom_fid;
 	struct mdt_object *obj = NULL;
 	struct md_object *child = NULL;
 	int rc;
@@ -114,6 +125,20 @@ static int mdt_lvbo_fill(struct ldlm_lock *lock, void *lvb, int lvblen)
 		RETURN(rc);
 	}
 
+	if (mdt_res_is_dom(lock->l_resource)) {
+		if (lvblen < sizeof(struct ost_lvb))
+			RETURN(0);
+
+		rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+		if (rc)
+			RETURN(0);
+
+		fid_extract_from_res_name(&dom_fid, &lock->l_resource->lr_name);
+		rc = mdt_dom_lvb_fill(&env, mdt, &dom_fid, lvb);
+		lu_env_fini(&env);
+		RETURN(rc < 0 ? 0 : sizeof(struct ost_lvb));
+	}
+
 	/* Only fill layout if layout lock is granted */
 	if (!ldlm_has_layout(lock) || lock->l_granted_mode != lock->l_req_mode)
 		RETURN(0);
@@ -44,8 +44,9 @@
 #include <lustre_nodemap.h>
 
 /* we do nothing because we do not have refcount now */
-static void mdt_mfd_get(void *mfdp)
+static bool mdt_mfd_get(void *mfdp)
 {
+	return true;
 }
 
 static struct portals_handle_ops mfd_handle_ops = {
@@ -827,6 +828,15 @@ static int mdt_object_open_lock(struct mdt_thread_info *info,
 		/* normal open holds read mode of open sem */
 		down_read(&obj->mot_open_sem);
 
+		/* the data is going to change, drop the read-only copies
+		 * cached by clients before the writer is accounted */
+		if (open_flags & (FMODE_WRITE | MDS_OPEN_TRUNC) &&
+		    ma->ma_valid & MA_HSM && ma->ma_hsm.mh_flags & HS_PCCRO) {
+			rc = mdt_pcc_revoke(info, obj, &ma->ma_hsm);
+			if (rc < 0)
+				GOTO(out, rc);
+		}
+
 		if (open_flags & MDS_OPEN_LOCK) {
 			if (open_flags & FMODE_WRITE)
 				lm = LCK_CW;
@@ -1062,7 +1072,7 @@ static int mdt_open_by_fid_lock(struct mdt_thread_info *info,
 	mdt_set_disposition(info, rep, (DISP_IT_EXECD | DISP_LOOKUP_EXECD));
 
 	mdt_prep_ma_buf_from_rep(info, o, ma);
-	if (flags & MDS_OPEN_RELEASE)
+	if (flags & (MDS_OPEN_RELEASE | FMODE_WRITE | MDS_OPEN_TRUNC))
 		ma->ma_need |= MA_HSM;
 	rc = mdt_attr_get_complex(info, o, ma);
 	if (rc)
@@ -2014,6 +2024,87 @@ out_lease:
 	return rc;
 }
 
+/**
+ * Finish the resync of a mirrored file on close of the resync lease.
+ *
+ * The stale flags are only cleared if the lease is still valid, i.e.
+ * nobody else opened the file while it was resynced, and the file has
+ * not been written since the resync started.
+ */
+static int mdt_close_resync_done(struct mdt_thread_info *info,
+				 struct mdt_object *o, struct md_attr *ma)
+{
+	struct layout_intent	 layout = {
+		.li_opc		= LAYOUT_INTENT_RESYNC_DONE,
+		.li_start	= 0,
+		.li_end		= LUSTRE_EOF,
+	};
+	struct close_data	*data;
+	struct ldlm_lock	*lease;
+	bool			 lease_broken;
+	int			 rc;
+	ENTRY;
+
+	if (exp_connect_flags(info->mti_exp) & OBD_CONNECT_RDONLY)
+		RETURN(-EROFS);
+
+	if (!S_ISREG(lu_object_attr(&o->mot_obj)))
+		RETURN(-EINVAL);
+
+	data = req_capsule_client_get(info->mti_pill, &RMF_CLOSE_DATA);
+	if (data == NULL)
+		RETURN(-EPROTO);
+
+	lease = ldlm_handle2lock(&data->cd_handle);
+	if (lease == NULL)
+		RETURN(-ESTALE);
+
+	/* try to hold open_sem so that nobody else can open the file */
+	if (!down_write_trylock(&o->mot_open_sem)) {
+		ldlm_lock_cancel(lease);
+		GOTO(out_reprocess, rc = -EBUSY);
+	}
+
+	/* Check if the lease open lease has already canceled */
+	lock_res_and_lock(lease);
+	lease_broken = ldlm_is_cancel(lease);
+	unlock_res_and_lock(lease);
+
+	LDLM_DEBUG(lease, DFID " lease broken? %d",
+		   PFID(mdt_object_fid(o)), lease_broken);
+
+	/* Cancel server side lease. Client side counterpart should
+	 * have been cancelled. It's okay to cancel it now as we've
+	 * held mot_open_sem. */
+	ldlm_lock_cancel(lease);
+
+	if (lease_broken)
+		GOTO(out_unlock_sem, rc = -ESTALE);
+
+	rc = mdt_layout_change(info, o, &layout, NULL);
+	EXIT;
+
+out_unlock_sem:
+	up_write(&o->mot_open_sem);
+
+	if (rc == 0) {
+		struct mdt_body *repbody;
+
+		repbody = req_capsule_server_get(info->mti_pill, &RMF_MDT_BODY);
+		LASSERT(repbody != NULL);
+		repbody->mbo_valid |= OBD_MD_CLOSE_INTENT_EXECED;
+	}
+
+out_reprocess:
+	ldlm_reprocess_all(lease->l_resource);
+	LDLM_LOCK_PUT(lease);
+
+	ma->ma_valid = 0;
+	ma->ma_need = 0;
+
+	return rc;
+}
+
 #define MFD_CLOSED(mode) ((mode) == MDS_FMODE_CLOSED)
 static int mdt_mfd_closed(struct mdt_file_data *mfd)
 {
@@ -2052,6 +2143,17 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
 		}
 	}
 
+	if (ma->ma_attr_flags & MDS_CLOSE_RESYNC_DONE) {
+		rc = mdt_close_resync_done(info, o, ma);
+		if (rc < 0) {
+			CDEBUG(D_INODE,
+			       "%s: cannot finish resync of "DFID": rc=%d\n",
+			       mdt_obd_name(info->mti_mdt),
+			       PFID(mdt_object_fid(o)), rc);
+			/* continue to close even if error occurred. */
+		}
+	}
+
 	if (mode & FMODE_WRITE)
 		mdt_write_put(o);
 	else if (mode & MDS_FMODE_EXEC)
@@ -736,6 +736,13 @@ static int mdt_reint_setattr(struct mdt_thread_info *info,
 		/* Check write access for the O_TRUNC case */
 		if (mdt_write_read(mo) < 0)
 			GOTO(out_put, rc = -ETXTBSY);
+
+		/* drop the read-only copies cached by clients */
+		down_read(&mo->mot_open_sem);
+		rc = mdt_pcc_revoke(info, mo, NULL);
+		up_read(&mo->mot_open_sem);
+		if (rc < 0)
+			GOTO(out_put, rc);
 	}
 
 	if ((ma->ma_valid & MA_INODE) && ma->ma_attr.la_valid) {
@@ -954,9 +954,9 @@ static void class_export_destroy(struct obd_export *exp)
         EXIT;
 }
 
-static void export_handle_addref(void *export)
+static bool export_handle_addref(void *export)
 {
-        class_export_get(export);
+	return atomic_inc_not_zero(&((struct obd_export *)export)->exp_refcount);
 }
 
 static struct portals_handle_ops export_handle_ops = {
@@ -1196,9 +1196,9 @@ static void class_import_destroy(struct obd_import *imp)
         EXIT;
 }
 
-static void import_handle_addref(void *import)
+static bool import_handle_addref(void *import)
 {
-        class_import_get(import);
+	return atomic_inc_not_zero(&((struct obd_import *)import)->imp_refcount);
 }
 
 static struct portals_handle_ops import_handle_ops = {
@@ -0,0 +1,269 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2017, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/obdclass/handle_test.c
+ *
+ * Functional test of class_handle2object(), the lookup behind every
+ * ldlm_handle2lock() and class_conn2export().
+ *
+ * The module hashes \a nr_handles handles and checks that each of them is
+ * found, with a reference, by its cookie and owner only. It then looks the
+ * handles up from \a threads threads while every other handle is released
+ * and unhashed, and checks that a lookup never returns another object or
+ * one without a reference. Like tests/kernel/kinode.ko it is never loaded:
+ * the results are in the console messages tagged with \a run_id.
+ */
+
+#define DEBUG_SUBSYSTEM S_CLASS
+
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/kthread.h>
+
+#include <obd_support.h>
+#include <obd_class.h>
+#include <lustre_handles.h>
+
+static int run_id;
+module_param(run_id, int, 0644);
+MODULE_PARM_DESC(run_id, "run ID, printed in the messages");
+
+static int threads;
+module_param(threads, int, 0644);
+MODULE_PARM_DESC(threads, "number of lookup threads (default: online CPUs)");
+
+static int nr_handles = 65536;
+module_param(nr_handles, int, 0644);
+MODULE_PARM_DESC(nr_handles, "number of handles looked up");
+
+#define PREFIX "lustre_handle_test_%u:"
+
+struct handle_test_obj {
+	struct portals_handle	hto_handle;
+	atomic_t		hto_refcount;
+};
+
+struct handle_test_thread {
+	struct task_struct	*htt_task;
+	unsigned int		 htt_index;
+	__u64			 htt_lookups;
+	int			 htt_errors;
+};
+
+static struct handle_test_obj *hto_objs;
+
+static bool handle_test_addref(void *object)
+{
+	return atomic_inc_not_zero(
+			&((struct handle_test_obj *)object)->hto_refcount);
+}
+
+static struct portals_handle_ops handle_test_ops = {
+	.hop_addref = handle_test_addref,
+	.hop_free   = NULL,
+};
+
+/* Odd handles are released and unhashed while the threads run. */
+static inline bool handle_test_stable(int i)
+{
+	return (i & 1) == 0;
+}
+
+static int handle_test_thread_main(void *data)
+{
+	struct handle_test_thread *htt = data;
+	struct handle_test_obj *obj;
+	unsigned int i = htt->htt_index * 7919;
+
+	while (!kthread_should_stop()) {
+		/* stride through the handles, threads start apart */
+		i = (i + 4099) % nr_handles;
+		obj = class_handle2object(hto_objs[i].hto_handle.h_cookie,
+					  &handle_test_ops);
+		if (obj != NULL && obj != &hto_objs[i])
+			htt->htt_errors++;
+		else if (obj == NULL && handle_test_stable(i))
+			htt->htt_errors++;
+		if (obj != NULL)
+			atomic_dec(&obj->hto_refcount);
+		htt->htt_lookups++;
+
+		if ((htt->htt_lookups & 1023) == 0)
+			cond_resched();
+	}
+
+	return 0;
+}
+
+/* Look up every handle from this thread, \a unhashed tells which are gone */
+static int handle_test_check(const char *step, bool unhashed)
+{
+	struct handle_test_obj *obj;
+	int errors = 0;
+	int i;
+
+	for (i = 0; i < nr_handles; i++) {
+		obj = class_handle2object(hto_objs[i].hto_handle.h_cookie,
+					  &handle_test_ops);
+		if (unhashed && !handle_test_stable(i)) {
+			if (obj != NULL)
+				errors++;
+		} else if (obj != &hto_objs[i] ||
+			   atomic_read(&obj->hto_refcount) != 2) {
+			errors++;
+		}
+		if (obj != NULL)
+			atomic_dec(&obj->hto_refcount);
+
+		/* the cookie alone must not be enough */
+		obj = class_handle2object(hto_objs[i].hto_handle.h_cookie,
+					  hto_objs);
+		if (obj != NULL) {
+			errors++;
+			atomic_dec(&obj->hto_refcount);
+		}
+	}
+
+	if (errors != 0) {
+		pr_err(PREFIX " %s: %d lookups failed\n", run_id, step, errors);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int handle_test_unhash(struct handle_test_thread *htt)
+{
+	__u64 lookups = 0;
+	int errors = 0;
+	int rc = 0;
+	int nr;
+	int i;
+
+	for (nr = 0; nr < threads; nr++) {
+		htt[nr].htt_index = nr;
+		htt[nr].htt_lookups = 0;
+		htt[nr].htt_errors = 0;
+		htt[nr].htt_task = kthread_run(handle_test_thread_main,
+					       &htt[nr], "handle_test_%d", nr);
+		if (IS_ERR(htt[nr].htt_task)) {
+			rc = PTR_ERR(htt[nr].htt_task);
+			pr_err(PREFIX " cannot start thread: rc = %d\n",
+			       run_id, rc);
+			break;
+		}
+	}
+
+	/* release and unhash, as the last class_handle_put() would */
+	for (i = 0; i < nr_handles; i++) {
+		if (handle_test_stable(i))
+			continue;
+		atomic_dec(&hto_objs[i].hto_refcount);
+		class_handle_unhash(&hto_objs[i].hto_handle);
+		if ((i & 1023) == 1)
+			cond_resched();
+	}
+
+	for (i = 0; i < nr; i++) {
+		kthread_stop(htt[i].htt_task);
+		lookups += htt[i].htt_lookups;
+		errors += htt[i].htt_errors;
+	}
+
+	if (rc != 0)
+		return rc;
+
+	if (errors != 0) {
+		pr_err(PREFIX " %d threads: %d of %llu lookups failed\n",
+		       run_id, nr, errors, lookups);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int __init handle_test_init(void)
+{
+	struct handle_test_thread *htt;
+	int rc;
+	int i;
+
+	if (threads <= 0)
+		threads = num_online_cpus();
+	if (nr_handles <= 0) {
+		pr_err(PREFIX " invalid parameters\n", run_id);
+		goto out;
+	}
+
+	OBD_ALLOC_LARGE(hto_objs, sizeof(*hto_objs) * nr_handles);
+	if (hto_objs == NULL)
+		goto out;
+	OBD_ALLOC(htt, sizeof(*htt) * threads);
+	if (htt == NULL)
+		goto out_objs;
+
+	for (i = 0; i < nr_handles; i++) {
+		INIT_LIST_HEAD(&hto_objs[i].hto_handle.h_link);
+		atomic_set(&hto_objs[i].hto_refcount, 1);
+		hto_objs[i].hto_handle.h_owner = &handle_test_ops;
+		class_handle_hash(&hto_objs[i].hto_handle, &handle_test_ops);
+	}
+
+	rc = handle_test_check("hashed", false);
+	if (rc == 0)
+		rc = handle_test_unhash(htt);
+	if (rc == 0)
+		rc = handle_test_check("unhashed", true);
+	if (rc == 0)
+		pr_err(PREFIX " done\n", run_id);
+
+	/* handles already unhashed are skipped, h_in is 0 */
+	for (i = 0; i < nr_handles; i++)
+		class_handle_unhash(&hto_objs[i].hto_handle);
+	/* wait for the lockless lookups walking the buckets */
+	synchronize_rcu();
+
+	OBD_FREE(htt, sizeof(*htt) * threads);
+out_objs:
+	OBD_FREE_LARGE(hto_objs, sizeof(*hto_objs) * nr_handles);
+	hto_objs = NULL;
+out:
+	/* Don't load. */
+	return -EINVAL;
+}
+
+static void __exit handle_test_exit(void)
+{
+}
+
+MODULE_AUTHOR("OpenSFS, Inc. <http://www.lustre.org/>");
+MODULE_DESCRIPTION("Lustre handle lookup test module");
+MODULE_VERSION(LUSTRE_VERSION_STRING);
+MODULE_LICENSE("GPL");
+
+module_init(handle_test_init);
+module_exit(handle_test_exit);
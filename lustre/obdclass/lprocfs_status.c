@@ -820,6 +820,11 @@ static const char *obd_connect_names[] = {
 	"second_flags",
 	/* flags2 names */
 	"file_secctx",
+	"dom",
+	"batch_getattr",
+	"readdir_plus",
+	"batch_reint",
+	"lock_convert",
 	NULL
 };
 
@@ -1613,6 +1618,7 @@ void lprocfs_init_mps_stats(int num_private_stats, struct lprocfs_stats *stats)
         LPROCFS_MD_OP_INIT(num_private_stats, stats, lock_match);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, cancel_unused);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, intent_getattr_async);
+	LPROCFS_MD_OP_INIT(num_private_stats, stats, batch_getattr_async);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, revalidate_lock);
 }
 
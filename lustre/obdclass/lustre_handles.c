@@ -45,6 +45,16 @@ static __u64 handle_base;
 #define HANDLE_INCR 7
 static DEFINE_SPINLOCK(handle_base_lock);
 
+/* Cookies are taken from handle_base by batches of HANDLE_BATCH per CPT, so
+ * that handle creations on different CPTs do not share handle_base_lock */
+#define HANDLE_BATCH 64
+
+static struct handle_cpt {
+	spinlock_t	hc_lock;
+	__u64		hc_next;
+	unsigned int	hc_left;
+} **handle_cpts;
+
 static struct handle_bucket {
 	spinlock_t	 lock;
 	struct list_head head;
@@ -54,39 +64,61 @@ static struct handle_bucket {
 #define HANDLE_HASH_MASK (HANDLE_HASH_SIZE - 1)
 
 /*
- * Generate a unique 64bit cookie (hash) for a handle and insert it into
- * global (per-node) hash-table.
+ * Generate a unique 64bit cookie for a handle.
  */
-void class_handle_hash(struct portals_handle *h,
-		       struct portals_handle_ops *ops)
+static __u64 class_handle_cookie(void)
 {
-        struct handle_bucket *bucket;
-        ENTRY;
-
-        LASSERT(h != NULL);
-	LASSERT(list_empty(&h->h_link));
+	struct handle_cpt *hc;
+	__u64 cookie;
 
-        /*
-         * This is fast, but simplistic cookie generation algorithm, it will
-         * need a re-do at some point in the future for security.
-         */
-	spin_lock(&handle_base_lock);
-	handle_base += HANDLE_INCR;
+	hc = handle_cpts[cfs_cpt_current(cfs_cpt_table, 0)];
+	spin_lock(&hc->hc_lock);
+	if (hc->hc_left == 0) {
+		/*
+		 * This is fast, but simplistic cookie generation algorithm,
+		 * it will need a re-do at some point in the future for
+		 * security.
+		 */
+		spin_lock(&handle_base_lock);
+		hc->hc_next = handle_base + HANDLE_INCR;
+		handle_base += HANDLE_INCR * HANDLE_BATCH;
+		spin_unlock(&handle_base_lock);
+		hc->hc_left = HANDLE_BATCH;
+	}
 
-	if (unlikely(handle_base == 0)) {
+	cookie = hc->hc_next;
+	hc->hc_next += HANDLE_INCR;
+	hc->hc_left--;
+	if (unlikely(cookie == 0)) {
 		/*
 		 * Cookie of zero is "dangerous", because in many places it's
 		 * assumed that 0 means "unassigned" handle, not bound to any
 		 * object.
 		 */
 		CWARN("The universe has been exhausted: cookie wrap-around.\n");
-		handle_base += HANDLE_INCR;
+		spin_unlock(&hc->hc_lock);
+		return class_handle_cookie();
 	}
-	h->h_cookie = handle_base;
-	spin_unlock(&handle_base_lock);
+	spin_unlock(&hc->hc_lock);
+
+	return cookie;
+}
+
+/*
+ * Generate a unique 64bit cookie (hash) for a handle and insert it into
+ * global (per-node) hash-table.
+ */
+void class_handle_hash(struct portals_handle *h,
+		       struct portals_handle_ops *ops)
+{
+        struct handle_bucket *bucket;
+        ENTRY;
+
+        LASSERT(h != NULL);
+	LASSERT(list_empty(&h->h_link));
 
+	h->h_cookie = class_handle_cookie();
 	h->h_ops = ops;
-	spin_lock_init(&h->h_lock);
 
 	bucket = &handle_hash[h->h_cookie & HANDLE_HASH_MASK];
 	spin_lock(&bucket->lock);
@@ -111,13 +143,10 @@ static void class_handle_unhash_nolock(struct portals_handle *h)
 	CDEBUG(D_INFO, "removing object %p with handle %#llx from hash\n",
                h, h->h_cookie);
 
-	spin_lock(&h->h_lock);
-	if (h->h_in == 0) {
-		spin_unlock(&h->h_lock);
+	/* the bucket lock serializes h_in updates */
+	if (h->h_in == 0)
 		return;
-	}
 	h->h_in = 0;
-	spin_unlock(&h->h_lock);
 	list_del_rcu(&h->h_link);
 }
 
@@ -161,17 +190,18 @@ void *class_handle2object(__u64 cookie, const void *owner)
 	 * rcu_read_lock() definition on top this file. - jxiong */
         bucket = handle_hash + (cookie & HANDLE_HASH_MASK);
 
+	/* Neither the bucket nor the handle is locked: the object memory
+	 * is freed after an RCU grace period, and a handle unhashed
+	 * concurrently is only returned if its object still has a
+	 * reference, as it would have been just before the unhash. */
         rcu_read_lock();
         list_for_each_entry_rcu(h, &bucket->head, h_link) {
 		if (h->h_cookie != cookie || h->h_owner != owner)
                         continue;
 
-		spin_lock(&h->h_lock);
-		if (likely(h->h_in != 0)) {
-			h->h_ops->hop_addref(h);
+		if (likely(h->h_in != 0) &&
+		    h->h_ops->hop_addref(h))
 			retval = h;
-		}
-		spin_unlock(&h->h_lock);
 		break;
 	}
 	rcu_read_unlock();
@@ -198,6 +228,8 @@ EXPORT_SYMBOL(class_handle_free_cb);
 int class_handle_init(void)
 {
         struct handle_bucket *bucket;
+	struct handle_cpt *hc;
+	int i;
 	struct timespec64 ts;
         int seed[2];
 
@@ -207,6 +239,16 @@ int class_handle_init(void)
         if (handle_hash == NULL)
                 return -ENOMEM;
 
+	handle_cpts = cfs_percpt_alloc(cfs_cpt_table, sizeof(*hc));
+	if (handle_cpts == NULL) {
+		OBD_FREE_LARGE(handle_hash, sizeof(*bucket) * HANDLE_HASH_SIZE);
+		handle_hash = NULL;
+		return -ENOMEM;
+	}
+
+	cfs_percpt_for_each(hc, i, handle_cpts)
+		spin_lock_init(&hc->hc_lock);
+
 	for (bucket = handle_hash + HANDLE_HASH_SIZE - 1; bucket >= handle_hash;
 	     bucket--) {
 		INIT_LIST_HEAD(&bucket->head);
@@ -256,6 +298,9 @@ void class_handle_cleanup(void)
         OBD_FREE_LARGE(handle_hash, sizeof(*handle_hash) * HANDLE_HASH_SIZE);
         handle_hash = NULL;
 
+	cfs_percpt_free(handle_cpts);
+	handle_cpts = NULL;
+
         if (count != 0)
                 CERROR("handle_count at cleanup: %d\n", count);
 }
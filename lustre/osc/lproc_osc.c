@@ -501,6 +501,39 @@ static ssize_t osc_checksum_dump_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(osc_checksum_dump);
 
+static int osc_short_io_bytes_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+
+	seq_printf(m, "%u\n", obd->u.cli.cl_short_io_bytes);
+	return 0;
+}
+
+static ssize_t osc_short_io_bytes_seq_write(struct file *file,
+					    const char __user *buffer,
+					    size_t count, loff_t *off)
+{
+	struct obd_device *obd = ((struct seq_file *)file->private_data)->private;
+	struct client_obd *cli = &obd->u.cli;
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* 0 disables short I/O */
+	if (val < 0 || val > OBD_MAX_SHORT_IO_BYTES)
+		return -ERANGE;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	cli->cl_short_io_bytes = val;
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(osc_short_io_bytes);
+
 static int osc_contention_seconds_seq_show(struct seq_file *m, void *v)
 {
 	struct obd_device *obd = m->private;
@@ -659,6 +692,8 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_checksum_type_fops		},
 	{ .name	=	"checksum_dump",
 	  .fops	=	&osc_checksum_dump_fops		},
+	{ .name	=	"short_io_bytes",
+	  .fops	=	&osc_short_io_bytes_fops	},
 	{ .name	=	"resend_count",
 	  .fops	=	&osc_resend_count_fops		},
 	{ .name	=	"timeouts",
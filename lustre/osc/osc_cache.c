@@ -1587,7 +1587,7 @@ static int osc_enter_cache(const struct lu_env *env, struct client_obd *cli,
 	/* force the caller to try sync io.  this can jump the list
 	 * of queued writes and create a discontiguous rpc stream */
 	if (OBD_FAIL_CHECK(OBD_FAIL_OSC_NO_GRANT) ||
-	    cli->cl_dirty_max_pages == 0 ||
+	    cli->cl_dirty_max_pages == 0 || osc_object_is_dom(osc) ||
 	    cli->cl_ar.ar_force_sync || loi->loi_ar.ar_force_sync) {
 		OSC_DUMP_GRANT(D_CACHE, cli, "forced sync i/o\n");
 		GOTO(out, rc = -EDQUOT);
@@ -2346,6 +2346,7 @@ void osc_io_unplug(const struct lu_env *env, struct client_obd *cli,
 {
 	(void)osc_io_unplug0(env, cli, osc, 0);
 }
+EXPORT_SYMBOL(osc_io_unplug);
 
 int osc_prep_async_page(struct osc_object *osc, struct osc_page *ops,
 			struct page *page, loff_t offset)
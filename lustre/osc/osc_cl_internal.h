@@ -118,6 +118,12 @@ struct osc_object {
          */
         int                oo_contended;
         cfs_time_t         oo_contention_time;
+	/**
+	 * Page range of the stripe the server reported contended, lockless
+	 * I/O is only done for locks overlapping it.
+	 */
+	pgoff_t		   oo_contended_start;
+	pgoff_t		   oo_contended_end;
 #ifdef CONFIG_LUSTRE_DEBUG_EXPENSIVE_CHECK
         /**
          * IO context used for invariant checks in osc_lock_has_pages().
@@ -314,10 +320,11 @@ struct osc_lock {
          * Glimpse lock should be destroyed immediately after use.
          */
                                  ols_glimpse:1,
-        /**
-         * For async glimpse lock.
-         */
-                                 ols_agl:1;
+	/**
+	 * For async glimpse lock (AGL) and lock ahead: the lock is enqueued
+	 * speculatively, without an I/O waiting for it.
+	 */
+				 ols_speculative:1;
 };
 
 
@@ -387,6 +394,7 @@ int osc_io_init  (const struct lu_env *env,
 struct lu_object *osc_object_alloc(const struct lu_env *env,
                                    const struct lu_object_header *hdr,
                                    struct lu_device *dev);
+extern const struct lu_object_operations osc_lu_obj_ops;
 int osc_page_init(const struct lu_env *env, struct cl_object *obj,
 		  struct cl_page *page, pgoff_t ind);
 
@@ -424,9 +432,11 @@ void osc_io_unplug(const struct lu_env *env, struct client_obd *cli,
 		   struct osc_object *osc);
 int lru_queue_work(const struct lu_env *env, void *data);
 
-void osc_object_set_contended  (struct osc_object *obj);
+void osc_object_set_contended  (struct osc_object *obj, pgoff_t start,
+				pgoff_t end);
 void osc_object_clear_contended(struct osc_object *obj);
-int  osc_object_is_contended   (struct osc_object *obj);
+int  osc_object_is_contended   (struct osc_object *obj, pgoff_t start,
+				pgoff_t end);
 
 int  osc_lock_is_lockless      (const struct osc_lock *olck);
 
@@ -459,14 +469,15 @@ static inline struct osc_io *osc_env_io(const struct lu_env *env)
         return &osc_env_session(env)->os_io;
 }
 
+/* osc objects are also used by the MDC device for Data-on-MDT */
 static inline int osc_is_object(const struct lu_object *obj)
 {
-        return obj->lo_dev->ld_type == &osc_device_type;
+	return obj->lo_ops == &osc_lu_obj_ops;
 }
 
 static inline struct osc_device *lu2osc_dev(const struct lu_device *d)
 {
-        LINVRNT(d->ld_type == &osc_device_type);
+	LINVRNT(d->ld_ops->ldo_object_alloc == osc_object_alloc);
         return container_of0(d, struct osc_device, od_cl.cd_lu_dev);
 }
 
@@ -480,6 +491,21 @@ static inline struct client_obd *osc_cli(const struct osc_object *obj)
 	return &osc_export(obj)->exp_obd->u.cli;
 }
 
+static inline bool osc_object_is_dom(const struct osc_object *obj)
+{
+	return lu2osc_dev(obj->oo_cl.co_lu.lo_dev)->od_dom;
+}
+
+/* Data-on-MDT objects are locked on the DoM resource of the file */
+static inline void osc_build_res_name(const struct osc_object *obj,
+				      struct ldlm_res_id *resname)
+{
+	if (osc_object_is_dom(obj))
+		fid_build_dom_res_name(&obj->oo_oinfo->loi_oi.oi_fid, resname);
+	else
+		ostid_build_res_name(&obj->oo_oinfo->loi_oi, resname);
+}
+
 static inline struct osc_object *cl2osc(const struct cl_object *obj)
 {
         LINVRNT(osc_is_object(&obj->co_lu));
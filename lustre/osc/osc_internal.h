@@ -109,7 +109,8 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 		     struct ost_lvb *lvb, int kms_valid,
 		     osc_enqueue_upcall_f upcall,
 		     void *cookie, struct ldlm_enqueue_info *einfo,
-		     struct ptlrpc_request_set *rqset, int async, int agl);
+		     struct ptlrpc_request_set *rqset, int async,
+		     bool speculative);
 
 int osc_match_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 		   enum ldlm_type type, union ldlm_policy_data *policy,
@@ -140,9 +141,27 @@ void osc_lru_unreserve(struct client_obd *cli, unsigned long npages);
 extern struct lu_kmem_descr osc_caches[];
 
 unsigned long osc_ldlm_weigh_ast(struct ldlm_lock *dlmlock);
+unsigned long osc_lock_lru_weight(struct ldlm_lock *dlmlock);
 
 int osc_cleanup(struct obd_device *obd);
 int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg);
+int osc_setup_common(struct obd_device *obd, struct lustre_cfg *lcfg);
+int osc_precleanup_common(struct obd_device *obd);
+int osc_cleanup_common(struct obd_device *obd);
+int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
+		       u32 keylen, void *key, u32 vallen, void *val,
+		       struct ptlrpc_request_set *set);
+int osc_ldlm_resource_invalidate(struct cfs_hash *hs, struct cfs_hash_bd *bd,
+				 struct hlist_node *hnode, void *arg);
+int osc_cancel_weight(struct ldlm_lock *lock);
+
+/* DoM I/O goes to the MDS_IO_PORTAL when the import is an MDC one */
+static inline int osc_io_portal(struct obd_import *imp)
+{
+	if (imp->imp_client->cli_request_portal == MDS_REQUEST_PORTAL)
+		return MDS_IO_PORTAL;
+	return OST_IO_PORTAL;
+}
 
 #ifdef CONFIG_PROC_FS
 extern struct lprocfs_vars lprocfs_osc_obd_vars[];
@@ -188,6 +207,8 @@ struct osc_device {
         /* configuration item(s) */
         int                 od_contention_time;
         int                 od_lockless_truncate;
+	/* Data-on-MDT device driven by the MDC, see mdc_dev.c */
+	bool		    od_dom;
 };
 
 static inline struct osc_device *obd2osc_dev(const struct obd_device *d)
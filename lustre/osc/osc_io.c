@@ -867,6 +867,10 @@ static int osc_io_ladvise_start(const struct lu_env *env,
 	int			 num_advise = 1;
 	ENTRY;
 
+	/* the MDT doesn't handle ladvise for DoM data */
+	if (osc_object_is_dom(cl2osc(obj)))
+		RETURN(-EOPNOTSUPP);
+
 	/* TODO: add multiple ladvise support in CLIO */
 	buf_size = offsetof(typeof(*ladvise_hdr), lah_advise[num_advise]);
 	if (osc_env_info(env)->oti_ladvise_buf.lb_len < buf_size)
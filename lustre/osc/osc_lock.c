@@ -171,6 +171,10 @@ static __u64 osc_enq2ldlm_flags(__u32 enqflags)
 		result |= LDLM_FL_TEST_LOCK;
 	if (enqflags & CEF_LOCK_MATCH)
 		result |= LDLM_FL_MATCH_LOCK;
+	if (enqflags & CEF_LOCK_NO_EXPAND)
+		result |= LDLM_FL_NO_EXPANSION;
+	if (enqflags & CEF_SPECULATIVE)
+		result |= LDLM_FL_SPECULATIVE;
 	return result;
 }
 
@@ -325,9 +329,9 @@ static int osc_lock_upcall(void *cookie, struct lustre_handle *lockh,
 	/* Error handling, some errors are tolerable. */
 	if (oscl->ols_locklessable && rc == -EUSERS) {
 		/* This is a tolerable error, turn this lock into
-		 * lockless lock.
+		 * lockless lock. The contended range was recorded by
+		 * osc_enqueue_interpret().
 		 */
-		osc_object_set_contended(cl2osc(slice->cls_obj));
 		LASSERT(slice->cls_ops == &osc_lock_ops);
 
 		/* Change this lock to ldlmlock-less lock. */
@@ -349,8 +353,9 @@ static int osc_lock_upcall(void *cookie, struct lustre_handle *lockh,
 	RETURN(rc);
 }
 
-static int osc_lock_upcall_agl(void *cookie, struct lustre_handle *lockh,
-			       int errcode)
+static int osc_lock_upcall_speculative(void *cookie,
+				       struct lustre_handle *lockh,
+				       int errcode)
 {
 	struct osc_object	*osc = cookie;
 	struct ldlm_lock	*dlmlock;
@@ -373,7 +378,7 @@ static int osc_lock_upcall_agl(void *cookie, struct lustre_handle *lockh,
 	lock_res_and_lock(dlmlock);
 	LASSERT(dlmlock->l_granted_mode == dlmlock->l_req_mode);
 
-	/* there is no osc_lock associated with AGL lock */
+	/* there is no osc_lock associated with speculative locks */
 	osc_lock_lvb_update(env, osc, dlmlock, NULL);
 
 	unlock_res_and_lock(dlmlock);
@@ -453,8 +458,8 @@ static int osc_dlm_blocking_ast0(const struct lu_env *env,
 
 	unlock_res_and_lock(dlmlock);
 
-	/* if l_ast_data is NULL, the dlmlock was enqueued by AGL or
-	 * the object has been destroyed. */
+	/* if l_ast_data is NULL, the dlmlock was enqueued speculatively
+	 * (AGL or lock ahead) or the object has been destroyed. */
 	if (obj != NULL) {
 		struct ldlm_extent *extent = &dlmlock->l_policy_data.l_extent;
 		struct cl_attr *attr = &osc_env_info(env)->oti_attr;
@@ -744,6 +749,32 @@ out:
 	return weight;
 }
 
+/**
+ * Get the cost of cancelling an unused dlm lock from the LRU: the number of
+ * cached pages of its object, bounded by the number of pages of its extent.
+ * Cheap enough to be called for every lock the LRU scans pick for cancel.
+ */
+unsigned long osc_lock_lru_weight(struct ldlm_lock *dlmlock)
+{
+	struct ldlm_extent *extent = &dlmlock->l_policy_data.l_extent;
+	struct osc_object *obj;
+	unsigned long weight = 0;
+
+	if (dlmlock->l_resource->lr_type != LDLM_EXTENT)
+		return 0;
+
+	lock_res_and_lock(dlmlock);
+	obj = dlmlock->l_ast_data;
+	if (obj != NULL)
+		weight = min_t(__u64, obj->oo_npages,
+			       (extent->end >> PAGE_SHIFT) -
+			       (extent->start >> PAGE_SHIFT) + 1);
+	unlock_res_and_lock(dlmlock);
+
+	return weight;
+}
+EXPORT_SYMBOL(osc_lock_lru_weight);
+
 static void osc_lock_build_einfo(const struct lu_env *env,
 				 const struct cl_lock *lock,
 				 struct osc_object *osc,
@@ -786,6 +817,7 @@ static void osc_lock_to_lockless(const struct lu_env *env,
                 struct cl_object *obj  = slice->cls_obj;
                 struct osc_object *oob = cl2osc(obj);
                 const struct osc_device *osd = lu2osc_dev(obj->co_lu.lo_dev);
+		struct cl_lock_descr *descr = &ols->ols_cl.cls_lock->cll_descr;
                 struct obd_connect_data *ocd;
 
                 LASSERT(io->ci_lockreq == CILR_MANDATORY ||
@@ -798,7 +830,9 @@ static void osc_lock_to_lockless(const struct lu_env *env,
                                 (ocd->ocd_connect_flags & OBD_CONNECT_SRVLOCK);
                 if (io->ci_lockreq == CILR_NEVER ||
                         /* lockless IO */
-                    (ols->ols_locklessable && osc_object_is_contended(oob)) ||
+		    (ols->ols_locklessable &&
+		     osc_object_is_contended(oob, descr->cld_start,
+					     descr->cld_end)) ||
                         /* lockless truncate */
                     (cl_io_is_trunc(io) &&
                      (ocd->ocd_connect_flags & OBD_CONNECT_TRUNCLOCK) &&
@@ -953,8 +987,11 @@ static int osc_lock_enqueue(const struct lu_env *env,
 	if (oscl->ols_flags & LDLM_FL_TEST_LOCK)
 		GOTO(enqueue_base, 0);
 
-	if (oscl->ols_glimpse) {
-		LASSERT(equi(oscl->ols_agl, anchor == NULL));
+	/* For glimpse and/or speculative locks, do not wait for reply from
+	 * server on LDLM request */
+	if (oscl->ols_glimpse || oscl->ols_speculative) {
+		/* speculative locks do not have an anchor */
+		LASSERT(equi(oscl->ols_speculative, anchor == NULL));
 		async = true;
 		GOTO(enqueue_base, 0);
 	}
@@ -980,17 +1017,17 @@ enqueue_base:
 
 	/**
 	 * DLM lock's ast data must be osc_object;
-	 * if glimpse or AGL lock, async of osc_enqueue_base() must be true,
-	 * DLM's enqueue callback set to osc_lock_upcall() with cookie as
+	 * if glimpse or speculative lock, async of osc_enqueue_base() must be
+	 * true, DLM's enqueue callback set to osc_lock_upcall() with cookie as
 	 * osc_lock.
 	 */
-	ostid_build_res_name(&osc->oo_oinfo->loi_oi, resname);
+	osc_build_res_name(osc, resname);
 	osc_lock_build_policy(env, lock, policy);
-	if (oscl->ols_agl) {
+	if (oscl->ols_speculative) {
 		oscl->ols_einfo.ei_cbdata = NULL;
 		/* hold a reference for callback */
 		cl_object_get(osc2cl(osc));
-		upcall = osc_lock_upcall_agl;
+		upcall = osc_lock_upcall_speculative;
 		cookie = osc;
 	}
 	result = osc_enqueue_base(osc_export(osc), resname, &oscl->ols_flags,
@@ -998,7 +1035,7 @@ enqueue_base:
 				  osc->oo_oinfo->loi_kms_valid,
 				  upcall, cookie,
 				  &oscl->ols_einfo, PTLRPCD_SET, async,
-				  oscl->ols_agl);
+				  oscl->ols_speculative);
 	if (result == 0) {
 		if (osc_lock_is_lockless(oscl)) {
 			oio->oi_lockless = 1;
@@ -1007,9 +1044,12 @@ enqueue_base:
 			LASSERT(oscl->ols_hold);
 			LASSERT(oscl->ols_dlmlock != NULL);
 		}
-	} else if (oscl->ols_agl) {
+	} else if (oscl->ols_speculative) {
 		cl_object_put(env, osc2cl(osc));
-		result = 0;
+		/* hide the error for AGL; lock ahead reports -EEXIST and
+		 * -ECANCELED to the caller for an already existing lock */
+		if (oscl->ols_glimpse)
+			result = 0;
 	}
 
 out:
@@ -1178,8 +1218,8 @@ int osc_lock_init(const struct lu_env *env,
 	INIT_LIST_HEAD(&oscl->ols_nextlock_oscobj);
 
 	oscl->ols_flags = osc_enq2ldlm_flags(enqflags);
-	oscl->ols_agl = !!(enqflags & CEF_AGL);
-	if (oscl->ols_agl)
+	oscl->ols_speculative = !!(enqflags & (CEF_AGL | CEF_SPECULATIVE));
+	if (oscl->ols_speculative)
 		oscl->ols_flags |= LDLM_FL_BLOCK_NOWAIT;
 	if (oscl->ols_flags & LDLM_FL_HAS_INTENT) {
 		oscl->ols_flags |= LDLM_FL_BLOCK_GRANTED;
@@ -1222,7 +1262,7 @@ struct ldlm_lock *osc_dlmlock_at_pgoff(const struct lu_env *env,
 
 	ENTRY;
 
-	ostid_build_res_name(&obj->oo_oinfo->loi_oi, resname);
+	osc_build_res_name(obj, resname);
 	osc_index2policy(policy, osc2cl(obj), index, index);
 	policy->l_extent.gid = LDLM_GID_ANY;
 
@@ -212,7 +212,7 @@ static int osc_object_prune(const struct lu_env *env, struct cl_object *obj)
 
 	/* DLM locks don't hold a reference of osc_object so we have to
 	 * clear it before the object is being destroyed. */
-	ostid_build_res_name(&osc->oo_oinfo->loi_oi, resname);
+	osc_build_res_name(osc, resname);
 	ldlm_resource_iterate(osc_export(osc)->exp_obd->obd_namespace, resname,
 			      osc_object_ast_clear, osc);
 	return 0;
@@ -233,6 +233,10 @@ static int osc_object_fiemap(const struct lu_env *env, struct cl_object *obj,
 	int rc;
 	ENTRY;
 
+	/* the MDT has no fiemap support for DoM data */
+	if (osc_object_is_dom(cl2osc(obj)))
+		RETURN(-EOPNOTSUPP);
+
 	fmkey->lfik_oa.o_oi = cl2osc(obj)->oo_oinfo->loi_oi;
 	if (!(fmkey->lfik_fiemap.fm_flags & FIEMAP_FLAG_SYNC))
 		goto skip_locking;
@@ -303,8 +307,20 @@ drop_lock:
 	RETURN(rc);
 }
 
-void osc_object_set_contended(struct osc_object *obj)
+/**
+ * Remember that the server denied a lock for the pages [\a start, \a end]
+ * of \a obj on contention. A range still contended is extended to cover
+ * both.
+ */
+void osc_object_set_contended(struct osc_object *obj, pgoff_t start,
+			      pgoff_t end)
 {
+	if (osc_object_is_contended(obj, 0, CL_PAGE_EOF)) {
+		start = min(start, obj->oo_contended_start);
+		end = max(end, obj->oo_contended_end);
+	}
+	obj->oo_contended_start = start;
+	obj->oo_contended_end = end;
         obj->oo_contention_time = cfs_time_current();
         /* mb(); */
         obj->oo_contended = 1;
@@ -315,7 +331,8 @@ void osc_object_clear_contended(struct osc_object *obj)
         obj->oo_contended = 0;
 }
 
-int osc_object_is_contended(struct osc_object *obj)
+int osc_object_is_contended(struct osc_object *obj, pgoff_t start,
+			    pgoff_t end)
 {
         struct osc_device *dev  = lu2osc_dev(obj->oo_cl.co_lu.lo_dev);
         int osc_contention_time = dev->od_contention_time;
@@ -338,7 +355,8 @@ int osc_object_is_contended(struct osc_object *obj)
                 osc_object_clear_contended(obj);
                 return 0;
         }
-        return 1;
+	return start <= obj->oo_contended_end &&
+	       end >= obj->oo_contended_start;
 }
 
 /**
@@ -400,7 +418,7 @@ static void osc_req_attr_set(const struct lu_env *env, struct cl_object *obj,
 				      "uncovered page!\n");
 
 			resname = &osc_env_info(env)->oti_resname;
-			ostid_build_res_name(&oinfo->loi_oi, resname);
+			osc_build_res_name(cl2osc(obj), resname);
 			res = ldlm_resource_get(
 				osc_export(cl2osc(obj))->exp_obd->obd_namespace,
 				NULL, resname, LDLM_EXTENT, 0);
@@ -431,7 +449,7 @@ static const struct cl_object_operations osc_ops = {
 	.coo_req_attr_set = osc_req_attr_set
 };
 
-static const struct lu_object_operations osc_lu_obj_ops = {
+const struct lu_object_operations osc_lu_obj_ops = {
 	.loo_object_init      = osc_object_init,
 	.loo_object_release   = NULL,
 	.loo_object_free      = osc_object_free,
@@ -456,6 +474,7 @@ struct lu_object *osc_object_alloc(const struct lu_env *env,
 		obj = NULL;
 	return obj;
 }
+EXPORT_SYMBOL(osc_object_alloc);
 
 int osc_object_invalidate(const struct lu_env *env, struct osc_object *osc)
 {
@@ -961,12 +961,15 @@ void osc_inc_unstable_pages(struct ptlrpc_request *req)
 {
 	struct ptlrpc_bulk_desc *desc = req->rq_bulk;
 	struct client_obd       *cli  = &req->rq_import->imp_obd->u.cli;
-	long			 page_count = desc->bd_iov_count;
+	long			 page_count;
 
-	/* No unstable page tracking */
-	if (cli->cl_cache == NULL || !cli->cl_cache->ccc_unstable_check)
+	/* No unstable page tracking, nor for short I/O which has no bulk */
+	if (cli->cl_cache == NULL || !cli->cl_cache->ccc_unstable_check ||
+	    desc == NULL)
 		return;
 
+	page_count = desc->bd_iov_count;
+
 	add_unstable_page_accounting(desc);
 	atomic_long_add(page_count, &cli->cl_unstable_count);
 	atomic_long_add(page_count, &cli->cl_cache->ccc_unstable_nr);
@@ -102,7 +102,7 @@ struct osc_enqueue_args {
 	void			*oa_cookie;
 	struct ost_lvb		*oa_lvb;
 	struct lustre_handle	oa_lockh;
-	unsigned int		oa_agl:1;
+	unsigned int		oa_speculative:1;
 };
 
 static void osc_release_ppga(struct brw_page **ppga, size_t count);
@@ -322,7 +322,7 @@ int osc_ladvise_base(struct obd_export *exp, struct obdo *oa,
 		ptlrpc_request_free(req);
 		RETURN(rc);
 	}
-	req->rq_request_portal = OST_IO_PORTAL;
+	req->rq_request_portal = osc_io_portal(req->rq_import);
 	ptlrpc_at_set_req_timeout(req);
 
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
@@ -429,7 +429,7 @@ int osc_punch_base(struct obd_export *exp, struct obdo *oa,
                 ptlrpc_request_free(req);
                 RETURN(rc);
         }
-        req->rq_request_portal = OST_IO_PORTAL; /* bug 7198 */
+	req->rq_request_portal = osc_io_portal(req->rq_import); /* bug 7198 */
         ptlrpc_at_set_req_timeout(req);
 
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
@@ -744,11 +744,6 @@ static void osc_update_grant(struct client_obd *cli, struct ost_body *body)
         }
 }
 
-static int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
-			      u32 keylen, void *key,
-			      u32 vallen, void *val,
-			      struct ptlrpc_request_set *set);
-
 static int osc_shrink_grant_interpret(const struct lu_env *env,
                                       struct ptlrpc_request *req,
                                       void *aa, int rc)
@@ -1001,6 +996,38 @@ static void handle_short_read(int nob_read, size_t page_count,
 	}
 }
 
+/**
+ * Copy the data of a short I/O read from the reply buffer into the pages.
+ *
+ * \retval	number of bytes copied
+ * \retval	negative errno if the reply buffer is missing or too small
+ */
+static int osc_shortio_to_pages(struct ptlrpc_request *req, int nob,
+				size_t page_count, struct brw_page **pga)
+{
+	unsigned char *buf;
+	int copied = 0;
+	int i;
+
+	buf = req_capsule_server_sized_get(&req->rq_pill, &RMF_SHORT_IO, nob);
+	if (buf == NULL) {
+		CDEBUG(D_INFO, "Missing/short short io buffer in BRW_READ "
+		       "reply, %d bytes expected\n", nob);
+		return -EPROTO;
+	}
+
+	for (i = 0; i < page_count && copied < nob; i++) {
+		int count = min_t(int, pga[i]->count, nob - copied);
+		unsigned char *ptr = ll_kmap_atomic(pga[i]->pg, KM_USER0);
+
+		memcpy(ptr + (pga[i]->off & ~PAGE_MASK), buf + copied, count);
+		ll_kunmap_atomic(ptr, KM_USER0);
+		copied += count;
+	}
+
+	return copied;
+}
+
 static int check_write_rcs(struct ptlrpc_request *req,
 			   int requested_nob, int niocount,
 			   size_t page_count, struct brw_page **pga)
@@ -1028,7 +1055,8 @@ static int check_write_rcs(struct ptlrpc_request *req,
                 }
         }
 
-        if (req->rq_bulk->bd_nob_transferred != requested_nob) {
+	if (req->rq_bulk != NULL &&
+	    req->rq_bulk->bd_nob_transferred != requested_nob) {
                 CERROR("Unexpected # bytes transferred: %d (requested %d)\n",
                        req->rq_bulk->bd_nob_transferred, requested_nob);
                 return(-EPROTO);
@@ -1125,6 +1153,8 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
         struct osc_brw_async_args *aa;
         struct req_capsule      *pill;
         struct brw_page *pg_prev;
+	unsigned char *short_io_buf = NULL;
+	u32 short_io_size = 0;
 
         ENTRY;
         if (OBD_FAIL_CHECK(OBD_FAIL_OSC_BRW_PREP_REQ))
@@ -1149,34 +1179,53 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
                         niocount++;
         }
 
+	/* Small transfers are carried inline in the RPC message itself
+	 * (short I/O), saving the separate bulk handshake */
+	for (i = 0; i < page_count; i++)
+		short_io_size += pga[i]->count;
+	if (short_io_size > cli->cl_short_io_bytes ||
+	    !imp_connect_shortio(cli->cl_import))
+		short_io_size = 0;
+
         pill = &req->rq_pill;
         req_capsule_set_size(pill, &RMF_OBD_IOOBJ, RCL_CLIENT,
                              sizeof(*ioobj));
         req_capsule_set_size(pill, &RMF_NIOBUF_REMOTE, RCL_CLIENT,
                              niocount * sizeof(*niobuf));
+	req_capsule_set_size(pill, &RMF_SHORT_IO, RCL_CLIENT,
+			     opc == OST_WRITE ? short_io_size : 0);
+	if (opc == OST_READ)
+		req_capsule_set_size(pill, &RMF_SHORT_IO, RCL_SERVER,
+				     short_io_size);
 
         rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, opc);
         if (rc) {
                 ptlrpc_request_free(req);
                 RETURN(rc);
         }
-        req->rq_request_portal = OST_IO_PORTAL; /* bug 7198 */
+	req->rq_request_portal = osc_io_portal(req->rq_import); /* bug 7198 */
         ptlrpc_at_set_req_timeout(req);
 	/* ask ptlrpc not to resend on EINPROGRESS since BRWs have their own
 	 * retry logic */
 	req->rq_no_retry_einprogress = 1;
 
-	desc = ptlrpc_prep_bulk_imp(req, page_count,
-		cli->cl_import->imp_connect_data.ocd_brw_size >> LNET_MTU_BITS,
-		(opc == OST_WRITE ? PTLRPC_BULK_GET_SOURCE :
-			PTLRPC_BULK_PUT_SINK) |
-			PTLRPC_BULK_BUF_KIOV,
-		OST_BULK_PORTAL,
-		&ptlrpc_bulk_kiov_pin_ops);
-
-        if (desc == NULL)
-                GOTO(out, rc = -ENOMEM);
-        /* NB request now owns desc and will free it when it gets freed */
+	if (short_io_size != 0) {
+		desc = NULL;
+	} else {
+		desc = ptlrpc_prep_bulk_imp(req, page_count,
+			cli->cl_import->imp_connect_data.ocd_brw_size >>
+				LNET_MTU_BITS,
+			(opc == OST_WRITE ? PTLRPC_BULK_GET_SOURCE :
+				PTLRPC_BULK_PUT_SINK) |
+				PTLRPC_BULK_BUF_KIOV,
+			OST_BULK_PORTAL,
+			&ptlrpc_bulk_kiov_pin_ops);
+
+		if (desc == NULL)
+			GOTO(out, rc = -ENOMEM);
+		/* NB request now owns desc and will free it when it gets
+		 * freed */
+	}
 
         body = req_capsule_client_get(pill, &RMF_OST_BODY);
         ioobj = req_capsule_client_get(pill, &RMF_OBD_IOOBJ);
@@ -1192,7 +1241,25 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 	 * when the RPC is finally sent in ptlrpc_register_bulk(). It sends
 	 * "max - 1" for old client compatibility sending "0", and also so the
 	 * the actual maximum is a power-of-two number, not one less. LU-1431 */
-	ioobj_max_brw_set(ioobj, desc->bd_md_max_brw);
+	ioobj_max_brw_set(ioobj, desc != NULL ? desc->bd_md_max_brw : 1);
+
+	if (short_io_size != 0) {
+		if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
+			body->oa.o_valid |= OBD_MD_FLFLAGS;
+			body->oa.o_flags = 0;
+		}
+		body->oa.o_flags |= OBD_FL_SHORT_IO;
+		CDEBUG(D_CACHE, "Using short io for data transfer, size = %u\n",
+		       short_io_size);
+		if (opc == OST_WRITE) {
+			short_io_buf = req_capsule_client_get(pill,
+							      &RMF_SHORT_IO);
+			LASSERT(short_io_buf != NULL);
+		}
+	} else if (body->oa.o_valid & OBD_MD_FLFLAGS) {
+		body->oa.o_flags &= ~OBD_FL_SHORT_IO;
+	}
+
 	LASSERT(page_count > 0);
 	pg_prev = pga[0];
         for (requested_nob = i = 0; i < page_count; i++, niobuf++) {
@@ -1218,7 +1285,17 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
                 LASSERT((pga[0]->flag & OBD_BRW_SRVLOCK) ==
                         (pg->flag & OBD_BRW_SRVLOCK));
 
-		desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff, pg->count);
+		if (short_io_size == 0) {
+			desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff,
+							 pg->count);
+		} else if (opc == OST_WRITE) {
+			unsigned char *ptr = ll_kmap_atomic(pg->pg, KM_USER0);
+
+			LASSERT(short_io_size >= requested_nob + pg->count);
+			memcpy(short_io_buf + requested_nob, ptr + poff,
+			       pg->count);
+			ll_kunmap_atomic(ptr, KM_USER0);
+		}
                 requested_nob += pg->count;
 
                 if (i > 0 && can_merge_pages(pg_prev, pg)) {
@@ -1488,10 +1565,12 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                         CERROR("Unexpected +ve rc %d\n", rc);
                         RETURN(-EPROTO);
                 }
-                LASSERT(req->rq_bulk->bd_nob == aa->aa_requested_nob);
+		if (req->rq_bulk != NULL) {
+			LASSERT(req->rq_bulk->bd_nob == aa->aa_requested_nob);
 
-                if (sptlrpc_cli_unwrap_bulk_write(req, req->rq_bulk))
-                        RETURN(-EAGAIN);
+			if (sptlrpc_cli_unwrap_bulk_write(req, req->rq_bulk))
+				RETURN(-EAGAIN);
+		}
 
                 if ((aa->aa_oa->o_valid & OBD_MD_FLCKSUM) && client_cksum &&
                     check_write_checksum(&body->oa, peer, client_cksum,
@@ -1505,10 +1584,12 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
 
         /* The rest of this function executes only for OST_READs */
 
-        /* if unwrap_bulk failed, return -EAGAIN to retry */
-        rc = sptlrpc_cli_unwrap_bulk_read(req, req->rq_bulk, rc);
-        if (rc < 0)
-                GOTO(out, rc = -EAGAIN);
+	/* if unwrap_bulk failed, return -EAGAIN to retry */
+	if (req->rq_bulk != NULL) {
+		rc = sptlrpc_cli_unwrap_bulk_read(req, req->rq_bulk, rc);
+		if (rc < 0)
+			GOTO(out, rc = -EAGAIN);
+	}
 
         if (rc > aa->aa_requested_nob) {
                 CERROR("Unexpected rc %d (%d requested)\n", rc,
@@ -1516,12 +1597,19 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                 RETURN(-EPROTO);
         }
 
-        if (rc != req->rq_bulk->bd_nob_transferred) {
+	if (req->rq_bulk != NULL && rc != req->rq_bulk->bd_nob_transferred) {
                 CERROR ("Unexpected rc %d (%d transferred)\n",
                         rc, req->rq_bulk->bd_nob_transferred);
                 return (-EPROTO);
         }
 
+	if (req->rq_bulk == NULL) {
+		rc = osc_shortio_to_pages(req, rc, aa->aa_page_count,
+					  aa->aa_ppga);
+		if (rc < 0)
+			RETURN(rc);
+	}
+
         if (rc < aa->aa_requested_nob)
                 handle_short_read(rc, aa->aa_page_count, aa->aa_ppga);
 
@@ -1538,7 +1626,8 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                                                  aa->aa_ppga, OST_READ,
                                                  cksum_type);
 
-		if (peer->nid != req->rq_bulk->bd_sender) {
+		if (req->rq_bulk != NULL &&
+		    peer->nid != req->rq_bulk->bd_sender) {
 			via = " via ";
 			router = libcfs_nid2str(req->rq_bulk->bd_sender);
 		}
@@ -1805,7 +1894,9 @@ static int brw_interpret(const struct lu_env *env,
 	LASSERT(list_empty(&aa->aa_oaps));
 
 	osc_release_ppga(aa->aa_ppga, aa->aa_page_count);
-	ptlrpc_lprocfs_brw(req, req->rq_bulk->bd_nob_transferred);
+	ptlrpc_lprocfs_brw(req, req->rq_bulk != NULL ?
+			   req->rq_bulk->bd_nob_transferred :
+			   aa->aa_requested_nob);
 
 	spin_lock(&cli->cl_loi_list_lock);
 	/* We need to decrement before osc_ap_completion->osc_wake_cache_waiters
@@ -2037,7 +2128,7 @@ static int osc_set_lock_data(struct ldlm_lock *lock, void *data)
 static int osc_enqueue_fini(struct ptlrpc_request *req,
 			    osc_enqueue_upcall_f upcall, void *cookie,
 			    struct lustre_handle *lockh, enum ldlm_mode mode,
-			    __u64 *flags, int agl, int errcode)
+			    __u64 *flags, bool speculative, int errcode)
 {
 	bool intent = *flags & LDLM_FL_HAS_INTENT;
 	int rc;
@@ -2054,7 +2145,7 @@ static int osc_enqueue_fini(struct ptlrpc_request *req,
 			ptlrpc_status_ntoh(rep->lock_policy_res1);
 		if (rep->lock_policy_res1)
 			errcode = rep->lock_policy_res1;
-		if (!agl)
+		if (!speculative)
 			*flags |= LDLM_FL_LVB_READY;
 	} else if (errcode == ELDLM_OK) {
 		*flags |= LDLM_FL_LVB_READY;
@@ -2072,6 +2163,35 @@ static int osc_enqueue_fini(struct ptlrpc_request *req,
         RETURN(rc);
 }
 
+/**
+ * Record on the osc_object of \a lock the range the server denied the lock
+ * for on contention, lockless I/O is done there for a while.
+ *
+ * Servers not reporting the contended range have the whole object contended.
+ */
+static void osc_enqueue_contended(struct ptlrpc_request *req,
+				  struct ldlm_lock *lock)
+{
+	struct osc_object *obj = lock->l_ast_data;
+	struct ldlm_reply *rep = NULL;
+	__u64 start = 0;
+	__u64 end = OBD_OBJECT_EOF;
+
+	if (obj == NULL)
+		return;
+
+	if (req->rq_repmsg != NULL &&
+	    req_capsule_field_present(&req->rq_pill, &RMF_DLM_REP, RCL_SERVER))
+		rep = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REP);
+	if (rep != NULL && rep->lock_flags & LDLM_FL_CONTENDED) {
+		start = rep->lock_desc.l_policy_data.l_extent.start;
+		end = rep->lock_desc.l_policy_data.l_extent.end;
+	}
+
+	osc_object_set_contended(obj, cl_index(osc2cl(obj), start),
+				 cl_index(osc2cl(obj), end));
+}
+
 static int osc_enqueue_interpret(const struct lu_env *env,
 				 struct ptlrpc_request *req,
 				 struct osc_enqueue_args *aa, int rc)
@@ -2104,19 +2224,22 @@ static int osc_enqueue_interpret(const struct lu_env *env,
 	/* Let CP AST to grant the lock first. */
 	OBD_FAIL_TIMEOUT(OBD_FAIL_OSC_CP_ENQ_RACE, 1);
 
-	if (aa->oa_agl) {
+	if (aa->oa_speculative) {
 		LASSERT(aa->oa_lvb == NULL);
 		LASSERT(aa->oa_flags == NULL);
 		aa->oa_flags = &flags;
 	}
 
+	if (rc == -EUSERS)
+		osc_enqueue_contended(req, lock);
+
 	/* Complete obtaining the lock procedure. */
 	rc = ldlm_cli_enqueue_fini(aa->oa_exp, req, aa->oa_type, 1,
 				   aa->oa_mode, aa->oa_flags, lvb, lvb_len,
 				   lockh, rc);
 	/* Complete osc stuff. */
 	rc = osc_enqueue_fini(req, aa->oa_upcall, aa->oa_cookie, lockh, mode,
-			      aa->oa_flags, aa->oa_agl, rc);
+			      aa->oa_flags, aa->oa_speculative, rc);
 
         OBD_FAIL_TIMEOUT(OBD_FAIL_OSC_CP_CANCEL_RACE, 10);
 
@@ -2139,7 +2262,8 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 		     struct ost_lvb *lvb, int kms_valid,
 		     osc_enqueue_upcall_f upcall, void *cookie,
 		     struct ldlm_enqueue_info *einfo,
-		     struct ptlrpc_request_set *rqset, int async, int agl)
+		     struct ptlrpc_request_set *rqset, int async,
+		     bool speculative)
 {
 	struct obd_device *obd = exp->exp_obd;
 	struct lustre_handle lockh = { 0 };
@@ -2179,7 +2303,7 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
         mode = einfo->ei_mode;
         if (einfo->ei_mode == LCK_PR)
                 mode |= LCK_PW;
-	if (agl == 0)
+	if (!speculative)
 		match_flags |= LDLM_FL_LVB_READY;
 	if (intent != 0)
 		match_flags |= LDLM_FL_BLOCK_GRANTED;
@@ -2192,13 +2316,23 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 			RETURN(ELDLM_OK);
 
 		matched = ldlm_handle2lock(&lockh);
-		if (agl) {
-			/* AGL enqueues DLM locks speculatively. Therefore if
-			 * it already exists a DLM lock, it wll just inform the
-			 * caller to cancel the AGL process for this stripe. */
+		if (speculative) {
+			/* This DLM lock request is speculative (AGL or lock
+			 * ahead) and has no associated I/O. Therefore if
+			 * there is already a DLM lock, just inform the caller
+			 * to cancel the request for this stripe, telling a
+			 * lock on exactly this extent apart from another. */
+			lock_res_and_lock(matched);
+			if (ldlm_extent_equal(&policy->l_extent,
+					      &matched->l_policy_data.l_extent))
+				rc = -EEXIST;
+			else
+				rc = -ECANCELED;
+			unlock_res_and_lock(matched);
+
 			ldlm_lock_decref(&lockh, mode);
 			LDLM_LOCK_PUT(matched);
-			RETURN(-ECANCELED);
+			RETURN(rc);
 		} else if (osc_set_lock_data(matched, einfo->ei_cbdata)) {
 			*flags |= LDLM_FL_LVB_READY;
 
@@ -2251,24 +2385,28 @@ no_match:
 			lustre_handle_copy(&aa->oa_lockh, &lockh);
 			aa->oa_upcall = upcall;
 			aa->oa_cookie = cookie;
-			aa->oa_agl    = !!agl;
-			if (!agl) {
+			aa->oa_speculative = speculative;
+			if (!speculative) {
 				aa->oa_flags  = flags;
 				aa->oa_lvb    = lvb;
 			} else {
-				/* AGL is essentially to enqueue an DLM lock
-				 * in advance, so we don't care about the
-				 * result of AGL enqueue. */
+				/* speculative locks are essentially to enqueue
+				 * a DLM lock in advance, so we don't care
+				 * about the result of the enqueue. */
 				aa->oa_lvb    = NULL;
 				aa->oa_flags  = NULL;
 			}
 
 			req->rq_interpret_reply =
 				(ptlrpc_interpterer_t)osc_enqueue_interpret;
-			if (rqset == PTLRPCD_SET)
+			if (rqset == PTLRPCD_SET) {
+				/* glimpses and lockahead don't hold up a
+				 * caller, they may be batched by ptlrpcd */
+				req->rq_coalesce = intent || speculative;
 				ptlrpcd_add_req(req);
-			else
+			} else {
 				ptlrpc_set_add_req(rqset, req);
+			}
 		} else if (intent) {
 			ptlrpc_req_finished(req);
 		}
@@ -2276,7 +2414,7 @@ no_match:
 	}
 
 	rc = osc_enqueue_fini(req, upcall, cookie, &lockh, einfo->ei_mode,
-			      flags, agl, rc);
+			      flags, speculative, rc);
 	if (intent)
 		ptlrpc_req_finished(req);
 
@@ -2504,10 +2642,9 @@ out:
 	return err;
 }
 
-static int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
-			      u32 keylen, void *key,
-			      u32 vallen, void *val,
-			      struct ptlrpc_request_set *set)
+int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
+		       u32 keylen, void *key, u32 vallen, void *val,
+		       struct ptlrpc_request_set *set)
 {
         struct ptlrpc_request *req;
         struct obd_device     *obd = exp->exp_obd;
@@ -2618,11 +2755,13 @@ static int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
 		ptlrpc_set_add_req(set, req);
 		ptlrpc_check_set(NULL, set);
 	} else {
+		req->rq_coalesce = 1;
 		ptlrpcd_add_req(req);
 	}
 
 	RETURN(0);
 }
+EXPORT_SYMBOL(osc_set_info_async);
 
 static int osc_reconnect(const struct lu_env *env,
                          struct obd_export *exp, struct obd_device *obd,
@@ -2683,8 +2822,8 @@ static int osc_disconnect(struct obd_export *exp)
         return rc;
 }
 
-static int osc_ldlm_resource_invalidate(struct cfs_hash *hs,
-	struct cfs_hash_bd *bd, struct hlist_node *hnode, void *arg)
+int osc_ldlm_resource_invalidate(struct cfs_hash *hs, struct cfs_hash_bd *bd,
+				 struct hlist_node *hnode, void *arg)
 {
 	struct lu_env *env = arg;
 	struct ldlm_resource *res = cfs_hash_object(hs, hnode);
@@ -2692,6 +2831,11 @@ static int osc_ldlm_resource_invalidate(struct cfs_hash *hs,
 	struct osc_object *osc = NULL;
 	ENTRY;
 
+	/* only extent locks carry an osc_object, the MDC namespace also
+	 * holds the metadata locks */
+	if (res->lr_type != LDLM_EXTENT)
+		RETURN(0);
+
 	lock_res(res);
 	list_for_each_entry(lock, &res->lr_granted, l_res_link) {
 		if (lock->l_ast_data != NULL && osc == NULL) {
@@ -2713,6 +2857,7 @@ static int osc_ldlm_resource_invalidate(struct cfs_hash *hs,
 
 	RETURN(0);
 }
+EXPORT_SYMBOL(osc_ldlm_resource_invalidate);
 
 static int osc_import_event(struct obd_device *obd,
                             struct obd_import *imp,
@@ -2797,7 +2942,7 @@ static int osc_import_event(struct obd_device *obd,
  * \retval zero the lock can't be canceled
  * \retval other ok to cancel
  */
-static int osc_cancel_weight(struct ldlm_lock *lock)
+int osc_cancel_weight(struct ldlm_lock *lock)
 {
 	/*
 	 * Cancel all unused and granted extent lock.
@@ -2809,6 +2954,7 @@ static int osc_cancel_weight(struct ldlm_lock *lock)
 
 	RETURN(0);
 }
+EXPORT_SYMBOL(osc_cancel_weight);
 
 static int brw_queue_work(const struct lu_env *env, void *data)
 {
@@ -2820,15 +2966,15 @@ static int brw_queue_work(const struct lu_env *env, void *data)
 	RETURN(0);
 }
 
-int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
+/**
+ * Set up the part of a client obd needed to cache and do I/O through the
+ * osc layer. This is shared with the MDC for Data-on-MDT.
+ */
+int osc_setup_common(struct obd_device *obd, struct lustre_cfg *lcfg)
 {
 	struct client_obd *cli = &obd->u.cli;
-	struct obd_type	  *type;
 	void		  *handler;
 	int		   rc;
-	int		   adding;
-	int		   added;
-	int		   req_count;
 	ENTRY;
 
 	rc = ptlrpcd_addref();
@@ -2854,6 +3000,38 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 		GOTO(out_ptlrpcd_work, rc);
 
 	cli->cl_grant_shrink_interval = GRANT_SHRINK_INTERVAL;
+	RETURN(0);
+
+out_ptlrpcd_work:
+	if (cli->cl_writeback_work != NULL) {
+		ptlrpcd_destroy_work(cli->cl_writeback_work);
+		cli->cl_writeback_work = NULL;
+	}
+	if (cli->cl_lru_work != NULL) {
+		ptlrpcd_destroy_work(cli->cl_lru_work);
+		cli->cl_lru_work = NULL;
+	}
+out_client_setup:
+	client_obd_cleanup(obd);
+out_ptlrpcd:
+	ptlrpcd_decref();
+	RETURN(rc);
+}
+EXPORT_SYMBOL(osc_setup_common);
+
+int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
+{
+	struct client_obd *cli = &obd->u.cli;
+	struct obd_type	  *type;
+	int		   rc;
+	int		   adding;
+	int		   added;
+	int		   req_count;
+	ENTRY;
+
+	rc = osc_setup_common(obd, lcfg);
+	if (rc < 0)
+		RETURN(rc);
 
 #ifdef CONFIG_PROC_FS
 	obd->obd_vars = lprocfs_osc_obd_vars;
@@ -2902,30 +3080,16 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 
 	INIT_LIST_HEAD(&cli->cl_grant_shrink_list);
 	ns_register_cancel(obd->obd_namespace, osc_cancel_weight);
+	ns_register_weigh(obd->obd_namespace, osc_lock_lru_weight);
 
 	spin_lock(&osc_shrink_lock);
 	list_add_tail(&cli->cl_shrink_list, &osc_shrink_list);
 	spin_unlock(&osc_shrink_lock);
 
 	RETURN(0);
-
-out_ptlrpcd_work:
-	if (cli->cl_writeback_work != NULL) {
-		ptlrpcd_destroy_work(cli->cl_writeback_work);
-		cli->cl_writeback_work = NULL;
-	}
-	if (cli->cl_lru_work != NULL) {
-		ptlrpcd_destroy_work(cli->cl_lru_work);
-		cli->cl_lru_work = NULL;
-	}
-out_client_setup:
-	client_obd_cleanup(obd);
-out_ptlrpcd:
-	ptlrpcd_decref();
-	RETURN(rc);
 }
 
-static int osc_precleanup(struct obd_device *obd)
+int osc_precleanup_common(struct obd_device *obd)
 {
 	struct client_obd *cli = &obd->u.cli;
 	ENTRY;
@@ -2951,21 +3115,27 @@ static int osc_precleanup(struct obd_device *obd)
 	}
 
 	obd_cleanup_client_import(obd);
+	RETURN(0);
+}
+EXPORT_SYMBOL(osc_precleanup_common);
+
+static int osc_precleanup(struct obd_device *obd)
+{
+	ENTRY;
+
+	osc_precleanup_common(obd);
+
 	ptlrpc_lprocfs_unregister_obd(obd);
 	RETURN(0);
 }
 
-int osc_cleanup(struct obd_device *obd)
+int osc_cleanup_common(struct obd_device *obd)
 {
 	struct client_obd *cli = &obd->u.cli;
 	int rc;
 
 	ENTRY;
 
-	spin_lock(&osc_shrink_lock);
-	list_del(&cli->cl_shrink_list);
-	spin_unlock(&osc_shrink_lock);
-
 	/* lru cleanup */
 	if (cli->cl_cache != NULL) {
 		LASSERT(atomic_read(&cli->cl_cache->ccc_users) > 0);
@@ -2985,6 +3155,22 @@ int osc_cleanup(struct obd_device *obd)
 	ptlrpcd_decref();
 	RETURN(rc);
 }
+EXPORT_SYMBOL(osc_cleanup_common);
+
+int osc_cleanup(struct obd_device *obd)
+{
+	struct client_obd *cli = &obd->u.cli;
+	int rc;
+
+	ENTRY;
+
+	spin_lock(&osc_shrink_lock);
+	list_del(&cli->cl_shrink_list);
+	spin_unlock(&osc_shrink_lock);
+
+	rc = osc_cleanup_common(obd);
+	RETURN(rc);
+}
 
 int osc_process_config_base(struct obd_device *obd, struct lustre_cfg *lcfg)
 {
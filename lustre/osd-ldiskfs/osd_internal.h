@@ -405,6 +405,8 @@ enum {
         LPROC_OSD_CACHE_ACCESS  = 4,
         LPROC_OSD_CACHE_HIT     = 5,
         LPROC_OSD_CACHE_MISS    = 6,
+        LPROC_OSD_PAGE_LOCAL    = 7,
+        LPROC_OSD_PAGE_REMOTE   = 8,
 
 #if OSD_THANDLE_STATS
         LPROC_OSD_THANDLE_STARTING,
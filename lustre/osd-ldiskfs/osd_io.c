@@ -454,6 +454,86 @@ static struct page *osd_get_page(struct dt_object *dt, loff_t offset,
         return page;
 }
 
+/* number of cached pages looked up at once by osd_bufs_get_cached() */
+#define OSD_GANG_PAGES	16
+
+/**
+ * Look up a run of pages already in the page cache
+ *
+ * Fill \a lnb with the cached pages of the \a npages consecutive page indices
+ * starting at the one of \a lnb[0], looking them up in batches rather than
+ * one by one. Pages are returned locked and referenced.
+ *
+ * \param inode		inode undergoing IO
+ * \param lnb		array of pages undergoing IO
+ * \param npages	number of pages in \a lnb
+ *
+ * \retval		number of leading pages of \a lnb found, the lookup
+ *			stops at the first page which is not cached
+ */
+static int osd_bufs_get_cached(struct inode *inode, struct niobuf_local *lnb,
+			       int npages)
+{
+	struct address_space	*mapping = inode->i_mapping;
+	struct page		*pages[OSD_GANG_PAGES];
+	pgoff_t			 index = lnb->lnb_file_offset >> PAGE_SHIFT;
+	int			 found = 0;
+	int			 nr;
+	int			 i;
+
+	while (found < npages) {
+		nr = find_get_pages_contig(mapping, index + found,
+					   min(npages - found, OSD_GANG_PAGES),
+					   pages);
+		for (i = 0; i < nr; i++) {
+			lock_page(pages[i]);
+			/* truncated before we got the page lock */
+			if (unlikely(pages[i]->mapping != mapping)) {
+				unlock_page(pages[i]);
+				break;
+			}
+			wait_on_page_writeback(pages[i]);
+			lnb[found + i].lnb_page = pages[i];
+		}
+		found += i;
+
+		if (i < nr) {
+			for (; i < nr; i++)
+				put_page(pages[i]);
+			break;
+		}
+
+		if (nr < OSD_GANG_PAGES)
+			break;
+	}
+
+	return found;
+}
+
+/*
+ * Account the pages of \a lnb by whether they are on the memory node of the
+ * calling thread. Service threads are bound to their CPT, so newly created
+ * pages are local and remote pages are ones cached by another node.
+ */
+static void osd_bufs_numa_stats(struct osd_device *osd,
+				struct niobuf_local *lnb, int npages)
+{
+	int node = numa_node_id();
+	int remote = 0;
+	int i;
+
+	for (i = 0; i < npages; i++)
+		if (page_to_nid(lnb[i].lnb_page) != node)
+			remote++;
+
+	if (remote < npages)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_PAGE_LOCAL,
+				    npages - remote);
+	if (remote > 0)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_PAGE_REMOTE,
+				    remote);
+}
+
 /*
  * there are following "locks":
  * journal_start
@@ -532,7 +612,7 @@ static int osd_bufs_get(const struct lu_env *env, struct dt_object *dt,
 			enum dt_bufs_type rw)
 {
 	struct osd_object *obj = osd_dt_obj(dt);
-	int npages, i, rc = 0;
+	int npages, i = 0, n, rc = 0;
 	gfp_t gfp_mask;
 
 	LASSERT(obj->oo_inode);
@@ -542,23 +622,37 @@ static int osd_bufs_get(const struct lu_env *env, struct dt_object *dt,
 	/* this could also try less hard for DT_BUFS_TYPE_READAHEAD pages */
 	gfp_mask = rw & DT_BUFS_TYPE_LOCAL ? (GFP_NOFS | __GFP_HIGHMEM) :
 					     GFP_HIGHUSER;
-	for (i = 0; i < npages; i++, lnb++) {
-		lnb->lnb_page = osd_get_page(dt, lnb->lnb_file_offset,
-					     gfp_mask);
-		if (lnb->lnb_page == NULL)
+	while (i < npages) {
+		/* reads mostly hit the cache, take the cached pages in
+		 * batches and only create the missing ones one by one */
+		if (!(rw & DT_BUFS_TYPE_WRITE)) {
+			n = osd_bufs_get_cached(obj->oo_inode, lnb + i,
+						npages - i);
+			for (; n > 0; n--, i++)
+				lu_object_get(&dt->do_lu);
+			if (i == npages)
+				break;
+		}
+
+		lnb[i].lnb_page = osd_get_page(dt, lnb[i].lnb_file_offset,
+					       gfp_mask);
+		if (lnb[i].lnb_page == NULL)
 			GOTO(cleanup, rc = -ENOMEM);
 
-		wait_on_page_writeback(lnb->lnb_page);
-		BUG_ON(PageWriteback(lnb->lnb_page));
+		wait_on_page_writeback(lnb[i].lnb_page);
+		BUG_ON(PageWriteback(lnb[i].lnb_page));
 
 		lu_object_get(&dt->do_lu);
+		i++;
 	}
 
+	osd_bufs_numa_stats(osd_obj2dev(obj), lnb, npages);
+
 	RETURN(i);
 
 cleanup:
 	if (i > 0)
-		osd_bufs_put(env, dt, lnb - i, i);
+		osd_bufs_put(env, dt, lnb, i);
 	return rc;
 }
 
@@ -1368,10 +1462,6 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 
         LASSERT(inode);
 
-	rc = osd_init_iobuf(osd, iobuf, 0, npages);
-	if (unlikely(rc != 0))
-		RETURN(rc);
-
 	isize = i_size_read(inode);
 
 	if (osd->od_read_cache)
@@ -1399,7 +1489,13 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 		if (PageUptodate(lnb[i].lnb_page)) {
 			cache_hits++;
 		} else {
-			cache_misses++;
+			/* set the iobuf up only once a page has to be read,
+			 * fully cached reads don't need it */
+			if (cache_misses++ == 0) {
+				rc = osd_init_iobuf(osd, iobuf, 0, npages);
+				if (unlikely(rc != 0))
+					RETURN(rc);
+			}
 			osd_iobuf_add_page(iobuf, lnb[i].lnb_page);
 		}
 
@@ -1421,7 +1517,7 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 		lprocfs_counter_add(osd->od_stats, LPROC_OSD_CACHE_ACCESS,
 				    cache_hits + cache_misses);
 
-        if (iobuf->dr_npages) {
+	if (cache_misses != 0) {
 		rc = osd_ldiskfs_map_inode_pages(inode, iobuf->dr_pages,
 						 iobuf->dr_npages,
 						 iobuf->dr_blocks, 0);
@@ -216,6 +216,12 @@ static int osd_stats_init(struct osd_device *osd)
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_MISS,
                                      LPROCFS_CNTR_AVGMINMAX,
                                      "cache_miss", "pages");
+                lprocfs_counter_init(osd->od_stats, LPROC_OSD_PAGE_LOCAL,
+                                     LPROCFS_CNTR_AVGMINMAX,
+                                     "numa_local", "pages");
+                lprocfs_counter_init(osd->od_stats, LPROC_OSD_PAGE_REMOTE,
+                                     LPROCFS_CNTR_AVGMINMAX,
+                                     "numa_remote", "pages");
 #if OSD_THANDLE_STATS
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_THANDLE_STARTING,
                                      LPROCFS_CNTR_AVGMINMAX,
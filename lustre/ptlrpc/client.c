@@ -108,6 +108,32 @@ struct ptlrpc_connection *ptlrpc_uuid_to_connection(struct obd_uuid *uuid,
 	return c;
 }
 
+/**
+ * Initialize bulk descriptor \a desc whose vector of \a nfrags entries
+ * is already allocated.
+ */
+void ptlrpc_init_bulk(struct ptlrpc_bulk_desc *desc, unsigned nfrags,
+		      unsigned max_brw, enum ptlrpc_bulk_op_type type,
+		      unsigned portal, const struct ptlrpc_bulk_frag_ops *ops)
+{
+	int i;
+
+	spin_lock_init(&desc->bd_lock);
+	init_waitqueue_head(&desc->bd_waitq);
+	desc->bd_max_iov = nfrags;
+	desc->bd_iov_count = 0;
+	desc->bd_portal = portal;
+	desc->bd_type = type;
+	desc->bd_md_count = 0;
+	desc->bd_frag_ops = (struct ptlrpc_bulk_frag_ops *) ops;
+	LASSERT(max_brw > 0);
+	desc->bd_md_max_brw = min(max_brw, PTLRPC_BULK_OPS_COUNT);
+	/* PTLRPC_BULK_OPS_COUNT is the compile-time transfer limit for this
+	 * node. Negotiated ocd_brw_size will always be <= this number. */
+	for (i = 0; i < PTLRPC_BULK_OPS_COUNT; i++)
+		LNetInvalidateMDHandle(&desc->bd_mds[i]);
+}
+
 /**
  * Allocate and initialize new bulk descriptor on the sender.
  * Returns pointer to the descriptor or NULL on error.
@@ -118,7 +144,6 @@ struct ptlrpc_bulk_desc *ptlrpc_new_bulk(unsigned nfrags, unsigned max_brw,
 					 const struct ptlrpc_bulk_frag_ops *ops)
 {
 	struct ptlrpc_bulk_desc *desc;
-	int i;
 
 	/* ensure that only one of KIOV or IOVEC is set but not both */
 	LASSERT((ptlrpc_is_bulk_desc_kiov(type) &&
@@ -141,20 +166,7 @@ struct ptlrpc_bulk_desc *ptlrpc_new_bulk(unsigned nfrags, unsigned max_brw,
 			goto out;
 	}
 
-	spin_lock_init(&desc->bd_lock);
-	init_waitqueue_head(&desc->bd_waitq);
-	desc->bd_max_iov = nfrags;
-	desc->bd_iov_count = 0;
-	desc->bd_portal = portal;
-	desc->bd_type = type;
-	desc->bd_md_count = 0;
-	desc->bd_frag_ops = (struct ptlrpc_bulk_frag_ops *) ops;
-	LASSERT(max_brw > 0);
-	desc->bd_md_max_brw = min(max_brw, PTLRPC_BULK_OPS_COUNT);
-	/* PTLRPC_BULK_OPS_COUNT is the compile-time transfer limit for this
-	 * node. Negotiated ocd_brw_size will always be <= this number. */
-	for (i = 0; i < PTLRPC_BULK_OPS_COUNT; i++)
-		LNetInvalidateMDHandle(&desc->bd_mds[i]);
+	ptlrpc_init_bulk(desc, nfrags, max_brw, type, portal, ops);
 
 	return desc;
 out:
@@ -273,6 +285,12 @@ void ptlrpc_free_bulk(struct ptlrpc_bulk_desc *desc)
 	if (desc->bd_frag_ops->release_frags != NULL)
 		desc->bd_frag_ops->release_frags(desc);
 
+	if (desc->bd_svcpt != NULL) {
+		ptlrpc_bulk_pool_put(desc);
+		EXIT;
+		return;
+	}
+
 	if (ptlrpc_is_bulk_desc_kiov(desc->bd_type))
 		OBD_FREE_LARGE(GET_KIOV(desc),
 			desc->bd_max_iov * sizeof(*GET_KIOV(desc)));
@@ -1109,7 +1127,7 @@ void ptlrpc_set_add_new_req(struct ptlrpcd_ctl *pc,
                            struct ptlrpc_request *req)
 {
         struct ptlrpc_request_set *set = pc->pc_set;
-        int count, i;
+	int count;
 
         LASSERT(req->rq_set == NULL);
 	LASSERT(test_bit(LIOD_STOP, &pc->pc_flags) == 0);
@@ -1124,16 +1142,15 @@ void ptlrpc_set_add_new_req(struct ptlrpcd_ctl *pc,
 	count = atomic_inc_return(&set->set_new_count);
 	spin_unlock(&set->set_new_req_lock);
 
-	/* Only need to call wakeup once for the first entry. */
-	if (count == 1) {
-		wake_up(&set->set_waitq);
+	/* Small async RPCs may leave the wakeup to the coalescing timer, so
+	 * that those queued within the window are sent in one pass. */
+	if (ptlrpcd_coalesce(pc, req, count))
+		return;
 
-		/* XXX: It maybe unnecessary to wakeup all the partners. But to
-		 *      guarantee the async RPC can be processed ASAP, we have
-		 *      no other better choice. It maybe fixed in future. */
-		for (i = 0; i < pc->pc_npartners; i++)
-			wake_up(&pc->pc_partners[i]->pc_set->set_waitq);
-	}
+	/* Only need to call wakeup once for the first entry, or for the
+	 * first one after the wakeup was deferred. */
+	if (count == 1 || test_and_clear_bit(LIOD_COALESCE, &pc->pc_flags))
+		ptlrpcd_wake_pc(pc, req);
 }
 
 /**
@@ -2928,6 +2945,58 @@ int ptlrpc_queue_wait(struct ptlrpc_request *req)
 }
 EXPORT_SYMBOL(ptlrpc_queue_wait);
 
+/**
+ * Complete request \a req with the reply message \a msg of \a len bytes
+ * received as a part of the reply of the batch request \a batch, as if
+ * the reply came from the network. \a req has never been sent on its own,
+ * it only has to be packed.
+ *
+ * \retval request processing status, as ptlrpc_queue_wait() returns it;
+ * if \a req->rq_resend is set on return, the request has to be resent.
+ */
+int ptlrpc_subreq_reply(struct ptlrpc_request *batch,
+			struct ptlrpc_request *req, void *msg, int len)
+{
+	struct obd_import *imp = req->rq_import;
+	int rc;
+	ENTRY;
+
+	LASSERT(req->rq_repbuf == NULL);
+	LASSERT(!req->rq_receiving_reply);
+
+	rc = sptlrpc_cli_alloc_repbuf(req, max_t(int, req->rq_replen, len));
+	if (rc)
+		RETURN(rc);
+
+	req->rq_reply_off = lustre_msg_early_size();
+	LASSERT(req->rq_reply_off + len <= req->rq_repbuf_len);
+	memcpy(req->rq_repbuf + req->rq_reply_off, msg, len);
+	req->rq_nob_received = len;
+	req->rq_sent = batch->rq_sent;
+	req->rq_sent_ns = batch->rq_sent_ns;
+	req->rq_import_generation = batch->rq_import_generation;
+
+	spin_lock(&req->rq_lock);
+	req->rq_req_unlinked = 1;
+	req->rq_reply_unlinked = 1;
+	req->rq_replied = 1;
+	spin_unlock(&req->rq_lock);
+
+	rc = after_reply(req);
+	if (req->rq_resend)
+		RETURN(rc);
+
+	spin_lock(&imp->imp_lock);
+	list_del_init(&req->rq_unreplied_list);
+	spin_unlock(&imp->imp_lock);
+
+	req->rq_status = rc;
+	ptlrpc_rqphase_move(req, RQ_PHASE_COMPLETE);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(ptlrpc_subreq_reply);
+
 /**
  * Callback used for replayed requests reply processing.
  * In case of successful reply calls registered request replay callback.
@@ -460,6 +460,19 @@ void server_bulk_callback(struct lnet_event *ev)
 		 * read/wrote the peer buffer and how much... */
 		desc->bd_nob_transferred += ev->mlength;
 		desc->bd_sender = ev->sender;
+
+		/* Let the waiter consume this MD's pages while the rest
+		 * of the bulk is still on the wire. MD n starts at page
+		 * n * LNET_MAX_IOV, see ptlrpc_fill_bulk_md(). */
+		if (desc->bd_md_track && ev->type == LNET_EVENT_REPLY) {
+			lnet_kiov_t *kiov = ev->md.start;
+			int mdidx = (kiov - &BD_GET_KIOV(desc, 0)) /
+				    LNET_MAX_IOV;
+
+			LASSERT(mdidx >= 0 && mdidx < 64);
+			desc->bd_md_done |= 1ULL << mdidx;
+			wake_up(&desc->bd_waitq);
+		}
 	}
 
 	if (ev->status != 0)
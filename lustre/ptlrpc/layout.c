@@ -328,6 +328,27 @@ static const struct req_msg_field *mdt_swap_layouts[] = {
 	&RMF_DLM_REQ
 };
 
+static const struct req_msg_field *mds_batch_getattr_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MDT_BODY,
+	&RMF_BATCH_GETATTR
+};
+
+static const struct req_msg_field *mds_batch_getattr_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_BATCH_GETATTR
+};
+
+static const struct req_msg_field *mds_batch_reint_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OUT_UPDATE_HEADER
+};
+
+static const struct req_msg_field *mds_batch_reint_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OUT_UPDATE_REPLY
+};
+
 static const struct req_msg_field *obd_connect_client[] = {
         &RMF_PTLRPC_BODY,
         &RMF_TGTUUID,
@@ -616,12 +637,14 @@ static const struct req_msg_field *ost_brw_client[] = {
         &RMF_OST_BODY,
         &RMF_OBD_IOOBJ,
         &RMF_NIOBUF_REMOTE,
-        &RMF_CAPA1
+	&RMF_CAPA1,
+	&RMF_SHORT_IO
 };
 
 static const struct req_msg_field *ost_brw_read_server[] = {
-        &RMF_PTLRPC_BODY,
-        &RMF_OST_BODY
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_SHORT_IO
 };
 
 static const struct req_msg_field *ost_brw_write_server[] = {
@@ -774,6 +797,8 @@ static struct req_format *req_formats[] = {
 	&RQF_MDS_HSM_ACTION,
 	&RQF_MDS_HSM_REQUEST,
 	&RQF_MDS_SWAP_LAYOUTS,
+	&RQF_MDS_BATCH_GETATTR,
+	&RQF_MDS_BATCH_REINT,
 	&RQF_OUT_UPDATE,
         &RQF_OST_CONNECT,
         &RQF_OST_DISCONNECT,
@@ -1138,6 +1163,11 @@ struct req_msg_field RMF_RCS =
                     lustre_swab_generic_32s, dump_rcs);
 EXPORT_SYMBOL(RMF_RCS);
 
+/* inline BRW data for OBD_FL_SHORT_IO requests, no swabbing needed */
+struct req_msg_field RMF_SHORT_IO =
+	DEFINE_MSGF("short_io", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_SHORT_IO);
+
 struct req_msg_field RMF_EAVALS_LENS =
 	DEFINE_MSGF("eavals_lens", RMF_F_STRUCT_ARRAY, sizeof(__u32),
 		lustre_swab_generic_32s, NULL);
@@ -1221,6 +1251,11 @@ struct req_msg_field RMF_SWAP_LAYOUTS =
 		    lustre_swab_swap_layouts, NULL);
 EXPORT_SYMBOL(RMF_SWAP_LAYOUTS);
 
+/* variable sized, the items are swabbed by their users */
+struct req_msg_field RMF_BATCH_GETATTR =
+	DEFINE_MSGF("batch_getattr", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_BATCH_GETATTR);
+
 struct req_msg_field RMF_LFSCK_REQUEST =
 	DEFINE_MSGF("lfsck_request", 0, sizeof(struct lfsck_request),
 		    lustre_swab_lfsck_request, NULL);
@@ -1601,6 +1636,16 @@ struct req_format RQF_MDS_SWAP_LAYOUTS =
 			mdt_swap_layouts, empty);
 EXPORT_SYMBOL(RQF_MDS_SWAP_LAYOUTS);
 
+struct req_format RQF_MDS_BATCH_GETATTR =
+	DEFINE_REQ_FMT0("MDS_BATCH_GETATTR",
+			mds_batch_getattr_client, mds_batch_getattr_server);
+EXPORT_SYMBOL(RQF_MDS_BATCH_GETATTR);
+
+struct req_format RQF_MDS_BATCH_REINT =
+	DEFINE_REQ_FMT0("MDS_BATCH_REINT",
+			mds_batch_reint_client, mds_batch_reint_server);
+EXPORT_SYMBOL(RQF_MDS_BATCH_REINT);
+
 struct req_format RQF_LLOG_ORIGIN_HANDLE_CREATE =
         DEFINE_REQ_FMT0("LLOG_ORIGIN_HANDLE_CREATE",
                         llog_origin_handle_create_client, llogd_body_only);
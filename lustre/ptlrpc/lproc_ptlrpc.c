@@ -96,6 +96,8 @@ static struct ll_rpc_opcode {
 	{ MDS_HSM_CT_REGISTER, "mds_hsm_ct_register" },
 	{ MDS_HSM_CT_UNREGISTER, "mds_hsm_ct_unregister" },
 	{ MDS_SWAP_LAYOUTS,	"mds_swap_layouts" },
+	{ MDS_BATCH_GETATTR,	"mds_batch_getattr" },
+	{ MDS_BATCH_REINT,	"mds_batch_reint" },
         { LDLM_ENQUEUE,     "ldlm_enqueue" },
         { LDLM_CONVERT,     "ldlm_convert" },
         { LDLM_CANCEL,      "ldlm_cancel" },
@@ -154,6 +156,7 @@ static struct ll_eopcode {
         { MDS_REINT_SETXATTR,   "mds_reint_setxattr" },
         { BRW_READ_BYTES,       "read_bytes" },
         { BRW_WRITE_BYTES,      "write_bytes" },
+	{ PTLRPC_COALESCED,	"req_coalesced" },
 };
 
 const char *ll_opcode2str(__u32 opcode)
@@ -434,6 +437,142 @@ ptlrpc_lprocfs_threads_max_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ptlrpc_lprocfs_threads_max);
 
+static int
+ptlrpc_lprocfs_threads_idle_time_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+
+	seq_printf(m, "%d\n", svc->srv_thrs_idle_time);
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_threads_idle_time_seq_write(struct file *file,
+					   const char __user *buffer,
+					   size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	__s64 val;
+	int rc = lprocfs_str_to_s64(buffer, count, &val);
+
+	if (rc < 0)
+		return rc;
+
+	if (val < 0 || val > INT_MAX)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_thrs_idle_time = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_threads_idle_time);
+
+static int
+ptlrpc_lprocfs_threads_wait_target_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+
+	seq_printf(m, "%d\n", svc->srv_thrs_wait_target);
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_threads_wait_target_seq_write(struct file *file,
+					     const char __user *buffer,
+					     size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	__s64 val;
+	int rc = lprocfs_str_to_s64(buffer, count, &val);
+
+	if (rc < 0)
+		return rc;
+
+	if (val < 0 || val > INT_MAX)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_thrs_wait_target = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_threads_wait_target);
+
+static int
+ptlrpc_lprocfs_threads_stats_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	int				i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		seq_printf(m, "cpt %d: running %d retired %llu "
+			   "wait_avg_us %llu\n", svcpt->scp_cpt,
+			   svcpt->scp_nthrs_running, svcpt->scp_nthrs_retired,
+			   svcpt->scp_thr_wait_avg);
+	}
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(ptlrpc_lprocfs_threads_stats);
+
+static int
+ptlrpc_lprocfs_bulk_pool_stats_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	__u64				 total;
+	int				 i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_bulk_lock);
+		total = svcpt->scp_bulk_hits + svcpt->scp_bulk_allocs;
+		seq_printf(m, "cpt %d: cached %d hits %llu allocs %llu "
+			   "local %llu remote %llu shrunk %llu\n",
+			   svcpt->scp_cpt, svcpt->scp_bulk_nfree,
+			   svcpt->scp_bulk_hits, svcpt->scp_bulk_allocs,
+			   total - svcpt->scp_bulk_remote,
+			   svcpt->scp_bulk_remote, svcpt->scp_bulk_shrunk);
+		spin_unlock(&svcpt->scp_bulk_lock);
+	}
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(ptlrpc_lprocfs_bulk_pool_stats);
+
+static int
+ptlrpc_lprocfs_rs_arena_stats_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	int				 i;
+	int				 j;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_rs_arena_lock);
+		seq_printf(m, "cpt %d: hits %llu misses %llu oversize %llu "
+			   "shrunk %llu cached", svcpt->scp_cpt,
+			   svcpt->scp_rs_arena_hits,
+			   svcpt->scp_rs_arena_misses,
+			   svcpt->scp_rs_arena_oversize,
+			   svcpt->scp_rs_arena_shrunk);
+		for (j = 0; j < PTLRPC_RS_ARENA_CLASSES; j++)
+			seq_printf(m, " %dK:%d",
+				   1 << (j + PTLRPC_RS_ARENA_SHIFT - 10),
+				   svcpt->scp_rs_arena_count[j]);
+		seq_putc(m, '\n');
+		spin_unlock(&svcpt->scp_rs_arena_lock);
+	}
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(ptlrpc_lprocfs_rs_arena_stats);
+
 /**
  * Translates \e ptlrpc_nrs_pol_state values to human-readable strings.
  *
@@ -1099,6 +1238,346 @@ ptlrpc_lprocfs_hp_ratio_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(ptlrpc_lprocfs_hp_ratio);
 
+static int ptlrpc_lprocfs_req_steal_seq_show(struct seq_file *m, void *v)
+{
+	struct ptlrpc_service *svc = m->private;
+
+	seq_printf(m, "%d\n", svc->srv_req_steal);
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_req_steal_seq_write(struct file *file,
+				   const char __user *buffer,
+				   size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc < 0)
+		return rc;
+
+	if (val != 0 && val != 1)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_req_steal = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_req_steal);
+
+static int ptlrpc_lprocfs_req_steal_stats_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	__u64				steal;
+	__u64				stolen;
+	int				nstolen;
+	int				i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_req_lock);
+		steal	= svcpt->scp_steal_count;
+		stolen	= svcpt->scp_stolen_count;
+		nstolen	= svcpt->scp_nreqs_stolen;
+		spin_unlock(&svcpt->scp_req_lock);
+
+		seq_printf(m, "cpt %d: steal %llu stolen %llu active %d\n",
+			   svcpt->scp_cpt, steal, stolen, nstolen);
+	}
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(ptlrpc_lprocfs_req_steal_stats);
+
+#define pct(a, b) (b ? a * 100 / b : 0)
+
+static const char *ptlrpc_req_stage_names[PTLRPC_STAGE_MAX] = {
+	[PTLRPC_STAGE_QUEUE]		= "queue",
+	[PTLRPC_STAGE_HANDLE]		= "handle",
+	[PTLRPC_STAGE_UNPACK]		= "unpack",
+	[PTLRPC_STAGE_IO_PREP]		= "io_prep",
+	[PTLRPC_STAGE_BULK]		= "bulk",
+	[PTLRPC_STAGE_IO_COMMIT]	= "io_commit",
+	[PTLRPC_STAGE_REPLY]		= "reply",
+};
+
+/* print a log2 usecs histogram, each bucket labelled by its upper bound */
+static void ptlrpc_lprocfs_hist_show(struct seq_file *m, const char *name,
+				     unsigned long *buckets)
+{
+	unsigned long	tot = 0;
+	unsigned long	cum = 0;
+	int		i;
+
+	for (i = 0; i < OBD_HIST_MAX; i++)
+		tot += buckets[i];
+	if (tot == 0)
+		return;
+
+	seq_printf(m, "\n%-22s rpcs   %% cum %%\n", name);
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		cum += buckets[i];
+		if (cum == 0)
+			continue;
+
+		if (i < 10)
+			seq_printf(m, "%uus", 1 << i);
+		else if (i < 20)
+			seq_printf(m, "%uKus", 1 << (i - 10));
+		else
+			seq_printf(m, "%uMus", 1 << (i - 20));
+
+		seq_printf(m, ":\t\t%10lu %3lu %3lu\n", buckets[i],
+			   pct(buckets[i], tot), pct(cum, tot));
+		if (cum == tot)
+			break;
+	}
+}
+
+static void ptlrpc_lprocfs_snapshot_time(struct seq_file *m)
+{
+	struct timespec64 now;
+
+	/* this sampling races with updates */
+	ktime_get_real_ts64(&now);
+	seq_printf(m, "snapshot_time:         %lld.%09ld (secs.nsecs)\n",
+		   (s64)now.tv_sec, now.tv_nsec);
+}
+
+static int ptlrpc_lprocfs_req_latency_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	unsigned long			buckets[OBD_HIST_MAX];
+	int				stage;
+	int				i;
+	int				j;
+
+	ptlrpc_lprocfs_snapshot_time(m);
+	for (stage = 0; stage < PTLRPC_STAGE_MAX; stage++) {
+		memset(buckets, 0, sizeof(buckets));
+		ptlrpc_service_for_each_part(svcpt, i, svc) {
+			for (j = 0; j < OBD_HIST_MAX; j++)
+				buckets[j] +=
+				    svcpt->scp_stage_hist[stage].oh_buckets[j];
+		}
+		ptlrpc_lprocfs_hist_show(m, ptlrpc_req_stage_names[stage],
+					 buckets);
+	}
+
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_req_latency_seq_write(struct file *file,
+				     const char __user *buffer,
+				     size_t count, loff_t *off)
+{
+	struct seq_file			*m = file->private_data;
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	int				stage;
+	int				i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		for (stage = 0; stage < PTLRPC_STAGE_MAX; stage++)
+			lprocfs_oh_clear(&svcpt->scp_stage_hist[stage]);
+	}
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_req_latency);
+
+static int
+ptlrpc_lprocfs_req_opc_latency_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	unsigned long			buckets[OBD_HIST_MAX];
+	int				opc;
+	int				i;
+	int				j;
+
+	ptlrpc_lprocfs_snapshot_time(m);
+	for (opc = 0; opc < LUSTRE_MAX_OPCODES; opc++) {
+		if (ll_rpc_opcode_table[opc].opname == NULL)
+			continue;
+
+		memset(buckets, 0, sizeof(buckets));
+		ptlrpc_service_for_each_part(svcpt, i, svc) {
+			for (j = 0; j < OBD_HIST_MAX; j++)
+				buckets[j] +=
+				    svcpt->scp_opc_hist[opc].oh_buckets[j];
+		}
+		ptlrpc_lprocfs_hist_show(m, ll_rpc_opcode_table[opc].opname,
+					 buckets);
+	}
+
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_req_opc_latency_seq_write(struct file *file,
+					 const char __user *buffer,
+					 size_t count, loff_t *off)
+{
+	struct seq_file			*m = file->private_data;
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	int				opc;
+	int				i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		for (opc = 0; opc < LUSTRE_MAX_OPCODES; opc++)
+			lprocfs_oh_clear(&svcpt->scp_opc_hist[opc]);
+	}
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_req_opc_latency);
+
+static int
+ptlrpc_lprocfs_difficult_reply_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	unsigned long			ack[OBD_HIST_MAX] = { 0 };
+	unsigned long			commit[OBD_HIST_MAX] = { 0 };
+	int				i;
+	int				j;
+
+	ptlrpc_lprocfs_snapshot_time(m);
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_rep_lock);
+		seq_printf(m, "cpt %d: outstanding %d committed %llu "
+			   "commit_batches %llu\n", svcpt->scp_cpt,
+			   atomic_read(&svcpt->scp_nreps_difficult),
+			   svcpt->scp_rep_committed,
+			   svcpt->scp_rep_commit_batches);
+		spin_unlock(&svcpt->scp_rep_lock);
+
+		for (j = 0; j < OBD_HIST_MAX; j++) {
+			ack[j] += svcpt->scp_rep_ack_hist.oh_buckets[j];
+			commit[j] += svcpt->scp_rep_commit_hist.oh_buckets[j];
+		}
+	}
+	ptlrpc_lprocfs_hist_show(m, "ack", ack);
+	ptlrpc_lprocfs_hist_show(m, "commit", commit);
+
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_difficult_reply_seq_write(struct file *file,
+					 const char __user *buffer,
+					 size_t count, loff_t *off)
+{
+	struct seq_file			*m = file->private_data;
+	struct ptlrpc_service		*svc = m->private;
+	struct ptlrpc_service_part	*svcpt;
+	int				i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_rep_lock);
+		svcpt->scp_rep_committed = 0;
+		svcpt->scp_rep_commit_batches = 0;
+		spin_unlock(&svcpt->scp_rep_lock);
+		lprocfs_oh_clear(&svcpt->scp_rep_ack_hist);
+		lprocfs_oh_clear(&svcpt->scp_rep_commit_hist);
+	}
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_difficult_reply);
+
+static int
+ptlrpc_lprocfs_req_slow_threshold_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+
+	seq_printf(m, "%d\n", svc->srv_slow_req_threshold);
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_req_slow_threshold_seq_write(struct file *file,
+					    const char __user *buffer,
+					    size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	__s64 val;
+	int rc = lprocfs_str_to_s64(buffer, count, &val);
+
+	if (rc < 0)
+		return rc;
+
+	if (val < 0 || val > INT_MAX)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_slow_req_threshold = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_req_slow_threshold);
+
+static int ptlrpc_lprocfs_req_slow_log_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service	*svc = m->private;
+	struct ptlrpc_slow_req	*psr;
+	unsigned int		next;
+	int			stage;
+	int			i;
+
+	spin_lock(&svc->srv_lock);
+	next = svc->srv_slow_req_next;
+	/* oldest first */
+	for (i = 0; i < PTLRPC_SLOW_REQ_MAX; i++) {
+		psr = &svc->srv_slow_reqs[(next + i) % PTLRPC_SLOW_REQ_MAX];
+		if (psr->psr_xid == 0)
+			continue;
+
+		seq_printf(m, "x%llu opc %u peer %s arrival %lld jobid %s "
+			   "total %uus", psr->psr_xid, psr->psr_opc,
+			   libcfs_nid2str(psr->psr_peer), (s64)psr->psr_arrival,
+			   psr->psr_jobid[0] != '\0' ? psr->psr_jobid : "-",
+			   psr->psr_total_us);
+		for (stage = 0; stage < PTLRPC_STAGE_MAX; stage++)
+			seq_printf(m, " %s %u", ptlrpc_req_stage_names[stage],
+				   psr->psr_stage_us[stage]);
+		seq_putc(m, '\n');
+	}
+	spin_unlock(&svc->srv_lock);
+
+	return 0;
+}
+
+static ssize_t
+ptlrpc_lprocfs_req_slow_log_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+
+	spin_lock(&svc->srv_lock);
+	memset(svc->srv_slow_reqs, 0,
+	       sizeof(*svc->srv_slow_reqs) * PTLRPC_SLOW_REQ_MAX);
+	svc->srv_slow_req_next = 0;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_req_slow_log);
+
 void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
                                      struct ptlrpc_service *svc)
 {
@@ -1121,12 +1600,48 @@ void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
 		{ .name = "threads_started",
 		  .fops = &ptlrpc_lprocfs_threads_started_fops,
 		  .data = svc },
+		{ .name = "threads_idle_time",
+		  .fops = &ptlrpc_lprocfs_threads_idle_time_fops,
+		  .data = svc },
+		{ .name = "threads_wait_target",
+		  .fops = &ptlrpc_lprocfs_threads_wait_target_fops,
+		  .data = svc },
+		{ .name = "threads_stats",
+		  .fops = &ptlrpc_lprocfs_threads_stats_fops,
+		  .data = svc },
+		{ .name = "bulk_pool_stats",
+		  .fops = &ptlrpc_lprocfs_bulk_pool_stats_fops,
+		  .data = svc },
+		{ .name = "rs_arena_stats",
+		  .fops = &ptlrpc_lprocfs_rs_arena_stats_fops,
+		  .data = svc },
 		{ .name = "timeouts",
 		  .fops = &ptlrpc_lprocfs_timeouts_fops,
 		  .data = svc },
 		{ .name = "nrs_policies",
 		  .fops = &ptlrpc_lprocfs_nrs_fops,
 		  .data = svc },
+		{ .name = "req_steal",
+		  .fops = &ptlrpc_lprocfs_req_steal_fops,
+		  .data = svc },
+		{ .name = "req_steal_stats",
+		  .fops = &ptlrpc_lprocfs_req_steal_stats_fops,
+		  .data = svc },
+		{ .name = "req_latency_hist",
+		  .fops = &ptlrpc_lprocfs_req_latency_fops,
+		  .data = svc },
+		{ .name = "req_opc_latency_hist",
+		  .fops = &ptlrpc_lprocfs_req_opc_latency_fops,
+		  .data = svc },
+		{ .name = "difficult_reply_stats",
+		  .fops = &ptlrpc_lprocfs_difficult_reply_fops,
+		  .data = svc },
+		{ .name = "req_slow_threshold",
+		  .fops = &ptlrpc_lprocfs_req_slow_threshold_fops,
+		  .data = svc },
+		{ .name = "req_slow_log",
+		  .fops = &ptlrpc_lprocfs_req_slow_log_fops,
+		  .data = svc },
 		{ NULL }
         };
         static struct file_operations req_history_fops = {
@@ -130,7 +130,9 @@ struct ptlrpc_bulk_desc *ptlrpc_prep_bulk_exp(struct ptlrpc_request *req,
 	ENTRY;
 	LASSERT(ptlrpc_is_bulk_op_active(type));
 
-	desc = ptlrpc_new_bulk(nfrags, max_brw, type, portal, ops);
+	desc = ptlrpc_bulk_pool_get(req, nfrags, max_brw, type, portal, ops);
+	if (desc == NULL)
+		desc = ptlrpc_new_bulk(nfrags, max_brw, type, portal, ops);
 	if (desc == NULL)
 		RETURN(NULL);
 
@@ -192,6 +194,7 @@ int ptlrpc_start_bulk_transfer(struct ptlrpc_bulk_desc *desc)
 
 	desc->bd_md_count = total_md;
 	desc->bd_failure = 0;
+	desc->bd_md_done = 0;
 
 	md.user_ptr = &desc->bd_cbid;
 	md.eq_handle = ptlrpc_eq_h;
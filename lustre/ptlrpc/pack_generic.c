@@ -326,6 +326,79 @@ void lustre_put_emerg_rs(struct ptlrpc_reply_state *rs)
 	wake_up(&svcpt->scp_rep_waitq);
 }
 
+/**
+ * Get a reply state of at least \a size bytes from the arena of \a svcpt,
+ * rounded up to the size class. The reply state is zeroed up to \a size.
+ *
+ * \retval NULL if \a size is larger than any size class or the allocation
+ *	   failed, the caller falls back to OBD_ALLOC_LARGE()
+ */
+struct ptlrpc_reply_state *
+lustre_get_arena_rs(struct ptlrpc_service_part *svcpt, int size)
+{
+	struct ptlrpc_service		*svc = svcpt->scp_service;
+	struct ptlrpc_reply_state	*rs = NULL;
+	int				 idx;
+
+	spin_lock(&svcpt->scp_rs_arena_lock);
+	if (size > PTLRPC_RS_ARENA_MAX) {
+		svcpt->scp_rs_arena_oversize++;
+		spin_unlock(&svcpt->scp_rs_arena_lock);
+		return NULL;
+	}
+
+	idx = max_t(int, order_base_2(size) - PTLRPC_RS_ARENA_SHIFT, 0);
+	if (!list_empty(&svcpt->scp_rs_arena[idx])) {
+		rs = list_entry(svcpt->scp_rs_arena[idx].next,
+				struct ptlrpc_reply_state, rs_list);
+		list_del(&rs->rs_list);
+		svcpt->scp_rs_arena_count[idx]--;
+		svcpt->scp_rs_arena_hits++;
+	} else {
+		svcpt->scp_rs_arena_misses++;
+	}
+	spin_unlock(&svcpt->scp_rs_arena_lock);
+
+	if (rs != NULL) {
+		memset(rs, 0, size);
+	} else {
+		OBD_CPT_ALLOC_LARGE(rs, svc->srv_cptable, svcpt->scp_cpt,
+				    1 << (idx + PTLRPC_RS_ARENA_SHIFT));
+		if (rs == NULL)
+			return NULL;
+	}
+
+	rs->rs_size = 1 << (idx + PTLRPC_RS_ARENA_SHIFT);
+	rs->rs_svcpt = svcpt;
+	rs->rs_arena = 1;
+
+	return rs;
+}
+
+/**
+ * Return reply state \a rs to the arena it was taken from, keeping at most
+ * one cached reply state per running thread in each size class.
+ */
+void lustre_put_arena_rs(struct ptlrpc_reply_state *rs)
+{
+	struct ptlrpc_service_part	*svcpt = rs->rs_svcpt;
+	int				 idx;
+
+	LASSERT(rs->rs_arena);
+	idx = ilog2(rs->rs_size) - PTLRPC_RS_ARENA_SHIFT;
+
+	spin_lock(&svcpt->scp_rs_arena_lock);
+	if (svcpt->scp_rs_arena_count[idx] < svcpt->scp_nthrs_running) {
+		list_add(&rs->rs_list, &svcpt->scp_rs_arena[idx]);
+		svcpt->scp_rs_arena_count[idx]++;
+		rs = NULL;
+	}
+	spin_unlock(&svcpt->scp_rs_arena_lock);
+
+	if (rs != NULL)
+		OBD_FREE_LARGE(rs, rs->rs_size);
+}
+
 int lustre_pack_reply_v2(struct ptlrpc_request *req, int count,
                          __u32 *lens, char **bufs, int flags)
 {
@@ -2267,6 +2340,7 @@ void lustre_swab_lov_comp_md_v1(struct lov_comp_md_v1 *lum)
 	__swab32s(&lum->lcm_layout_gen);
 	__swab16s(&lum->lcm_flags);
 	__swab16s(&lum->lcm_entry_count);
+	__swab16s(&lum->lcm_mirror_count);
 	CLASSERT(offsetof(typeof(*lum), lcm_padding1) != 0);
 	CLASSERT(offsetof(typeof(*lum), lcm_padding2) != 0);
 
@@ -2400,6 +2474,31 @@ void lustre_swab_ldlm_reply (struct ldlm_reply *r)
         __swab64s (&r->lock_policy_res2);
 }
 
+void lustre_swab_mdt_batch_getattr(struct mdt_batch_getattr *mbg)
+{
+	__swab32s(&mbg->mbg_count);
+	CLASSERT(offsetof(typeof(*mbg), mbg_padding) != 0);
+}
+EXPORT_SYMBOL(lustre_swab_mdt_batch_getattr);
+
+void lustre_swab_mdt_batch_getattr_req(struct mdt_batch_getattr_req *mbq)
+{
+	lustre_swab_ldlm_request(&mbq->mbq_lockreq);
+	lustre_swab_lu_fid(&mbq->mbq_fid);
+	__swab32s(&mbq->mbq_namelen);
+	CLASSERT(offsetof(typeof(*mbq), mbq_padding) != 0);
+}
+EXPORT_SYMBOL(lustre_swab_mdt_batch_getattr_req);
+
+void lustre_swab_mdt_batch_getattr_rep(struct mdt_batch_getattr_rep *mbp)
+{
+	__swab32s(&mbp->mbp_rc);
+	CLASSERT(offsetof(typeof(*mbp), mbp_padding) != 0);
+	lustre_swab_ldlm_reply(&mbp->mbp_lockrep);
+	lustre_swab_mdt_body(&mbp->mbp_body);
+}
+EXPORT_SYMBOL(lustre_swab_mdt_batch_getattr_rep);
+
 void lustre_swab_quota_body(struct quota_body *b)
 {
 	lustre_swab_lu_fid(&b->qb_fid);
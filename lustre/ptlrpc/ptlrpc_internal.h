@@ -64,12 +64,25 @@ extern struct mutex ptlrpcd_mutex;
 extern struct mutex pinger_mutex;
 
 int ptlrpc_start_thread(struct ptlrpc_service_part *svcpt, int wait);
+struct ptlrpc_bulk_desc *
+ptlrpc_bulk_pool_get(struct ptlrpc_request *req, unsigned nfrags,
+		     unsigned max_brw, enum ptlrpc_bulk_op_type type,
+		     unsigned portal, const struct ptlrpc_bulk_frag_ops *ops);
+void ptlrpc_bulk_pool_put(struct ptlrpc_bulk_desc *desc);
+int ptlrpc_svc_cache_init(void);
+void ptlrpc_svc_cache_fini(void);
 /* ptlrpcd.c */
 int ptlrpcd_start(struct ptlrpcd_ctl *pc);
+bool ptlrpcd_coalesce(struct ptlrpcd_ctl *pc, struct ptlrpc_request *req,
+		      int count);
+void ptlrpcd_wake_pc(struct ptlrpcd_ctl *pc, struct ptlrpc_request *req);
 
 /* client.c */
 void ptlrpc_at_adj_net_latency(struct ptlrpc_request *req,
 			       unsigned int service_time);
+void ptlrpc_init_bulk(struct ptlrpc_bulk_desc *desc, unsigned nfrags,
+		      unsigned max_brw, enum ptlrpc_bulk_op_type type,
+		      unsigned portal, const struct ptlrpc_bulk_frag_ops *ops);
 struct ptlrpc_bulk_desc *ptlrpc_new_bulk(unsigned npages, unsigned max_brw,
 					 enum ptlrpc_bulk_op_type type,
 					 unsigned portal,
@@ -265,6 +278,9 @@ void ptlrpc_fill_bulk_md(struct lnet_md *md, struct ptlrpc_bulk_desc *desc,
 struct ptlrpc_reply_state *
 lustre_get_emerg_rs(struct ptlrpc_service_part *svcpt);
 void lustre_put_emerg_rs(struct ptlrpc_reply_state *rs);
+struct ptlrpc_reply_state *
+lustre_get_arena_rs(struct ptlrpc_service_part *svcpt, int size);
+void lustre_put_arena_rs(struct ptlrpc_reply_state *rs);
 
 /* pinger.c */
 int ptlrpc_start_pinger(void);
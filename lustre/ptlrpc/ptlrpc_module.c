@@ -77,10 +77,14 @@ static __init int ptlrpc_init(void)
 	if (rc)
 		GOTO(err_hr, rc);
 
-	rc = ptlrpc_init_portals();
+	rc = ptlrpc_svc_cache_init();
 	if (rc)
 		GOTO(err_cache, rc);
 
+	rc = ptlrpc_init_portals();
+	if (rc)
+		GOTO(err_svc_cache, rc);
+
 	rc = ptlrpc_connection_init();
 	if (rc)
 		GOTO(err_portals, rc);
@@ -120,6 +124,8 @@ err_conn:
 	ptlrpc_connection_fini();
 err_portals:
 	ptlrpc_exit_portals();
+err_svc_cache:
+	ptlrpc_svc_cache_fini();
 err_cache:
 	ptlrpc_request_cache_fini();
 err_hr:
@@ -139,6 +145,7 @@ static void __exit ptlrpc_exit(void)
 	ldlm_exit();
 	ptlrpc_stop_pinger();
 	ptlrpc_exit_portals();
+	ptlrpc_svc_cache_fini();
 	ptlrpc_request_cache_fini();
 	ptlrpc_hr_fini();
 	ptlrpc_connection_fini();
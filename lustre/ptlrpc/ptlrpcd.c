@@ -51,6 +51,7 @@
 
 #define DEBUG_SUBSYSTEM S_RPC
 
+#include <linux/hash.h>
 #include <linux/kthread.h>
 #include <libcfs/libcfs.h>
 #include <lustre_net.h>
@@ -137,6 +138,34 @@ module_param(ptlrpcd_cpts, charp, 0644);
 MODULE_PARM_DESC(ptlrpcd_cpts,
 		 "CPU partitions ptlrpcd threads should run in");
 
+/*
+ * ptlrpcd_import_affinity: Queue all requests of an import to the same
+ * ptlrpcd thread of the submitting CPT, instead of spreading them over
+ * the threads round-robin, so that the import, its connection and its
+ * request state stay warm in one thread's cache.
+ */
+static int ptlrpcd_import_affinity = 1;
+module_param(ptlrpcd_import_affinity, int, 0644);
+MODULE_PARM_DESC(ptlrpcd_import_affinity,
+		 "Send the requests of an import from one ptlrpcd thread per CPT");
+
+/*
+ * ptlrpcd_coalesce_usecs: How long the wakeup of a ptlrpcd thread may be
+ * deferred for small async RPCs (lock cancels, glimpses, grant shrinks),
+ * so that those queued meanwhile are sent in one pass over the set.
+ * 0 disables coalescing. ptlrpcd_coalesce_max bounds the batch size,
+ * the thread is woken at once when that many requests are queued.
+ */
+static unsigned int ptlrpcd_coalesce_usecs;
+module_param(ptlrpcd_coalesce_usecs, uint, 0644);
+MODULE_PARM_DESC(ptlrpcd_coalesce_usecs,
+		 "Max time small async RPCs wait for ptlrpcd to batch them");
+
+static unsigned int ptlrpcd_coalesce_max = 32;
+module_param(ptlrpcd_coalesce_max, uint, 0644);
+MODULE_PARM_DESC(ptlrpcd_coalesce_max,
+		 "Max number of small async RPCs batched by ptlrpcd");
+
 /* ptlrpcds_cpt_idx maps cpt numbers to an index in the ptlrpcds array. */
 static int		*ptlrpcds_cpt_idx;
 
@@ -182,6 +211,10 @@ ptlrpcd_select_pc(struct ptlrpc_request *req)
 		idx = ptlrpcds_cpt_idx[cpt];
 	pd = ptlrpcds[idx];
 
+	if (ptlrpcd_import_affinity && req != NULL && req->rq_import != NULL)
+		return &pd->pd_threads[hash_ptr(req->rq_import, 16) %
+				       pd->pd_nthreads];
+
 	/* We do not care whether it is strict load balance. */
 	idx = pd->pd_cursor;
 	if (++idx == pd->pd_nthreads)
@@ -191,6 +224,72 @@ ptlrpcd_select_pc(struct ptlrpc_request *req)
 	return &pd->pd_threads[idx];
 }
 
+/**
+ * Wake up \a pc to pick up its newly queued requests.
+ *
+ * The partners are woken as well so that an idle one can steal the work,
+ * unless \a req was queued to \a pc by import affinity and \a pc has
+ * nothing in flight to hold it back.
+ */
+void ptlrpcd_wake_pc(struct ptlrpcd_ctl *pc, struct ptlrpc_request *req)
+{
+	struct ptlrpc_request_set *set = pc->pc_set;
+	int i;
+
+	wake_up(&set->set_waitq);
+
+	if (ptlrpcd_import_affinity && req != NULL && req->rq_import != NULL &&
+	    atomic_read(&set->set_remaining) == 0)
+		return;
+
+	/* XXX: It maybe unnecessary to wakeup all the partners. But to
+	 *      guarantee the async RPC can be processed ASAP, we have
+	 *      no other better choice. It maybe fixed in future. */
+	for (i = 0; i < pc->pc_npartners; i++)
+		wake_up(&pc->pc_partners[i]->pc_set->set_waitq);
+}
+
+/**
+ * Decide whether the wakeup of \a pc for \a req, the \a count-th request
+ * queued since the thread last looked at its new requests, can be left to
+ * the coalescing timer.
+ *
+ * The first small async RPC arms the timer, those that follow within the
+ * window ride along. Any other request, or reaching ptlrpcd_coalesce_max,
+ * wakes the thread at once (see ptlrpc_set_add_new_req()). Each deferred
+ * wakeup is accounted as req_coalesced in the stats of the request's import.
+ */
+bool ptlrpcd_coalesce(struct ptlrpcd_ctl *pc, struct ptlrpc_request *req,
+		      int count)
+{
+	struct obd_device *obd;
+
+	if (!req->rq_coalesce || ptlrpcd_coalesce_usecs == 0 ||
+	    count >= ptlrpcd_coalesce_max)
+		return false;
+
+	obd = req->rq_import != NULL ? req->rq_import->imp_obd : NULL;
+	if (obd != NULL && obd->obd_svc_stats != NULL)
+		lprocfs_counter_incr(obd->obd_svc_stats,
+				     PTLRPC_LAST_CNTR + PTLRPC_COALESCED);
+
+	if (count == 1) {
+		set_bit(LIOD_COALESCE, &pc->pc_flags);
+		mod_timer(&pc->pc_coalesce_timer, jiffies +
+			  max(usecs_to_jiffies(ptlrpcd_coalesce_usecs), 1UL));
+	}
+
+	return true;
+}
+
+static void ptlrpcd_coalesce_timer(unsigned long castmeharder)
+{
+	struct ptlrpcd_ctl *pc = (struct ptlrpcd_ctl *)castmeharder;
+
+	if (test_and_clear_bit(LIOD_COALESCE, &pc->pc_flags))
+		ptlrpcd_wake_pc(pc, NULL);
+}
+
 /**
  * Move all request from an existing request set to the ptlrpcd queue.
  * All requests from the set must be in phase RQ_PHASE_NEW.
@@ -221,15 +320,8 @@ void ptlrpcd_add_rqset(struct ptlrpc_request_set *set)
 	count = atomic_add_return(i, &new->set_new_count);
 	atomic_set(&set->set_remaining, 0);
 	spin_unlock(&new->set_new_req_lock);
-	if (count == i) {
-		wake_up(&new->set_waitq);
-
-		/* XXX: It maybe unnecessary to wakeup all the partners. But to
-		 *      guarantee the async RPC can be processed ASAP, we have
-		 *      no other better choice. It maybe fixed in future. */
-		for (i = 0; i < pc->pc_npartners; i++)
-			wake_up(&pc->pc_partners[i]->pc_set->set_waitq);
-	}
+	if (count == i || test_and_clear_bit(LIOD_COALESCE, &pc->pc_flags))
+		ptlrpcd_wake_pc(pc, NULL);
 }
 
 /**
@@ -530,6 +622,8 @@ static void ptlrpcd_ctl_init(struct ptlrpcd_ctl *pc, int index, int cpt)
 	init_completion(&pc->pc_starting);
 	init_completion(&pc->pc_finishing);
 	spin_lock_init(&pc->pc_lock);
+	setup_timer(&pc->pc_coalesce_timer, ptlrpcd_coalesce_timer,
+		    (unsigned long)pc);
 
 	if (index < 0) {
 		/* Recovery thread. */
@@ -661,6 +755,7 @@ void ptlrpcd_free(struct ptlrpcd_ctl *pc)
 	}
 
 	wait_for_completion(&pc->pc_finishing);
+	del_timer_sync(&pc->pc_coalesce_timer);
 
 	spin_lock(&pc->pc_lock);
 	pc->pc_set = NULL;
@@ -670,6 +765,7 @@ void ptlrpcd_free(struct ptlrpcd_ctl *pc)
 	clear_bit(LIOD_START, &pc->pc_flags);
 	clear_bit(LIOD_STOP, &pc->pc_flags);
 	clear_bit(LIOD_FORCE, &pc->pc_flags);
+	clear_bit(LIOD_COALESCE, &pc->pc_flags);
 
 out:
         if (pc->pc_npartners > 0) {
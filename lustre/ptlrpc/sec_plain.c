@@ -819,6 +819,10 @@ int plain_alloc_rs(struct ptlrpc_request *req, int msgsize)
 		/* pre-allocated */
 		LASSERT(rs->rs_size >= rs_size);
 	} else {
+		rs = lustre_get_arena_rs(req->rq_rqbd->rqbd_svcpt, rs_size);
+	}
+
+	if (rs == NULL) {
 		OBD_ALLOC_LARGE(rs, rs_size);
 		if (rs == NULL)
 			RETURN(-ENOMEM);
@@ -846,7 +850,9 @@ void plain_free_rs(struct ptlrpc_reply_state *rs)
 	LASSERT(atomic_read(&rs->rs_svc_ctx->sc_refcount) > 1);
 	atomic_dec(&rs->rs_svc_ctx->sc_refcount);
 
-	if (!rs->rs_prealloc)
+	if (rs->rs_arena)
+		lustre_put_arena_rs(rs);
+	else if (!rs->rs_prealloc)
 		OBD_FREE_LARGE(rs, rs->rs_size);
 	EXIT;
 }
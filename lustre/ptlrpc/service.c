@@ -194,14 +194,172 @@ ptlrpc_save_lock(struct ptlrpc_request *req, struct lustre_handle *lock,
 }
 EXPORT_SYMBOL(ptlrpc_save_lock);
 
+/**
+ * Part of MDS_BATCH_REINT handling.
+ * Sets up a server request for the sub-request message \a msg of \a len
+ * bytes packed inline in the batch request \a req. The sub-request shares
+ * the export, the service thread, the peer and the security context of the
+ * batch, its xid is carried in the match bits of the message.
+ *
+ * \retval sub-request on success, ERR_PTR on failure
+ */
+struct ptlrpc_request *
+ptlrpc_server_subreq_alloc(struct ptlrpc_request *req, struct lustre_msg *msg,
+			   int len)
+{
+	struct ptlrpc_request *sub;
+	int rc;
+	ENTRY;
+
+	sub = ptlrpc_request_cache_alloc(GFP_NOFS);
+	if (sub == NULL)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	ptlrpc_srv_req_init(sub);
+	sub->rq_reqbuf = msg;
+	sub->rq_reqbuf_len = len;
+	sub->rq_reqdata_len = len;
+	sub->rq_reqmsg = msg;
+	sub->rq_reqlen = len;
+
+	rc = ptlrpc_unpack_req_msg(sub, len);
+	if (rc == 0)
+		rc = lustre_unpack_req_ptlrpc_body(sub, MSG_PTLRPC_BODY_OFF);
+	if (rc == 0 &&
+	    lustre_msg_get_type(sub->rq_reqmsg) != PTL_RPC_MSG_REQUEST)
+		rc = -EINVAL;
+	if (rc != 0) {
+		DEBUG_REQ(D_ERROR, req, "bad sub-request: rc = %d", rc);
+		ptlrpc_request_cache_free(sub);
+		RETURN(ERR_PTR(rc < 0 ? rc : -EPROTO));
+	}
+
+	sub->rq_xid = lustre_msg_get_mbits(sub->rq_reqmsg);
+	sub->rq_export = req->rq_export;
+	sub->rq_svc_thread = req->rq_svc_thread;
+	sub->rq_rqbd = req->rq_rqbd;
+	sub->rq_peer = req->rq_peer;
+	sub->rq_source = req->rq_source;
+	sub->rq_self = req->rq_self;
+	sub->rq_arrival_time = req->rq_arrival_time;
+	sub->rq_deadline = req->rq_deadline;
+	sub->rq_flvr = req->rq_flvr;
+	sub->rq_sp_from = req->rq_sp_from;
+	sub->rq_auth_gss = req->rq_auth_gss;
+	sub->rq_auth_usr_root = req->rq_auth_usr_root;
+	sub->rq_auth_usr_mdt = req->rq_auth_usr_mdt;
+	sub->rq_auth_usr_ost = req->rq_auth_usr_ost;
+	sub->rq_auth_uid = req->rq_auth_uid;
+	sub->rq_auth_mapped_uid = req->rq_auth_mapped_uid;
+	sub->rq_svc_ctx = req->rq_svc_ctx;
+	sptlrpc_svc_ctx_addref(sub);
+	sub->rq_phase = RQ_PHASE_INTERPRET;
+
+	/* a resent batch may carry sub-requests executed already */
+	if (lustre_msg_get_flags(req->rq_reqmsg) & MSG_RESENT)
+		lustre_msg_add_flags(sub->rq_reqmsg, MSG_RESENT);
+
+	RETURN(sub);
+}
+EXPORT_SYMBOL(ptlrpc_server_subreq_alloc);
+
+/**
+ * Part of MDS_BATCH_REINT handling.
+ * Finishes the reply of the sub-request \a sub as ptlrpc_send_reply() does
+ * and copies it into \a buf of \a buflen bytes. The locks saved in the reply
+ * state of \a sub are moved to the reply state of the batch request \a req,
+ * so they are released once the batch reply is acked or committed.
+ *
+ * \retval length of the reply message copied into \a buf
+ * \retval -EOVERFLOW if the reply message does not fit into \a buf
+ * \retval -ENOSPC if the locks of \a sub do not fit into the reply state of
+ *		   \a req, nothing is done then
+ */
+int ptlrpc_server_subreq_reply(struct ptlrpc_request *req,
+			       struct ptlrpc_request *sub, void *buf,
+			       int buflen)
+{
+	struct ptlrpc_reply_state *rs = sub->rq_reply_state;
+	struct ptlrpc_service_part *svcpt = req->rq_rqbd->rqbd_svcpt;
+	int len;
+	int i;
+
+	LASSERT(req->rq_reply_state != NULL);
+	LASSERT(rs != NULL);
+
+	/* the locks must not lose their rep-ack protection */
+	if (rs->rs_nlocks > RS_MAX_LOCKS - req->rq_reply_state->rs_nlocks) {
+		DEBUG_REQ(D_HA, sub, "no room to save %d locks",
+			  rs->rs_nlocks);
+		return -ENOSPC;
+	}
+
+	if (sub->rq_type != PTL_RPC_MSG_ERR)
+		sub->rq_type = PTL_RPC_MSG_REPLY;
+	lustre_msg_set_type(sub->rq_repmsg, sub->rq_type);
+	lustre_msg_set_status(sub->rq_repmsg,
+			      ptlrpc_status_hton(sub->rq_status));
+	lustre_msg_set_opc(sub->rq_repmsg,
+			   lustre_msg_get_opc(sub->rq_reqmsg));
+	target_pack_pool_reply(sub);
+	/* service time is measured for the whole batch */
+	lustre_msg_set_service_time(sub->rq_repmsg,
+				    max_t(int, ktime_get_real_seconds() -
+					  req->rq_arrival_time.tv_sec, 1));
+	lustre_msg_set_timeout(sub->rq_repmsg,
+			       AT_OFF ? 0 : at_get(&svcpt->scp_at_estimate));
+
+	len = lustre_packed_msg_size(sub->rq_repmsg);
+	if (len > buflen)
+		len = -EOVERFLOW;
+	else
+		memcpy(buf, sub->rq_repmsg, len);
+
+	for (i = 0; i < rs->rs_nlocks; i++)
+		ptlrpc_save_lock(req, &rs->rs_locks[i], rs->rs_modes[i],
+				 rs->rs_no_ack, rs->rs_convert_lock);
+	rs->rs_nlocks = 0;
+	rs->rs_difficult = 0;
+
+	if (sub->rq_transno > req->rq_transno)
+		req->rq_transno = sub->rq_transno;
+	ptlrpc_req_drop_rs(sub);
+
+	return len;
+}
+EXPORT_SYMBOL(ptlrpc_server_subreq_reply);
+
+/**
+ * Part of MDS_BATCH_REINT handling.
+ * Releases the sub-request set up by ptlrpc_server_subreq_alloc().
+ */
+void ptlrpc_server_subreq_free(struct ptlrpc_request *sub)
+{
+	struct ptlrpc_reply_state *rs = sub->rq_reply_state;
+	int i;
+
+	if (rs != NULL) {
+		/* no reply was built, e.g. the handler asked for none */
+		for (i = 0; i < rs->rs_nlocks; i++)
+			ldlm_lock_decref(&rs->rs_locks[i], rs->rs_modes[i]);
+		rs->rs_nlocks = 0;
+		rs->rs_difficult = 0;
+		ptlrpc_req_drop_rs(sub);
+	}
+	sptlrpc_svc_ctx_decref(sub);
+	ptlrpc_request_cache_free(sub);
+}
+EXPORT_SYMBOL(ptlrpc_server_subreq_free);
+
 
 struct ptlrpc_hr_partition;
 
 struct ptlrpc_hr_thread {
 	int				hrt_id;		/* thread ID */
-	spinlock_t			hrt_lock;
 	wait_queue_head_t		hrt_waitq;
-	struct list_head		hrt_queue;
+	/* replies to handle, queued without locking by the commit
+	 * callbacks and the ACK path */
+	struct llist_head		hrt_queue;
 	struct ptlrpc_hr_partition	*hrt_partition;
 };
 
@@ -236,9 +394,14 @@ struct ptlrpc_hr_service {
 };
 
 struct rs_batch {
-	struct list_head			rsb_replies;
+	/* chain of batched replies, linked by rs_hr_node */
+	struct llist_node		*rsb_first;
+	struct llist_node		*rsb_last;
 	unsigned int			rsb_n_replies;
+	/* partition whose scp_rep_lock is held */
 	struct ptlrpc_service_part	*rsb_svcpt;
+	/* hr partition the batch will be dispatched to */
+	struct ptlrpc_hr_partition	*rsb_hrp;
 };
 
 /** reply handling service. */
@@ -257,32 +420,43 @@ static struct ptlrpc_hr_service		ptlrpc_hr;
 static void rs_batch_init(struct rs_batch *b)
 {
 	memset(b, 0, sizeof *b);
-	INIT_LIST_HEAD(&b->rsb_replies);
 }
 
 /**
- * Choose an hr thread to dispatch requests to.
+ * Choose the hr partition handling the replies of \a svcpt.
  */
-static struct ptlrpc_hr_thread *
-ptlrpc_hr_select(struct ptlrpc_service_part *svcpt)
+static struct ptlrpc_hr_partition *
+ptlrpc_hr_select_partition(struct ptlrpc_service_part *svcpt)
 {
-	struct ptlrpc_hr_partition	*hrp;
-	unsigned int			rotor;
+	unsigned int rotor;
 
 	if (svcpt->scp_cpt >= 0 &&
 	    svcpt->scp_service->srv_cptable == ptlrpc_hr.hr_cpt_table) {
 		/* directly match partition */
-		hrp = ptlrpc_hr.hr_partitions[svcpt->scp_cpt];
+		return ptlrpc_hr.hr_partitions[svcpt->scp_cpt];
+	}
 
-	} else {
-		rotor = ptlrpc_hr.hr_rotor++;
-		rotor %= cfs_cpt_number(ptlrpc_hr.hr_cpt_table);
+	rotor = ptlrpc_hr.hr_rotor++;
+	rotor %= cfs_cpt_number(ptlrpc_hr.hr_cpt_table);
 
-		hrp = ptlrpc_hr.hr_partitions[rotor];
-	}
+	return ptlrpc_hr.hr_partitions[rotor];
+}
+
+/**
+ * Queue the chain of replies \a first .. \a last to a thread of \a hrp.
+ * The thread is only woken if its queue was empty, otherwise it has been
+ * woken already and will find the new replies when it takes the queue.
+ */
+static void ptlrpc_hr_queue(struct ptlrpc_hr_partition *hrp,
+			    struct llist_node *first, struct llist_node *last)
+{
+	struct ptlrpc_hr_thread *hrt;
+	unsigned int		 rotor;
 
 	rotor = hrp->hrp_rotor++;
-	return &hrp->hrp_thrs[rotor % hrp->hrp_nthrs];
+	hrt = &hrp->hrp_thrs[rotor % hrp->hrp_nthrs];
+	if (llist_add_batch(first, last, &hrt->hrt_queue))
+		wake_up(&hrt->hrt_waitq);
 }
 
 /**
@@ -294,15 +468,10 @@ ptlrpc_hr_select(struct ptlrpc_service_part *svcpt)
 static void rs_batch_dispatch(struct rs_batch *b)
 {
 	if (b->rsb_n_replies != 0) {
-		struct ptlrpc_hr_thread	*hrt;
-
-		hrt = ptlrpc_hr_select(b->rsb_svcpt);
-
-		spin_lock(&hrt->hrt_lock);
-		list_splice_init(&b->rsb_replies, &hrt->hrt_queue);
-		spin_unlock(&hrt->hrt_lock);
-
-		wake_up(&hrt->hrt_waitq);
+		ptlrpc_hr_queue(b->rsb_hrp, b->rsb_first, b->rsb_last);
+		b->rsb_svcpt->scp_rep_commit_batches++;
+		b->rsb_first = NULL;
+		b->rsb_last = NULL;
 		b->rsb_n_replies = 0;
 	}
 }
@@ -311,6 +480,11 @@ static void rs_batch_dispatch(struct rs_batch *b)
  * Add a reply to a batch.
  * Add one reply object to a batch, schedule batched replies if overload.
  *
+ * Replies of service partitions handled by the same hr partition are kept
+ * in one batch, so that the commit of an export whose replies are spread
+ * over the partitions of a CPT wakes one hr thread rather than one for
+ * every change of partition.
+ *
  * \param b batch
  * \param rs reply
  */
@@ -319,19 +493,32 @@ static void rs_batch_add(struct rs_batch *b, struct ptlrpc_reply_state *rs)
 	struct ptlrpc_service_part *svcpt = rs->rs_svcpt;
 
 	if (svcpt != b->rsb_svcpt || b->rsb_n_replies >= MAX_SCHEDULED) {
+		struct ptlrpc_hr_partition *hrp = b->rsb_hrp;
+
+		if (svcpt != b->rsb_svcpt)
+			hrp = ptlrpc_hr_select_partition(svcpt);
+
 		if (b->rsb_svcpt != NULL) {
-			rs_batch_dispatch(b);
+			if (hrp != b->rsb_hrp ||
+			    b->rsb_n_replies >= MAX_SCHEDULED)
+				rs_batch_dispatch(b);
 			spin_unlock(&b->rsb_svcpt->scp_rep_lock);
 		}
 		spin_lock(&svcpt->scp_rep_lock);
 		b->rsb_svcpt = svcpt;
+		b->rsb_hrp = hrp;
 	}
 	spin_lock(&rs->rs_lock);
 	rs->rs_scheduled_ever = 1;
 	if (rs->rs_scheduled == 0) {
-		list_move(&rs->rs_list, &b->rsb_replies);
+		list_del_init(&rs->rs_list);
+		rs->rs_hr_node.next = b->rsb_first;
+		b->rsb_first = &rs->rs_hr_node;
+		if (b->rsb_last == NULL)
+			b->rsb_last = &rs->rs_hr_node;
 		rs->rs_scheduled = 1;
 		b->rsb_n_replies++;
+		svcpt->scp_rep_committed++;
 	}
 	rs->rs_committed = 1;
 	spin_unlock(&rs->rs_lock);
@@ -361,18 +548,12 @@ static void rs_batch_fini(struct rs_batch *b)
  */
 void ptlrpc_dispatch_difficult_reply(struct ptlrpc_reply_state *rs)
 {
-	struct ptlrpc_hr_thread *hrt;
 	ENTRY;
 
 	LASSERT(list_empty(&rs->rs_list));
 
-	hrt = ptlrpc_hr_select(rs->rs_svcpt);
-
-	spin_lock(&hrt->hrt_lock);
-	list_add_tail(&rs->rs_list, &hrt->hrt_queue);
-	spin_unlock(&hrt->hrt_lock);
-
-	wake_up(&hrt->hrt_waitq);
+	ptlrpc_hr_queue(ptlrpc_hr_select_partition(rs->rs_svcpt),
+			&rs->rs_hr_node, &rs->rs_hr_node);
 	EXIT;
 }
 
@@ -585,6 +766,291 @@ ptlrpc_server_nthreads_check(struct ptlrpc_service *svc,
 	}
 }
 
+/*
+ * Server bulk descriptor pools
+ *
+ * Large server bulk descriptors are cached per service partition with a
+ * kiov vector of PTLRPC_MAX_BRW_PAGES entries, allocated on the memory of
+ * the partition's CPT. This saves the vmalloc of the vector for every
+ * bulk RPC and keeps the descriptor on the node of the thread using it.
+ */
+
+/* smaller vectors come from the slab, which is node local anyway */
+#define PTLRPC_BULK_POOL_MIN_FRAGS	LNET_MAX_IOV
+
+static void ptlrpc_bulk_pool_free(struct ptlrpc_bulk_desc *desc)
+{
+	OBD_FREE_LARGE(GET_KIOV(desc),
+		       PTLRPC_MAX_BRW_PAGES * sizeof(*GET_KIOV(desc)));
+	OBD_FREE_PTR(desc);
+}
+
+/**
+ * Get a bulk descriptor for \a req from the pool of the partition the
+ * handling thread belongs to.
+ *
+ * \retval NULL if the descriptor is not suitable for pooling or can't be
+ *	   allocated, the caller falls back to ptlrpc_new_bulk()
+ */
+struct ptlrpc_bulk_desc *
+ptlrpc_bulk_pool_get(struct ptlrpc_request *req, unsigned nfrags,
+		     unsigned max_brw, enum ptlrpc_bulk_op_type type,
+		     unsigned portal, const struct ptlrpc_bulk_frag_ops *ops)
+{
+	struct ptlrpc_service_part	*svcpt;
+	struct ptlrpc_service		*svc;
+	struct ptlrpc_bulk_desc		*desc = NULL;
+	lnet_kiov_t			*kiov;
+	bool				 remote;
+
+	if (req->rq_svc_thread == NULL || !ptlrpc_is_bulk_desc_kiov(type) ||
+	    nfrags <= PTLRPC_BULK_POOL_MIN_FRAGS ||
+	    nfrags > PTLRPC_MAX_BRW_PAGES)
+		return NULL;
+
+	LASSERT(ops->add_kiov_frag != NULL);
+
+	svcpt = req->rq_svc_thread->t_svcpt;
+	svc = svcpt->scp_service;
+	remote = svcpt->scp_cpt != CFS_CPT_ANY &&
+		 cfs_cpt_current(svc->srv_cptable, 0) != svcpt->scp_cpt;
+
+	spin_lock(&svcpt->scp_bulk_lock);
+	if (!list_empty(&svcpt->scp_bulk_free)) {
+		desc = list_entry(svcpt->scp_bulk_free.next,
+				  struct ptlrpc_bulk_desc, bd_pool_list);
+		list_del(&desc->bd_pool_list);
+		svcpt->scp_bulk_nfree--;
+		svcpt->scp_bulk_hits++;
+	} else {
+		svcpt->scp_bulk_allocs++;
+	}
+	if (remote)
+		svcpt->scp_bulk_remote++;
+	spin_unlock(&svcpt->scp_bulk_lock);
+
+	if (desc != NULL) {
+		kiov = GET_KIOV(desc);
+	} else {
+		OBD_CPT_ALLOC_PTR(desc, svc->srv_cptable, svcpt->scp_cpt);
+		if (desc == NULL)
+			return NULL;
+
+		OBD_CPT_ALLOC_LARGE(kiov, svc->srv_cptable, svcpt->scp_cpt,
+				    PTLRPC_MAX_BRW_PAGES * sizeof(*kiov));
+		if (kiov == NULL) {
+			OBD_FREE_PTR(desc);
+			return NULL;
+		}
+	}
+
+	memset(desc, 0, sizeof(*desc));
+	GET_KIOV(desc) = kiov;
+	ptlrpc_init_bulk(desc, PTLRPC_MAX_BRW_PAGES, max_brw, type, portal,
+			 ops);
+	desc->bd_svcpt = svcpt;
+
+	return desc;
+}
+
+/**
+ * Return pooled descriptor \a desc to its partition, keeping at most one
+ * cached descriptor per running thread.
+ */
+void ptlrpc_bulk_pool_put(struct ptlrpc_bulk_desc *desc)
+{
+	struct ptlrpc_service_part *svcpt = desc->bd_svcpt;
+
+	LASSERT(svcpt != NULL);
+
+	spin_lock(&svcpt->scp_bulk_lock);
+	if (svcpt->scp_bulk_nfree < svcpt->scp_nthrs_running) {
+		list_add(&desc->bd_pool_list, &svcpt->scp_bulk_free);
+		svcpt->scp_bulk_nfree++;
+		desc = NULL;
+	}
+	spin_unlock(&svcpt->scp_bulk_lock);
+
+	if (desc != NULL)
+		ptlrpc_bulk_pool_free(desc);
+}
+
+/* release up to \a nr cached descriptors of \a svcpt, coldest first */
+static int ptlrpc_bulk_pool_drain(struct ptlrpc_service_part *svcpt, int nr)
+{
+	struct ptlrpc_bulk_desc *desc;
+	struct list_head	 zombies;
+	int			 count = 0;
+
+	INIT_LIST_HEAD(&zombies);
+
+	spin_lock(&svcpt->scp_bulk_lock);
+	while (count < nr && !list_empty(&svcpt->scp_bulk_free)) {
+		list_move(svcpt->scp_bulk_free.prev, &zombies);
+		svcpt->scp_bulk_nfree--;
+		count++;
+	}
+	spin_unlock(&svcpt->scp_bulk_lock);
+
+	while (!list_empty(&zombies)) {
+		desc = list_entry(zombies.next, struct ptlrpc_bulk_desc,
+				  bd_pool_list);
+		list_del(&desc->bd_pool_list);
+		ptlrpc_bulk_pool_free(desc);
+	}
+
+	return count;
+}
+
+/* release up to \a nr cached reply states of \a svcpt, largest first */
+static int ptlrpc_rs_arena_drain(struct ptlrpc_service_part *svcpt, int nr)
+{
+	struct ptlrpc_reply_state	*rs;
+	struct list_head		 zombies;
+	int				 count = 0;
+	int				 idx;
+
+	INIT_LIST_HEAD(&zombies);
+
+	spin_lock(&svcpt->scp_rs_arena_lock);
+	for (idx = PTLRPC_RS_ARENA_CLASSES - 1; idx >= 0; idx--) {
+		while (count < nr && !list_empty(&svcpt->scp_rs_arena[idx])) {
+			list_move(svcpt->scp_rs_arena[idx].prev, &zombies);
+			svcpt->scp_rs_arena_count[idx]--;
+			count++;
+		}
+	}
+	spin_unlock(&svcpt->scp_rs_arena_lock);
+
+	while (!list_empty(&zombies)) {
+		rs = list_entry(zombies.next, struct ptlrpc_reply_state,
+				rs_list);
+		list_del(&rs->rs_list);
+		OBD_FREE_LARGE(rs, rs->rs_size);
+	}
+
+	return count;
+}
+
+static int ptlrpc_rs_arena_cached(struct ptlrpc_service_part *svcpt)
+{
+	int count = 0;
+	int idx;
+
+	for (idx = 0; idx < PTLRPC_RS_ARENA_CLASSES; idx++)
+		count += svcpt->scp_rs_arena_count[idx];
+
+	return count;
+}
+
+/*
+ * Memory shrinker for the bulk descriptor pools and reply state arenas
+ * of all services
+ */
+static struct shrinker *ptlrpc_svc_cache_shrinker;
+
+static unsigned long ptlrpc_svc_cache_shrink_count(struct shrinker *s,
+						   struct shrink_control *sc)
+{
+	struct ptlrpc_service		*svc;
+	struct ptlrpc_service_part	*svcpt;
+	unsigned long			 count = 0;
+	int				 i;
+
+	/* services are set up and torn down with the mutex held, and may
+	 * allocate memory while doing so */
+	if (!mutex_trylock(&ptlrpc_all_services_mutex))
+		return 0;
+
+	list_for_each_entry(svc, &ptlrpc_all_services, srv_list) {
+		ptlrpc_service_for_each_part(svcpt, i, svc)
+			count += svcpt->scp_bulk_nfree +
+				 ptlrpc_rs_arena_cached(svcpt);
+	}
+	mutex_unlock(&ptlrpc_all_services_mutex);
+
+	return count;
+}
+
+static unsigned long ptlrpc_svc_cache_shrink_scan(struct shrinker *s,
+						  struct shrink_control *sc)
+{
+	struct ptlrpc_service		*svc;
+	struct ptlrpc_service_part	*svcpt;
+	unsigned long			 freed = 0;
+	int				 count;
+	int				 i;
+
+	if (!mutex_trylock(&ptlrpc_all_services_mutex))
+		return SHRINK_STOP;
+
+	list_for_each_entry(svc, &ptlrpc_all_services, srv_list) {
+		ptlrpc_service_for_each_part(svcpt, i, svc) {
+			if (freed >= sc->nr_to_scan)
+				break;
+
+			count = ptlrpc_bulk_pool_drain(svcpt,
+						       sc->nr_to_scan - freed);
+			if (count != 0) {
+				spin_lock(&svcpt->scp_bulk_lock);
+				svcpt->scp_bulk_shrunk += count;
+				spin_unlock(&svcpt->scp_bulk_lock);
+				freed += count;
+			}
+
+			count = ptlrpc_rs_arena_drain(svcpt,
+						      sc->nr_to_scan - freed);
+			if (count != 0) {
+				spin_lock(&svcpt->scp_rs_arena_lock);
+				svcpt->scp_rs_arena_shrunk += count;
+				spin_unlock(&svcpt->scp_rs_arena_lock);
+				freed += count;
+			}
+		}
+	}
+	mutex_unlock(&ptlrpc_all_services_mutex);
+
+	return freed;
+}
+
+#ifndef HAVE_SHRINKER_COUNT
+static int ptlrpc_svc_cache_shrink(SHRINKER_ARGS(sc, nr_to_scan, gfp_mask))
+{
+	struct shrink_control scv = {
+		.nr_to_scan = shrink_param(sc, nr_to_scan),
+		.gfp_mask   = shrink_param(sc, gfp_mask)
+	};
+#if !defined(HAVE_SHRINKER_WANT_SHRINK_PTR) && !defined(HAVE_SHRINK_CONTROL)
+	struct shrinker *shrinker = NULL;
+#endif
+
+	ptlrpc_svc_cache_shrink_scan(shrinker, &scv);
+
+	return ptlrpc_svc_cache_shrink_count(shrinker, &scv);
+}
+#endif /* HAVE_SHRINKER_COUNT */
+
+int ptlrpc_svc_cache_init(void)
+{
+	DEF_SHRINKER_VAR(shvar, ptlrpc_svc_cache_shrink,
+			 ptlrpc_svc_cache_shrink_count,
+			 ptlrpc_svc_cache_shrink_scan);
+
+	ptlrpc_svc_cache_shrinker = set_shrinker(DEFAULT_SEEKS, &shvar);
+	if (ptlrpc_svc_cache_shrinker == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
+
+void ptlrpc_svc_cache_fini(void)
+{
+	if (ptlrpc_svc_cache_shrinker != NULL) {
+		remove_shrinker(ptlrpc_svc_cache_shrinker);
+		ptlrpc_svc_cache_shrinker = NULL;
+	}
+}
+
 /**
  * Initialize percpt data for a service
  */
@@ -613,12 +1079,23 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 	/* acitve requests and hp requests */
 	spin_lock_init(&svcpt->scp_req_lock);
 
+	/* bulk descriptor pool */
+	spin_lock_init(&svcpt->scp_bulk_lock);
+	INIT_LIST_HEAD(&svcpt->scp_bulk_free);
+
+	/* reply state arena */
+	spin_lock_init(&svcpt->scp_rs_arena_lock);
+	for (index = 0; index < PTLRPC_RS_ARENA_CLASSES; index++)
+		INIT_LIST_HEAD(&svcpt->scp_rs_arena[index]);
+
 	/* reply states */
 	spin_lock_init(&svcpt->scp_rep_lock);
 	INIT_LIST_HEAD(&svcpt->scp_rep_active);
 	INIT_LIST_HEAD(&svcpt->scp_rep_idle);
 	init_waitqueue_head(&svcpt->scp_rep_waitq);
 	atomic_set(&svcpt->scp_nreps_difficult, 0);
+	spin_lock_init(&svcpt->scp_rep_ack_hist.oh_lock);
+	spin_lock_init(&svcpt->scp_rep_commit_hist.oh_lock);
 
 	/* adaptive timeout */
 	spin_lock_init(&svcpt->scp_at_lock);
@@ -643,6 +1120,18 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 	if (array->paa_reqs_count == NULL)
 		goto failed;
 
+	/* latency histograms */
+	for (index = 0; index < PTLRPC_STAGE_MAX; index++)
+		spin_lock_init(&svcpt->scp_stage_hist[index].oh_lock);
+
+	OBD_CPT_ALLOC_LARGE(svcpt->scp_opc_hist, svc->srv_cptable, cpt,
+			    sizeof(struct obd_histogram) * LUSTRE_MAX_OPCODES);
+	if (svcpt->scp_opc_hist == NULL)
+		goto failed;
+
+	for (index = 0; index < LUSTRE_MAX_OPCODES; index++)
+		spin_lock_init(&svcpt->scp_opc_hist[index].oh_lock);
+
 	setup_timer(&svcpt->scp_at_timer, ptlrpc_at_timer,
 		    (unsigned long)svcpt);
 
@@ -662,6 +1151,13 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 	return 0;
 
  failed:
+	if (svcpt->scp_opc_hist != NULL) {
+		OBD_FREE_LARGE(svcpt->scp_opc_hist,
+			       sizeof(struct obd_histogram) *
+			       LUSTRE_MAX_OPCODES);
+		svcpt->scp_opc_hist = NULL;
+	}
+
 	if (array->paa_reqs_count != NULL) {
 		OBD_FREE(array->paa_reqs_count, sizeof(__u32) * size);
 		array->paa_reqs_count = NULL;
@@ -775,6 +1271,11 @@ ptlrpc_register_service(struct ptlrpc_service_conf *conf,
 	service->srv_hpreq_ratio	= PTLRPC_SVC_HP_RATIO;
 	service->srv_ops		= conf->psc_ops;
 
+	OBD_ALLOC(service->srv_slow_reqs,
+		  sizeof(struct ptlrpc_slow_req) * PTLRPC_SLOW_REQ_MAX);
+	if (service->srv_slow_reqs == NULL)
+		GOTO(failed, rc = -ENOMEM);
+
 	for (i = 0; i < ncpts; i++) {
 		if (!conf->psc_thr.tc_cpu_affinity)
 			cpt = CFS_CPT_ANY;
@@ -1023,9 +1524,13 @@ static void ptlrpc_server_finish_active_request(
 {
 	spin_lock(&svcpt->scp_req_lock);
 	ptlrpc_nrs_req_stop_nolock(req);
-	svcpt->scp_nreqs_active--;
-	if (req->rq_hp)
-		svcpt->scp_nhreqs_active--;
+	if (req->rq_stolen) {
+		svcpt->scp_nreqs_stolen--;
+	} else {
+		svcpt->scp_nreqs_active--;
+		if (req->rq_hp)
+			svcpt->scp_nhreqs_active--;
+	}
 	spin_unlock(&svcpt->scp_req_lock);
 
 	ptlrpc_nrs_req_finalize(req);
@@ -1842,6 +2347,158 @@ got_request:
 	RETURN(req);
 }
 
+/**
+ * Returns true if \a svcpt has normal priority requests queued which its
+ * own threads are not allowed to take right now, so they can be handed to
+ * an idle thread of another partition. High priority requests are never
+ * stolen, they have threads reserved on their own partition.
+ * User can call it w/o any lock but need to hold
+ * ptlrpc_service_part::scp_req_lock to get reliable result
+ */
+static bool ptlrpc_server_steal_allowed(struct ptlrpc_service_part *svcpt)
+{
+	return !ptlrpc_server_allow_normal(svcpt, false) &&
+	       !ptlrpc_nrs_req_throttling_nolock(svcpt, false) &&
+	       ptlrpc_nrs_req_pending_nolock(svcpt, false);
+}
+
+/**
+ * Find the partition an idle thread of \a svcpt should steal a request
+ * from: the nearest one in NUMA distance, or the one with the deepest
+ * queue among equally near partitions.
+ * Returns NULL if stealing is disabled, \a svcpt still has requests of its
+ * own queued, has no thread to spare besides the one reserved for high
+ * priority requests, or no other partition is backlogged.
+ */
+static struct ptlrpc_service_part *
+ptlrpc_server_steal_victim(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service		*svc = svcpt->scp_service;
+	struct ptlrpc_service_part	*victim = NULL;
+	struct ptlrpc_service_part	*part;
+	unsigned int			best = UINT_MAX;
+	unsigned int			dist;
+	int				i;
+
+	if (!svc->srv_req_steal || svc->srv_ncpts < 2)
+		return NULL;
+
+	if (ptlrpc_nrs_req_pending_nolock(svcpt, false) ||
+	    ptlrpc_nrs_req_pending_nolock(svcpt, true) ||
+	    !ptlrpc_server_allow_normal(svcpt, false))
+		return NULL;
+
+	ptlrpc_service_for_each_part(part, i, svc) {
+		if (part == svcpt || !ptlrpc_server_steal_allowed(part))
+			continue;
+
+		dist = cfs_cpt_distance(svc->srv_cptable, svcpt->scp_cpt,
+					part->scp_cpt);
+		if (dist < best ||
+		    (dist == best && part->scp_nrs_reg.nrs_req_queued >
+				     victim->scp_nrs_reg.nrs_req_queued)) {
+			best = dist;
+			victim = part;
+		}
+	}
+
+	return victim;
+}
+
+static inline bool
+ptlrpc_server_steal_pending(struct ptlrpc_service_part *svcpt)
+{
+	return ptlrpc_server_steal_victim(svcpt) != NULL;
+}
+
+/**
+ * Fetch a normal priority request queued on another partition for an idle
+ * thread of \a svcpt. The request stays accounted to the partition it was
+ * queued on, but as stolen rather than active, so that partition keeps its
+ * threads reserved for high priority requests. It is active on \a svcpt,
+ * whose thread is busy with it and must not be counted as idle by
+ * ptlrpc_server_allow_normal().
+ */
+static struct ptlrpc_request *
+ptlrpc_server_request_steal(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service_part	*victim;
+	struct ptlrpc_request		*req = NULL;
+	ENTRY;
+
+	victim = ptlrpc_server_steal_victim(svcpt);
+	if (victim == NULL)
+		RETURN(NULL);
+
+	/* take the thread before the request, so that the thread reserved
+	 * for high priority requests is never used for a stolen one */
+	spin_lock(&svcpt->scp_req_lock);
+	if (!ptlrpc_server_allow_normal(svcpt, false)) {
+		spin_unlock(&svcpt->scp_req_lock);
+		RETURN(NULL);
+	}
+	svcpt->scp_nreqs_active++;
+	spin_unlock(&svcpt->scp_req_lock);
+
+	spin_lock(&victim->scp_req_lock);
+	if (ptlrpc_server_steal_allowed(victim))
+		req = ptlrpc_nrs_req_get_nolock(victim, false, false);
+	if (req != NULL) {
+		req->rq_stolen = 1;
+		victim->scp_nreqs_stolen++;
+		victim->scp_stolen_count++;
+	}
+	spin_unlock(&victim->scp_req_lock);
+
+	spin_lock(&svcpt->scp_req_lock);
+	if (req != NULL)
+		svcpt->scp_steal_count++;
+	else
+		svcpt->scp_nreqs_active--;
+	spin_unlock(&svcpt->scp_req_lock);
+
+	if (req == NULL)
+		RETURN(NULL);
+
+	if (likely(req->rq_export))
+		class_export_rpc_inc(req->rq_export);
+
+	RETURN(req);
+}
+
+/**
+ * Wake up an idle thread on the partition nearest to \a svcpt if \a svcpt
+ * has just queued a request its own threads cannot serve yet.
+ */
+static void ptlrpc_server_steal_wakeup(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service		*svc = svcpt->scp_service;
+	struct ptlrpc_service_part	*thief = NULL;
+	struct ptlrpc_service_part	*part;
+	unsigned int			best = UINT_MAX;
+	unsigned int			dist;
+	int				i;
+
+	if (!svc->srv_req_steal || svc->srv_ncpts < 2 ||
+	    !ptlrpc_server_steal_allowed(svcpt))
+		return;
+
+	ptlrpc_service_for_each_part(part, i, svc) {
+		if (part == svcpt || !ptlrpc_server_allow_normal(part, false))
+			continue;
+
+		dist = cfs_cpt_distance(svc->srv_cptable, part->scp_cpt,
+					svcpt->scp_cpt);
+		if (dist < best) {
+			best = dist;
+			thief = part;
+		}
+	}
+
+	if (thief != NULL)
+		wake_up(&thief->scp_waitq);
+}
+
 /**
  * Handle freshly incoming reqs, add to timed early reply list,
  * pass on to regular request queue.
@@ -2000,6 +2657,7 @@ ptlrpc_server_handle_req_in(struct ptlrpc_service_part *svcpt,
 		GOTO(err_req, rc);
 
 	wake_up(&svcpt->scp_waitq);
+	ptlrpc_server_steal_wakeup(svcpt);
 	RETURN(1);
 
 err_req:
@@ -2008,6 +2666,68 @@ err_req:
 	RETURN(1);
 }
 
+/**
+ * Record how long each handling stage of \a req took in the histograms of
+ * partition \a svcpt, and keep \a req in the slow request ring of the
+ * service if it took longer than srv_slow_req_threshold in total.
+ */
+static void ptlrpc_server_req_latency(struct ptlrpc_service_part *svcpt,
+				      struct ptlrpc_request *req,
+				      s64 queue_usecs, s64 handle_usecs)
+{
+	struct ptlrpc_service	*svc = svcpt->scp_service;
+	struct ptlrpc_srv_req	*sr = &req->rq_srv;
+	struct ptlrpc_slow_req	*psr;
+	char			*jobid = NULL;
+	__u32			 opc = 0;
+	s64			 total;
+	int			 threshold;
+	int			 i;
+
+	sr->sr_stage_us[PTLRPC_STAGE_QUEUE] = max_t(s64, queue_usecs, 0);
+	sr->sr_stage_us[PTLRPC_STAGE_HANDLE] = max_t(s64, handle_usecs, 0);
+	sr->sr_stage_mask |= BIT(PTLRPC_STAGE_QUEUE) | BIT(PTLRPC_STAGE_HANDLE);
+	total = (s64)sr->sr_stage_us[PTLRPC_STAGE_QUEUE] +
+		sr->sr_stage_us[PTLRPC_STAGE_HANDLE];
+
+	for (i = 0; i < PTLRPC_STAGE_MAX; i++) {
+		if (sr->sr_stage_mask & BIT(i))
+			lprocfs_oh_tally_log2(&svcpt->scp_stage_hist[i],
+					      sr->sr_stage_us[i]);
+	}
+
+	if (req->rq_reqmsg != NULL) {
+		opc = lustre_msg_get_opc(req->rq_reqmsg);
+		i = opcode_offset(opc);
+		if (i >= 0 && i < LUSTRE_MAX_OPCODES)
+			lprocfs_oh_tally_log2(&svcpt->scp_opc_hist[i],
+					      min_t(s64, total, UINT_MAX));
+	}
+
+	threshold = svc->srv_slow_req_threshold;
+	if (threshold == 0 || total < (s64)threshold * USEC_PER_MSEC)
+		return;
+
+	if (req->rq_reqmsg != NULL && req->rq_export != NULL &&
+	    exp_connect_flags(req->rq_export) & OBD_CONNECT_JOBSTATS)
+		jobid = lustre_msg_get_jobid(req->rq_reqmsg);
+
+	spin_lock(&svc->srv_lock);
+	psr = &svc->srv_slow_reqs[svc->srv_slow_req_next++ %
+				  PTLRPC_SLOW_REQ_MAX];
+	psr->psr_xid = req->rq_xid;
+	psr->psr_peer = req->rq_peer.nid;
+	psr->psr_arrival = req->rq_arrival_time.tv_sec;
+	psr->psr_opc = opc;
+	psr->psr_total_us = min_t(s64, total, UINT_MAX);
+	memcpy(psr->psr_stage_us, sr->sr_stage_us, sizeof(psr->psr_stage_us));
+	if (jobid != NULL)
+		strlcpy(psr->psr_jobid, jobid, sizeof(psr->psr_jobid));
+	else
+		psr->psr_jobid[0] = '\0';
+	spin_unlock(&svc->srv_lock);
+}
+
 /**
  * Main incoming request handling logic.
  * Calls handler function from service to do actual processing.
@@ -2017,6 +2737,7 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 			     struct ptlrpc_thread *thread)
 {
 	struct ptlrpc_service *svc = svcpt->scp_service;
+	struct ptlrpc_service_part *thief = NULL;
 	struct ptlrpc_request *request;
 	ktime_t work_start;
 	ktime_t work_end;
@@ -2028,8 +2749,14 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 	ENTRY;
 
 	request = ptlrpc_server_request_get(svcpt, false);
-	if (request == NULL)
-		RETURN(0);
+	if (request == NULL) {
+		request = ptlrpc_server_request_steal(svcpt);
+		if (request == NULL)
+			RETURN(0);
+		/* account it to the partition it was queued on */
+		thief = svcpt;
+		svcpt = request->rq_rqbd->rqbd_svcpt;
+	}
 
         if (OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_NOTIMEOUT))
                 fail_opc = OBD_FAIL_PTLRPC_HPREQ_NOTIMEOUT;
@@ -2049,6 +2776,9 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 	work_start = ktime_get_real();
 	arrived = timespec64_to_ktime(request->rq_arrival_time);
 	timediff_usecs = ktime_us_delta(work_start, arrived);
+	/* lockless, it only steers the number of threads */
+	svcpt->scp_thr_wait_avg = (svcpt->scp_thr_wait_avg * 7 +
+				   max_t(s64, timediff_usecs, 0)) / 8;
 	if (likely(svc->srv_stats != NULL)) {
                 lprocfs_counter_add(svc->srv_stats, PTLRPC_REQWAIT_CNTR,
 				    timediff_usecs);
@@ -2117,6 +2847,9 @@ put_conn:
 	work_end = ktime_get_real();
 	timediff_usecs = ktime_us_delta(work_end, work_start);
 	arrived_usecs = ktime_us_delta(work_end, arrived);
+	ptlrpc_server_req_latency(svcpt, request,
+				  arrived_usecs - timediff_usecs,
+				  timediff_usecs);
 	CDEBUG(D_RPCTRACE, "Handled RPC pname:cluuid+ref:pid:xid:nid:opc "
 	       "%s:%s+%d:%d:x%llu:%s:%d Request processed in %lldus "
 	       "(%lldus total) trans %llu rc %d/%d\n",
@@ -2155,6 +2888,11 @@ put_conn:
 	}
 
 	ptlrpc_server_finish_active_request(svcpt, request);
+	if (thief != NULL) {
+		spin_lock(&thief->scp_req_lock);
+		thief->scp_nreqs_active--;
+		spin_unlock(&thief->scp_req_lock);
+	}
 
 	RETURN(1);
 }
@@ -2218,7 +2956,7 @@ ptlrpc_handle_rs(struct ptlrpc_reply_state *rs)
 					/*
 					 * NB don't assume rs is always handled
 					 * by the same service thread (see
-					 * ptlrpc_hr_select, so REP-ACK hr may
+					 * ptlrpc_hr_queue, so REP-ACK hr may
 					 * race with trans commit, while the
 					 * latter will release locks, get locks
 					 * here early to convert to COS mode
@@ -2297,6 +3035,11 @@ ptlrpc_handle_rs(struct ptlrpc_reply_state *rs)
 		/* Off the net */
 		spin_unlock(&rs->rs_lock);
 
+		lprocfs_oh_tally_log2(rs->rs_committed ?
+				      &svcpt->scp_rep_commit_hist :
+				      &svcpt->scp_rep_ack_hist,
+				      ktime_us_delta(ktime_get(), rs->rs_sent));
+
 		class_export_put (exp);
 		rs->rs_export = NULL;
 		ptlrpc_rs_decref(rs);
@@ -2366,13 +3109,17 @@ ptlrpc_threads_increasable(struct ptlrpc_service_part *svcpt)
 }
 
 /**
- * too many requests and allowed to create more threads
+ * too many requests and allowed to create more threads, if the service has
+ * a queue wait target only when requests wait longer than that on average
  */
 static inline int
 ptlrpc_threads_need_create(struct ptlrpc_service_part *svcpt)
 {
+	int target = svcpt->scp_service->srv_thrs_wait_target;
+
 	return !ptlrpc_threads_enough(svcpt) &&
-		ptlrpc_threads_increasable(svcpt);
+		ptlrpc_threads_increasable(svcpt) &&
+		(target == 0 || svcpt->scp_thr_wait_avg > target);
 }
 
 static inline int
@@ -2406,13 +3153,62 @@ ptlrpc_server_request_incoming(struct ptlrpc_service_part *svcpt)
 	return !list_empty(&svcpt->scp_req_incoming);
 }
 
+/**
+ * Retire \a thread if it has not handled any request for the service idle
+ * time and \a svcpt has enough threads without it. The thread is counted
+ * as stopping rather than running from now on, and never goes below the
+ * number of threads started for the partition initially.
+ */
+static bool ptlrpc_thread_retire(struct ptlrpc_service_part *svcpt,
+				 struct ptlrpc_thread *thread)
+{
+	struct ptlrpc_service	*svc = svcpt->scp_service;
+	int			idle_time = svc->srv_thrs_idle_time;
+	bool			retire = false;
+
+	if (idle_time == 0 ||
+	    ktime_get_seconds() - thread->t_busy_time < idle_time)
+		return false;
+
+	spin_lock(&svcpt->scp_lock);
+	if (!thread_is_stopping(thread) && !svc->srv_is_stopping &&
+	    svcpt->scp_nthrs_running > svc->srv_nthrs_cpt_init &&
+	    !ptlrpc_server_request_incoming(svcpt) &&
+	    !ptlrpc_server_request_pending(svcpt, false) &&
+	    !ptlrpc_server_steal_pending(svcpt) &&
+	    !ptlrpc_rqbd_pending(svcpt) && !ptlrpc_at_check(svcpt)) {
+		svcpt->scp_nthrs_running--;
+		retire = ptlrpc_threads_enough(svcpt);
+		if (retire) {
+			thread_clear_flags(thread, SVC_RUNNING);
+			svcpt->scp_nthrs_stopping++;
+			svcpt->scp_nthrs_retired++;
+		} else {
+			svcpt->scp_nthrs_running++;
+		}
+	}
+	spin_unlock(&svcpt->scp_lock);
+
+	if (retire)
+		CDEBUG(D_RPCTRACE, "%s: retire idle thread %s, %d running\n",
+		       svc->srv_name, thread->t_name, svcpt->scp_nthrs_running);
+	return retire;
+}
+
 static __attribute__((__noinline__)) int
 ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 		  struct ptlrpc_thread *thread)
 {
+	int idle_time = svcpt->scp_service->srv_thrs_idle_time;
 	/* Don't exit while there are replies to be handled */
-	struct l_wait_info lwi = LWI_TIMEOUT(svcpt->scp_rqbd_timeout,
-					     ptlrpc_retry_rqbds, svcpt);
+	cfs_duration_t timeout = svcpt->scp_rqbd_timeout;
+	struct l_wait_info lwi;
+
+	/* wake up now and then to check if this thread has been idle long
+	 * enough to retire, see ptlrpc_thread_retire() */
+	if (timeout == 0 && idle_time != 0)
+		timeout = cfs_time_seconds(idle_time);
+	lwi = LWI_TIMEOUT(timeout, ptlrpc_retry_rqbds, svcpt);
 
 	lc_watchdog_disable(thread->t_watchdog);
 
@@ -2422,6 +3218,7 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 				ptlrpc_thread_stopping(thread) ||
 				ptlrpc_server_request_incoming(svcpt) ||
 				ptlrpc_server_request_pending(svcpt, false) ||
+				ptlrpc_server_steal_pending(svcpt) ||
 				ptlrpc_rqbd_pending(svcpt) ||
 				ptlrpc_at_check(svcpt), &lwi);
 
@@ -2448,6 +3245,7 @@ static int ptlrpc_main(void *arg)
 	struct group_info *ginfo = NULL;
 	struct lu_env *env;
 	int counter = 0, rc = 0;
+	bool retired = false;
 	ENTRY;
 
 	thread->t_pid = current_pid();
@@ -2539,11 +3337,18 @@ static int ptlrpc_main(void *arg)
 	CDEBUG(D_NET, "service thread %d (#%d) started\n", thread->t_id,
 	       svcpt->scp_nthrs_running);
 
+	thread->t_busy_time = ktime_get_seconds();
+
 	/* XXX maintain a list of all managed devices: insert here */
 	while (!ptlrpc_thread_stopping(thread)) {
 		if (ptlrpc_wait_event(svcpt, thread))
 			break;
 
+		if (ptlrpc_thread_retire(svcpt, thread)) {
+			retired = true;
+			break;
+		}
+
 		ptlrpc_check_rqbd_pool(svcpt);
 
 		if (ptlrpc_threads_need_create(svcpt)) {
@@ -2558,6 +3363,7 @@ static int ptlrpc_main(void *arg)
 			lu_context_enter(&env->le_ctx);
 			ptlrpc_server_handle_req_in(svcpt, thread);
 			lu_context_exit(&env->le_ctx);
+			thread->t_busy_time = ktime_get_seconds();
 
 			/* but limit ourselves in case of flood */
 			if (counter++ < 100)
@@ -2568,11 +3374,13 @@ static int ptlrpc_main(void *arg)
 		if (ptlrpc_at_check(svcpt))
 			ptlrpc_at_check_timed(svcpt);
 
-		if (ptlrpc_server_request_pending(svcpt, false)) {
+		if (ptlrpc_server_request_pending(svcpt, false) ||
+		    ptlrpc_server_steal_pending(svcpt)) {
 			lu_context_enter(&env->le_ctx);
 			ptlrpc_server_handle_request(svcpt, thread);
 			lu_context_exit(&env->le_ctx);
-                }
+			thread->t_busy_time = ktime_get_seconds();
+		}
 
 		if (ptlrpc_rqbd_pending(svcpt) &&
 		    ptlrpc_server_post_idle_rqbds(svcpt) < 0) {
@@ -2588,6 +3396,23 @@ static int ptlrpc_main(void *arg)
         lc_watchdog_delete(thread->t_watchdog);
         thread->t_watchdog = NULL;
 
+	if (retired) {
+		/* give back the reply state this thread brought into the
+		 * pool, unless they are all in use */
+		spin_lock(&svcpt->scp_rep_lock);
+		if (!list_empty(&svcpt->scp_rep_idle)) {
+			rs = list_entry(svcpt->scp_rep_idle.next,
+					struct ptlrpc_reply_state, rs_list);
+			list_del(&rs->rs_list);
+		} else {
+			rs = NULL;
+		}
+		spin_unlock(&svcpt->scp_rep_lock);
+
+		if (rs != NULL)
+			OBD_FREE_LARGE(rs, svc->srv_max_reply_size);
+	}
+
 out_srv_fini:
         /*
          * deconstruct service specific state created by ptlrpc_start_thread()
@@ -2612,6 +3437,18 @@ out:
 		svcpt->scp_nthrs_running--;
 	}
 
+	if (retired) {
+		svcpt->scp_nthrs_stopping--;
+		/* nobody else knows about this thread unless the service
+		 * is being stopped, see ptlrpc_svcpt_stop_threads() */
+		if (!thread_is_stopping(thread)) {
+			list_del(&thread->t_link);
+			spin_unlock(&svcpt->scp_lock);
+			OBD_FREE_PTR(thread);
+			return rc;
+		}
+	}
+
 	thread->t_id = rc;
 	thread_add_flags(thread, SVC_STOPPED);
 
@@ -2622,17 +3459,11 @@ out:
 }
 
 static int hrt_dont_sleep(struct ptlrpc_hr_thread *hrt,
-			  struct list_head *replies)
+			  struct llist_node **replies)
 {
-	int result;
-
-	spin_lock(&hrt->hrt_lock);
-
-	list_splice_init(&hrt->hrt_queue, replies);
-	result = ptlrpc_hr.hr_stopping || !list_empty(replies);
+	*replies = llist_del_all(&hrt->hrt_queue);
 
-	spin_unlock(&hrt->hrt_lock);
-	return result;
+	return ptlrpc_hr.hr_stopping || *replies != NULL;
 }
 
 /**
@@ -2643,10 +3474,9 @@ static int ptlrpc_hr_main(void *arg)
 {
 	struct ptlrpc_hr_thread		*hrt = (struct ptlrpc_hr_thread *)arg;
 	struct ptlrpc_hr_partition	*hrp = hrt->hrt_partition;
-	struct list_head		replies;
+	struct llist_node		*replies = NULL;
 	int				rc;
 
-	INIT_LIST_HEAD(&replies);
 	unshare_fs_struct();
 
 	rc = cfs_cpt_bind(ptlrpc_hr.hr_cpt_table, hrp->hrp_cpt);
@@ -2665,13 +3495,13 @@ static int ptlrpc_hr_main(void *arg)
 	while (!ptlrpc_hr.hr_stopping) {
 		l_wait_condition(hrt->hrt_waitq, hrt_dont_sleep(hrt, &replies));
 
-		while (!list_empty(&replies)) {
+		while (replies != NULL) {
 			struct ptlrpc_reply_state *rs;
 
-			rs = list_entry(replies.prev,
-					struct ptlrpc_reply_state,
-					rs_list);
-			list_del_init(&rs->rs_list);
+			rs = llist_entry(replies, struct ptlrpc_reply_state,
+					 rs_hr_node);
+			/* rs may be freed or queued again once handled */
+			replies = llist_next(replies);
 			ptlrpc_handle_rs(rs);
 		}
 	}
@@ -2994,8 +3824,7 @@ int ptlrpc_hr_init(void)
 			hrt->hrt_id = i;
 			hrt->hrt_partition = hrp;
 			init_waitqueue_head(&hrt->hrt_waitq);
-			spin_lock_init(&hrt->hrt_lock);
-			INIT_LIST_HEAD(&hrt->hrt_queue);
+			init_llist_head(&hrt->hrt_queue);
 		}
 	}
 
@@ -3211,11 +4040,25 @@ ptlrpc_service_free(struct ptlrpc_service *svc)
 				 sizeof(__u32) * array->paa_size);
 			array->paa_reqs_count = NULL;
 		}
+
+		if (svcpt->scp_opc_hist != NULL) {
+			OBD_FREE_LARGE(svcpt->scp_opc_hist,
+				       sizeof(struct obd_histogram) *
+				       LUSTRE_MAX_OPCODES);
+			svcpt->scp_opc_hist = NULL;
+		}
+
+		ptlrpc_bulk_pool_drain(svcpt, INT_MAX);
+		ptlrpc_rs_arena_drain(svcpt, INT_MAX);
 	}
 
 	ptlrpc_service_for_each_part(svcpt, i, svc)
 		OBD_FREE_PTR(svcpt);
 
+	if (svc->srv_slow_reqs != NULL)
+		OBD_FREE(svc->srv_slow_reqs,
+			 sizeof(struct ptlrpc_slow_req) * PTLRPC_SLOW_REQ_MAX);
+
 	if (svc->srv_cpts != NULL)
 		cfs_expr_list_values_free(svc->srv_cpts, svc->srv_ncpts);
 
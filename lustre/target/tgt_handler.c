@@ -45,6 +45,7 @@
 #include <lustre_lfsck.h>
 #include <lustre_nodemap.h>
 #include <lustre_acl.h>
+#include <lustre_update.h>
 
 #include "tgt_internal.h"
 
@@ -287,7 +288,12 @@ static int tgt_ost_body_unpack(struct tgt_session_info *tsi, __u32 flags)
 		}
 	}
 
-	ost_fid_build_resid(&tsi->tsi_fid, &tsi->tsi_resid);
+	/* Data-on-MDT I/O is locked on the separate DoM data resource so
+	 * it doesn't conflict with the metadata IBITS locks on the file */
+	if (ptlrpc_req2svc(tgt_ses_req(tsi))->srv_req_portal == MDS_IO_PORTAL)
+		fid_build_dom_res_name(&tsi->tsi_fid, &tsi->tsi_resid);
+	else
+		ost_fid_build_resid(&tsi->tsi_fid, &tsi->tsi_resid);
 
 	/*
 	 * OST doesn't get object in advance for further use to prevent
@@ -366,54 +372,56 @@ static int tgt_request_preprocess(struct tgt_session_info *tsi,
 	RETURN(rc);
 }
 
-/*
- * Invoke handler for this request opc. Also do necessary preprocessing
- * (according to handler ->th_flags), and post-processing (setting of
- * ->last_{xid,committed}).
+/**
+ * Size of the inline reply buffer needed by a short I/O read.
+ *
+ * The whole requested range is returned inline, so the buffer is the sum of
+ * the remote niobuf lengths. Requests exceeding OBD_MAX_SHORT_IO_BYTES get
+ * no buffer and are rejected by tgt_brw_read().
  */
-static int tgt_handle_request0(struct tgt_session_info *tsi,
-			       struct tgt_handler *h,
-			       struct ptlrpc_request *req)
+static __u32 tgt_short_io_size(struct tgt_session_info *tsi)
 {
-	int	 serious = 0;
-	int	 rc;
-	__u32    opc = lustre_msg_get_opc(req->rq_reqmsg);
+	struct ost_body		*body = tsi->tsi_ost_body;
+	struct niobuf_remote	*remote_nb;
+	__u32			 size = 0;
+	int			 niocount, i;
 
-	ENTRY;
+	if (body == NULL || !(body->oa.o_valid & OBD_MD_FLFLAGS) ||
+	    !(body->oa.o_flags & OBD_FL_SHORT_IO))
+		return 0;
 
+	remote_nb = req_capsule_client_get(tsi->tsi_pill, &RMF_NIOBUF_REMOTE);
+	if (remote_nb == NULL)
+		return 0;
 
-	/* When dealing with sec context requests, no export is associated yet,
-	 * because these requests are sent before *_CONNECT requests.
-	 * A NULL req->rq_export means the normal *_common_slice handlers will
-	 * not be called, because there is no reference to the target.
-	 * So deal with them by hand and jump directly to target_send_reply().
-	 */
-	switch (opc) {
-	case SEC_CTX_INIT:
-	case SEC_CTX_INIT_CONT:
-	case SEC_CTX_FINI:
-		CFS_FAIL_TIMEOUT(OBD_FAIL_SEC_CTX_HDL_PAUSE, cfs_fail_val);
-		GOTO(out, rc = 0);
+	niocount = req_capsule_get_size(tsi->tsi_pill, &RMF_NIOBUF_REMOTE,
+					RCL_CLIENT) / sizeof(*remote_nb);
+	for (i = 0; i < niocount; i++) {
+		if (remote_nb[i].rnb_len > OBD_MAX_SHORT_IO_BYTES - size)
+			return 0;
+		size += remote_nb[i].rnb_len;
 	}
 
-	/*
-	 * Checking for various OBD_FAIL_$PREF_$OPC_NET codes. _Do_ not try
-	 * to put same checks into handlers like mdt_close(), mdt_reint(),
-	 * etc., without talking to mdt authors first. Checking same thing
-	 * there again is useless and returning 0 error without packing reply
-	 * is buggy! Handlers either pack reply or return error.
-	 *
-	 * We return 0 here and do not send any reply in order to emulate
-	 * network failure. Do not send any reply in case any of NET related
-	 * fail_id has occured.
-	 */
-	if (OBD_FAIL_CHECK_ORSET(h->th_fail_id, OBD_FAIL_ONCE))
-		RETURN(0);
-	if (unlikely(lustre_msg_get_opc(req->rq_reqmsg) == MDS_REINT &&
-		     OBD_FAIL_CHECK(OBD_FAIL_MDS_REINT_MULTI_NET)))
-		RETURN(0);
+	return size;
+}
+
+/*
+ * Preprocess the request, pack its reply if the format is fixed and run the
+ * handler. Returns the error to be passed to target_send_reply(), the result
+ * of the operation itself is placed in req->rq_status.
+ */
+static int tgt_handle_request_act(struct tgt_session_info *tsi,
+				  struct tgt_handler *h,
+				  struct ptlrpc_request *req)
+{
+	ktime_t	 kstart = ktime_get();
+	int	 serious = 0;
+	int	 rc;
+
+	ENTRY;
 
 	rc = tgt_request_preprocess(tsi, h, req);
+	ptlrpc_req_stage_add(req, PTLRPC_STAGE_UNPACK, kstart);
 	/* pack reply if reply format is fixed */
 	if (rc == 0 && h->th_flags & HABEO_REFERO) {
 		/* Pack reply */
@@ -430,6 +438,11 @@ static int tgt_handle_request0(struct tgt_session_info *tsi,
 			req_capsule_set_size(tsi->tsi_pill,
 					     &RMF_ACL, RCL_SERVER,
 					     LUSTRE_POSIX_ACL_MAX_SIZE_OLD);
+		if (req_capsule_has_field(tsi->tsi_pill, &RMF_SHORT_IO,
+					  RCL_SERVER))
+			req_capsule_set_size(tsi->tsi_pill, &RMF_SHORT_IO,
+					     RCL_SERVER,
+					     tgt_short_io_size(tsi));
 
 		rc = req_capsule_server_pack(tsi->tsi_pill);
 	}
@@ -470,8 +483,61 @@ static int tgt_handle_request0(struct tgt_session_info *tsi,
 	if (likely(rc == 0 && req->rq_export))
 		target_committed_to_req(req);
 
+	RETURN(rc);
+}
+
+/*
+ * Invoke handler for this request opc. Also do necessary preprocessing
+ * (according to handler ->th_flags), and post-processing (setting of
+ * ->last_{xid,committed}).
+ */
+static int tgt_handle_request0(struct tgt_session_info *tsi,
+			       struct tgt_handler *h,
+			       struct ptlrpc_request *req)
+{
+	ktime_t	 kstart;
+	int	 rc;
+	__u32    opc = lustre_msg_get_opc(req->rq_reqmsg);
+
+	ENTRY;
+
+
+	/* When dealing with sec context requests, no export is associated yet,
+	 * because these requests are sent before *_CONNECT requests.
+	 * A NULL req->rq_export means the normal *_common_slice handlers will
+	 * not be called, because there is no reference to the target.
+	 * So deal with them by hand and jump directly to target_send_reply().
+	 */
+	switch (opc) {
+	case SEC_CTX_INIT:
+	case SEC_CTX_INIT_CONT:
+	case SEC_CTX_FINI:
+		CFS_FAIL_TIMEOUT(OBD_FAIL_SEC_CTX_HDL_PAUSE, cfs_fail_val);
+		GOTO(out, rc = 0);
+	}
+
+	/*
+	 * Checking for various OBD_FAIL_$PREF_$OPC_NET codes. _Do_ not try
+	 * to put same checks into handlers like mdt_close(), mdt_reint(),
+	 * etc., without talking to mdt authors first. Checking same thing
+	 * there again is useless and returning 0 error without packing reply
+	 * is buggy! Handlers either pack reply or return error.
+	 *
+	 * We return 0 here and do not send any reply in order to emulate
+	 * network failure. Do not send any reply in case any of NET related
+	 * fail_id has occured.
+	 */
+	if (OBD_FAIL_CHECK_ORSET(h->th_fail_id, OBD_FAIL_ONCE))
+		RETURN(0);
+	if (unlikely(lustre_msg_get_opc(req->rq_reqmsg) == MDS_REINT &&
+		     OBD_FAIL_CHECK(OBD_FAIL_MDS_REINT_MULTI_NET)))
+		RETURN(0);
+
+	rc = tgt_handle_request_act(tsi, h, req);
 out:
+	kstart = ktime_get();
 	target_send_reply(req, rc, tsi->tsi_reply_fail_id);
+	ptlrpc_req_stage_add(req, PTLRPC_STAGE_REPLY, kstart);
 	RETURN(0);
 }
 
@@ -788,6 +854,245 @@ out:
 }
 EXPORT_SYMBOL(tgt_request_handle);
 
+/*
+ * Execute one sub-request of MDS_BATCH_REINT the way tgt_request_handle()
+ * does for a standalone request, and copy its reply message to \a buf.
+ * Returns the length of the reply message, or a negative error if there is
+ * no reply to return for the sub-request.
+ */
+static int tgt_batch_reint_sub(struct tgt_session_info *tsi,
+			       struct ptlrpc_request *req,
+			       struct lustre_msg *msg, int msglen,
+			       void *buf, int buflen)
+{
+	struct tgt_thread_info	*tti = tgt_th_info(tsi->tsi_env);
+	struct ptlrpc_request	*sub;
+	struct tgt_handler	*h;
+	int			 rc;
+
+	ENTRY;
+
+	sub = ptlrpc_server_subreq_alloc(req, msg, msglen);
+	if (IS_ERR(sub))
+		RETURN(PTR_ERR(sub));
+
+	req_capsule_init(&sub->rq_pill, sub, RCL_SERVER);
+	tsi->tsi_pill = &sub->rq_pill;
+	tsi->tsi_dlm_req = NULL;
+	tsi->tsi_mdt_body = NULL;
+	tsi->tsi_ost_body = NULL;
+	tsi->tsi_corpus = NULL;
+	fid_zero(&tsi->tsi_fid);
+	tsi->tsi_vbr_obj = NULL;
+	tsi->tsi_opdata = 0;
+	tsi->tsi_preprocessed = false;
+	if (exp_connect_flags(sub->rq_export) & OBD_CONNECT_JOBSTATS)
+		tsi->tsi_jobid = lustre_msg_get_jobid(sub->rq_reqmsg);
+	else
+		tsi->tsi_jobid = NULL;
+	/* every sub-request gets its own transno */
+	tti->tti_has_trans = 0;
+	tti->tti_mult_trans = 0;
+
+	if (lustre_msg_get_opc(sub->rq_reqmsg) != MDS_REINT)
+		GOTO(out_error, rc = -EPROTO);
+
+	rc = process_req_last_xid(sub);
+	if (rc)
+		GOTO(out_error, rc);
+
+	h = tgt_handler_find_check(sub);
+	if (IS_ERR(h))
+		GOTO(out_error, rc = PTR_ERR(h));
+
+	rc = lustre_msg_check_version(sub->rq_reqmsg, h->th_version);
+	if (unlikely(rc)) {
+		DEBUG_REQ(D_ERROR, sub, "%s: drop mal-formed sub-request, "
+			  "version %08x, expecting %08x\n",
+			  tgt_name(tsi->tsi_tgt),
+			  lustre_msg_get_version(sub->rq_reqmsg),
+			  h->th_version);
+		GOTO(out_error, rc = -EINVAL);
+	}
+
+	rc = tgt_handle_request_act(tsi, h, sub);
+	if (sub->rq_no_reply)
+		GOTO(out, rc = -EBUSY);
+	if (rc == 0)
+		GOTO(out_reply, rc);
+
+out_error:
+	/* error reply, as ptlrpc_error() packs it */
+	sub->rq_status = rc;
+	if (sub->rq_reply_state == NULL) {
+		rc = lustre_pack_reply(sub, 1, NULL, NULL);
+		if (rc)
+			GOTO(out, rc);
+	}
+	sub->rq_type = PTL_RPC_MSG_ERR;
+out_reply:
+	rc = ptlrpc_server_subreq_reply(req, sub, buf, buflen);
+	if (rc == -ENOSPC) {
+		struct ptlrpc_reply_state *rs = sub->rq_reply_state;
+		int i;
+
+		/* No room left in the batch reply state for the locks of
+		 * the sub-request. It is executed already, so it cannot be
+		 * sent again alone as a new one: commit it instead, then its
+		 * locks need no rep-ack protection. */
+		rc = tgt_sync(tsi->tsi_env, tsi->tsi_tgt, NULL, 0,
+			      OBD_OBJECT_EOF);
+		if (rc != 0) {
+			/* no reply, the client resends it to be
+			 * reconstructed */
+			DEBUG_REQ(D_ERROR, sub, "%s: cannot commit: rc = %d",
+				  tgt_name(tsi->tsi_tgt), rc);
+			GOTO(out, rc = -EBUSY);
+		}
+		for (i = 0; i < rs->rs_nlocks; i++)
+			ldlm_lock_decref(&rs->rs_locks[i], rs->rs_modes[i]);
+		rs->rs_nlocks = 0;
+		rc = ptlrpc_server_subreq_reply(req, sub, buf, buflen);
+	}
+out:
+	req_capsule_fini(&sub->rq_pill);
+	if (tsi->tsi_corpus != NULL) {
+		lu_object_put(tsi->tsi_env, tsi->tsi_corpus);
+		tsi->tsi_corpus = NULL;
+	}
+	ptlrpc_server_subreq_free(sub);
+	RETURN(rc);
+}
+
+/*
+ * MDS_BATCH_REINT handler.
+ *
+ * The sub-requests are executed in order, each one as a separate MDS_REINT
+ * with its own XID, tag, transno and reply data, so it is resent and
+ * replayed on its own. An empty result with -EAGAIN means the sub-request
+ * was not executed, any other empty result means its reply was lost and it
+ * has to be resent.
+ */
+int tgt_batch_reint(struct tgt_session_info *tsi)
+{
+	struct ptlrpc_request		*req = tgt_ses_req(tsi);
+	struct req_capsule		*pill = tsi->tsi_pill;
+	struct tgt_session_info		 batch;
+	struct out_update_header	*ouh;
+	struct out_update_buffer	*oub;
+	struct object_update_reply	*reply;
+	struct object_update_result	*result;
+	char				*buf;
+	char				*end;
+	size_t				 off;
+	size_t				 reply_size;
+	int				 ouh_size;
+	int				 avail;
+	int				 count;
+	int				 len;
+	int				 i;
+	int				 rc;
+
+	ENTRY;
+
+	/* sub-requests are not wrapped on their own */
+	if (SPTLRPC_FLVR_POLICY(req->rq_flvr.sf_rpc) != SPTLRPC_POLICY_NULL)
+		RETURN(err_serious(-EOPNOTSUPP));
+
+	ouh_size = req_capsule_get_size(pill, &RMF_OUT_UPDATE_HEADER,
+					RCL_CLIENT);
+	if (ouh_size < (int)sizeof(*ouh))
+		RETURN(err_serious(-EPROTO));
+
+	ouh = req_capsule_client_get(pill, &RMF_OUT_UPDATE_HEADER);
+	if (ouh == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	count = ouh->ouh_count;
+	if (ouh->ouh_magic != BATCH_REINT_HEADER_MAGIC || count == 0 ||
+	    count > BATCH_REINT_MAX ||
+	    ouh->ouh_inline_length > ouh_size - sizeof(*ouh)) {
+		CERROR("%s: invalid batch header magic %x count %u "
+		       "length %u: rc = %d\n", tgt_name(tsi->tsi_tgt),
+		       ouh->ouh_magic, count, ouh->ouh_inline_length, -EPROTO);
+		RETURN(err_serious(-EPROTO));
+	}
+
+	off = cfs_size_round(offsetof(struct object_update_reply,
+				      ourp_lens[count]));
+	reply_size = ouh->ouh_reply_size;
+	if (reply_size < off + count * sizeof(*result) ||
+	    reply_size > MDS_REG_MAXREPSIZE)
+		RETURN(err_serious(-EPROTO));
+
+	/* validate the sub-request buffers before executing any of them */
+	buf = (char *)ouh->ouh_inline_data;
+	end = buf + ouh->ouh_inline_length;
+	for (i = 0; i < count; i++) {
+		oub = (struct out_update_buffer *)buf;
+		if (buf + sizeof(*oub) > end)
+			RETURN(err_serious(-EPROTO));
+		if (ptlrpc_req_need_swab(req))
+			lustre_swab_out_update_buffer(oub);
+		if (oub->oub_size == 0 ||
+		    oub->oub_size > end - buf - sizeof(*oub))
+			RETURN(err_serious(-EPROTO));
+		buf += sizeof(*oub) + cfs_size_round(oub->oub_size);
+	}
+
+	req_capsule_set_size(pill, &RMF_OUT_UPDATE_REPLY, RCL_SERVER,
+			     reply_size);
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	reply = req_capsule_server_get(pill, &RMF_OUT_UPDATE_REPLY);
+	if (reply == NULL)
+		RETURN(err_serious(-EPROTO));
+	memset(reply, 0, reply_size);
+	reply->ourp_magic = UPDATE_REPLY_MAGIC;
+	reply->ourp_count = count;
+
+	batch = *tsi;
+	buf = (char *)ouh->ouh_inline_data;
+	for (i = 0; i < count; i++) {
+		oub = (struct out_update_buffer *)buf;
+		buf += sizeof(*oub) + cfs_size_round(oub->oub_size);
+
+		/* keep room for the empty results of the rest */
+		result = (struct object_update_result *)((char *)reply + off);
+		avail = reply_size - off - (count - i) * sizeof(*result);
+		avail = min_t(int, avail,
+			      (USHRT_MAX & ~7) - sizeof(*result));
+
+		/* the locks of a sub-request are kept in the batch reply
+		 * state for rep-ack, stop before it runs out of room rather
+		 * than commit the sub-requests which do not fit, see
+		 * tgt_batch_reint_sub() */
+		if (i > 0 &&
+		    req->rq_reply_state->rs_nlocks + RS_MAX_LOCKS / 2 >
+		    RS_MAX_LOCKS) {
+			len = -EAGAIN;
+		} else {
+			len = tgt_batch_reint_sub(tsi, req,
+						  (struct lustre_msg *)(oub + 1),
+						  oub->oub_size,
+						  result->our_data, avail);
+			*tsi = batch;
+		}
+
+		if (len > 0)
+			object_update_result_insert(reply, NULL, len, i, 0);
+		else
+			object_update_result_insert(reply, NULL, 0, i,
+						    len < 0 ? len : -EPROTO);
+		off += reply->ourp_lens[i];
+	}
+
+	RETURN(0);
+}
+EXPORT_SYMBOL(tgt_batch_reint);
+
 /** Assign high priority operations to the request if needed. */
 int tgt_hpreq_handler(struct ptlrpc_request *req)
 {
@@ -1655,27 +1960,60 @@ void tgt_brw_unlock(struct obd_ioobj *obj, struct niobuf_remote *niob,
 	EXIT;
 }
 
-static __u32 tgt_checksum_bulk(struct lu_target *tgt,
-			       struct ptlrpc_bulk_desc *desc, int opc,
-			       cksum_type_t cksum_type)
+/**
+ * Copy the inline data of a short I/O write into the prepared local pages.
+ */
+static int tgt_shortio2pages(struct niobuf_local *local, int npages,
+			     unsigned char *buf, int size)
+{
+	int i;
+
+	for (i = 0; i < npages; i++) {
+		unsigned char *ptr;
+		int off = local[i].lnb_page_offset & ~PAGE_MASK;
+		int len = local[i].lnb_len;
+
+		if (len > size)
+			return -EINVAL;
+
+		ptr = ll_kmap_atomic(local[i].lnb_page, KM_USER0);
+		memcpy(ptr + off, buf, len);
+		ll_kunmap_atomic(ptr, KM_USER0);
+		buf += len;
+		size -= len;
+	}
+
+	return size;
+}
+
+static struct cfs_crypto_hash_desc *
+tgt_checksum_bulk_init(struct lu_target *tgt, cksum_type_t cksum_type)
 {
 	struct cfs_crypto_hash_desc	*hdesc;
-	unsigned int			bufsize;
-	int				i, err;
 	unsigned char			cfs_alg = cksum_obd2cfs(cksum_type);
-	__u32				cksum;
-
-	LASSERT(ptlrpc_is_bulk_desc_kiov(desc->bd_type));
 
 	hdesc = cfs_crypto_hash_init(cfs_alg, NULL, 0);
 	if (IS_ERR(hdesc)) {
 		CERROR("%s: unable to initialize checksum hash %s\n",
 		       tgt_name(tgt), cfs_crypto_hash_name(cfs_alg));
-		return PTR_ERR(hdesc);
+		return hdesc;
 	}
 
 	CDEBUG(D_INFO, "Checksum for algo %s\n", cfs_crypto_hash_name(cfs_alg));
-	for (i = 0; i < desc->bd_iov_count; i++) {
+	return hdesc;
+}
+
+/* add pages [first, last) of \a desc to the checksum */
+static void tgt_checksum_bulk_update(struct lu_target *tgt,
+				     struct cfs_crypto_hash_desc *hdesc,
+				     struct ptlrpc_bulk_desc *desc, int opc,
+				     int first, int last)
+{
+	int i;
+
+	LASSERT(ptlrpc_is_bulk_desc_kiov(desc->bd_type));
+
+	for (i = first; i < last; i++) {
 		/* corrupt the data before we compute the checksum, to
 		 * simulate a client->OST data error */
 		if (i == 0 && opc == OST_WRITE &&
@@ -1740,13 +2078,51 @@ static __u32 tgt_checksum_bulk(struct lu_target *tgt,
 			}
 		}
 	}
+}
+
+static __u32 tgt_checksum_bulk_final(struct cfs_crypto_hash_desc *hdesc)
+{
+	unsigned int	bufsize = sizeof(__u32);
+	__u32		cksum;
 
-	bufsize = sizeof(cksum);
-	err = cfs_crypto_hash_final(hdesc, (unsigned char *)&cksum, &bufsize);
+	cfs_crypto_hash_final(hdesc, (unsigned char *)&cksum, &bufsize);
 
 	return cksum;
 }
 
+static __u32 tgt_checksum_bulk(struct lu_target *tgt,
+			       struct ptlrpc_bulk_desc *desc, int opc,
+			       cksum_type_t cksum_type)
+{
+	struct cfs_crypto_hash_desc *hdesc;
+
+	hdesc = tgt_checksum_bulk_init(tgt, cksum_type);
+	if (IS_ERR(hdesc))
+		return PTR_ERR(hdesc);
+
+	tgt_checksum_bulk_update(tgt, hdesc, desc, opc, 0, desc->bd_iov_count);
+
+	return tgt_checksum_bulk_final(hdesc);
+}
+
+struct tgt_bulk_cksum {
+	struct lu_target		*tbk_tgt;
+	struct cfs_crypto_hash_desc	*tbk_hdesc;
+};
+
+/* target_bulk_io_pipelined() callback: checksum the pages of one MD of a
+ * bulk write as soon as they have arrived */
+static void tgt_checksum_bulk_md(struct ptlrpc_bulk_desc *desc, int mdidx,
+				 void *data)
+{
+	struct tgt_bulk_cksum *tbk = data;
+
+	tgt_checksum_bulk_update(tbk->tbk_tgt, tbk->tbk_hdesc, desc, OST_WRITE,
+				 mdidx * LNET_MAX_IOV,
+				 min(desc->bd_iov_count,
+				     (mdidx + 1) * LNET_MAX_IOV));
+}
+
 char dbgcksum_file_name[PATH_MAX];
 
 static void dump_all_bulk_pages(struct obdo *oa, int count,
@@ -1876,10 +2252,14 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 	struct lustre_handle	 lockh = { 0 };
 	int			 npages, nob = 0, rc, i, no_reply = 0;
 	struct tgt_thread_big_cache *tbc = req->rq_svc_thread->t_data;
+	unsigned char		*short_io_buf = NULL;
+	int			 short_io_size = 0;
+	ktime_t			 kstart;
 
 	ENTRY;
 
-	if (ptlrpc_req2svc(req)->srv_req_portal != OST_IO_PORTAL) {
+	if (ptlrpc_req2svc(req)->srv_req_portal != OST_IO_PORTAL &&
+	    ptlrpc_req2svc(req)->srv_req_portal != MDS_IO_PORTAL) {
 		CERROR("%s: deny read request from %s to portal %u\n",
 		       tgt_name(tsi->tsi_tgt),
 		       obd_export_nid2str(req->rq_export),
@@ -1920,6 +2300,19 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 	remote_nb = req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE);
 	LASSERT(remote_nb != NULL); /* must exists after tgt_ost_body_unpack */
 
+	/* the reply buffer for short I/O was sized in tgt_handle_request0() */
+	if (body->oa.o_valid & OBD_MD_FLFLAGS &&
+	    body->oa.o_flags & OBD_FL_SHORT_IO) {
+		short_io_size = req_capsule_get_size(&req->rq_pill,
+						     &RMF_SHORT_IO, RCL_SERVER);
+		if (short_io_size == 0)
+			RETURN(-EPROTO);
+		short_io_buf = req_capsule_server_get(&req->rq_pill,
+						      &RMF_SHORT_IO);
+		if (short_io_buf == NULL)
+			RETURN(-EPROTO);
+	}
+
 	local_nb = tbc->local;
 
 	rc = tgt_brw_lock(exp->exp_obd->obd_namespace, &tsi->tsi_resid, ioo,
@@ -1945,11 +2338,15 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 	repbody->oa = body->oa;
 
 	npages = PTLRPC_MAX_BRW_PAGES;
+	kstart = ktime_get();
 	rc = obd_preprw(tsi->tsi_env, OBD_BRW_READ, exp, &repbody->oa, 1,
 			ioo, remote_nb, &npages, local_nb);
+	ptlrpc_req_stage_add(req, PTLRPC_STAGE_IO_PREP, kstart);
 	if (rc != 0)
 		GOTO(out_lock, rc);
 
+	/* For short I/O the descriptor is only used to collect the pages for
+	 * checksumming, the data itself is returned in the reply buffer */
 	desc = ptlrpc_prep_bulk_exp(req, npages, ioobj_max_brw_get(ioo),
 				    PTLRPC_BULK_PUT_SOURCE |
 					PTLRPC_BULK_BUF_KIOV,
@@ -1967,14 +2364,29 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 			break;
 		}
 
-		nob += page_rc;
 		if (page_rc != 0) { /* some data! */
 			LASSERT(local_nb[i].lnb_page != NULL);
 			desc->bd_frag_ops->add_kiov_frag
 			  (desc, local_nb[i].lnb_page,
 			   local_nb[i].lnb_page_offset,
 			   page_rc);
+
+			if (short_io_buf != NULL) {
+				unsigned char *ptr;
+
+				if (nob + page_rc > short_io_size) {
+					rc = -EPROTO;
+					break;
+				}
+				ptr = ll_kmap_atomic(local_nb[i].lnb_page,
+						     KM_USER0);
+				memcpy(short_io_buf + nob, ptr +
+				       (local_nb[i].lnb_page_offset &
+					~PAGE_MASK), page_rc);
+				ll_kunmap_atomic(ptr, KM_USER0);
+			}
 		}
+		nob += page_rc;
 
 		if (page_rc != local_nb[i].lnb_len) { /* short read */
 			/* All subsequent pages should be 0 */
@@ -2014,21 +2426,31 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 
 	/* Check if client was evicted while we were doing i/o before touching
 	 * network */
-	if (likely(rc == 0 &&
+	if (short_io_buf != NULL) {
+		/* the data is already in the reply, trim off any short read */
+		if (rc == 0)
+			req_capsule_shrink(&req->rq_pill, &RMF_SHORT_IO, nob,
+					   RCL_SERVER);
+	} else if (likely(rc == 0 &&
 		   !CFS_FAIL_PRECHECK(OBD_FAIL_PTLRPC_CLIENT_BULK_CB2) &&
 		   !CFS_FAIL_CHECK(OBD_FAIL_PTLRPC_DROP_BULK))) {
+		kstart = ktime_get();
 		rc = target_bulk_io(exp, desc, &lwi);
+		ptlrpc_req_stage_add(req, PTLRPC_STAGE_BULK, kstart);
 		no_reply = rc != 0;
 	}
 
 out_commitrw:
 	/* Must commit after prep above in all cases */
+	kstart = ktime_get();
 	rc = obd_commitrw(tsi->tsi_env, OBD_BRW_READ, exp, &repbody->oa, 1, ioo,
 			  remote_nb, npages, local_nb, rc);
+	ptlrpc_req_stage_add(req, PTLRPC_STAGE_IO_COMMIT, kstart);
 out_lock:
 	tgt_brw_unlock(ioo, remote_nb, &lockh, LCK_PR);
 
-	if (desc && !CFS_FAIL_PRECHECK(OBD_FAIL_PTLRPC_CLIENT_BULK_CB2))
+	if (desc && (short_io_buf != NULL ||
+		     !CFS_FAIL_PRECHECK(OBD_FAIL_PTLRPC_CLIENT_BULK_CB2)))
 		ptlrpc_free_bulk(desc);
 
 	LASSERT(rc <= 0);
@@ -2047,7 +2469,8 @@ out_lock:
 	}
 	/* send a bulk after reply to simulate a network delay or reordering
 	 * by a router */
-	if (unlikely(CFS_FAIL_PRECHECK(OBD_FAIL_PTLRPC_CLIENT_BULK_CB2))) {
+	if (unlikely(short_io_buf == NULL &&
+		     CFS_FAIL_PRECHECK(OBD_FAIL_PTLRPC_CLIENT_BULK_CB2))) {
 		wait_queue_head_t	 waitq;
 		struct l_wait_info	 lwi1;
 
@@ -2129,11 +2552,14 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	cksum_type_t		 cksum_type = OBD_CKSUM_CRC32;
 	bool			 no_reply = false, mmap;
 	struct tgt_thread_big_cache *tbc = req->rq_svc_thread->t_data;
+	struct tgt_bulk_cksum	 tbk = { .tbk_hdesc = NULL };
 	bool wait_sync = false;
+	ktime_t kstart;
 
 	ENTRY;
 
-	if (ptlrpc_req2svc(req)->srv_req_portal != OST_IO_PORTAL) {
+	if (ptlrpc_req2svc(req)->srv_req_portal != OST_IO_PORTAL &&
+	    ptlrpc_req2svc(req)->srv_req_portal != MDS_IO_PORTAL) {
 		CERROR("%s: deny write request from %s to portal %u\n",
 		       tgt_name(tsi->tsi_tgt),
 		       obd_export_nid2str(req->rq_export),
@@ -2231,8 +2657,10 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	repbody->oa = body->oa;
 
 	npages = PTLRPC_MAX_BRW_PAGES;
+	kstart = ktime_get();
 	rc = obd_preprw(tsi->tsi_env, OBD_BRW_WRITE, exp, &repbody->oa,
 			objcount, ioo, remote_nb, &npages, local_nb);
+	ptlrpc_req_stage_add(req, PTLRPC_STAGE_IO_PREP, kstart);
 	if (rc < 0)
 		GOTO(out_lock, rc);
 
@@ -2250,11 +2678,54 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 						 local_nb[i].lnb_page_offset,
 						 local_nb[i].lnb_len);
 
+	if (body->oa.o_valid & OBD_MD_FLFLAGS &&
+	    body->oa.o_flags & OBD_FL_SHORT_IO) {
+		unsigned char *short_io_buf;
+		int short_io_size;
+
+		/* the data came inline with the request, no bulk transfer */
+		short_io_size = req_capsule_get_size(&req->rq_pill,
+						     &RMF_SHORT_IO,
+						     RCL_CLIENT);
+		short_io_buf = req_capsule_client_get(&req->rq_pill,
+						      &RMF_SHORT_IO);
+		if (short_io_buf == NULL)
+			GOTO(skip_transfer, rc = -EPROTO);
+
+		rc = tgt_shortio2pages(local_nb, npages, short_io_buf,
+				       short_io_size);
+		/* the request must carry exactly the data described */
+		if (rc > 0)
+			rc = -EPROTO;
+		GOTO(skip_transfer, rc);
+	}
+
 	rc = sptlrpc_svc_prep_bulk(req, desc);
 	if (rc != 0)
 		GOTO(skip_transfer, rc);
 
-	rc = target_bulk_io(exp, desc, &lwi);
+	/* For a bulk spanning several MDs, checksum each MD as it arrives
+	 * instead of walking all the pages after the whole transfer. */
+	if (body->oa.o_valid & OBD_MD_FLCKSUM &&
+	    desc->bd_iov_count > LNET_MAX_IOV &&
+	    desc->bd_iov_count <= 64 * LNET_MAX_IOV && !GET_ENC_KIOV(desc)) {
+		if (body->oa.o_valid & OBD_MD_FLFLAGS)
+			cksum_type = cksum_type_unpack(body->oa.o_flags);
+
+		tbk.tbk_tgt = tsi->tsi_tgt;
+		tbk.tbk_hdesc = tgt_checksum_bulk_init(tsi->tsi_tgt,
+						       cksum_type);
+		if (IS_ERR(tbk.tbk_hdesc))
+			tbk.tbk_hdesc = NULL;
+	}
+
+	kstart = ktime_get();
+	if (tbk.tbk_hdesc != NULL)
+		rc = target_bulk_io_pipelined(exp, desc, &lwi,
+					      tgt_checksum_bulk_md, &tbk);
+	else
+		rc = target_bulk_io(exp, desc, &lwi);
+	ptlrpc_req_stage_add(req, PTLRPC_STAGE_BULK, kstart);
 	no_reply = rc != 0;
 
 skip_transfer:
@@ -2267,8 +2738,15 @@ skip_transfer:
 		repbody->oa.o_valid |= OBD_MD_FLCKSUM | OBD_MD_FLFLAGS;
 		repbody->oa.o_flags &= ~OBD_FL_CKSUM_ALL;
 		repbody->oa.o_flags |= cksum_type_pack(cksum_type);
-		repbody->oa.o_cksum = tgt_checksum_bulk(tsi->tsi_tgt, desc,
-							OST_WRITE, cksum_type);
+		if (tbk.tbk_hdesc != NULL) {
+			repbody->oa.o_cksum =
+				tgt_checksum_bulk_final(tbk.tbk_hdesc);
+			tbk.tbk_hdesc = NULL;
+		} else {
+			repbody->oa.o_cksum = tgt_checksum_bulk(tsi->tsi_tgt,
+								desc, OST_WRITE,
+								cksum_type);
+		}
 		cksum_counter++;
 
 		if (unlikely(body->oa.o_cksum != repbody->oa.o_cksum)) {
@@ -2286,10 +2764,15 @@ skip_transfer:
 			       repbody->oa.o_cksum);
 		}
 	}
+	/* bulk failed after the pipelined checksum was started */
+	if (tbk.tbk_hdesc != NULL)
+		cfs_crypto_hash_final(tbk.tbk_hdesc, NULL, NULL);
 
 	/* Must commit after prep above in all cases */
+	kstart = ktime_get();
 	rc = obd_commitrw(tsi->tsi_env, OBD_BRW_WRITE, exp, &repbody->oa,
 			  objcount, ioo, remote_nb, npages, local_nb, rc);
+	ptlrpc_req_stage_add(req, PTLRPC_STAGE_IO_COMMIT, kstart);
 	if (rc == -ENOTCONN)
 		/* quota acquire process has been given up because
 		 * either the client has been evicted or the client
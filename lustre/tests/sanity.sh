@@ -5409,6 +5409,38 @@ test_56aa() { # LU-5937
 }
 run_test 56aa "lfs find --size under striped dir"
 
+test_56ab() {
+	local dir=$DIR/$tdir
+	local i
+
+	test_mkdir $dir
+	for i in {0..4}; do
+		$LFS mkdir -i $((i % MDSCOUNT)) $dir/d$i ||
+			error "mkdir $dir/d$i failed"
+		test_mkdir $dir/d$i/sub
+		createmany -o $dir/d$i/f 20 > /dev/null
+		createmany -o $dir/d$i/sub/f 20 > /dev/null
+	done
+
+	local serial=$($LFS find $dir | sort | md5sum)
+	local parallel=$($LFS find --threads 4 $dir | sort | md5sum)
+
+	[ "$serial" == "$parallel" ] ||
+		error "lfs find --threads found different entries"
+
+	local expect=$($LFS find $dir -type f -maxdepth 2 | wc -l)
+	local count=$($LFS find --threads 4 $dir -type f -maxdepth 2 | wc -l)
+
+	[ $count -eq $expect ] ||
+		error "lfs find --threads -maxdepth found $count != $expect"
+
+	count=$($LFS find --threads 4 $dir -type f -print0 | tr -cd '\0' |
+		wc -c)
+	[ $count -eq 200 ] ||
+		error "lfs find --threads -print0 found $count != 200"
+}
+run_test 56ab "lfs find --threads matches the serial search"
+
 test_57a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	# note test will not do anything if MDS is not local
@@ -6435,6 +6467,67 @@ test_77j() { # bug 13805
 }
 run_test 77j "client only supporting ADLER32"
 
+test_77k() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	$GSS && skip "could not run with gss" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ $(lustre_version_code ost1) -lt $(version_code 2.9.52) ] &&
+		skip "Need OST version at least 2.9.52" && return
+
+	local osts=$(get_facets OST)
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local brw_size="obdfilter.*.brw_size"
+	local orig_mb=$(do_facet ost1 $LCTL get_param -n $brw_size | head -n 1)
+	local pages=$((16 * 1048576 / $(page_size)))
+	local before
+	local after
+
+	# 16MB RPCs span several MDs, their checksum is computed per MD
+	# while the bulk is in flight
+	if [[ $orig_mb -lt 16 ]]; then
+		save_lustre_params $osts "$brw_size" > $p
+		do_nodes $(comma_list $(osts_nodes)) \
+			$LCTL set_param -n $brw_size=16M ||
+			error "set 16MB RPC size failed"
+		remount_client $MOUNT || error "remount_client failed"
+	fi
+	$LCTL set_param osc.*.max_pages_per_rpc=16M ||
+		error "unable to set max_pages_per_rpc=16M"
+	[ $($LCTL get_param -n osc.*-OST0000-*.max_pages_per_rpc) -eq $pages ] ||
+		error "max_pages_per_rpc is not $pages"
+
+	dd if=/dev/urandom of=$F77_TMP.16M bs=16M count=1 ||
+		error "error writing to $F77_TMP.16M"
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile
+	set_checksums 1
+
+	# a good checksum computed per MD
+	dd if=$F77_TMP.16M of=$DIR/$tfile bs=16M count=1 conv=fsync ||
+		error "write error: rc=$?"
+	cancel_lru_locks osc
+	cmp $F77_TMP.16M $DIR/$tfile || error "file compare failed"
+
+	# a corrupted MD must be detected and the write resent
+	before=$(dmesg | grep -c "BAD WRITE CHECKSUM")
+	#define OBD_FAIL_OST_CHECKSUM_RECEIVE       0x21a
+	do_facet ost1 $LCTL set_param fail_loc=0x8000021a
+	dd if=$F77_TMP.16M of=$DIR/$tfile bs=16M count=1 conv=fsync ||
+		error "write error after checksum failure: rc=$?"
+	do_facet ost1 $LCTL set_param fail_loc=0
+	after=$(dmesg | grep -c "BAD WRITE CHECKSUM")
+	(( after > before )) || error "checksum error not detected"
+	cancel_lru_locks osc
+	cmp $F77_TMP.16M $DIR/$tfile || error "resent file compare failed"
+
+	set_checksums 0
+	rm -f $F77_TMP.16M $DIR/$tfile
+	if [[ $orig_mb -lt 16 ]]; then
+		restore_lustre_params < $p
+		remount_client $MOUNT || error "remount_client restore failed"
+	fi
+}
+run_test 77k "checksum error on OST write of a multi-MD RPC"
+
 [ "$ORIG_CSUM" ] && set_checksums $ORIG_CSUM || true
 rm -f $F77_TMP
 unset F77_TMP
@@ -7081,6 +7174,48 @@ test_101g() {
 }
 run_test 101g "Big bulk(4/16 MiB) readahead"
 
+test_101h() {
+	local file=$DIR/$tfile
+	local windows=$($LCTL get_param -n llite.*.read_ahead_async_windows |
+			head -n 1)
+
+	[ -z "$windows" ] && skip "no async readahead support" && return
+
+	$LFS setstripe -c 1 -i 0 $file || error "setstripe $file failed"
+	dd if=/dev/zero of=$file bs=1M count=64 || error "dd write failed"
+
+	stack_trap "$LCTL set_param -n \
+		llite.*.read_ahead_async_windows=$windows" EXIT
+	$LCTL set_param -n llite.*.read_ahead_async_windows=4 ||
+		error "enable async readahead failed"
+
+	cancel_lru_locks osc
+	$LCTL set_param -n llite.*.read_ahead_stats=0
+	dd if=$file of=/dev/null bs=64k || error "dd read failed"
+
+	local async=$($LCTL get_param -n llite.*.read_ahead_stats |
+		      get_named_value 'async readahead' | cut -d" " -f1 |
+		      calc_total)
+	echo "async readahead windows: $async"
+	[ ${async:-0} -gt 0 ] || error "no readahead window was read asynchronously"
+
+	# the async windows must not change what the reader gets back
+	cancel_lru_locks osc
+	cmp $file /dev/zero -n $((64 * 1048576)) ||
+		error "data mismatch with async readahead"
+
+	$LCTL set_param -n llite.*.read_ahead_async_windows=0
+	cancel_lru_locks osc
+	$LCTL set_param -n llite.*.read_ahead_stats=0
+	dd if=$file of=/dev/null bs=64k || error "dd read failed"
+	async=$($LCTL get_param -n llite.*.read_ahead_stats |
+		get_named_value 'async readahead' | cut -d" " -f1 | calc_total)
+	[ ${async:-0} -eq 0 ] || error "async readahead used while disabled: $async"
+
+	rm -f $file
+}
+run_test 101h "async readahead keeps windows in flight ahead of reader"
+
 setup_test102() {
 	test_mkdir $DIR/$tdir
 	chown $RUNAS_ID $DIR/$tdir
@@ -7924,7 +8059,8 @@ test_115() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	remote_ost_nodsh && skip "remote OST with nodsh" && return
 
-	# Lustre does not stop service threads once they are started.
+	# Lustre does not stop service threads once they are started,
+	# unless threads_idle_time is set.
 	# Reset number of running threads to default.
 	stopall
 	setupall
@@ -9038,6 +9174,86 @@ test_123b () { # statahead(bug 15027)
 }
 run_test 123b "not panic with network error in statahead enqueue (bug 15027)"
 
+test_123c() {
+	local nrfiles=1000
+	local batch=$($LCTL get_param -n llite.*.statahead_batch_max |
+		      head -n 1)
+
+	[ -z "$batch" ] && skip "no batched statahead support" && return
+	[ -z "$($LCTL get_param -n mdc.*.connect_flags |
+		grep batch_getattr)" ] &&
+		skip "MDS does not support batched getattr" && return
+
+	test_mkdir $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile- $nrfiles ||
+		error "createmany failed"
+
+	stack_trap "$LCTL set_param -n llite.*.statahead_batch_max=$batch" EXIT
+	$LCTL set_param -n llite.*.statahead_batch_max=32 ||
+		error "set statahead_batch_max failed"
+
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+	$LCTL set_param -n mdc.*.stats=clear
+	local num=$(ls -l $DIR/$tdir | grep -c $tfile-)
+	[ $num -eq $nrfiles ] || error "ls -l found $num files, not $nrfiles"
+
+	local batched=$(calc_stats mdc.*.stats mds_batch_getattr)
+	echo "$nrfiles entries stated with $batched batched RPCs"
+	[ ${batched:-0} -gt 0 ] || error "statahead did not batch any getattr"
+	[ $batched -lt $((nrfiles / 2)) ] ||
+		error "too many batched RPCs: $batched for $nrfiles entries"
+	$LCTL get_param -n llite.*.statahead_stats
+
+	rm -rf $DIR/$tdir
+}
+run_test 123c "statahead fetches attributes with batched getattr RPCs"
+
+test_123d() {
+	local nrdirs=500
+	local age=$($LCTL get_param -n llite.*.readdir_plus_max_age |
+		    head -n 1)
+	local batch=$($LCTL get_param -n llite.*.statahead_batch_max |
+		      head -n 1)
+
+	[ -z "$age" ] && skip "no readdir-plus support" && return
+	[ -z "$($LCTL get_param -n mdc.*.connect_flags |
+		grep readdir_plus)" ] &&
+		skip "MDS does not support readdir-plus" && return
+
+	test_mkdir $DIR/$tdir
+	createmany -d $DIR/$tdir/$tdir- $nrdirs || error "createmany failed"
+
+	stack_trap "$LCTL set_param -n llite.*.readdir_plus_max_age=$age" EXIT
+	stack_trap "$LCTL set_param -n llite.*.statahead_batch_max=$batch" EXIT
+	# one RPC per entry when readdir-plus is not used
+	$LCTL set_param -n llite.*.statahead_batch_max=0
+	$LCTL set_param -n llite.*.readdir_plus_max_age=30 ||
+		error "set readdir_plus_max_age failed"
+
+	cancel_lru_locks mdc
+	$LCTL set_param -n mdc.*.stats=clear
+	local num=$(ls -l $DIR/$tdir | grep -c $tdir-)
+	[ $num -eq $nrdirs ] || error "ls -l found $num dirs, not $nrdirs"
+
+	local enqueued=$(calc_stats mdc.*.stats ldlm_enqueue)
+	echo "$nrdirs entries stated with ${enqueued:-0} lock enqueues"
+	[ ${enqueued:-0} -lt $((nrdirs / 2)) ] ||
+		error "readdir-plus did not prime entries: $enqueued enqueues"
+
+	# primed attributes must not hide changes made since
+	$LCTL set_param -n llite.*.readdir_plus_max_age=1
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > /dev/null
+	chmod 0700 $DIR/$tdir/$tdir-0
+	sleep 2
+	local mode=$(stat -c %a $DIR/$tdir/$tdir-0)
+	[ "$mode" == "700" ] || error "stale mode $mode after expiry"
+
+	rm -rf $DIR/$tdir
+}
+run_test 123d "readdir-plus primes directory entries without getattr RPCs"
+
 test_124a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	[ -z "$($LCTL get_param -n mdc.*.connect_flags | grep lru_resize)" ] &&
@@ -11489,6 +11705,50 @@ test_160e() {
 }
 run_test 160e "changelog negative testing"
 
+test_160f() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+
+	CL_USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 \
+		changelog_register -n)
+	echo "Registered as changelog user $CL_USER"
+	trap cleanup_changelog EXIT
+
+	test_mkdir -c1 -i0 $DIR/$tdir
+	test_mkdir -c1 -i0 $DIR/$tdir/other
+	touch $DIR/$tdir/f{1..3} $DIR/$tdir/other/f{1..3}
+	rm -f $DIR/$tdir/f1
+
+	local fid=$($LFS path2fid $DIR/$tdir)
+	local all=$($LFS changelog $MDT0 | wc -l)
+	local creat=$($LFS changelog $MDT0 | grep -c " 01CREAT ")
+
+	# only record types listed by --type are delivered
+	local count=$($LFS changelog --type CREAT $MDT0 | wc -l)
+	[ $count -eq $creat ] ||
+		error "--type CREAT got $count records, expected $creat"
+	$LFS changelog --type CREAT,UNLNK $MDT0 | grep -v "CREAT\|UNLNK" &&
+		error "--type CREAT,UNLNK got other record types"
+	count=$($LFS changelog -t UNLNK $MDT0 | wc -l)
+	[ $count -ge 1 ] || error "--type UNLNK got no records"
+
+	# only records about the FID, here as parent, are delivered
+	count=$($LFS changelog --fid $fid --type CREAT $MDT0 | wc -l)
+	[ $count -eq 3 ] ||
+		error "--fid $fid got $count CREAT records, expected 3"
+	local expect=$($LFS changelog $MDT0 | grep -cF "$fid")
+	count=$($LFS changelog --fid $fid $MDT0 | wc -l)
+	[ $count -eq $expect ] ||
+		error "--fid $fid got $count records, expected $expect"
+
+	[ $($LFS changelog $MDT0 | wc -l) -eq $all ] ||
+		error "unfiltered changelog changed"
+
+	$LFS changelog_clear $MDT0 $CL_USER 0
+	cleanup_changelog
+}
+run_test 160f "changelog records filtered by type and FID"
+
 test_161a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	test_mkdir -p -c1 $DIR/$tdir
@@ -16231,6 +16491,215 @@ test_315() { # LU-618
 }
 run_test 315 "read should be accounted"
 
+test_316() {
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local size
+
+	$LCTL get_param -n osc.*.connect_flags | grep -q short_io ||
+		{ skip "no short io support" && return; }
+
+	! $LCTL set_param osc.*.short_io_bytes=$((128 * 1024)) 2>/dev/null ||
+		error "short_io_bytes above maximum should be refused"
+
+	save_lustre_params client "osc.*.short_io_bytes" > $p
+	stack_trap "restore_lustre_params < $p; rm -f $p" EXIT
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	for size in 1 4096 8191 16384 65536 1048576; do
+		for short in 0 16384 65536; do
+			$LCTL set_param -n osc.*.short_io_bytes=$short
+			dd if=/dev/urandom of=$TMP/$tfile bs=$size count=1 \
+				2>/dev/null || error "create $TMP/$tfile failed"
+			dd if=$TMP/$tfile of=$DIR/$tfile bs=$size count=1 \
+				conv=notrunc,fsync 2>/dev/null ||
+				error "write size $size failed"
+			cancel_lru_locks osc
+			cmp -n $size $TMP/$tfile $DIR/$tfile ||
+				error "data mismatch size $size short_io $short"
+		done
+	done
+	rm -f $DIR/$tfile $TMP/$tfile
+}
+run_test 316 "short io read and write for small and large sizes"
+
+test_317() {
+	local ns="ldlm.namespaces.*-OST0000-osc-[-0-9a-f]*.lock_count"
+	local count
+
+	$LCTL get_param -n osc.*.connect_flags | grep -q lock_ahead ||
+		{ skip "no lock ahead support" && return; }
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	cancel_lru_locks osc
+
+	$LFS ladvise -a lockahead -s 0 -l 1M $DIR/$tfile 2>/dev/null &&
+		error "lockahead without a mode should fail"
+	$LFS ladvise -a lockahead -m WRITE -s 0 -l 1M $DIR/$tfile ||
+		error "lockahead [0, 1M) failed"
+	# without expansion the first lock does not cover the second range
+	$LFS ladvise -a lockahead -m WRITE -s 2M -l 1M $DIR/$tfile ||
+		error "lockahead [2M, 3M) failed"
+	wait_update $HOSTNAME "$LCTL get_param -n $ns" 2 ||
+		error "expected 2 locks, got $($LCTL get_param -n $ns)"
+
+	# an already held lock is not requested again
+	$LFS ladvise -a lockahead -m READ -s 0 -l 1M $DIR/$tfile ||
+		error "lockahead READ [0, 1M) failed"
+
+	# writes inside the requested ranges reuse the locks
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 conv=notrunc ||
+		error "write [0, 1M) failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 seek=2 conv=notrunc ||
+		error "write [2M, 3M) failed"
+	count=$($LCTL get_param -n $ns)
+	[ $count -eq 2 ] || error "expected 2 locks after write, got $count"
+
+	cancel_lru_locks osc
+	rm -f $DIR/$tfile
+}
+run_test 317 "lock ahead requests non-expanded extent locks"
+
+test_318() {
+	local dom=$DIR/$tdir/$tfile
+	local size
+
+	$LCTL get_param -n mdc.*.connect_flags | grep -q dom ||
+		{ skip "no Data-on-MDT support" && return; }
+
+	test_mkdir $DIR/$tdir
+	$SETSTRIPE -L mdt -c 1 -E 1M -E -1 $DIR/$tdir/bad 2>/dev/null &&
+		error "OST striping should be refused for MDT component"
+	$SETSTRIPE -E 1M -c 1 -E 2M -L mdt -E -1 $DIR/$tdir/bad 2>/dev/null &&
+		error "MDT pattern should be refused for non-first component"
+	$SETSTRIPE -E 1M -L mdt -E -1 -c 1 $dom ||
+		error "create DoM file failed"
+	[ $($GETSTRIPE -I1 -L $dom) == "mdt" ] ||
+		error "bad pattern $($GETSTRIPE -I1 -L $dom)"
+
+	# both the MDT part and the OST part of the file
+	for size in 1 4096 65537 1048576 1048577 3145728; do
+		dd if=/dev/urandom of=$TMP/$tfile bs=$size count=1 \
+			2>/dev/null || error "create $TMP/$tfile failed"
+		dd if=$TMP/$tfile of=$dom bs=$size count=1 conv=fsync \
+			2>/dev/null || error "write size $size failed"
+		cancel_lru_locks mdc
+		cancel_lru_locks osc
+		[ $(stat -c %s $dom) -eq $size ] ||
+			error "size $(stat -c %s $dom) != $size"
+		cmp $TMP/$tfile $dom || error "data mismatch size $size"
+	done
+
+	$TRUNCATE $dom 4096 || error "truncate failed"
+	cancel_lru_locks mdc
+	[ $(stat -c %s $dom) -eq 4096 ] ||
+		error "size after truncate $(stat -c %s $dom) != 4096"
+	cmp -n 4096 $TMP/$tfile $dom || error "data mismatch after truncate"
+
+	rm -f $dom $TMP/$tfile
+}
+run_test 318 "Data-on-MDT basic read, write, truncate"
+
+test_319() {
+	local pcc_dir=$TMP/pcc.$$
+	local old_root=$($LCTL get_param -n llite.*.pcc_root 2>/dev/null |
+			 head -n 1)
+
+	[ -n "$old_root" ] || { skip "no PCC support" && return; }
+
+	mkdir -p $pcc_dir
+	stack_trap "rm -rf $pcc_dir" EXIT
+	stack_trap "$LCTL set_param llite.*.pcc_root=$old_root" EXIT
+	$LCTL set_param llite.*.pcc_root=$pcc_dir ||
+		error "set pcc_root failed"
+
+	dd if=/dev/urandom of=$DIR/$tfile bs=1M count=4 conv=fsync ||
+		error "write $tfile failed"
+	$LFS pcc_attach $DIR/$tfile || error "attach $tfile failed"
+	$LFS pcc_state $DIR/$tfile | grep -q readonly ||
+		error "$tfile not attached: $($LFS pcc_state $DIR/$tfile)"
+	$LFS hsm_state $DIR/$tfile | grep -q pcc_readonly ||
+		error "HS_PCCRO not set: $($LFS hsm_state $DIR/$tfile)"
+	cmp $DIR/$tfile $pcc_dir/$($LFS path2fid $DIR/$tfile | tr -d '[]') ||
+		error "local copy differs"
+
+	# reads are served by the local copy
+	cancel_lru_locks osc
+	$LCTL set_param -n osc.*.stats=clear
+	cat $DIR/$tfile > /dev/null || error "read $tfile failed"
+	local reads=$($LCTL get_param -n osc.*.stats |
+		      awk '/^ost_read/ { sum += $2 } END { print sum + 0 }')
+	[ $reads -eq 0 ] || error "$reads OST_READ RPCs sent"
+
+	# a writer drops the local copy
+	echo "foo" >> $DIR/$tfile || error "append $tfile failed"
+	$LFS pcc_state $DIR/$tfile | grep -q none ||
+		error "$tfile still attached after write"
+	$LFS hsm_state $DIR/$tfile | grep -q pcc_readonly &&
+		error "HS_PCCRO still set after write"
+	tail -c 4 $DIR/$tfile | grep -q foo || error "new data not read"
+
+	# a file opened for write cannot be attached
+	exec 3>>$DIR/$tfile
+	$LFS pcc_attach $DIR/$tfile && error "attach opened file succeeded"
+	exec 3>&-
+
+	$LFS pcc_attach $DIR/$tfile || error "attach $tfile again failed"
+	$LFS pcc_detach $DIR/$tfile || error "detach $tfile failed"
+	$LFS pcc_state $DIR/$tfile | grep -q none ||
+		error "$tfile still attached after detach"
+
+	rm -f $DIR/$tfile
+}
+run_test 319 "read-only Persistent Client Cache"
+
+test_320() {
+	[ $OSTCOUNT -lt 2 ] && skip "needs >= 2 OSTs" && return
+	[ $(lustre_version_code $SINGLEMDS) -lt $(version_code 2.10.58) ] &&
+		skip "needs MDS with FLR support" && return
+
+	$LFS mirror create -N -i 0 -c 1 -N -i 1 -c 1 $DIR/$tfile ||
+		error "create mirrored $tfile failed"
+	$LFS getstripe $DIR/$tfile | grep -q "lcm_mirror_count: 2" ||
+		error "$tfile not mirrored: $($LFS getstripe $DIR/$tfile)"
+
+	# a write stales the other mirror
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=4 ||
+		error "create $TMP/$tfile failed"
+	cp $TMP/$tfile $DIR/$tfile || error "write $tfile failed"
+	$LFS getstripe $DIR/$tfile | grep -q "lcme_flags:.*stale" ||
+		error "no stale component: $($LFS getstripe $DIR/$tfile)"
+	cmp $TMP/$tfile $DIR/$tfile || error "$tfile differs after write"
+
+	$LFS mirror resync $DIR/$tfile || error "resync $tfile failed"
+	$LFS getstripe $DIR/$tfile | grep -q "lcme_flags:.*stale" &&
+		error "stale component after resync"
+
+	cancel_lru_locks osc
+	$LCTL set_param -n osc.*.stats=clear
+	cmp $TMP/$tfile $DIR/$tfile || error "$tfile differs after resync"
+	local reads=$($LCTL get_param -n osc.*.stats |
+		      awk '/^ost_read/ { sum += $2 } END { print sum + 0 }')
+	[ $reads -gt 0 ] || error "no OST_READ RPC sent"
+
+	# truncate is a write as well
+	$TRUNCATE $DIR/$tfile 1000 || error "truncate $tfile failed"
+	$LFS getstripe $DIR/$tfile | grep -q "lcme_flags:.*stale" ||
+		error "no stale component after truncate"
+	$LFS mirror resync $DIR/$tfile || error "resync after truncate failed"
+	[ $(stat -c %s $DIR/$tfile) -eq 1000 ] ||
+		error "bad size $(stat -c %s $DIR/$tfile) after resync"
+
+	# resync needs the file for itself
+	exec 3<$DIR/$tfile
+	echo foo >> $DIR/$tfile || error "append $tfile failed"
+	$LFS mirror resync $DIR/$tfile && error "resync of open file succeeded"
+	exec 3<&-
+	$LFS mirror resync $DIR/$tfile || error "resync $tfile failed"
+
+	rm -f $DIR/$tfile $TMP/$tfile
+}
+run_test 320 "mirrored file write, stale and resync"
+
 test_fake_rw() {
 	local read_write=$1
 	if [ "$read_write" = "write" ]; then
@@ -16735,6 +17204,554 @@ test_410()
 }
 run_test 410 "Test inode number returned from kernel thread"
 
+test_411() {
+	local nthreads=8
+	local nrdirs=200
+	local max=$($LCTL get_param -n mdc.*.batch_reint_max | head -n 1)
+
+	[ -z "$max" ] && skip "no batched reint support" && return
+	[ -z "$($LCTL get_param -n mdc.*.connect_flags |
+		grep batch_reint)" ] &&
+		skip "MDS does not support batched reint" && return
+
+	stack_trap "$LCTL set_param -n mdc.*.batch_reint_max=$max" EXIT
+	$LCTL set_param -n mdc.*.batch_reint_max=8 ||
+		error "set batch_reint_max failed"
+
+	test_mkdir $DIR/$tdir
+	$LCTL set_param -n mdc.*.stats=clear
+
+	local i
+	local pids=""
+
+	for i in $(seq $nthreads); do
+		( for j in $(seq $nrdirs); do
+			mkdir $DIR/$tdir/d$i.$j || exit 1
+		done ) &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || error "concurrent mkdir failed"
+	done
+
+	local num=$(ls $DIR/$tdir | wc -l)
+	[ $num -eq $((nthreads * nrdirs)) ] ||
+		error "found $num directories, not $((nthreads * nrdirs))"
+
+	local batched=$(calc_stats mdc.*.stats mds_batch_reint)
+	echo "$num mkdirs used $batched batched RPCs"
+	[ ${batched:-0} -gt 0 ] || error "no mkdir was batched"
+
+	pids=""
+	for i in $(seq $nthreads); do
+		( for j in $(seq $nrdirs); do
+			rmdir $DIR/$tdir/d$i.$j || exit 1
+		done ) &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || error "concurrent rmdir failed"
+	done
+
+	num=$(ls $DIR/$tdir | wc -l)
+	[ $num -eq 0 ] || error "$num directories left"
+}
+run_test 411 "concurrent mkdir/rmdir batched into MDS_BATCH_REINT"
+
+test_412() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local param=ost.OSS.ost_io.req_steal
+	local old=$(do_facet ost1 $LCTL get_param -n $param 2>/dev/null)
+
+	[ -z "$old" ] && skip "no request stealing support" && return
+
+	local nparts=$(do_facet ost1 $LCTL get_param -n \
+		       ost.OSS.ost_io.req_steal_stats | grep -c "^cpt")
+
+	[ $nparts -lt 2 ] && skip "ost_io has only $nparts partition" &&
+		return
+
+	stack_trap "do_facet ost1 $LCTL set_param -n $param=$old" EXIT
+	do_facet ost1 $LCTL set_param -n $param=2 &&
+		error "req_steal accepted invalid value 2"
+	do_facet ost1 $LCTL set_param -n $param=1 ||
+		error "enable req_steal failed"
+
+	# With the fewest threads each partition serves one normal request
+	# at a time. Slow requests then back up on the partition the client
+	# sends to, and the idle threads of the others must steal them.
+	local tmin=$(do_facet ost1 $LCTL get_param -n \
+		     ost.OSS.ost_io.threads_min)
+	local tmax=$(do_facet ost1 $LCTL get_param -n \
+		     ost.OSS.ost_io.threads_max)
+
+	stack_trap "do_facet ost1 $LCTL set_param -n \
+		ost.OSS.ost_io.threads_max=$tmax" EXIT
+	do_facet ost1 $LCTL set_param -n ost.OSS.ost_io.threads_max=$tmin ||
+		error "set threads_max=$tmin failed"
+	#define OBD_FAIL_PTLRPC_PAUSE_REQ        0x50a
+	stack_trap "do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0" EXIT
+	do_facet ost1 $LCTL set_param fail_val=20 fail_loc=0x50a
+
+	local i
+	local pids=""
+	local steal0=$(do_facet ost1 $LCTL get_param -n \
+		ost.OSS.ost_io.req_steal_stats |
+		awk '{ sum += $4 } END { print sum }')
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	for i in $(seq 8); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=1M count=16 \
+			oflag=direct 2>/dev/null &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || error "dd failed"
+	done
+	do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0
+
+	do_facet ost1 $LCTL get_param ost.OSS.ost_io.req_steal_stats
+	local active=$(do_facet ost1 $LCTL get_param -n \
+		ost.OSS.ost_io.req_steal_stats |
+		awk '{ sum += $NF } END { print sum }')
+	[ ${active:-0} -eq 0 ] || error "$active stolen requests still active"
+
+	local steal=$(do_facet ost1 $LCTL get_param -n \
+		ost.OSS.ost_io.req_steal_stats |
+		awk '{ sum += $4 } END { print sum }')
+	local stolen=$(do_facet ost1 $LCTL get_param -n \
+		ost.OSS.ost_io.req_steal_stats |
+		awk '{ sum += $6 } END { print sum }')
+	[ ${steal:-0} -gt ${steal0:-0} ] || error "no request was stolen"
+	[ ${steal:-0} -eq ${stolen:-0} ] ||
+		error "stole $steal requests but $stolen were stolen"
+}
+run_test 412 "ost_io threads steal requests from busy partitions"
+
+test_413() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local param=ost.OSS.ost_io
+	local idle=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_idle_time 2>/dev/null)
+
+	[ -z "$idle" ] && skip "no idle thread retirement support" && return
+
+	local min=$(do_facet ost1 $LCTL get_param -n $param.threads_min)
+	local max=$(do_facet ost1 $LCTL get_param -n $param.threads_max)
+	local target=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_wait_target)
+
+	[ $max -gt $min ] ||
+		{ skip "threads_max $max is not above threads_min"; return; }
+
+	stack_trap "do_facet ost1 $LCTL set_param \
+		$param.threads_idle_time=$idle" EXIT
+	stack_trap "do_facet ost1 $LCTL set_param \
+		$param.threads_wait_target=$target" EXIT
+	# start threads on demand and keep them, and keep every request long
+	# enough in a thread that the load needs more than threads_min
+	do_facet ost1 $LCTL set_param $param.threads_wait_target=0 \
+		$param.threads_idle_time=0
+	#define OBD_FAIL_PTLRPC_PAUSE_REQ        0x50a
+	stack_trap "do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0" EXIT
+	do_facet ost1 $LCTL set_param fail_val=100 fail_loc=0x50a
+
+	local i
+	local pids=""
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	for i in $(seq 32); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=1M count=8 \
+			oflag=direct 2>/dev/null &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || error "dd failed"
+	done
+	do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0
+
+	local started=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_started)
+
+	echo "$started threads started, threads_min $min"
+	[ $started -gt $min ] || error "no thread started beyond threads_min"
+
+	do_facet ost1 $LCTL set_param $param.threads_idle_time=1
+	wait_update_facet ost1 "$LCTL get_param -n $param.threads_started" \
+		$min 60 || error "idle threads were not retired"
+	do_facet ost1 $LCTL get_param $param.threads_stats
+}
+run_test 413 "idle ost_io threads are retired down to threads_min"
+
+test_414() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local param=ost.OSS.ost_io
+
+	do_facet ost1 $LCTL get_param -n $param.req_latency_hist \
+		&> /dev/null || { skip "no request latency histograms"; return; }
+
+	local thresh=$(do_facet ost1 $LCTL get_param -n \
+		$param.req_slow_threshold)
+
+	stack_trap "do_facet ost1 $LCTL set_param \
+		$param.req_slow_threshold=$thresh" EXIT
+	do_facet ost1 $LCTL set_param $param.req_latency_hist=clear \
+		$param.req_opc_latency_hist=clear $param.req_slow_log=clear
+	do_facet ost1 $LCTL set_param $param.req_slow_threshold=1
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 oflag=direct ||
+		error "dd write failed"
+
+	local hist=$(do_facet ost1 $LCTL get_param -n $param.req_latency_hist)
+	local stage
+
+	echo "$hist"
+	for stage in queue handle io_prep bulk io_commit reply; do
+		echo "$hist" | grep -q "^$stage " ||
+			error "no $stage latency recorded"
+	done
+	do_facet ost1 $LCTL get_param -n $param.req_opc_latency_hist |
+		grep -q "^ost_write " || error "no ost_write latency recorded"
+	do_facet ost1 $LCTL get_param $param.req_slow_log
+}
+run_test 414 "ost_io request latency is recorded per stage and opcode"
+
+test_415() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local param=ost.OSS.ost_io.bulk_pool_stats
+
+	do_facet ost1 $LCTL get_param -n $param &>/dev/null ||
+		{ skip "no bulk descriptor pool support" && return; }
+
+	local brw=$($LCTL get_param -n osc.$FSNAME-OST0000*.max_pages_per_rpc |
+		    head -n1)
+
+	[ $brw -le 256 ] && skip "RPCs of $brw pages are not pooled" && return
+
+	local before=$(do_facet ost1 $LCTL get_param -n $param |
+		       awk '{ n += $6 + $8 } END { print n + 0 }')
+
+	$SETSTRIPE -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=4M count=16 oflag=direct ||
+		error "dd failed"
+
+	local after=$(do_facet ost1 $LCTL get_param -n $param |
+		      awk '{ n += $6 + $8 } END { print n + 0 }')
+
+	do_facet ost1 $LCTL get_param $param
+	[ $after -gt $before ] ||
+		error "bulk descriptors not taken from the pool: $before/$after"
+}
+run_test 415 "large ost_io bulk descriptors come from per-CPT pools"
+
+test_416() {
+	local param=mds.MDS.mdt.rs_arena_stats
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param &>/dev/null ||
+		{ skip "no reply state arena support" && return; }
+
+	test_mkdir $DIR/$tdir
+	createmany -o $DIR/$tdir/f 1000 || error "createmany failed"
+	unlinkmany $DIR/$tdir/f 1000 || error "unlinkmany failed"
+
+	local hits=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+		     awk '{ n += $4 } END { print n + 0 }')
+
+	do_facet $SINGLEMDS $LCTL get_param $param
+	[ $hits -gt 0 ] || error "no reply state was reused from the arena"
+}
+run_test 416 "mdt reply states are reused from the per-CPT arena"
+
+test_417() {
+	local param=/sys/module/ptlrpc/parameters/ptlrpcd_coalesce_usecs
+
+	[ -f $param ] || { skip "no ptlrpcd coalescing support" && return; }
+
+	local old=$(cat $param)
+
+	stack_trap "echo $old > $param" EXIT
+	echo 2000 > $param
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c -1 $DIR/$tdir || error "setstripe failed"
+	createmany -o $DIR/$tdir/f 200 || error "createmany failed"
+	cancel_lru_locks osc
+	$LCTL set_param -n osc.*.stats=clear
+	# glimpses and async cancels are now batched by ptlrpcd
+	ls -l $DIR/$tdir > /dev/null || error "ls -l failed"
+	cancel_lru_locks osc
+
+	local coalesced=$($LCTL get_param -n osc.*.stats |
+			  awk '/^req_coalesced/ { n += $2 } END { print n + 0 }')
+
+	echo "$coalesced RPCs coalesced"
+	[ $coalesced -gt 0 ] || error "no RPC wakeup was coalesced"
+
+	local locks=$($LCTL get_param -n \
+		      ldlm.namespaces.*-osc-[^M]*.lock_count |
+		      awk '{ n += $1 } END { print n + 0 }')
+
+	[ $locks -eq 0 ] || error "$locks osc locks left after cancel"
+	unlinkmany $DIR/$tdir/f 200 || error "unlinkmany failed"
+}
+run_test 417 "coalesced ptlrpcd wakeups for glimpses and lock cancels"
+
+test_418() {
+	local param=mds.MDS.mdt.difficult_reply_stats
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param &>/dev/null ||
+		{ skip "no difficult reply stats" && return; }
+
+	do_facet $SINGLEMDS $LCTL set_param $param=clear
+	# directory creates and unlinks keep their parent locks in
+	# difficult replies until the client acks and the MDT commits
+	test_mkdir $DIR/$tdir
+	createmany -d $DIR/$tdir/d 200 || error "createmany failed"
+	do_facet $SINGLEMDS sync
+	unlinkmany -d $DIR/$tdir/d 200 || error "unlinkmany failed"
+	do_facet $SINGLEMDS sync
+
+	do_facet $SINGLEMDS $LCTL get_param $param
+
+	local committed=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+			  awk '/outstanding/ { n += $6 } END { print n + 0 }')
+	local batches=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+			awk '/outstanding/ { n += $8 } END { print n + 0 }')
+
+	[ $committed -gt 0 ] || error "no difficult reply was committed"
+	[ $batches -gt 0 ] || error "no difficult reply commit batch"
+	[ $batches -le $committed ] ||
+		error "$batches commit batches for $committed replies"
+
+	local outstanding
+	local i
+
+	for ((i = 0; i < 30; i++)); do
+		outstanding=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+			awk '/outstanding/ { n += $4 } END { print n + 0 }')
+		[ $outstanding -eq 0 ] && break
+		sleep 1
+	done
+	[ $outstanding -eq 0 ] ||
+		error "$outstanding difficult replies still outstanding"
+}
+run_test 418 "difficult replies are committed and released"
+
+test_419() {
+	local stats=mds.MDS.mdt.stats
+	local nfiles=2000
+	local nproc
+	local before
+	local locks
+	local enq
+	local i
+
+	test_mkdir -c1 -i0 $DIR/$tdir
+	createmany -o $DIR/$tdir/f $nfiles || error "createmany failed"
+	cancel_lru_locks mdc
+	before=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		 ldlm.namespaces.mdt-*.lock_count |
+		 awk '{ n += $1 } END { print n + 0 }')
+
+	# stat and create on a hot directory from more and more processes,
+	# so that IBITS locks with different bits queue up on it
+	for nproc in 1 4 16 64; do
+		cancel_lru_locks mdc
+		do_facet $SINGLEMDS $LCTL set_param -n $stats=clear
+		for ((i = 0; i < nproc; i++)); do
+			(stat $DIR/$tdir/f* > /dev/null &&
+			 touch $DIR/$tdir/new$i) &
+		done
+		wait
+
+		for ((i = 0; i < nproc; i++)); do
+			[ -f $DIR/$tdir/new$i ] ||
+				error "procs $nproc: create new$i failed"
+		done
+		enq=$(do_facet $SINGLEMDS $LCTL get_param -n $stats |
+		      awk '/ldlm_ibits_enqueue/ { print $2 }')
+		echo "procs $nproc: ${enq:-0} ibits enqueues"
+		[ ${enq:-0} -ge $nproc ] ||
+			error "procs $nproc: ${enq:-0} ibits enqueues < $nproc"
+	done
+
+	# every lock that had to wait was granted, and goes away with
+	# the client locks
+	cancel_lru_locks mdc
+	for ((i = 0; i < 20; i++)); do
+		locks=$(do_facet $SINGLEMDS $LCTL get_param -n \
+			ldlm.namespaces.mdt-*.lock_count |
+			awk '{ n += $1 } END { print n + 0 }')
+		[ $locks -le $before ] && break
+		sleep 1
+	done
+	[ $locks -le $before ] ||
+		error "$locks MDT locks left, $before before the test"
+
+	rm -rf $DIR/$tdir || error "rm failed"
+}
+run_test 419 "ibits locks with different bits waiting on a hot directory"
+
+test_420() {
+	local ns=ldlm.namespaces.*-mdc-*
+	local conv1
+	local conv2
+	local locks
+
+	[ -z "$($LCTL get_param -n mdc.*.connect_flags |
+		grep lock_convert)" ] &&
+		skip "no lock convert support on server" && return
+
+	test_mkdir -c1 -i0 $DIR/$tdir
+	touch $DIR/$tdir/$tfile || error "touch failed"
+
+	# keep the setattr from cancelling the cached lock on the client
+	$LCTL set_param $ns.early_lock_cancel=0
+	cancel_lru_locks mdc
+	stat $DIR/$tdir/$tfile > /dev/null || error "stat failed"
+
+	conv1=$($LCTL get_param -n mdc.*.stats |
+		awk '/ldlm_convert/ { n += $2 } END { print n + 0 }')
+	# mtime setattr conflicts with the UPDATE bit of the getattr lock only
+	touch -c -m -d @1000000000 $DIR/$tdir/$tfile || error "setattr failed"
+	conv2=$($LCTL get_param -n mdc.*.stats |
+		awk '/ldlm_convert/ { n += $2 } END { print n + 0 }')
+	locks=$($LCTL get_param -n $ns.lock_count |
+		awk '{ n += $1 } END { print n + 0 }')
+	$LCTL set_param $ns.early_lock_cancel=1
+
+	[ $conv2 -gt $conv1 ] || error "lock was not converted"
+	[ $locks -gt 0 ] || error "converted lock was not kept"
+	# the kept LOOKUP bit still serves the lookup
+	stat -c %Y $DIR/$tdir/$tfile | grep -q 1000000000 ||
+		error "stale mtime after lock convert"
+
+	rm -rf $DIR/$tdir || error "rm failed"
+}
+run_test 420 "drop conflicting ibits instead of cancelling the lock"
+
+test_421() {
+	local run_id=$RANDOM
+	local threads=$(grep -c ^processor /proc/cpuinfo)
+
+	# The module is never loaded, it only runs the test from its init
+	# function and prints the results.
+	load_module obdclass/handle_test run_id=$run_id threads=$threads \
+		&> /dev/null
+
+	dmesg | grep "lustre_handle_test_$run_id:"
+	dmesg | grep "lustre_handle_test_$run_id:" | grep -q "failed" &&
+		error "handle lookups failed"
+	dmesg | grep -q "lustre_handle_test_$run_id: done" ||
+		error "handle lookup test did not complete"
+}
+run_test 421 "handle lookups while handles are released and unhashed"
+
+test_422() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+
+	local nsdir="ldlm.namespaces.*-OST0000-osc-[^mM]*"
+	local lru_size=$($LCTL get_param -n $nsdir.lru_size)
+	local nr=100
+	local i
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	for ((i = 0; i < nr; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=4k count=1 2>/dev/null ||
+			error "dd to f$i failed"
+	done
+	cancel_lru_locks osc
+	$LCTL set_param -n $nsdir.stats=clear
+
+	# the cached pages keep the read locks in the LRU
+	for ((i = 0; i < nr; i++)); do
+		cat $DIR/$tdir/f$i > /dev/null || error "read f$i failed"
+	done
+	for ((i = 0; i < nr; i++)); do
+		cat $DIR/$tdir/f$i > /dev/null || error "reread f$i failed"
+	done
+	$LCTL get_param $nsdir.stats
+
+	local hits=$(calc_stats $nsdir.stats lru_hits)
+	(( hits >= nr )) || error "$hits LRU hits for $nr cached locks"
+
+	# lru_size reads the number of unused locks with LRU resize on
+	$LCTL get_param -n osc.*-OST0000-*.connect_flags | grep -q lru_resize &&
+		lru_size=0
+	stack_trap "$LCTL set_param -n $nsdir.lru_size=$lru_size" EXIT
+	# an explicit shrink cancels the locks whatever pages they cover
+	$LCTL set_param -n $nsdir.lru_size=$((nr / 4))
+	wait_update_facet client "$LCTL get_param -n $nsdir.lock_unused_count" \
+		$((nr / 4)) 30 || error "LRU not shrunk to $((nr / 4)) locks"
+	$LCTL get_param $nsdir.stats
+
+	local scanned=$(calc_stats $nsdir.stats lru_scanned)
+	local cancelled=$(calc_stats $nsdir.stats lru_cancelled)
+
+	(( cancelled >= nr * 3 / 4 )) ||
+		error "$cancelled LRU locks cancelled, expected $((nr * 3 / 4))"
+	(( scanned >= cancelled )) ||
+		error "$scanned locks scanned, fewer than $cancelled cancelled"
+}
+run_test 422 "LRU statistics of a client namespace"
+
+test_423() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local tmp=$TMP/$tfile.tmp
+	local file=$DIR/$tfile
+	local npages=256
+	local half=$((npages / 2))
+	local before
+	local after
+
+	save_writethrough $p
+	stack_trap "restore_lustre_params < $p; rm -f $p" EXIT
+	roc_hit_init
+	set_cache read on
+	set_cache writethrough on
+
+	dd if=/dev/urandom of=$tmp bs=4k count=$npages || error "dd $tmp failed"
+	$SETSTRIPE -c 1 -i 0 $file || error "setstripe $file failed"
+	dd if=$tmp of=$file bs=4k count=$npages || error "dd $file failed"
+
+	# a read with the read cache off drops the pages from the OST cache,
+	# leaving only the first half of the file cached
+	set_cache read off
+	dd if=$file of=/dev/null bs=4k skip=$half count=$half ||
+		error "read of the second half failed"
+	set_cache read on
+
+	# the cached run is looked up in batches, the rest is read from disk
+	before=$(roc_hit)
+	cmp $tmp $file || error "partially cached file compare failed"
+	after=$(roc_hit)
+	(( after - before == half )) ||
+		error "$((after - before)) cache hits, expected $half"
+
+	cancel_lru_locks osc
+	before=$(roc_hit)
+	cmp $tmp $file || error "cached file compare failed"
+	after=$(roc_hit)
+	(( after - before == npages )) ||
+		error "$((after - before)) cache hits, expected $npages"
+
+	rm -f $tmp $file
+}
+run_test 423 "OST reads mixing cached and uncached pages"
+
 prep_801() {
 	[[ $(lustre_version_code mds1) -lt $(version_code 2.9.55) ]] ||
 	[[ $(lustre_version_code ost1) -lt $(version_code 2.9.55) ]] &&
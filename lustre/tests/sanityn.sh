@@ -825,6 +825,61 @@ test_32b() { # bug 11270
 }
 run_test 32b "lockless i/o"
 
+test_32c() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local facets=$(get_facets OST)
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+
+	save_lustre_params client "osc.*.contention_seconds" > $p
+	save_lustre_params $facets \
+		"ldlm.namespaces.filter-*.max_nolock_bytes" >> $p
+	save_lustre_params $facets \
+		"ldlm.namespaces.filter-*.contended_locks" >> $p
+	save_lustre_params $facets \
+		"ldlm.namespaces.filter-*.contention_seconds" >> $p
+	save_lustre_params $facets \
+		"ldlm.namespaces.filter-*.contention_region_bytes" >> $p
+
+	do_facet ost1 $LCTL set_param -n \
+		ldlm.namespaces.filter-*.contention_region_bytes=1000 &&
+		error "non power of two region size accepted"
+
+	$LFS setstripe -c 1 -i 0 $DIR1/$tfile || error "setstripe failed"
+
+	# contend the first 1MB region of the object only
+	do_nodes $(comma_list $(osts_nodes)) \
+		"lctl set_param -n ldlm.namespaces.*.max_nolock_bytes=2000000 \
+			ldlm.namespaces.filter-*.contended_locks=0 \
+			ldlm.namespaces.filter-*.contention_seconds=60 \
+			ldlm.namespaces.filter-*.contention_region_bytes=1048576"
+	lctl set_param -n osc.*.contention_seconds=60
+	for i in {1..5}; do
+		dd if=/dev/zero of=$DIR1/$tfile bs=4k count=1 conv=notrunc > \
+			/dev/null 2>&1
+		dd if=/dev/zero of=$DIR2/$tfile bs=4k count=1 conv=notrunc > \
+			/dev/null 2>&1
+	done
+
+	cancel_lru_locks osc
+	clear_stats osc.*.osc_stats
+	dd if=/dev/zero of=$DIR1/$tfile bs=4k count=1 seek=16384 \
+		conv=notrunc > /dev/null 2>&1
+	[ $(calc_stats osc.*.osc_stats lockless_write_bytes) -eq 0 ] ||
+		error "lockless i/o outside of the contended region"
+
+	dd if=/dev/zero of=$DIR1/$tfile bs=4k count=1 conv=notrunc > \
+		/dev/null 2>&1
+	[ $(calc_stats osc.*.osc_stats lockless_write_bytes) -ne 0 ] ||
+		error "lockless i/o was not triggered in the contended region"
+
+	lctl set_param -n osc.*.contention_seconds=0
+	rm -f $DIR1/$tfile
+	restore_lustre_params <$p
+	rm -f $p
+}
+run_test 32c "lockless i/o is limited to the contended region"
+
 print_jbd_stat () {
     local dev
     local mdts=$(get_facets MDS)
@@ -108,9 +108,13 @@ static int lfs_hsm_restore(int argc, char **argv);
 static int lfs_hsm_release(int argc, char **argv);
 static int lfs_hsm_remove(int argc, char **argv);
 static int lfs_hsm_cancel(int argc, char **argv);
+static int lfs_pcc_attach(int argc, char **argv);
+static int lfs_pcc_detach(int argc, char **argv);
+static int lfs_pcc_state(int argc, char **argv);
 static int lfs_swap_layouts(int argc, char **argv);
 static int lfs_mv(int argc, char **argv);
 static int lfs_ladvise(int argc, char **argv);
+static int lfs_mirror(int argc, char **argv);
 static int lfs_list_commands(int argc, char **argv);
 
 /* Setstripe and migrate share mostly the same parameters */
@@ -120,7 +124,8 @@ static int lfs_list_commands(int argc, char **argv);
 	"                 [--stripe-index|-i <start_ost_idx>]\n"	\
 	"                 [--stripe-size|-S <stripe_size>]\n"		\
 	"                 [--pool|-p <pool_name>]\n"			\
-	"                 [--ost|-o <ost_indices>]\n"
+	"                 [--ost|-o <ost_indices>]\n"			\
+	"                 [--layout|-L <pattern>]\n"
 
 #define SSM_HELP_COMMON \
 	"\tstripe_count: Number of OSTs to stripe over (0=fs default, -1 all)\n" \
@@ -139,7 +144,10 @@ static int lfs_list_commands(int argc, char **argv);
 	"\tcomp_end:     Extent end of component, start after previous end.\n"\
 	"\t              Can be specified with K, M or G (for KB, MB, GB\n" \
 	"\t              respectively, -1 for EOF). Must be a multiple of\n"\
-	"\t              stripe_size.\n"
+	"\t              stripe_size.\n"					\
+	"\tpattern:      Layout pattern of the component, raid0 (default)\n"\
+	"\t              or mdt. The mdt pattern stores the data of the\n" \
+	"\t              first component on the MDT (Data-on-MDT).\n"
 
 
 #define MIGRATE_USAGE							\
@@ -244,19 +252,22 @@ command_t cmdlist[] = {
          "     [[!] --gid|-g|--group|-G <gid>|<gname>]\n"
          "     [[!] --uid|-u|--user|-U <uid>|<uname>] [[!] --pool <pool>]\n"
 	 "     [[!] --projid <projid>]\n"
-	 "     [[!] --layout|-L released,raid0]\n"
+	 "     [[!] --layout|-L released,raid0,mdt]\n"
 	 "     [[!] --component-count [+-]<comp_cnt>]\n"
 	 "     [[!] --component-start [+-]N[kMGTPE]]\n"
 	 "     [[!] --component-end|-E [+-]N[kMGTPE]]\n"
 	 "     [[!] --component-flags <comp_flags>]\n"
 	 "     [[!] --mdt-count|-T [+-]<stripes>]\n"
 	 "     [[!] --mdt-hash|-H <hashtype>\n"
+	 "     [--threads <nthreads>]\n"
          "\t !: used before an option indicates 'NOT' requested attribute\n"
          "\t -: used before a value indicates less than requested value\n"
          "\t +: used before a value indicates more than requested value\n"
 	 "\tmdt-hash:	hash type of the striped directory.\n"
 	 "\t		fnv_1a_64 FNV-1a hash algorithm\n"
-	 "\t		all_char  sum of characters % MDT_COUNT\n"},
+	 "\t		all_char  sum of characters % MDT_COUNT\n"
+	 "\tthreads:	search the tree with several threads, the names\n"
+	 "\t		are printed in no particular order.\n"},
         {"check", lfs_check, 0,
          "Display the status of MDS or OSTs (as specified in the command)\n"
          "or all the servers (MDS and OSTs).\n"
@@ -323,7 +334,11 @@ command_t cmdlist[] = {
          "usage: ls [OPTION]... [FILE]..."},
         {"changelog", lfs_changelog, 0,
          "Show the metadata changes on an MDT."
-         "\nusage: changelog <mdtname> [startrec [endrec]]"},
+	 "\nusage: changelog [--type|-t <type,...>] [--fid|-F <fid>]\n"
+	 "                 [--jobid|-j <jobid>] <mdtname> [startrec [endrec]]\n"
+	 "\ttype:  only show these record types, e.g. CREAT,UNLNK\n"
+	 "\tfid:   only show records about this target or parent FID\n"
+	 "\tjobid: only show records of this job"},
         {"changelog_clear", lfs_changelog_clear, 0,
          "Indicate that old changelog records up to <endrec> are no longer of "
          "interest to consumer <id>, allowing the system to free up space.\n"
@@ -372,6 +387,17 @@ command_t cmdlist[] = {
 	{"hsm_cancel", lfs_hsm_cancel, 0,
 	 "Cancel requests related to specified files.\n"
 	 "usage: hsm_cancel [--filelist FILELIST] [--data DATA] <file> ..."},
+	{"pcc_attach", lfs_pcc_attach, 0,
+	 "Cache the data of files on the local Persistent Client Cache, the "
+	 "reads of this client are served from the local copy until the file "
+	 "is modified.\n"
+	 "usage: pcc_attach <file> ..."},
+	{"pcc_detach", lfs_pcc_detach, 0,
+	 "Stop reading files from the local Persistent Client Cache.\n"
+	 "usage: pcc_detach <file> ..."},
+	{"pcc_state", lfs_pcc_state, 0,
+	 "Display the Persistent Client Cache state of files.\n"
+	 "usage: pcc_state <file> ..."},
 	{"swap_layouts", lfs_swap_layouts, 0, "Swap layouts between 2 files.\n"
 	 "usage: swap_layouts <path1> <path2>"},
 	{"migrate", lfs_setstripe, 0,
@@ -408,7 +434,20 @@ command_t cmdlist[] = {
 	 "usage: ladvise [--advice|-a ADVICE] [--start|-s START[kMGT]]\n"
 	 "               [--background|-b]\n"
 	 "               {[--end|-e END[kMGT]] | [--length|-l LENGTH[kMGT]]}\n"
-	 "               <file> ...\n"},
+	 "               [--mode|-m {READ,WRITE}] <file> ...\n"
+	 "\t--mode:  lock mode to request with the lockahead advice\n"},
+	{"mirror", lfs_mirror, 0,
+	 "Create or resynchronize mirrored files.\n"
+	 "usage: mirror create <--mirror-count|-N[mirror_count]>\n"
+	 "                     [--flags prefer] [setstripe options] ...\n"
+	 "                     <filename>\n"
+	 "       mirror resync <filename> ...\n"
+	 "\tmirror_count: Number of mirrors with the layout given by the\n"
+	 "\t              setstripe options following -N (1 by default).\n"
+	 "\t              Each mirror has to extend to EOF.\n"
+	 "\tprefer:       Read from this mirror when it is up to date.\n"
+	 "\tresync:       Copy up to date data over the stale components\n"
+	 "\t              left by writes to a mirrored file.\n"},
 	{"help", Parser_help, 0, "help"},
 	{"exit", Parser_quit, 0, "quit"},
 	{"quit", Parser_quit, 0, "quit"},
@@ -1024,19 +1063,21 @@ struct lfs_setstripe_args {
 	int			 lsa_nr_osts;
 	__u32			*lsa_osts;
 	char			*lsa_pool_name;
+	unsigned long long	 lsa_pattern;
 };
 
 static inline void setstripe_args_init(struct lfs_setstripe_args *lsa)
 {
 	memset(lsa, 0, sizeof(*lsa));
 	lsa->lsa_stripe_off = -1;
+	lsa->lsa_pattern = LLAPI_LAYOUT_RAID0;
 }
 
 static inline bool setstripe_args_specified(struct lfs_setstripe_args *lsa)
 {
 	return (lsa->lsa_stripe_size != 0 || lsa->lsa_stripe_count != 0 ||
 		lsa->lsa_stripe_off != -1 || lsa->lsa_pool_name != NULL ||
-		lsa->lsa_comp_end != 0);
+		lsa->lsa_comp_end != 0 || lsa->lsa_pattern != LLAPI_LAYOUT_RAID0);
 }
 
 static int comp_args_to_layout(struct llapi_layout **composite,
@@ -1081,6 +1122,27 @@ static int comp_args_to_layout(struct llapi_layout **composite,
 		return rc;
 	}
 
+	if (lsa->lsa_pattern == LLAPI_LAYOUT_MDT) {
+		/* DoM component has no OST objects, only its size */
+		if (prev_end != 0) {
+			fprintf(stderr, "Only the first component can be on "
+				"MDT.\n");
+			return -EINVAL;
+		}
+		if (lsa->lsa_stripe_count > 0 || lsa->lsa_nr_osts > 0 ||
+		    lsa->lsa_stripe_off != -1 || lsa->lsa_pool_name != NULL) {
+			fprintf(stderr, "Can't specify OST striping for MDT "
+				"component.\n");
+			return -EINVAL;
+		}
+		rc = llapi_layout_pattern_set(layout, lsa->lsa_pattern);
+		if (rc) {
+			fprintf(stderr, "Set stripe pattern %#llx failed. %s\n",
+				lsa->lsa_pattern, strerror(errno));
+			return rc;
+		}
+	}
+
 	if (lsa->lsa_stripe_size != 0) {
 		rc = llapi_layout_stripe_size_set(layout,
 						  lsa->lsa_stripe_size);
@@ -1306,10 +1368,76 @@ enum {
 	LFS_COMP_SET_OPT,
 	LFS_COMP_ADD_OPT,
 	LFS_PROJID_OPT,
+	LFS_MIRROR_FLAGS_OPT,
+	LFS_FIND_THREADS_OPT,
+};
+
+/* the command lfs_setstripe_internal() is run for */
+enum setstripe_origin {
+	SO_SETSTRIPE,
+	SO_MIGRATE,
+	SO_MIRROR_CREATE,
 };
 
 /* functions */
-static int lfs_setstripe(int argc, char **argv)
+/**
+ * Append \a mirror_count copies of the mirror described by \a layout, or
+ * by \a lsa if no component was given with -E, to \a mirrors.
+ */
+static int mirror_args_to_layout(struct llapi_layout **mirrors,
+				 struct llapi_layout **layout,
+				 struct lfs_setstripe_args *lsa,
+				 int mirror_count, __u32 mirror_flags)
+{
+	int rc = 0;
+	int i;
+
+	/* a mirror without -E option is made of a single component */
+	if (*layout == NULL && lsa->lsa_comp_end == 0)
+		lsa->lsa_comp_end = LUSTRE_EOF;
+
+	if (lsa->lsa_comp_end != 0) {
+		rc = comp_args_to_layout(layout, lsa);
+		if (rc)
+			return rc;
+	}
+
+	if (mirror_flags != 0) {
+		rc = llapi_layout_comp_use(*layout,
+					   LLAPI_LAYOUT_COMP_USE_FIRST);
+		while (rc == 0) {
+			rc = llapi_layout_comp_flags_set(*layout,
+							 mirror_flags);
+			if (rc)
+				break;
+			rc = llapi_layout_comp_use(*layout,
+						   LLAPI_LAYOUT_COMP_USE_NEXT);
+		}
+		if (rc < 0) {
+			fprintf(stderr, "Set mirror flags failed. %s\n",
+				strerror(errno));
+			return rc;
+		}
+	}
+
+	for (i = 0; i < mirror_count; i++) {
+		rc = llapi_layout_merge(mirrors, *layout);
+		if (rc) {
+			fprintf(stderr, "Add mirror failed. %s\n",
+				strerror(errno));
+			return rc;
+		}
+	}
+
+	llapi_layout_free(*layout);
+	*layout = NULL;
+	setstripe_args_init(lsa);
+
+	return 0;
+}
+
+static int lfs_setstripe_internal(int argc, char **argv,
+				  enum setstripe_origin opc)
 {
 	struct lfs_setstripe_args	 lsa;
 	struct llapi_stripe_param	*param = NULL;
@@ -1333,6 +1461,10 @@ static int lfs_setstripe(int argc, char **argv)
 	int				 comp_add = 0;
 	__u32				 comp_id = 0;
 	struct llapi_layout		*layout = NULL;
+	struct llapi_layout		*mirrors = NULL;
+	int				 mirror_count = 0;
+	__u32				 mirror_flags = 0;
+	bool				 mirror_mode = false;
 
 	struct option long_opts[] = {
 		/* --block is only valid in migrate mode */
@@ -1369,6 +1501,9 @@ static int lfs_setstripe(int argc, char **argv)
 	{ .val = 'E',	.name = "comp-end",	.has_arg = required_argument},
 	{ .val = 'E',	.name = "component-end",
 						.has_arg = required_argument},
+	/* --flags is only valid in mirror create mode */
+	{ .val = LFS_MIRROR_FLAGS_OPT,
+			.name = "flags",	.has_arg = required_argument},
 	/* dirstripe {"mdt-hash",     required_argument, 0, 'H'}, */
 #if LUSTRE_VERSION_CODE < OBD_OCD_VERSION(2, 9, 59, 0)
 	/* This formerly implied "stripe-index", but was explicitly
@@ -1380,11 +1515,14 @@ static int lfs_setstripe(int argc, char **argv)
 	{ .val = 'i',	.name = "stripe_index",	.has_arg = required_argument},
 	{ .val = 'I',	.name = "comp-id",	.has_arg = required_argument},
 	{ .val = 'I',	.name = "component-id",	.has_arg = required_argument},
+	{ .val = 'L',	.name = "layout",	.has_arg = required_argument },
 	{ .val = 'm',	.name = "mdt",		.has_arg = required_argument},
 	{ .val = 'm',	.name = "mdt-index",	.has_arg = required_argument},
 	{ .val = 'm',	.name = "mdt_index",	.has_arg = required_argument},
 	/* --non-block is only valid in migrate mode */
 	{ .val = 'n',	.name = "non-block",	.has_arg = no_argument},
+	/* --mirror-count is only valid in mirror create mode */
+	{ .val = 'N',	.name = "mirror-count",	.has_arg = optional_argument},
 	{ .val = 'o',	.name = "ost",		.has_arg = required_argument},
 #if LUSTRE_VERSION_CODE < OBD_OCD_VERSION(3, 0, 53, 0)
 	{ .val = 'o',	.name = "ost-list",	.has_arg = required_argument },
@@ -1418,10 +1556,12 @@ static int lfs_setstripe(int argc, char **argv)
 
 	setstripe_args_init(&lsa);
 
-	if (strcmp(argv[0], "migrate") == 0)
+	if (opc == SO_MIGRATE)
 		migrate_mode = true;
+	else if (opc == SO_MIRROR_CREATE)
+		mirror_mode = true;
 
-	while ((c = getopt_long(argc, argv, "bc:dE:i:I:m:no:p:s:S:v",
+	while ((c = getopt_long(argc, argv, "bc:dE:i:I:L:m:nN::o:p:s:S:v",
 				long_opts, NULL)) >= 0) {
 		switch (c) {
 		case 0:
@@ -1444,6 +1584,20 @@ static int lfs_setstripe(int argc, char **argv)
 		case LFS_COMP_SET_OPT:
 			comp_set = 1;
 			break;
+		case LFS_MIRROR_FLAGS_OPT:
+			if (!mirror_mode) {
+				fprintf(stderr, "--flags is valid only for "
+					"mirror create mode\n");
+				goto error;
+			}
+			result = comp_str2flags(&mirror_flags, optarg);
+			if (result != 0 || mirror_flags & ~LCME_FL_PREFERRED) {
+				fprintf(stderr, "error: %s: bad mirror flags "
+					"'%s', only 'prefer' is supported\n",
+					argv[0], optarg);
+				goto error;
+			}
+			break;
 		case 'b':
 			if (!migrate_mode) {
 				fprintf(stderr, "--block is valid only for"
@@ -1512,6 +1666,17 @@ static int lfs_setstripe(int argc, char **argv)
 				goto error;
 			}
 			break;
+		case 'L':
+			if (strcmp(optarg, "mdt") == 0) {
+				lsa.lsa_pattern = LLAPI_LAYOUT_MDT;
+			} else if (strcmp(optarg, "raid0") == 0) {
+				lsa.lsa_pattern = LLAPI_LAYOUT_RAID0;
+			} else {
+				fprintf(stderr, "error: %s: bad layout pattern "
+					"'%s'\n", argv[0], optarg);
+				goto error;
+			}
+			break;
 		case 'm':
 			if (!migrate_mode) {
 				fprintf(stderr, "--mdt-index is valid only for"
@@ -1528,6 +1693,39 @@ static int lfs_setstripe(int argc, char **argv)
 			}
 			migration_flags |= MIGRATION_NONBLOCK;
 			break;
+		case 'N':
+			if (!mirror_mode) {
+				fprintf(stderr, "--mirror-count is valid only "
+					"for mirror create mode\n");
+				goto error;
+			}
+			if (mirror_count != 0) {
+				result = mirror_args_to_layout(&mirrors,
+							       &layout, &lsa,
+							       mirror_count,
+							       mirror_flags);
+				if (result)
+					goto error;
+			} else if (setstripe_args_specified(&lsa) ||
+				   layout != NULL) {
+				fprintf(stderr, "error: %s: -N must be given "
+					"before the options of the mirror\n",
+					argv[0]);
+				goto error;
+			}
+
+			mirror_count = 1;
+			mirror_flags = 0;
+			if (optarg != NULL) {
+				mirror_count = strtoul(optarg, &end, 0);
+				if (*end != '\0' || mirror_count == 0) {
+					fprintf(stderr, "error: %s: bad mirror "
+						"count '%s'\n", argv[0],
+						optarg);
+					goto error;
+				}
+			}
+			break;
 		case 'o':
 			lsa.lsa_nr_osts = parse_targets(osts,
 						sizeof(osts) / sizeof(__u32),
@@ -1579,7 +1777,21 @@ static int lfs_setstripe(int argc, char **argv)
 
 	fname = argv[optind];
 
-	if (lsa.lsa_comp_end != 0) {
+	if (mirror_mode) {
+		if (mirror_count == 0) {
+			fprintf(stderr, "error: %s: -N option is required\n",
+				argv[0]);
+			goto error;
+		}
+
+		result = mirror_args_to_layout(&mirrors, &layout, &lsa,
+					       mirror_count, mirror_flags);
+		if (result)
+			goto error;
+
+		layout = mirrors;
+		mirrors = NULL;
+	} else if (lsa.lsa_comp_end != 0) {
 		result = comp_args_to_layout(&layout, &lsa);
 		if (result)
 			goto error;
@@ -1600,6 +1812,13 @@ static int lfs_setstripe(int argc, char **argv)
 		goto error;
 	}
 
+	if (mirror_mode && (delete + comp_set + comp_del + comp_add) > 0) {
+		fprintf(stderr, "error: %s: can't specify -d, --component-set, "
+			"--component-del or --component-add with -N\n",
+			argv[0]);
+		goto error;
+	}
+
 	if ((delete + comp_set + comp_del + comp_add) > 1) {
 		fprintf(stderr, "error: %s: can't specify --component-set, "
 			"--component-del, --component-add or -d together\n",
@@ -1683,6 +1902,12 @@ static int lfs_setstripe(int argc, char **argv)
 		}
 		migrate_mdt_param.fp_migrate = 1;
 	} else if (layout == NULL) {
+		if (lsa.lsa_pattern == LLAPI_LAYOUT_MDT) {
+			fprintf(stderr, "error: %s: '-L mdt' needs a composite "
+				"layout with -E option\n", argv[0]);
+			goto error;
+		}
+
 		/* initialize stripe parameters */
 		param = calloc(1, offsetof(typeof(*param),
 			       lsp_osts[lsa.lsa_nr_osts]));
@@ -1770,10 +1995,18 @@ static int lfs_setstripe(int argc, char **argv)
 	llapi_layout_free(layout);
 	return result2;
 error:
+	llapi_layout_free(mirrors);
 	llapi_layout_free(layout);
 	return CMD_HELP;
 }
 
+static int lfs_setstripe(int argc, char **argv)
+{
+	return lfs_setstripe_internal(argc, argv,
+				      strcmp(argv[0], "migrate") == 0 ?
+				      SO_MIGRATE : SO_SETSTRIPE);
+}
+
 static int lfs_poollist(int argc, char **argv)
 {
         if (argc != 2)
@@ -1872,6 +2105,8 @@ static int name2layout(__u32 *layout, char *name)
 			*layout |= LOV_PATTERN_F_RELEASED;
 		else if (strcmp(lyt, "raid0") == 0)
 			*layout |= LOV_PATTERN_RAID0;
+		else if (strcmp(lyt, "mdt") == 0)
+			*layout |= LOV_PATTERN_MDT;
 		else
 			return -1;
 	}
@@ -1887,6 +2122,7 @@ static int lfs_find(int argc, char **argv)
 		.fp_max_depth = -1,
 		.fp_quiet = 1,
 	};
+	unsigned int nthreads = 1;
         struct option long_opts[] = {
 		{"atime",        required_argument, 0, 'A'},
 		{"comp-count",	 required_argument, 0, LFS_COMP_COUNT_OPT},
@@ -1924,6 +2160,7 @@ static int lfs_find(int argc, char **argv)
                 {"size",         required_argument, 0, 's'},
                 {"stripe-size",  required_argument, 0, 'S'},
                 {"stripe_size",  required_argument, 0, 'S'},
+		{"threads",	 required_argument, 0, LFS_FIND_THREADS_OPT},
                 {"type",         required_argument, 0, 't'},
 		{"mdt-count",    required_argument, 0, 'T'},
                 {"uid",          required_argument, 0, 'u'},
@@ -2264,6 +2501,15 @@ err_free:
 			param.fp_exclude_projid = !!neg_opt;
 			param.fp_check_projid = 1;
 			break;
+		case LFS_FIND_THREADS_OPT:
+			nthreads = strtoul(optarg, &endptr, 0);
+			if (*endptr != '\0' || nthreads == 0) {
+				fprintf(stderr, "error: bad threads '%s'\n",
+					optarg);
+				ret = -1;
+				goto err;
+			}
+			break;
 		case 's':
 			if (optarg[0] == '+') {
 				param.fp_size_sign = -1;
@@ -2369,7 +2615,7 @@ err_free:
         }
 
 	do {
-		rc = llapi_find(argv[pathstart], &param);
+		rc = llapi_find_parallel(argv[pathstart], &param, nthreads);
 		if (rc != 0 && ret == 0)
 			ret = rc;
 	} while (++pathstart < pathend);
@@ -4518,41 +4764,146 @@ static int lfs_ls(int argc, char **argv)
 	return 0;
 }
 
+/* Parse a comma separated list of changelog record type names or numbers */
+static int lfs_changelog_parse_types(char *list, __u32 *mask)
+{
+	char *name;
+
+	*mask = 0;
+	while ((name = strsep(&list, ",")) != NULL) {
+		char *end;
+		int type;
+
+		type = strtol(name, &end, 0);
+		if (*name == '\0' || *end != '\0') {
+			for (type = 0; type < CL_LAST; type++)
+				if (!strcasecmp(name, changelog_type2str(type)))
+					break;
+		}
+		if (type < 0 || type >= CL_LAST) {
+			fprintf(stderr, "error: unknown changelog type '%s'\n",
+				name);
+			return -EINVAL;
+		}
+		*mask |= 1U << type;
+	}
+
+	return 0;
+}
+
+static void lfs_changelog_print(struct changelog_rec *rec)
+{
+	time_t secs;
+	struct tm ts;
+
+	secs = rec->cr_time >> 30;
+	gmtime_r(&secs, &ts);
+	printf("%ju %02d%-5s %02d:%02d:%02d.%09d %04d.%02d.%02d "
+	       "0x%x t="DFID, (uintmax_t)rec->cr_index, rec->cr_type,
+	       changelog_type2str(rec->cr_type),
+	       ts.tm_hour, ts.tm_min, ts.tm_sec,
+	       (int)(rec->cr_time & ((1 << 30) - 1)),
+	       ts.tm_year + 1900, ts.tm_mon + 1, ts.tm_mday,
+	       rec->cr_flags & CLF_FLAGMASK, PFID(&rec->cr_tfid));
+
+	if (rec->cr_flags & CLF_JOBID) {
+		struct changelog_ext_jobid *jid =
+			changelog_rec_jobid(rec);
+
+		if (jid->cr_jobid[0] != '\0')
+			printf(" j=%s", jid->cr_jobid);
+	}
+
+	if (rec->cr_namelen)
+		printf(" p="DFID" %.*s", PFID(&rec->cr_pfid),
+		       rec->cr_namelen, changelog_rec_name(rec));
+
+	if (rec->cr_flags & CLF_RENAME) {
+		struct changelog_ext_rename *rnm =
+			changelog_rec_rename(rec);
+
+		if (!fid_is_zero(&rnm->cr_sfid))
+			printf(" s="DFID" sp="DFID" %.*s",
+			       PFID(&rnm->cr_sfid),
+			       PFID(&rnm->cr_spfid),
+			       (int)changelog_rec_snamelen(rec),
+			       changelog_rec_sname(rec));
+	}
+	printf("\n");
+}
+
 static int lfs_changelog(int argc, char **argv)
 {
-        void *changelog_priv;
-	struct changelog_rec *rec;
-        long long startrec = 0, endrec = 0;
-        char *mdd;
-        struct option long_opts[] = {
-                {"follow", no_argument, 0, 'f'},
-                {0, 0, 0, 0}
-        };
-        char short_opts[] = "f";
-        int rc, follow = 0;
+	void *changelog_priv;
+	struct changelog_rec *recs[64];
+	struct changelog_filter filter = { 0 };
+	long long startrec = 0, endrec = 0;
+	char *mdd;
+	struct option long_opts[] = {
+		{"follow", no_argument, 0, 'f'},
+		{"fid", required_argument, 0, 'F'},
+		{"jobid", required_argument, 0, 'j'},
+		{"type", required_argument, 0, 't'},
+		{0, 0, 0, 0}
+	};
+	char short_opts[] = "fF:j:t:";
+	bool filtered = false;
+	bool done = false;
+	int rc, follow = 0;
+	int i;
 
-        while ((rc = getopt_long(argc, argv, short_opts,
-                                long_opts, NULL)) != -1) {
-                switch (rc) {
-                case 'f':
-                        follow++;
-                        break;
-                case '?':
-                        return CMD_HELP;
-                default:
-                        fprintf(stderr, "error: %s: option '%s' unrecognized\n",
-                                argv[0], argv[optind - 1]);
-                        return CMD_HELP;
-                }
-        }
-        if (optind >= argc)
-                return CMD_HELP;
+	while ((rc = getopt_long(argc, argv, short_opts,
+				long_opts, NULL)) != -1) {
+		switch (rc) {
+		case 'f':
+			follow++;
+			break;
+		case 'F': {
+			char *fidstr = optarg;
+
+			while (*fidstr == '[')
+				fidstr++;
+			if (sscanf(fidstr, SFID, RFID(&filter.cf_fid)) != 3 ||
+			    fid_is_zero(&filter.cf_fid)) {
+				fprintf(stderr, "error: %s: bad FID '%s'\n",
+					argv[0], optarg);
+				return CMD_HELP;
+			}
+			filtered = true;
+			break;
+		}
+		case 'j':
+			if (strlen(optarg) >= sizeof(filter.cf_jobid)) {
+				fprintf(stderr, "error: %s: jobid '%s' is too "
+					"long\n", argv[0], optarg);
+				return CMD_HELP;
+			}
+			strncpy(filter.cf_jobid, optarg,
+				sizeof(filter.cf_jobid));
+			filtered = true;
+			break;
+		case 't':
+			if (lfs_changelog_parse_types(optarg,
+						      &filter.cf_mask) < 0)
+				return CMD_HELP;
+			filtered = true;
+			break;
+		case '?':
+			return CMD_HELP;
+		default:
+			fprintf(stderr, "error: %s: option '%s' unrecognized\n",
+				argv[0], argv[optind - 1]);
+			return CMD_HELP;
+		}
+	}
+	if (optind >= argc)
+		return CMD_HELP;
 
-        mdd = argv[optind++];
-        if (argc > optind)
-                startrec = strtoll(argv[optind++], NULL, 10);
-        if (argc > optind)
-                endrec = strtoll(argv[optind++], NULL, 10);
+	mdd = argv[optind++];
+	if (argc > optind)
+		startrec = strtoll(argv[optind++], NULL, 10);
+	if (argc > optind)
+		endrec = strtoll(argv[optind++], NULL, 10);
 
 	rc = llapi_changelog_start(&changelog_priv,
 				   CHANGELOG_FLAG_BLOCK |
@@ -4565,63 +4916,35 @@ static int lfs_changelog(int argc, char **argv)
 		return rc;
 	}
 
-	while ((rc = llapi_changelog_recv(changelog_priv, &rec)) == 0) {
-		time_t secs;
-		struct tm ts;
-
-		if (endrec && rec->cr_index > endrec) {
-			llapi_changelog_free(&rec);
-			break;
-		}
-		if (rec->cr_index < startrec) {
-			llapi_changelog_free(&rec);
-			continue;
-		}
-
-		secs = rec->cr_time >> 30;
-		gmtime_r(&secs, &ts);
-		printf("%ju %02d%-5s %02d:%02d:%02d.%09d %04d.%02d.%02d "
-		       "0x%x t="DFID, (uintmax_t)rec->cr_index, rec->cr_type,
-		       changelog_type2str(rec->cr_type),
-		       ts.tm_hour, ts.tm_min, ts.tm_sec,
-		       (int)(rec->cr_time & ((1 << 30) - 1)),
-		       ts.tm_year + 1900, ts.tm_mon + 1, ts.tm_mday,
-		       rec->cr_flags & CLF_FLAGMASK, PFID(&rec->cr_tfid));
-
-		if (rec->cr_flags & CLF_JOBID) {
-			struct changelog_ext_jobid *jid =
-				changelog_rec_jobid(rec);
-
-			if (jid->cr_jobid[0] != '\0')
-				printf(" j=%s", jid->cr_jobid);
+	if (filtered) {
+		rc = llapi_changelog_set_filter(changelog_priv, &filter);
+		if (rc < 0) {
+			fprintf(stderr, "Can't filter changelog: %s\n",
+				strerror(errno = -rc));
+			llapi_changelog_fini(&changelog_priv);
+			return rc;
 		}
+	}
 
-		if (rec->cr_namelen)
-			printf(" p="DFID" %.*s", PFID(&rec->cr_pfid),
-			       rec->cr_namelen, changelog_rec_name(rec));
-
-		if (rec->cr_flags & CLF_RENAME) {
-			struct changelog_ext_rename *rnm =
-				changelog_rec_rename(rec);
+	while (!done &&
+	       (rc = llapi_changelog_recv_batch(changelog_priv, recs,
+						ARRAY_SIZE(recs))) > 0) {
+		for (i = 0; i < rc; i++) {
+			if (endrec && recs[i]->cr_index > endrec)
+				done = true;
+			if (!done && recs[i]->cr_index >= startrec)
+				lfs_changelog_print(recs[i]);
 
-			if (!fid_is_zero(&rnm->cr_sfid))
-				printf(" s="DFID" sp="DFID" %.*s",
-				       PFID(&rnm->cr_sfid),
-				       PFID(&rnm->cr_spfid),
-				       (int)changelog_rec_snamelen(rec),
-				       changelog_rec_sname(rec));
+			llapi_changelog_free(&recs[i]);
 		}
-		printf("\n");
-
-		llapi_changelog_free(&rec);
-        }
+	}
 
-        llapi_changelog_fini(&changelog_priv);
+	llapi_changelog_fini(&changelog_priv);
 
-        if (rc < 0)
-                fprintf(stderr, "Changelog: %s\n", strerror(errno = -rc));
+	if (rc < 0)
+		fprintf(stderr, "Changelog: %s\n", strerror(errno = -rc));
 
-        return (rc == 1 ? 0 : rc);
+	return rc < 0 ? rc : 0;
 }
 
 static int lfs_changelog_clear(int argc, char **argv)
@@ -4899,6 +5222,8 @@ static int lfs_hsm_state(int argc, char **argv)
 			printf(" never_archive");
 		if (hus.hus_states & HS_LOST)
 			printf(" lost_from_hsm");
+		if (hus.hus_states & HS_PCCRO)
+			printf(" pcc_readonly");
 
 		if (hus.hus_archive_id != 0)
 			printf(", archive_id:%d", hus.hus_archive_id);
@@ -5368,6 +5693,79 @@ static int lfs_hsm_cancel(int argc, char **argv)
 	return lfs_hsm_request(argc, argv, HUA_CANCEL);
 }
 
+static int lfs_pcc_attach(int argc, char **argv)
+{
+	int rc = 0;
+	int rc2;
+	int i;
+
+	if (argc < 2)
+		return CMD_HELP;
+
+	for (i = 1; i < argc; i++) {
+		rc2 = llapi_pcc_attach(argv[i]);
+		if (rc2 < 0) {
+			fprintf(stderr, "%s: cannot attach '%s' to PCC: %s\n",
+				progname, argv[i], strerror(-rc2));
+			if (rc == 0)
+				rc = rc2;
+		}
+	}
+
+	return rc;
+}
+
+static int lfs_pcc_detach(int argc, char **argv)
+{
+	int rc = 0;
+	int rc2;
+	int i;
+
+	if (argc < 2)
+		return CMD_HELP;
+
+	for (i = 1; i < argc; i++) {
+		rc2 = llapi_pcc_detach(argv[i]);
+		if (rc2 < 0) {
+			fprintf(stderr, "%s: cannot detach '%s' from PCC: %s\n",
+				progname, argv[i], strerror(-rc2));
+			if (rc == 0)
+				rc = rc2;
+		}
+	}
+
+	return rc;
+}
+
+static int lfs_pcc_state(int argc, char **argv)
+{
+	struct lu_pcc_state state;
+	int rc = 0;
+	int rc2;
+	int i;
+
+	if (argc < 2)
+		return CMD_HELP;
+
+	for (i = 1; i < argc; i++) {
+		rc2 = llapi_pcc_state_get(argv[i], &state);
+		if (rc2 < 0) {
+			fprintf(stderr, "%s: cannot get PCC state of '%s': %s\n",
+				progname, argv[i], strerror(-rc2));
+			if (rc == 0)
+				rc = rc2;
+			continue;
+		}
+
+		if (state.pccs_state & PCC_STATE_READONLY)
+			printf("%s: readonly, %s\n", argv[i], state.pccs_path);
+		else
+			printf("%s: none\n", argv[i]);
+	}
+
+	return rc;
+}
+
 static int lfs_swap_layouts(int argc, char **argv)
 {
 	if (argc != 3)
@@ -5379,6 +5777,21 @@ static int lfs_swap_layouts(int argc, char **argv)
 }
 
 static const char *const ladvise_names[] = LU_LADVISE_NAMES;
+static const char *const lock_mode_names[] = LOCK_MODE_NAMES;
+
+static int lfs_get_mode(const char *string)
+{
+	enum lock_mode_user mode;
+
+	for (mode = 0; mode < ARRAY_SIZE(lock_mode_names); mode++) {
+		if (lock_mode_names[mode] == NULL)
+			continue;
+		if (strcasecmp(string, lock_mode_names[mode]) == 0)
+			return mode;
+	}
+
+	return -EINVAL;
+}
 
 static enum lu_ladvise_type lfs_get_ladvice(const char *string)
 {
@@ -5403,9 +5816,10 @@ static int lfs_ladvise(int argc, char **argv)
 		{"end",		required_argument,	0, 'e'},
 		{"start",	required_argument,	0, 's'},
 		{"length",	required_argument,	0, 'l'},
+		{"mode",	required_argument,	0, 'm'},
 		{0, 0, 0, 0}
 	};
-	char			 short_opts[] = "a:be:l:s:";
+	char			 short_opts[] = "a:be:l:m:s:";
 	int			 c;
 	int			 rc = 0;
 	const char		*path;
@@ -5417,6 +5831,7 @@ static int lfs_ladvise(int argc, char **argv)
 	unsigned long long	 length = 0;
 	unsigned long long	 size_units;
 	unsigned long long	 flags = 0;
+	int			 mode = 0;
 
 	optind = 0;
 	while ((c = getopt_long(argc, argv, short_opts,
@@ -5475,6 +5890,15 @@ static int lfs_ladvise(int argc, char **argv)
 				return CMD_HELP;
 			}
 			break;
+		case 'm':
+			mode = lfs_get_mode(optarg);
+			if (mode < 0) {
+				fprintf(stderr, "%s: bad mode '%s', valid "
+					"modes are READ or WRITE\n",
+					argv[0], optarg);
+				return CMD_HELP;
+			}
+			break;
 		case '?':
 			return CMD_HELP;
 		default:
@@ -5497,6 +5921,31 @@ static int lfs_ladvise(int argc, char **argv)
 		return CMD_HELP;
 	}
 
+	if (advice_type == LU_LADVISE_LOCKNOEXPAND) {
+		fprintf(stderr, "%s: lock no expand is an advice on a file "
+			"descriptor, it has no effect when given by lfs\n",
+			argv[0]);
+		return CMD_HELP;
+	}
+
+	if (advice_type == LU_LADVISE_LOCKAHEAD && mode == 0) {
+		fprintf(stderr, "%s: please give a mode for the lockahead "
+			"advice: READ or WRITE\n", argv[0]);
+		return CMD_HELP;
+	}
+
+	if (advice_type != LU_LADVISE_LOCKAHEAD && mode != 0) {
+		fprintf(stderr, "%s: mode is only valid with the lockahead "
+			"advice\n", argv[0]);
+		return CMD_HELP;
+	}
+
+	if (advice_type == LU_LADVISE_LOCKAHEAD && (flags & LF_ASYNC)) {
+		fprintf(stderr, "%s: lockahead requests are always "
+			"asynchronous, --background is not valid\n", argv[0]);
+		return CMD_HELP;
+	}
+
 	if (argc <= optind) {
 		fprintf(stderr, "%s: please give one or more file names\n",
 			argv[0]);
@@ -5538,6 +5987,8 @@ static int lfs_ladvise(int argc, char **argv)
 		advice.lla_value2 = 0;
 		advice.lla_value3 = 0;
 		advice.lla_value4 = 0;
+		if (advice_type == LU_LADVISE_LOCKAHEAD)
+			advice.lla_lockahead_mode = mode;
 		rc2 = llapi_ladvise(fd, flags, 1, &advice);
 		close(fd);
 		if (rc2 < 0) {
@@ -5545,6 +5996,12 @@ static int lfs_ladvise(int argc, char **argv)
 				"'%s': %s\n", argv[0],
 				ladvise_names[advice_type],
 				path, strerror(errno));
+		} else if (advice_type == LU_LADVISE_LOCKAHEAD &&
+			   (int)advice.lla_lockahead_result < 0) {
+			rc2 = (int)advice.lla_lockahead_result;
+			fprintf(stderr, "%s: cannot request lock ahead on "
+				"file '%s': %s\n", argv[0], path,
+				strerror(-rc2));
 		}
 next:
 		if (rc == 0 && rc2 < 0)
@@ -5553,6 +6010,358 @@ next:
 	return rc;
 }
 
+/* size of the buffer used to copy the data between mirrors */
+#define MIRROR_RESYNC_BUF_SIZE	(4 << 20)
+
+/* a component of a mirrored file, as seen by lfs mirror resync */
+struct mirror_comp {
+	unsigned int	mc_mirror_id;
+	__u32		mc_flags;
+	uint64_t	mc_start;
+	uint64_t	mc_end;
+};
+
+/**
+ * Fetch the components of the file open on \a fd into \a comps, with the
+ * id of the mirror each belongs to. Mirror ids start at 1.
+ *
+ * \retval	number of components on success
+ * \retval	-errno on error
+ */
+static int mirror_comps_get(int fd, struct mirror_comp **comps)
+{
+	struct llapi_layout *layout;
+	struct mirror_comp *array = NULL;
+	unsigned int mirror_id = 0;
+	int count = 0;
+	int rc;
+
+	layout = llapi_layout_get_by_fd(fd, 0);
+	if (layout == NULL)
+		return -errno;
+
+	rc = llapi_layout_comp_use(layout, LLAPI_LAYOUT_COMP_USE_FIRST);
+	while (rc == 0) {
+		struct mirror_comp *mc;
+
+		mc = realloc(array, (count + 1) * sizeof(*array));
+		if (mc == NULL) {
+			rc = -ENOMEM;
+			break;
+		}
+		array = mc;
+		mc = &array[count];
+
+		rc = llapi_layout_comp_extent_get(layout, &mc->mc_start,
+						  &mc->mc_end);
+		if (rc == 0)
+			rc = llapi_layout_comp_flags_get(layout,
+							 &mc->mc_flags);
+		if (rc < 0) {
+			rc = -errno;
+			break;
+		}
+
+		if (mc->mc_start == 0)
+			mirror_id++;
+		mc->mc_mirror_id = mirror_id;
+		count++;
+
+		rc = llapi_layout_comp_use(layout, LLAPI_LAYOUT_COMP_USE_NEXT);
+	}
+	llapi_layout_free(layout);
+
+	if (rc < 0) {
+		free(array);
+		return rc;
+	}
+
+	*comps = array;
+	return count;
+}
+
+/**
+ * Find a mirror which is up to date over [\a start, \a end).
+ *
+ * \retval	the mirror id if one is found
+ * \retval	0 otherwise
+ */
+static unsigned int mirror_find_valid(struct mirror_comp *comps, int count,
+				      uint64_t start, uint64_t end)
+{
+	unsigned int id;
+	int i;
+
+	for (id = 1; id <= comps[count - 1].mc_mirror_id; id++) {
+		bool valid = true;
+
+		for (i = 0; i < count; i++) {
+			if (comps[i].mc_mirror_id != id ||
+			    comps[i].mc_end <= start ||
+			    comps[i].mc_start >= end)
+				continue;
+
+			if (comps[i].mc_flags & LCME_FL_STALE) {
+				valid = false;
+				break;
+			}
+		}
+		if (valid)
+			return id;
+	}
+
+	return 0;
+}
+
+/**
+ * Copy [\a start, \a end) of mirror \a src to mirror \a dst, with direct
+ * I/O on the file open on \a fd. The length written is rounded up to the
+ * page size, the size of \a dst is set by the caller afterwards.
+ */
+static int mirror_copy_data(int fd, unsigned int src, unsigned int dst,
+			    uint64_t start, uint64_t end, const char *fname)
+{
+	size_t page_size = getpagesize();
+	void *buf = NULL;
+	uint64_t pos = start;
+	int rc;
+
+	/* Use a page-aligned buffer for direct I/O */
+	rc = posix_memalign(&buf, page_size, MIRROR_RESYNC_BUF_SIZE);
+	if (rc != 0)
+		return -rc;
+
+	while (pos < end) {
+		size_t count = MIRROR_RESYNC_BUF_SIZE;
+		ssize_t rsize;
+		ssize_t wsize;
+
+		if (end - pos < count)
+			count = (end - pos + page_size - 1) & ~(page_size - 1);
+
+		/* stop as soon as somebody else opened the file */
+		if (llapi_lease_check(fd) <= 0) {
+			fprintf(stderr, "%s: cannot resync '%s': file busy\n",
+				progname, fname);
+			rc = -EBUSY;
+			break;
+		}
+
+		rc = ioctl(fd, LL_IOC_FLR_SET_MIRROR, src);
+		if (rc < 0) {
+			rc = -errno;
+			break;
+		}
+
+		rsize = pread(fd, buf, count, pos);
+		if (rsize < 0) {
+			rc = -errno;
+			fprintf(stderr, "%s: %s: read mirror %u failed: %s\n",
+				progname, fname, src, strerror(-rc));
+			break;
+		}
+		if (rsize == 0)
+			break;
+
+		/* direct I/O writes whole pages, the tail is zeroed */
+		count = (rsize + page_size - 1) & ~(page_size - 1);
+		memset(buf + rsize, 0, count - rsize);
+
+		rc = ioctl(fd, LL_IOC_FLR_SET_MIRROR, dst);
+		if (rc < 0) {
+			rc = -errno;
+			break;
+		}
+
+		wsize = pwrite(fd, buf, count, pos);
+		if (wsize < 0) {
+			rc = -errno;
+			fprintf(stderr, "%s: %s: write mirror %u failed: %s\n",
+				progname, fname, dst, strerror(-rc));
+			break;
+		}
+		if (wsize != count) {
+			rc = -EIO;
+			fprintf(stderr, "%s: %s: short write to mirror %u\n",
+				progname, fname, dst);
+			break;
+		}
+
+		pos += rsize;
+	}
+
+	free(buf);
+	return rc;
+}
+
+static int lfs_mirror_resync_file(const char *fname)
+{
+	struct mirror_comp *comps = NULL;
+	struct stat st;
+	unsigned int mirror_id;
+	bool stale = false;
+	int count;
+	int fd;
+	int rc;
+	int i;
+
+	fd = open(fname, O_RDWR | O_DIRECT);
+	if (fd < 0) {
+		rc = -errno;
+		fprintf(stderr, "%s: cannot open '%s': %s\n",
+			progname, fname, strerror(-rc));
+		return rc;
+	}
+
+	/* the write lease is broken by any other open of the file, which
+	 * is checked before each copy and by the final resync done */
+	rc = llapi_lease_get(fd, LL_LEASE_WRLCK);
+	if (rc < 0) {
+		fprintf(stderr, "%s: cannot get lease on '%s': %s\n",
+			progname, fname, strerror(-rc));
+		goto out;
+	}
+
+	/* instantiate the stale components to copy the data to */
+	rc = llapi_lease_resync(fd);
+	if (rc < 0)
+		goto out_lease;
+
+	count = mirror_comps_get(fd, &comps);
+	if (count <= 0) {
+		rc = count < 0 ? count : -ENODATA;
+		fprintf(stderr, "%s: cannot get layout of '%s': %s\n",
+			progname, fname, strerror(-rc));
+		goto out_lease;
+	}
+
+	for (i = 0; i < count; i++)
+		if (comps[i].mc_flags & LCME_FL_STALE)
+			stale = true;
+	if (!stale) {
+		/* nothing was written since the last resync */
+		rc = 0;
+		goto out_lease;
+	}
+
+	if (fstat(fd, &st) < 0) {
+		rc = -errno;
+		goto out_lease;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct mirror_comp *mc = &comps[i];
+		uint64_t end = mc->mc_end;
+		unsigned int src;
+
+		if (!(mc->mc_flags & LCME_FL_STALE))
+			continue;
+
+		if (mc->mc_start >= st.st_size)
+			continue;
+		if (end > st.st_size)
+			end = st.st_size;
+
+		src = mirror_find_valid(comps, count, mc->mc_start, end);
+		if (src == 0) {
+			rc = -ENODATA;
+			fprintf(stderr, "%s: %s: no up to date mirror for "
+				"[%llu, %llu)\n", progname, fname,
+				(unsigned long long)mc->mc_start,
+				(unsigned long long)end);
+			goto out_lease;
+		}
+
+		rc = mirror_copy_data(fd, src, mc->mc_mirror_id,
+				      mc->mc_start, end, fname);
+		if (rc < 0)
+			goto out_lease;
+	}
+
+	/* drop the padding written past EOF, and any data left there by
+	 * a truncate while the mirror was stale */
+	for (mirror_id = 0, i = 0; i < count; i++) {
+		if (!(comps[i].mc_flags & LCME_FL_STALE) ||
+		    comps[i].mc_mirror_id == mirror_id)
+			continue;
+
+		mirror_id = comps[i].mc_mirror_id;
+		rc = ioctl(fd, LL_IOC_FLR_SET_MIRROR, mirror_id);
+		if (rc == 0)
+			rc = ftruncate(fd, st.st_size);
+		if (rc < 0) {
+			rc = -errno;
+			fprintf(stderr, "%s: %s: cannot set size of mirror "
+				"%u: %s\n", progname, fname, mirror_id,
+				strerror(-rc));
+			goto out_lease;
+		}
+	}
+
+	rc = ioctl(fd, LL_IOC_FLR_SET_MIRROR, 0);
+	if (rc < 0) {
+		rc = -errno;
+		goto out_lease;
+	}
+
+	rc = llapi_lease_resync_done(fd);
+	if (rc == -EBUSY)
+		fprintf(stderr, "%s: '%s' was opened during resync, try "
+			"again\n", progname, fname);
+	/* the lease is gone, whatever the result */
+	goto out;
+
+out_lease:
+	llapi_lease_put(fd);
+out:
+	free(comps);
+	close(fd);
+	return rc;
+}
+
+static int lfs_mirror_create(int argc, char **argv)
+{
+	return lfs_setstripe_internal(argc, argv, SO_MIRROR_CREATE);
+}
+
+static int lfs_mirror_resync(int argc, char **argv)
+{
+	int rc = 0;
+	int rc2;
+	int i;
+
+	if (argc < 2)
+		return CMD_HELP;
+
+	for (i = 1; i < argc; i++) {
+		rc2 = lfs_mirror_resync_file(argv[i]);
+		if (rc2 < 0 && rc == 0)
+			rc = rc2;
+	}
+
+	return rc;
+}
+
+static command_t mirror_cmdlist[] = {
+	{"create", lfs_mirror_create, 0,
+	 "Create a mirrored file.\n"
+	 "usage: mirror create <--mirror-count|-N[mirror_count]>\n"
+	 "                     [--flags prefer] [setstripe options] ...\n"
+	 "                     <filename>\n"},
+	{"resync", lfs_mirror_resync, 0,
+	 "Resynchronize the stale mirrors of files.\n"
+	 "usage: mirror resync <filename> ...\n"},
+	{ 0, 0, 0, NULL }
+};
+
+static int lfs_mirror(int argc, char **argv)
+{
+	if (argc < 2)
+		return CMD_HELP;
+
+	return Parser_execarg(argc - 1, argv + 1, mirror_cmdlist);
+}
+
 static int lfs_list_commands(int argc, char **argv)
 {
 	char buffer[81] = ""; /* 80 printable chars + terminating NUL */
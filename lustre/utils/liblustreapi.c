@@ -1399,12 +1399,9 @@ err:
 	return rc;
 }
 
-typedef int (semantic_func_t)(char *path, DIR *parent, DIR **d,
-			      void *data, struct dirent64 *de);
-
 #define OBD_NOT_FOUND           (-1)
 
-static int common_param_init(struct find_param *param, char *path)
+int common_param_init(struct find_param *param, char *path)
 {
 	int lum_size = get_mds_md_size(path);
 
@@ -1440,7 +1437,7 @@ static int common_param_init(struct find_param *param, char *path)
 	return 0;
 }
 
-static void find_param_fini(struct find_param *param)
+void find_param_fini(struct find_param *param)
 {
 	if (param->fp_obd_indexes)
 		free(param->fp_obd_indexes);
@@ -2334,7 +2331,11 @@ static void lov_dump_user_lmm_header(struct lov_user_md *lum, char *path,
 		if (verbose & ~VERBOSE_LAYOUT)
 			llapi_printf(LLAPI_MSG_NORMAL, "%s%spattern:       ",
 				     space, prefix);
-		llapi_printf(LLAPI_MSG_NORMAL, "%.x", lum->lmm_pattern);
+		if (lov_pattern(lum->lmm_pattern) == LOV_PATTERN_MDT)
+			llapi_printf(LLAPI_MSG_NORMAL, "mdt");
+		else
+			llapi_printf(LLAPI_MSG_NORMAL, "%.x",
+				     lum->lmm_pattern);
 		separator = "\n";
 	}
 
@@ -2612,6 +2613,14 @@ static void lov_dump_comp_v1_header(struct find_param *param, char *path,
 		llapi_printf(LLAPI_MSG_NORMAL, "%u\n",
 			     comp_v1->lcm_magic == LOV_USER_MAGIC_COMP_V1 ?
 			     comp_v1->lcm_entry_count : 0);
+
+		/* the mirrors of a file are only shown in the full output */
+		if (verbose & ~VERBOSE_COMP_COUNT &&
+		    comp_v1->lcm_magic == LOV_USER_MAGIC_COMP_V1 &&
+		    comp_v1->lcm_mirror_count > 1)
+			llapi_printf(LLAPI_MSG_NORMAL,
+				     "%2slcm_mirror_count: %u\n", " ",
+				     comp_v1->lcm_mirror_count);
 	}
 
 	if (verbose & VERBOSE_DETAIL && !yaml)
@@ -3588,8 +3597,8 @@ static int fget_projid(int fd, int *projid)
 	return 0;
 }
 
-static int cb_find_init(char *path, DIR *parent, DIR **dirp,
-			void *data, struct dirent64 *de)
+int cb_find_init(char *path, DIR *parent, DIR **dirp, void *data,
+		 struct dirent64 *de)
 {
 	struct find_param *param = (struct find_param *)data;
 	DIR *dir = dirp == NULL ? NULL : *dirp;
@@ -3930,13 +3939,11 @@ obd_matches:
 					  param->fp_exclude_size,
 					  param->fp_size_units, 0);
 
-	if (decision != -1) {
-		llapi_printf(LLAPI_MSG_NORMAL, "%s", path);
-		if (param->fp_zero_end)
-			llapi_printf(LLAPI_MSG_NORMAL, "%c", '\0');
-		else
-			llapi_printf(LLAPI_MSG_NORMAL, "\n");
-	}
+	/* Print the name and its terminator in a single call, so that the
+	 * lines do not interleave when several threads are searching. */
+	if (decision != -1)
+		llapi_printf(LLAPI_MSG_NORMAL, "%s%c", path,
+			     param->fp_zero_end ? '\0' : '\n');
 
 decided:
 	ret = 0;
@@ -34,10 +34,12 @@
 #include <unistd.h>
 #include <errno.h>
 #include <poll.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include <lustre/lustreapi.h>
+#include <linux/lustre_ioctl.h>
 
 
 static int chlg_dev_path(char *path, size_t path_len, const char *device)
@@ -55,7 +57,7 @@ static int chlg_dev_path(char *path, size_t path_len, const char *device)
 }
 
 #define CHANGELOG_PRIV_MAGIC 0xCA8E1080
-#define CHANGELOG_BUFFER_SZ  4096
+#define CHANGELOG_BUFFER_SZ  65536
 
 /**
  * Record state for efficient changelog consumption.
@@ -259,6 +261,109 @@ out_free:
 	return rc;
 }
 
+/**
+ * Read up to \a count changelog entries at once, as many as the kernel has
+ * ready, so that consumers do not pay a system call and a maximum sized
+ * allocation for each record. Each record is released by
+ * llapi_changelog_free().
+ *
+ * @param priv   Opaque private control structure
+ * @param rechs  Array of \a count records handles, filled in
+ * @param count  Maximum number of records to receive
+ * @return number of records received, 0 at EOF, <0 error code
+ */
+int llapi_changelog_recv_batch(void *priv, struct changelog_rec **rechs,
+			       int count)
+{
+	struct changelog_private *cp = priv;
+	enum changelog_rec_flags rec_fmt = DEFAULT_RECORD_FMT;
+	int nr = 0;
+
+	if (!cp || (cp->clp_magic != CHANGELOG_PRIV_MAGIC))
+		return -EINVAL;
+
+	if (rechs == NULL || count <= 0)
+		return -EINVAL;
+
+	if (cp->clp_send_flags & CHANGELOG_FLAG_JOBID)
+		rec_fmt |= CLF_JOBID;
+
+	while (nr < count) {
+		struct changelog_rec *tmp;
+		size_t len;
+		size_t size;
+
+		if (cp->clp_buf + cp->clp_buf_len <= cp->clp_buf_pos) {
+			ssize_t refresh;
+
+			/* Only wait for new records if there are none yet */
+			if (nr > 0)
+				break;
+
+			refresh = chlg_read_bulk(cp);
+			if (refresh == 0)
+				break;
+			else if (refresh < 0)
+				return refresh;
+		}
+
+		tmp = (struct changelog_rec *)cp->clp_buf_pos;
+		len = changelog_rec_size(tmp) + tmp->cr_namelen;
+
+		/* the record is remapped in place, make room for both */
+		size = changelog_rec_offset(rec_fmt) + tmp->cr_namelen;
+		if (size < len)
+			size = len;
+
+		rechs[nr] = malloc(size);
+		if (rechs[nr] == NULL) {
+			while (nr > 0)
+				llapi_changelog_free(&rechs[--nr]);
+			return -ENOMEM;
+		}
+
+		memcpy(rechs[nr], tmp, len);
+		cp->clp_buf_pos += len;
+		changelog_remap_rec(rechs[nr], rec_fmt);
+		nr++;
+	}
+
+	return nr;
+}
+
+/**
+ * Only deliver the changelog records matching \a filter to this reader.
+ * The records are filtered by the kernel before they are copied to userland,
+ * so this should be called before receiving the first records.
+ *
+ * @param priv    Opaque private control structure
+ * @param filter  Record types mask, FID and jobid to match, zeroed fields
+ *		  are not checked
+ * @return 0 on success, <0 error code
+ */
+int llapi_changelog_set_filter(void *priv,
+			       const struct changelog_filter *filter)
+{
+	struct changelog_private *cp = priv;
+	int rc;
+
+	if (!cp || (cp->clp_magic != CHANGELOG_PRIV_MAGIC))
+		return -EINVAL;
+
+	if (filter == NULL)
+		return -EINVAL;
+
+	/* Records read before the filter was set would not be filtered */
+	if (cp->clp_buf + cp->clp_buf_len > cp->clp_buf_pos)
+		return -EBUSY;
+
+	rc = ioctl(cp->clp_fd, OBD_IOC_CHLG_SET_FILTER, filter);
+	if (rc < 0)
+		return -errno;
+
+	return 0;
+}
+
 /** Release the changelog record when done with it. */
 int llapi_changelog_free(struct changelog_rec **rech)
 {
@@ -27,6 +27,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <stdbool.h>
 #include <sys/time.h>
@@ -76,9 +77,18 @@ int llapi_ladvise(int fd, unsigned long long flags, int num_advise,
 
 	rc = ioctl(fd, LL_IOC_LADVISE, ladvise_hdr);
 	if (rc < 0) {
-		llapi_error(LLAPI_MSG_ERROR, -errno, "cannot give advice");
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "cannot give advice");
+		free(ladvise_hdr);
+		errno = -rc;
 		return -1;
 	}
+
+	/* Copy results back in to caller provided structs, e.g. the result
+	 * of each lock ahead request */
+	memcpy(ladvise, ladvise_hdr->lah_advise, sizeof(*ladvise) * num_advise);
+	free(ladvise_hdr);
+
 	return 0;
 }
 
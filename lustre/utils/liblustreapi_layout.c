@@ -136,6 +136,7 @@ llapi_layout_swab_lov_user_md(struct lov_user_md *lum, int lum_size)
 		__swab32s(&comp_v1->lcm_layout_gen);
 		__swab16s(&comp_v1->lcm_flags);
 		__swab16s(&comp_v1->lcm_entry_count);
+		__swab16s(&comp_v1->lcm_mirror_count);
 		ent_count = comp_v1->lcm_entry_count;
 	} else {
 		ent_count = 1;
@@ -422,6 +423,8 @@ llapi_layout_from_lum(const struct lov_user_md *lum, int lum_size)
 
 		if (v1->lmm_pattern == LOV_PATTERN_RAID0)
 			comp->llc_pattern = LLAPI_LAYOUT_RAID0;
+		else if (v1->lmm_pattern == LOV_PATTERN_MDT)
+			comp->llc_pattern = LLAPI_LAYOUT_MDT;
 		else
 			/* Lustre only supports RAID0 for now. */
 			comp->llc_pattern = v1->lmm_pattern;
@@ -502,9 +505,14 @@ llapi_layout_to_lum(const struct llapi_layout *layout)
 	/* Allocate header of lov_comp_md_v1 if necessary */
 	if (layout->llot_is_composite) {
 		int comp_cnt = 0;
+		int mirror_cnt = 1;
 
-		list_for_each_entry(comp, &layout->llot_comp_list, llc_list)
+		list_for_each_entry(comp, &layout->llot_comp_list, llc_list) {
+			/* a component back at 0 starts a new mirror */
+			if (comp_cnt > 0 && comp->llc_extent.e_start == 0)
+				mirror_cnt++;
 			comp_cnt++;
+		}
 
 		lum_size = sizeof(*comp_v1) + comp_cnt * sizeof(*ent);
 		lum = malloc(lum_size);
@@ -518,6 +526,10 @@ llapi_layout_to_lum(const struct llapi_layout *layout)
 		comp_v1->lcm_layout_gen = 0;
 		comp_v1->lcm_flags = 0;
 		comp_v1->lcm_entry_count = comp_cnt;
+		comp_v1->lcm_mirror_count = mirror_cnt > 1 ? mirror_cnt : 0;
+		memset(comp_v1->lcm_padding1, 0,
+		       sizeof(comp_v1->lcm_padding1));
+		comp_v1->lcm_padding2 = 0;
 		offset += lum_size;
 	}
 
@@ -570,6 +582,8 @@ llapi_layout_to_lum(const struct llapi_layout *layout)
 			blob->lmm_pattern = 0;
 		else if (pattern == LLAPI_LAYOUT_RAID0)
 			blob->lmm_pattern = LOV_PATTERN_RAID0;
+		else if (pattern == LLAPI_LAYOUT_MDT)
+			blob->lmm_pattern = LOV_PATTERN_MDT;
 		else
 			blob->lmm_pattern = pattern;
 
@@ -1225,7 +1239,7 @@ int llapi_layout_pattern_set(struct llapi_layout *layout, uint64_t pattern)
 		return -1;
 
 	if (pattern != LLAPI_LAYOUT_DEFAULT &&
-	    pattern != LLAPI_LAYOUT_RAID0) {
+	    pattern != LLAPI_LAYOUT_RAID0 && pattern != LLAPI_LAYOUT_MDT) {
 		errno = EOPNOTSUPP;
 		return -1;
 	}
@@ -1737,6 +1751,100 @@ int llapi_layout_comp_add(struct llapi_layout *layout)
 	return 0;
 }
 
+/**
+ * Appends the components of \a src_layout to \a dst_layout as a new
+ * mirror of the file. Both layouts have to cover the whole file, from 0 to
+ * EOF. If \a *dst_layout is NULL, it is set to a copy of \a src_layout.
+ * The current component of \a dst_layout becomes the last component added.
+ *
+ * \param[in,out] dst_layout	layout to add the mirror to
+ * \param[in] src_layout	layout of the new mirror
+ *
+ * \retval	0 on success
+ * \retval	-1 on error with errno set
+ */
+int llapi_layout_merge(struct llapi_layout **dst_layout,
+		       const struct llapi_layout *src_layout)
+{
+	struct llapi_layout *new_layout = *dst_layout;
+	struct llapi_layout_comp *comp, *new = NULL, *n;
+	struct list_head new_comps;
+	uint64_t prev_end = 0;
+
+	if (src_layout == NULL ||
+	    list_empty((struct list_head *)&src_layout->llot_comp_list)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (new_layout != NULL) {
+		comp = list_entry(new_layout->llot_comp_list.prev,
+				  typeof(*comp), llc_list);
+		if (comp->llc_extent.e_end != LUSTRE_EOF) {
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	INIT_LIST_HEAD(&new_comps);
+	list_for_each_entry(comp, &src_layout->llot_comp_list, llc_list) {
+		if (comp->llc_extent.e_start != prev_end) {
+			errno = EINVAL;
+			goto error;
+		}
+
+		new = __llapi_comp_alloc(0);
+		if (new == NULL)
+			goto error;
+
+		if (__llapi_comp_objects_realloc(new,
+					comp->llc_objects_count) < 0) {
+			__llapi_comp_free(new);
+			goto error;
+		}
+		if (comp->llc_objects_count > 0)
+			memcpy(new->llc_objects, comp->llc_objects,
+			       sizeof(*new->llc_objects) *
+			       comp->llc_objects_count);
+
+		new->llc_pattern = comp->llc_pattern;
+		new->llc_stripe_size = comp->llc_stripe_size;
+		new->llc_stripe_count = comp->llc_stripe_count;
+		new->llc_stripe_offset = comp->llc_stripe_offset;
+		strncpy(new->llc_pool_name, comp->llc_pool_name,
+			sizeof(new->llc_pool_name));
+		new->llc_extent = comp->llc_extent;
+		new->llc_flags = comp->llc_flags & ~LCME_FL_INIT;
+		list_add_tail(&new->llc_list, &new_comps);
+
+		prev_end = comp->llc_extent.e_end;
+	}
+
+	if (prev_end != LUSTRE_EOF) {
+		errno = EINVAL;
+		goto error;
+	}
+
+	if (new_layout == NULL) {
+		new_layout = __llapi_layout_alloc();
+		if (new_layout == NULL)
+			goto error;
+		*dst_layout = new_layout;
+	}
+
+	list_splice_tail(&new_comps, &new_layout->llot_comp_list);
+	new_layout->llot_cur_comp = new;
+	new_layout->llot_is_composite = true;
+
+	return 0;
+error:
+	list_for_each_entry_safe(comp, n, &new_comps, llc_list) {
+		list_del_init(&comp->llc_list);
+		__llapi_comp_free(comp);
+	}
+	return -1;
+}
+
 /**
  * Deletes current component from the composite layout. The component
  * to be deleted must be the tail of components list, and it can't be
@@ -111,3 +111,48 @@ int llapi_lease_put(int fd)
 	}
 	return rc;
 }
+
+/**
+ * Start resynchronizing a mirrored file, its stale components are
+ * instantiated so that they can be written with a designated mirror.
+ * A write lease must be held on \a fd.
+ *
+ * \param fd    File to resync, with a write lease on it.
+ *
+ * \retval 0 on success.
+ * \retval -errno on error.
+ */
+int llapi_lease_resync(int fd)
+{
+	int rc;
+
+	rc = ioctl(fd, LL_IOC_SET_LEASE, LL_LEASE_RESYNC);
+	if (rc < 0) {
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "cannot start resync");
+	}
+	return rc;
+}
+
+/**
+ * Release the write lease of a resynced file and clear the stale flag of
+ * its components. This fails if the lease was broken meanwhile, the file
+ * then has to be resynced again.
+ *
+ * \param fd    File being resynced, with a write lease on it.
+ *
+ * \retval 0 on success.
+ * \retval -EBUSY if the lease was broken.
+ * \retval -errno on error.
+ */
+int llapi_lease_resync_done(int fd)
+{
+	int rc;
+
+	rc = ioctl(fd, LL_IOC_SET_LEASE, LL_LEASE_RESYNC_DONE);
+	if (rc < 0) {
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "cannot finish resync");
+	}
+	return rc;
+}
@@ -0,0 +1,151 @@
+/*
+ * LGPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Lesser General Public License
+ * LGPL version 2.1 or (at your discretion) any later version.
+ * LGPL version 2.1 accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/lgpl-2.1.html
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * LGPL HEADER END
+ */
+/*
+ * Copyright (c) 2017, Intel Corporation.
+ */
+/*
+ * lustre/utils/liblustreapi_pcc.c
+ *
+ * lustreapi library for the read-only Persistent Client Cache
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include <lustre/lustreapi.h>
+#include "lustreapi_internal.h"
+
+/**
+ * Copy the data of the file opened as \a fd into the local cache of this
+ * client, the following reads of the file on this client are served from
+ * the local copy until the file is modified.
+ *
+ * \param fd	File opened for read.
+ *
+ * \retval 0 on success.
+ * \retval -errno on error.
+ */
+int llapi_pcc_attach_fd(int fd)
+{
+	int rc;
+
+	rc = ioctl(fd, LL_IOC_PCC_ATTACH);
+	/* If error, save errno value */
+	rc = rc ? -errno : 0;
+
+	return rc;
+}
+
+/**
+ * Attach the file pointed by \a path to the local cache.
+ *
+ * see llapi_pcc_attach_fd() for args use and return
+ */
+int llapi_pcc_attach(const char *path)
+{
+	int fd;
+	int rc;
+
+	fd = open(path, O_RDONLY | O_NONBLOCK);
+	if (fd < 0)
+		return -errno;
+
+	rc = llapi_pcc_attach_fd(fd);
+
+	close(fd);
+	return rc;
+}
+
+/**
+ * Stop serving the reads of the file opened as \a fd from the local cache.
+ *
+ * \retval 0 on success.
+ * \retval -errno on error.
+ */
+int llapi_pcc_detach_fd(int fd)
+{
+	int rc;
+
+	rc = ioctl(fd, LL_IOC_PCC_DETACH);
+	rc = rc ? -errno : 0;
+
+	return rc;
+}
+
+/**
+ * Detach the file pointed by \a path from the local cache.
+ *
+ * see llapi_pcc_detach_fd() for args use and return
+ */
+int llapi_pcc_detach(const char *path)
+{
+	int fd;
+	int rc;
+
+	fd = open(path, O_RDONLY | O_NONBLOCK);
+	if (fd < 0)
+		return -errno;
+
+	rc = llapi_pcc_detach_fd(fd);
+
+	close(fd);
+	return rc;
+}
+
+/**
+ * Return the local cache state of the file opened as \a fd.
+ *
+ * \param state	Where the state and the path of the local copy are saved.
+ *
+ * \retval 0 on success.
+ * \retval -errno on error.
+ */
+int llapi_pcc_state_get_fd(int fd, struct lu_pcc_state *state)
+{
+	int rc;
+
+	memset(state, 0, sizeof(*state));
+	rc = ioctl(fd, LL_IOC_PCC_STATE, state);
+	rc = rc ? -errno : 0;
+
+	return rc;
+}
+
+/**
+ * Return the local cache state of the file pointed by \a path.
+ *
+ * see llapi_pcc_state_get_fd() for args use and return
+ */
+int llapi_pcc_state_get(const char *path, struct lu_pcc_state *state)
+{
+	int fd;
+	int rc;
+
+	fd = open(path, O_RDONLY | O_NONBLOCK);
+	if (fd < 0)
+		return -errno;
+
+	rc = llapi_pcc_state_get_fd(fd, state);
+
+	close(fd);
+	return rc;
+}
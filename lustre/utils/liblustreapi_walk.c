@@ -0,0 +1,487 @@
+/*
+ * LGPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Lesser General Public License
+ * LGPL version 2.1 or (at your discretion) any later version.
+ * LGPL version 2.1 accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/lgpl-2.1.html
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * LGPL HEADER END
+ */
+/*
+ * Copyright (c) 2017, Intel Corporation.
+ */
+/*
+ * lustre/utils/liblustreapi_walk.c
+ *
+ * lustreapi library for the parallel traversal of a directory tree
+ *
+ * Every walker thread owns a queue of directories still to be read. The
+ * subdirectories found while reading a directory are queued to the thread
+ * serving the MDT of that directory, since they are most likely located on
+ * the same MDT, and a thread which runs out of work steals directories from
+ * the tail of the other queues. The other entries are passed to the callback
+ * with the open parent directory, so that their attributes and layout are
+ * fetched by IOC_MDC_GETFILEINFO without opening each of them.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <libcfs/util/list.h>
+#include <libcfs/util/string.h>
+#include <lustre/lustreapi.h>
+#include "lustreapi_internal.h"
+
+struct walk_dir {
+	struct list_head	 wd_list;
+	int			 wd_depth;
+	char			 wd_path[0];
+};
+
+struct walk_queue {
+	pthread_mutex_t		 wq_lock;
+	struct list_head	 wq_dirs;
+};
+
+struct walk_ctl {
+	const struct llapi_walk_ops	*wc_ops;
+	void				*wc_arg;
+	unsigned int			 wc_nthreads;
+	struct walk_queue		*wc_queues;
+	/* protects the counters below */
+	pthread_mutex_t			 wc_lock;
+	pthread_cond_t			 wc_cond;
+	/* directories queued, not yet picked up by a thread */
+	unsigned long			 wc_queued;
+	/* directories queued or being read, the walk ends at zero */
+	unsigned long			 wc_pending;
+	int				 wc_rc;
+};
+
+struct walk_thread {
+	struct walk_ctl		*wt_ctl;
+	unsigned int		 wt_index;
+	pthread_t		 wt_thread;
+	void			*wt_data;
+	char			 wt_path[PATH_MAX + 1];
+};
+
+static void walk_set_error(struct walk_ctl *wc, int rc)
+{
+	pthread_mutex_lock(&wc->wc_lock);
+	if (wc->wc_rc == 0)
+		wc->wc_rc = rc;
+	pthread_mutex_unlock(&wc->wc_lock);
+}
+
+static int walk_dir_push(struct walk_ctl *wc, unsigned int index,
+			 const char *path, int depth)
+{
+	struct walk_queue *wq = &wc->wc_queues[index];
+	struct walk_dir *wd;
+	size_t len = strlen(path);
+
+	wd = malloc(sizeof(*wd) + len + 1);
+	if (wd == NULL)
+		return -ENOMEM;
+
+	wd->wd_depth = depth;
+	memcpy(wd->wd_path, path, len + 1);
+
+	/* account the directory before it can be picked up, so that the
+	 * number of pending directories never drops to zero too early */
+	pthread_mutex_lock(&wc->wc_lock);
+	wc->wc_pending++;
+	wc->wc_queued++;
+	pthread_cond_signal(&wc->wc_cond);
+	pthread_mutex_unlock(&wc->wc_lock);
+
+	pthread_mutex_lock(&wq->wq_lock);
+	list_add(&wd->wd_list, &wq->wq_dirs);
+	pthread_mutex_unlock(&wq->wq_lock);
+
+	return 0;
+}
+
+/* Take the most recently queued directory of our own queue, this keeps the
+ * walk depth first per thread, or steal the oldest one from another queue. */
+static struct walk_dir *walk_dir_pop(struct walk_ctl *wc, unsigned int index)
+{
+	struct walk_dir *wd = NULL;
+	unsigned int i;
+
+	for (i = 0; i < wc->wc_nthreads && wd == NULL; i++) {
+		struct walk_queue *wq;
+
+		wq = &wc->wc_queues[(index + i) % wc->wc_nthreads];
+		pthread_mutex_lock(&wq->wq_lock);
+		if (!list_empty(&wq->wq_dirs)) {
+			if (i == 0)
+				wd = list_entry(wq->wq_dirs.next,
+						struct walk_dir, wd_list);
+			else
+				wd = list_entry(wq->wq_dirs.prev,
+						struct walk_dir, wd_list);
+			list_del(&wd->wd_list);
+		}
+		pthread_mutex_unlock(&wq->wq_lock);
+	}
+
+	if (wd != NULL) {
+		pthread_mutex_lock(&wc->wc_lock);
+		wc->wc_queued--;
+		pthread_mutex_unlock(&wc->wc_lock);
+	}
+
+	return wd;
+}
+
+/* The walk starts from a file, hand it to the callback with its parent. */
+static int walk_file(struct walk_thread *wt, char *path, int depth)
+{
+	const struct llapi_walk_ops *ops = wt->wt_ctl->wc_ops;
+	char *path_copy;
+	DIR *parent;
+	DIR *d = NULL;
+	int rc;
+
+	path_copy = strdup(path);
+	if (path_copy == NULL)
+		return -ENOMEM;
+
+	parent = opendir(dirname(path_copy));
+	if (parent == NULL) {
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "%s: Failed to open '%s'",
+			    __func__, path_copy);
+		free(path_copy);
+		return rc;
+	}
+	free(path_copy);
+
+	rc = ops->lwo_entry(path, parent, &d, NULL, depth, wt->wt_data);
+	closedir(parent);
+
+	return rc < 0 ? rc : 0;
+}
+
+static int walk_dir_read(struct walk_thread *wt, struct walk_dir *wd)
+{
+	struct walk_ctl *wc = wt->wt_ctl;
+	const struct llapi_walk_ops *ops = wc->wc_ops;
+	struct dirent64 *dent;
+	struct dirent64 de = { .d_type = DT_DIR };
+	char *path = wt->wt_path;
+	char *name;
+	unsigned int index = wt->wt_index;
+	int mdtidx;
+	int len;
+	DIR *d;
+	int rc = 0;
+
+	len = strlen(wd->wd_path);
+	memcpy(path, wd->wd_path, len + 1);
+
+	d = opendir(path);
+	if (d == NULL) {
+		if (errno == ENOTDIR && wd->wd_depth == 0)
+			return walk_file(wt, path, wd->wd_depth);
+
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "%s: Failed to open '%s'",
+			    __func__, path);
+		return rc;
+	}
+
+	/* there is no dirent for the top directory */
+	name = strrchr(wd->wd_path, '/');
+	strlcpy(de.d_name, name == NULL ? wd->wd_path : name + 1,
+		sizeof(de.d_name));
+	rc = ops->lwo_entry(path, NULL, &d, wd->wd_depth == 0 ? NULL : &de,
+			    wd->wd_depth, wt->wt_data);
+	if (rc != 0 || d == NULL)
+		goto out;
+
+	if (wc->wc_nthreads > 1 &&
+	    llapi_file_fget_mdtidx(dirfd(d), &mdtidx) == 0)
+		index = mdtidx % wc->wc_nthreads;
+
+	while ((dent = readdir64(d)) != NULL) {
+		int rc2;
+
+		if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, ".."))
+			continue;
+
+		/* Don't traverse .lustre directory */
+		if (!strcmp(dent->d_name, dot_lustre_name))
+			continue;
+
+		path[len] = 0;
+		if (len + strlen(dent->d_name) + 2 > PATH_MAX + 1) {
+			llapi_err_noerrno(LLAPI_MSG_ERROR,
+					  "error: %s: string buffer is too small",
+					  __func__);
+			break;
+		}
+		strcat(path, "/");
+		strcat(path, dent->d_name);
+
+		if (dent->d_type == DT_UNKNOWN) {
+			struct stat st;
+
+			if (fstatat(dirfd(d), dent->d_name, &st,
+				    AT_SYMLINK_NOFOLLOW) < 0) {
+				rc2 = -errno;
+				if (rc2 == -ENOENT)
+					continue;
+				llapi_error(LLAPI_MSG_ERROR, rc2,
+					    "error: %s: cannot stat '%s'",
+					    __func__, path);
+				if (rc == 0)
+					rc = rc2;
+				continue;
+			}
+			dent->d_type = IFTODT(st.st_mode);
+		}
+
+		if (dent->d_type == DT_DIR)
+			rc2 = walk_dir_push(wc, index, path, wd->wd_depth + 1);
+		else
+			rc2 = ops->lwo_entry(path, d, NULL, dent,
+					     wd->wd_depth + 1, wt->wt_data);
+		if (rc2 < 0 && rc == 0)
+			rc = rc2;
+	}
+
+out:
+	if (d != NULL)
+		closedir(d);
+
+	return rc < 0 ? rc : 0;
+}
+
+static void *walk_thread_main(void *arg)
+{
+	struct walk_thread *wt = arg;
+	struct walk_ctl *wc = wt->wt_ctl;
+	struct walk_dir *wd;
+	int rc;
+
+	for (;;) {
+		wd = walk_dir_pop(wc, wt->wt_index);
+		if (wd == NULL) {
+			bool done;
+
+			pthread_mutex_lock(&wc->wc_lock);
+			while (wc->wc_pending > 0 && wc->wc_queued == 0)
+				pthread_cond_wait(&wc->wc_cond, &wc->wc_lock);
+			done = wc->wc_pending == 0;
+			pthread_mutex_unlock(&wc->wc_lock);
+			if (done)
+				break;
+			continue;
+		}
+
+		rc = walk_dir_read(wt, wd);
+		if (rc < 0)
+			walk_set_error(wc, rc);
+		free(wd);
+
+		pthread_mutex_lock(&wc->wc_lock);
+		if (--wc->wc_pending == 0)
+			pthread_cond_broadcast(&wc->wc_cond);
+		pthread_mutex_unlock(&wc->wc_lock);
+	}
+
+	return NULL;
+}
+
+/**
+ * Walk the directory tree starting at \a path with \a nthreads threads,
+ * calling \a ops->lwo_entry() for every directory and file found. Unlike
+ * the serial traversal, the entries are visited in no particular order and
+ * a directory is read after the callback returned for it, but not
+ * necessarily before the entries of its siblings.
+ *
+ * \param path		Top of the tree, a file is passed to the callback
+ *			with its parent directory.
+ * \param nthreads	Number of walker threads, 0 means 1.
+ * \param ops		Callbacks, lwo_entry() is mandatory.
+ * \param arg		Passed to lwo_thread_init() and lwo_thread_fini(),
+ *			and to lwo_entry() if there is no lwo_thread_init().
+ *
+ * \retval 0 on success.
+ * \retval -errno of the first error found, the walk goes on after errors.
+ */
+int llapi_walk_tree(const char *path, unsigned int nthreads,
+		    const struct llapi_walk_ops *ops, void *arg)
+{
+	struct walk_ctl wc = {
+		.wc_ops		= ops,
+		.wc_arg		= arg,
+	};
+	struct walk_thread *threads;
+	unsigned int started = 0;
+	unsigned int i;
+	int rc;
+
+	if (ops == NULL || ops->lwo_entry == NULL)
+		return -EINVAL;
+
+	if (strlen(path) > PATH_MAX) {
+		rc = -EINVAL;
+		llapi_error(LLAPI_MSG_ERROR, rc,
+			    "Path name '%s' is too long", path);
+		return rc;
+	}
+
+	if (nthreads == 0)
+		nthreads = 1;
+	wc.wc_nthreads = nthreads;
+
+	wc.wc_queues = calloc(nthreads, sizeof(*wc.wc_queues));
+	threads = calloc(nthreads, sizeof(*threads));
+	if (wc.wc_queues == NULL || threads == NULL) {
+		rc = -ENOMEM;
+		goto out_free;
+	}
+
+	pthread_mutex_init(&wc.wc_lock, NULL);
+	pthread_cond_init(&wc.wc_cond, NULL);
+	for (i = 0; i < nthreads; i++) {
+		pthread_mutex_init(&wc.wc_queues[i].wq_lock, NULL);
+		INIT_LIST_HEAD(&wc.wc_queues[i].wq_dirs);
+	}
+
+	for (i = 0; i < nthreads; i++) {
+		threads[i].wt_ctl = &wc;
+		threads[i].wt_index = i;
+		threads[i].wt_data = arg;
+		if (ops->lwo_thread_init != NULL) {
+			rc = ops->lwo_thread_init(arg, &threads[i].wt_data);
+			if (rc < 0)
+				goto out_fini;
+		}
+		started++;
+	}
+
+	rc = walk_dir_push(&wc, 0, path, 0);
+	if (rc < 0)
+		goto out_fini;
+
+	/* the calling thread is walker 0 */
+	for (i = 1; i < nthreads; i++) {
+		rc = pthread_create(&threads[i].wt_thread, NULL,
+				    walk_thread_main, &threads[i]);
+		if (rc != 0) {
+			/* the threads already running finish the walk */
+			llapi_error(LLAPI_MSG_WARN, -rc,
+				    "cannot start walker thread %u", i);
+			break;
+		}
+	}
+	walk_thread_main(&threads[0]);
+	while (--i > 0)
+		pthread_join(threads[i].wt_thread, NULL);
+
+	rc = wc.wc_rc;
+out_fini:
+	for (i = 0; i < started; i++)
+		if (ops->lwo_thread_fini != NULL)
+			ops->lwo_thread_fini(arg, threads[i].wt_data);
+
+	for (i = 0; i < nthreads; i++)
+		pthread_mutex_destroy(&wc.wc_queues[i].wq_lock);
+	pthread_cond_destroy(&wc.wc_cond);
+	pthread_mutex_destroy(&wc.wc_lock);
+out_free:
+	free(threads);
+	free(wc.wc_queues);
+
+	return rc;
+}
+
+struct find_walk_arg {
+	struct find_param	*fwa_param;
+	char			*fwa_path;
+};
+
+static int find_thread_init(void *arg, void **data)
+{
+	struct find_walk_arg *fwa = arg;
+	struct find_param *param;
+	int rc;
+
+	param = malloc(sizeof(*param));
+	if (param == NULL)
+		return -ENOMEM;
+
+	memcpy(param, fwa->fwa_param, sizeof(*param));
+	rc = common_param_init(param, fwa->fwa_path);
+	if (rc < 0) {
+		find_param_fini(param);
+		free(param);
+		return rc;
+	}
+
+	*data = param;
+	return 0;
+}
+
+static void find_thread_fini(void *arg, void *data)
+{
+	find_param_fini(data);
+	free(data);
+}
+
+static int find_walk_entry(char *path, DIR *parent, DIR **dirp,
+			   struct dirent64 *de, int depth, void *data)
+{
+	struct find_param *param = data;
+
+	/* cb_find_init() compares and increments the depth as the serial
+	 * traversal goes down, here it is known from the walk */
+	param->fp_depth = depth;
+
+	return cb_find_init(path, parent, dirp, param, de);
+}
+
+static const struct llapi_walk_ops find_walk_ops = {
+	.lwo_thread_init	= find_thread_init,
+	.lwo_thread_fini	= find_thread_fini,
+	.lwo_entry		= find_walk_entry,
+};
+
+/**
+ * Same as llapi_find(), but searching the tree with \a nthreads threads.
+ * The matching names are printed in no particular order.
+ */
+int llapi_find_parallel(char *path, struct find_param *param,
+			unsigned int nthreads)
+{
+	struct find_walk_arg fwa = {
+		.fwa_param	= param,
+		.fwa_path	= path,
+	};
+
+	if (nthreads <= 1)
+		return llapi_find(path, param);
+
+	return llapi_walk_tree(path, nthreads, &find_walk_ops, &fwa);
+}
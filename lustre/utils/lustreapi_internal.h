@@ -43,6 +43,7 @@
 #include <libcfs/util/param.h>
 
 #include <linux/lustre_ioctl.h>
+#include <lustre/lustreapi.h>
 #include <uapi_kernelcomm.h>
 
 #define WANT_PATH   0x1
@@ -65,6 +66,14 @@ int sattr_cache_get_defaults(const char *const fsname,
 			     const char *const pathname, unsigned int *scount,
 			     unsigned int *ssize, unsigned int *soffset);
 
+typedef int (semantic_func_t)(char *path, DIR *parent, DIR **d,
+			      void *data, struct dirent64 *de);
+
+int common_param_init(struct find_param *param, char *path);
+void find_param_fini(struct find_param *param);
+int cb_find_init(char *path, DIR *parent, DIR **dirp, void *data,
+		 struct dirent64 *de);
+
 /**
  * Often when determining the parameter path in sysfs/procfs we
  * are often only interest set of data. This enum gives use the
@@ -296,6 +296,7 @@ check_lu_dirent(void)
 	CHECK_VALUE_X(LUDA_FID);
 	CHECK_VALUE_X(LUDA_TYPE);
 	CHECK_VALUE_X(LUDA_64BITHASH);
+	CHECK_VALUE_X(LUDA_ATTRS);
 }
 
 static void
@@ -306,6 +307,25 @@ check_luda_type(void)
 	CHECK_MEMBER(luda_type, lt_type);
 }
 
+static void
+check_luda_attrs(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(luda_attrs);
+	CHECK_MEMBER(luda_attrs, lat_valid);
+	CHECK_MEMBER(luda_attrs, lat_size);
+	CHECK_MEMBER(luda_attrs, lat_blocks);
+	CHECK_MEMBER(luda_attrs, lat_mtime);
+	CHECK_MEMBER(luda_attrs, lat_atime);
+	CHECK_MEMBER(luda_attrs, lat_ctime);
+	CHECK_MEMBER(luda_attrs, lat_mode);
+	CHECK_MEMBER(luda_attrs, lat_nlink);
+	CHECK_MEMBER(luda_attrs, lat_uid);
+	CHECK_MEMBER(luda_attrs, lat_gid);
+	CHECK_MEMBER(luda_attrs, lat_rdev);
+	CHECK_MEMBER(luda_attrs, lat_flags);
+}
+
 static void
 check_lu_dirpage(void)
 {
@@ -594,6 +614,11 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT_OBDOPACK);
 	CHECK_DEFINE_64X(OBD_CONNECT_FLAGS2);
 	CHECK_DEFINE_64X(OBD_CONNECT2_FILE_SECCTX);
+	CHECK_DEFINE_64X(OBD_CONNECT2_DOM);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_GETATTR);
+	CHECK_DEFINE_64X(OBD_CONNECT2_READDIR_PLUS);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_REINT);
+	CHECK_DEFINE_64X(OBD_CONNECT2_LOCK_CONVERT);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -764,7 +789,7 @@ check_lov_mds_md_v3(void)
 
 	CHECK_VALUE_X(LOV_PATTERN_RAID0);
 	CHECK_VALUE_X(LOV_PATTERN_RAID1);
-	CHECK_VALUE_X(LOV_PATTERN_FIRST);
+	CHECK_VALUE_X(LOV_PATTERN_MDT);
 	CHECK_VALUE_X(LOV_PATTERN_CMOBD);
 }
 
@@ -793,11 +818,17 @@ check_lov_comp_md_v1(void)
 	CHECK_MEMBER(lov_comp_md_v1, lcm_layout_gen);
 	CHECK_MEMBER(lov_comp_md_v1, lcm_flags);
 	CHECK_MEMBER(lov_comp_md_v1, lcm_entry_count);
+	CHECK_MEMBER(lov_comp_md_v1, lcm_mirror_count);
 	CHECK_MEMBER(lov_comp_md_v1, lcm_padding1);
 	CHECK_MEMBER(lov_comp_md_v1, lcm_padding2);
 	CHECK_MEMBER(lov_comp_md_v1, lcm_entries[0]);
 
 	CHECK_CDEFINE(LOV_MAGIC_COMP_V1);
+
+	CHECK_VALUE(LCM_FL_NONE);
+	CHECK_VALUE(LCM_FL_RDONLY);
+	CHECK_VALUE(LCM_FL_WRITE_PENDING);
+	CHECK_VALUE(LCM_FL_SYNC_PENDING);
 }
 
 static void
@@ -1374,6 +1405,7 @@ check_ldlm_inodebits(void)
 	BLANK_LINE();
 	CHECK_STRUCT(ldlm_inodebits);
 	CHECK_MEMBER(ldlm_inodebits, bits);
+	CHECK_MEMBER(ldlm_inodebits, cancel_bits);
 }
 
 static void
@@ -1455,6 +1487,39 @@ check_ldlm_reply(void)
 	CHECK_MEMBER(ldlm_reply, lock_policy_res2);
 }
 
+static void
+check_mdt_batch_getattr(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(mdt_batch_getattr);
+	CHECK_MEMBER(mdt_batch_getattr, mbg_count);
+	CHECK_MEMBER(mdt_batch_getattr, mbg_padding);
+}
+
+static void
+check_mdt_batch_getattr_req(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(mdt_batch_getattr_req);
+	CHECK_MEMBER(mdt_batch_getattr_req, mbq_lockreq);
+	CHECK_MEMBER(mdt_batch_getattr_req, mbq_fid);
+	CHECK_MEMBER(mdt_batch_getattr_req, mbq_namelen);
+	CHECK_MEMBER(mdt_batch_getattr_req, mbq_padding);
+	CHECK_MEMBER(mdt_batch_getattr_req, mbq_name);
+}
+
+static void
+check_mdt_batch_getattr_rep(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(mdt_batch_getattr_rep);
+	CHECK_MEMBER(mdt_batch_getattr_rep, mbp_rc);
+	CHECK_MEMBER(mdt_batch_getattr_rep, mbp_padding);
+	CHECK_MEMBER(mdt_batch_getattr_rep, mbp_lockrep);
+	CHECK_MEMBER(mdt_batch_getattr_rep, mbp_body);
+	CHECK_MEMBER(mdt_batch_getattr_rep, mbp_data);
+}
+
 static void
 check_ldlm_ost_lvb_v1(void)
 {
@@ -2168,6 +2233,8 @@ static void check_layout_intent(void)
 	CHECK_VALUE(LAYOUT_INTENT_TRUNC);
 	CHECK_VALUE(LAYOUT_INTENT_RELEASE);
 	CHECK_VALUE(LAYOUT_INTENT_RESTORE);
+	CHECK_VALUE(LAYOUT_INTENT_RESYNC);
+	CHECK_VALUE(LAYOUT_INTENT_RESYNC_DONE);
 }
 
 static void check_hsm_state_set(void)
@@ -2592,6 +2659,8 @@ main(int argc, char **argv)
 	CHECK_VALUE(MDS_HSM_CT_REGISTER);
 	CHECK_VALUE(MDS_HSM_CT_UNREGISTER);
 	CHECK_VALUE(MDS_SWAP_LAYOUTS);
+	CHECK_VALUE(MDS_BATCH_GETATTR);
+	CHECK_VALUE(MDS_BATCH_REINT);
 	CHECK_VALUE(MDS_LAST_OPC);
 
 	CHECK_VALUE(REINT_SETATTR);
@@ -2748,6 +2817,7 @@ main(int argc, char **argv)
 	check_ost_id();
 	check_lu_dirent();
 	check_luda_type();
+	check_luda_attrs();
 	check_lu_dirpage();
 	check_lu_ladvise();
 	check_ladvise_hdr();
@@ -2790,6 +2860,9 @@ main(int argc, char **argv)
 	check_ldlm_lock_desc();
 	check_ldlm_request();
 	check_ldlm_reply();
+	check_mdt_batch_getattr();
+	check_mdt_batch_getattr_req();
+	check_mdt_batch_getattr_rep();
 	check_ldlm_ost_lvb_v1();
 	check_ldlm_ost_lvb();
 	check_ldlm_lquota_lvb();
@@ -194,7 +194,11 @@ void lustre_assert_wire_constants(void)
 		 (long long)MDS_HSM_CT_UNREGISTER);
 	LASSERTF(MDS_SWAP_LAYOUTS == 61, "found %lld\n",
 		 (long long)MDS_SWAP_LAYOUTS);
-	LASSERTF(MDS_LAST_OPC == 62, "found %lld\n",
+	LASSERTF(MDS_BATCH_GETATTR == 62, "found %lld\n",
+		 (long long)MDS_BATCH_GETATTR);
+	LASSERTF(MDS_BATCH_REINT == 63, "found %lld\n",
+		 (long long)MDS_BATCH_REINT);
+	LASSERTF(MDS_LAST_OPC == 64, "found %lld\n",
 		 (long long)MDS_LAST_OPC);
 	LASSERTF(REINT_SETATTR == 1, "found %lld\n",
 		 (long long)REINT_SETATTR);
@@ -633,6 +637,8 @@ void lustre_assert_wire_constants(void)
 		(unsigned)LUDA_TYPE);
 	LASSERTF(LUDA_64BITHASH == 0x00000004UL, "found 0x%.8xUL\n",
 		(unsigned)LUDA_64BITHASH);
+	LASSERTF(LUDA_ATTRS == 0x00000008UL, "found 0x%.8xUL\n",
+		(unsigned)LUDA_ATTRS);
 
 	/* Checks for struct luda_type */
 	LASSERTF((int)sizeof(struct luda_type) == 2, "found %lld\n",
@@ -642,6 +648,58 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct luda_type *)0)->lt_type) == 2, "found %lld\n",
 		 (long long)(int)sizeof(((struct luda_type *)0)->lt_type));
 
+	/* Checks for struct luda_attrs */
+	LASSERTF((int)sizeof(struct luda_attrs) == 72, "found %lld\n",
+		 (long long)(int)sizeof(struct luda_attrs));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_valid) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_valid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_valid) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_valid));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_size));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_size) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_size));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_blocks) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_blocks));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_blocks) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_blocks));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_mtime) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_mtime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_mtime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_mtime));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_atime) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_atime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_atime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_atime));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_ctime) == 40, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_ctime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_ctime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_ctime));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_mode) == 48, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_mode));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_mode) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_mode));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_nlink) == 52, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_nlink));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_nlink) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_nlink));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_uid) == 56, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_uid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_uid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_uid));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_gid) == 60, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_gid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_gid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_gid));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_rdev) == 64, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_rdev));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_rdev) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_rdev));
+	LASSERTF((int)offsetof(struct luda_attrs, lat_flags) == 68, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lat_flags));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lat_flags) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lat_flags));
+
 	/* Checks for struct lu_dirpage */
 	LASSERTF((int)sizeof(struct lu_dirpage) == 24, "found %lld\n",
 		 (long long)(int)sizeof(struct lu_dirpage));
@@ -1258,6 +1316,16 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT_FLAGS2);
 	LASSERTF(OBD_CONNECT2_FILE_SECCTX == 0x1ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_FILE_SECCTX);
+	LASSERTF(OBD_CONNECT2_DOM == 0x2ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_DOM);
+	LASSERTF(OBD_CONNECT2_BATCH_GETATTR == 0x4ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_GETATTR);
+	LASSERTF(OBD_CONNECT2_READDIR_PLUS == 0x8ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_READDIR_PLUS);
+	LASSERTF(OBD_CONNECT2_BATCH_REINT == 0x10ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_REINT);
+	LASSERTF(OBD_CONNECT2_LOCK_CONVERT == 0x20ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_LOCK_CONVERT);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1617,8 +1685,8 @@ void lustre_assert_wire_constants(void)
 		(unsigned)LOV_PATTERN_RAID0);
 	LASSERTF(LOV_PATTERN_RAID1 == 0x00000002UL, "found 0x%.8xUL\n",
 		(unsigned)LOV_PATTERN_RAID1);
-	LASSERTF(LOV_PATTERN_FIRST == 0x00000100UL, "found 0x%.8xUL\n",
-		(unsigned)LOV_PATTERN_FIRST);
+	LASSERTF(LOV_PATTERN_MDT == 0x00000100UL, "found 0x%.8xUL\n",
+		(unsigned)LOV_PATTERN_MDT);
 	LASSERTF(LOV_PATTERN_CMOBD == 0x00000200UL, "found 0x%.8xUL\n",
 		(unsigned)LOV_PATTERN_CMOBD);
 
@@ -1675,9 +1743,13 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct lov_comp_md_v1, lcm_entry_count));
 	LASSERTF((int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_entry_count) == 2, "found %lld\n",
 		 (long long)(int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_entry_count));
-	LASSERTF((int)offsetof(struct lov_comp_md_v1, lcm_padding1) == 16, "found %lld\n",
+	LASSERTF((int)offsetof(struct lov_comp_md_v1, lcm_mirror_count) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct lov_comp_md_v1, lcm_mirror_count));
+	LASSERTF((int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_mirror_count) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_mirror_count));
+	LASSERTF((int)offsetof(struct lov_comp_md_v1, lcm_padding1) == 18, "found %lld\n",
 		 (long long)(int)offsetof(struct lov_comp_md_v1, lcm_padding1));
-	LASSERTF((int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_padding1) == 8, "found %lld\n",
+	LASSERTF((int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_padding1) == 6, "found %lld\n",
 		 (long long)(int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_padding1));
 	LASSERTF((int)offsetof(struct lov_comp_md_v1, lcm_padding2) == 24, "found %lld\n",
 		 (long long)(int)offsetof(struct lov_comp_md_v1, lcm_padding2));
@@ -1688,6 +1760,14 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_entries[0]) == 48, "found %lld\n",
 		 (long long)(int)sizeof(((struct lov_comp_md_v1 *)0)->lcm_entries[0]));
 	CLASSERT(LOV_MAGIC_COMP_V1 == (0x0BD60000 | 0x0BD0));
+	LASSERTF(LCM_FL_NONE == 0, "found %lld\n",
+		 (long long)LCM_FL_NONE);
+	LASSERTF(LCM_FL_RDONLY == 1, "found %lld\n",
+		 (long long)LCM_FL_RDONLY);
+	LASSERTF(LCM_FL_WRITE_PENDING == 2, "found %lld\n",
+		 (long long)LCM_FL_WRITE_PENDING);
+	LASSERTF(LCM_FL_SYNC_PENDING == 3, "found %lld\n",
+		 (long long)LCM_FL_SYNC_PENDING);
 
 	/* Checks for struct lmv_mds_md_v1 */
 	LASSERTF((int)sizeof(struct lmv_mds_md_v1) == 56, "found %lld\n",
@@ -3182,12 +3262,16 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)sizeof(((struct ldlm_extent *)0)->gid));
 
 	/* Checks for struct ldlm_inodebits */
-	LASSERTF((int)sizeof(struct ldlm_inodebits) == 8, "found %lld\n",
+	LASSERTF((int)sizeof(struct ldlm_inodebits) == 16, "found %lld\n",
 		 (long long)(int)sizeof(struct ldlm_inodebits));
 	LASSERTF((int)offsetof(struct ldlm_inodebits, bits) == 0, "found %lld\n",
 		 (long long)(int)offsetof(struct ldlm_inodebits, bits));
 	LASSERTF((int)sizeof(((struct ldlm_inodebits *)0)->bits) == 8, "found %lld\n",
 		 (long long)(int)sizeof(((struct ldlm_inodebits *)0)->bits));
+	LASSERTF((int)offsetof(struct ldlm_inodebits, cancel_bits) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct ldlm_inodebits, cancel_bits));
+	LASSERTF((int)sizeof(((struct ldlm_inodebits *)0)->cancel_bits) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct ldlm_inodebits *)0)->cancel_bits));
 
 	/* Checks for struct ldlm_flock_wire */
 	LASSERTF((int)sizeof(struct ldlm_flock_wire) == 32, "found %lld\n",
@@ -3333,6 +3417,66 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct ldlm_reply *)0)->lock_policy_res2) == 8, "found %lld\n",
 		 (long long)(int)sizeof(((struct ldlm_reply *)0)->lock_policy_res2));
 
+	/* Checks for struct mdt_batch_getattr */
+	LASSERTF((int)sizeof(struct mdt_batch_getattr) == 8, "found %lld\n",
+		 (long long)(int)sizeof(struct mdt_batch_getattr));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr, mbg_count) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr, mbg_count));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr *)0)->mbg_count) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr *)0)->mbg_count));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr, mbg_padding) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr, mbg_padding));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr *)0)->mbg_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr *)0)->mbg_padding));
+
+	/* Checks for struct mdt_batch_getattr_req */
+	LASSERTF((int)sizeof(struct mdt_batch_getattr_req) == 128, "found %lld\n",
+		 (long long)(int)sizeof(struct mdt_batch_getattr_req));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_req, mbq_lockreq) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_req, mbq_lockreq));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_lockreq) == 104, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_lockreq));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_req, mbq_fid) == 104, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_req, mbq_fid));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_fid) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_fid));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_req, mbq_namelen) == 120, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_req, mbq_namelen));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_namelen) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_namelen));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_req, mbq_padding) == 124, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_req, mbq_padding));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_padding));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_req, mbq_name) == 128, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_req, mbq_name));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_name) == 0, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_req *)0)->mbq_name));
+
+	/* Checks for struct mdt_batch_getattr_rep */
+	LASSERTF((int)sizeof(struct mdt_batch_getattr_rep) == 336, "found %lld\n",
+		 (long long)(int)sizeof(struct mdt_batch_getattr_rep));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_rep, mbp_rc) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_rep, mbp_rc));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_rc) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_rc));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_rep, mbp_padding) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_rep, mbp_padding));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_padding));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_rep, mbp_lockrep) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_rep, mbp_lockrep));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_lockrep) == 112, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_lockrep));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_rep, mbp_body) == 120, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_rep, mbp_body));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_body) == 216, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_body));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_rep, mbp_data) == 336, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_rep, mbp_data));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_data) == 0, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_rep *)0)->mbp_data));
+
 	/* Checks for struct ost_lvb_v1 */
 	LASSERTF((int)sizeof(struct ost_lvb_v1) == 40, "found %lld\n",
 		 (long long)(int)sizeof(struct ost_lvb_v1));
@@ -4466,6 +4610,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)LAYOUT_INTENT_RELEASE);
 	LASSERTF(LAYOUT_INTENT_RESTORE == 6, "found %lld\n",
 		 (long long)LAYOUT_INTENT_RESTORE);
+	LASSERTF(LAYOUT_INTENT_RESYNC == 7, "found %lld\n",
+		 (long long)LAYOUT_INTENT_RESYNC);
+	LASSERTF(LAYOUT_INTENT_RESYNC_DONE == 8, "found %lld\n",
+		 (long long)LAYOUT_INTENT_RESYNC_DONE);
 
 	/* Checks for struct hsm_action_item */
 	LASSERTF((int)sizeof(struct hsm_action_item) == 72, "found %lld\n",